@@ -0,0 +1,82 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+
+TEST(BMPKeepsTheMessageInEveryLayout) {
+	FileHandler fileHandler;
+	const std::string message = "Message stored in a .bmp of any layout";
+	// Width 21 pads the 24 bit rows, V5 with 32 bits stores the pixels as bit fields
+	const uint16_t bitsPerPixel[] = { 24, 32, 32 };
+	const uint32_t infoHeaderSizes[] = { 40, 40, 124 };
+	for (int layout = 0; layout < 3; layout++) {
+		for (bool topDown : { false, true }) {
+			const std::string original = TestImages::createBMP(21, 30, bitsPerPixel[layout], infoHeaderSizes[layout], topDown, 45 + layout);
+			const std::string filePath = TestImages::writeFile("layout.bmp", original);
+			CHECK(fileHandler.encodeMessage(filePath, message, EncodeOptions()));
+
+			std::string decoded;
+			CHECK(fileHandler.readEncodedMessage(filePath, decoded));
+			CHECK(decoded == message);
+
+			// Header and the zero padding of the rows are written back unchanged
+			const std::string encoded = TestImages::readFile(filePath);
+			const size_t dataOffset = 14 + infoHeaderSizes[layout];
+			const size_t rowLength = 21 * bitsPerPixel[layout] / 8, paddedRowLength = (rowLength + 3) / 4 * 4;
+			CHECK(encoded.size() == original.size());
+			CHECK(encoded.compare(0, dataOffset, original, 0, dataOffset) == 0);
+			for (size_t i = dataOffset; i < encoded.size(); i++) {
+				CHECK((i - dataOffset) % paddedRowLength < rowLength || encoded[i] == original[i]);
+			}
+		}
+	}
+}
+
+TEST(BMPUpdateWritesInPlaceInEveryLayout) {
+	FileHandler fileHandler;
+	for (bool topDown : { false, true }) {
+		const std::string filePath = TestImages::writeFile("inplace.bmp", TestImages::createBMP(21, 30, 32, 124, topDown, 46));
+		CHECK(fileHandler.encodeMessage(filePath, "First message of the image", EncodeOptions()));
+		size_t changedBytes = 0;
+		CHECK(fileHandler.updateMessage(filePath, "Other message of the image", EncodeOptions(), changedBytes));
+		CHECK(changedBytes > 0);
+
+		std::string decoded;
+		CHECK(fileHandler.readEncodedMessage(filePath, decoded));
+		CHECK(decoded == "Other message of the image");
+	}
+}
+
+TEST(BMPTopDownKeepsThePictureUpright) {
+	FileHandler fileHandler;
+	// Same bytes of the pixels, stored once from the bottom and once from the top of the picture
+	const std::string bottomUpPath = TestImages::writeFile("bottomup.bmp", TestImages::createBMP(8, 6, 24, 40, false, 47));
+	const std::string topDownPath = TestImages::writeFile("topdown.bmp", TestImages::createBMP(8, 6, 24, 40, true, 47));
+
+	Image bottomUp, topDown;
+	CHECK(fileHandler.loadImage(bottomUpPath, bottomUp));
+	CHECK(fileHandler.loadImage(topDownPath, topDown));
+	for (uint32_t y = 0; y < 6; y++) {
+		const uint8_t* bottomUpRow = bottomUp.getTopRow() + y * bottomUp.getRowStride();
+		const uint8_t* topDownRow = topDown.getTopRow() + (5 - y) * topDown.getRowStride();
+		CHECK(std::memcmp(bottomUpRow, topDownRow, bottomUp.getRowLength()) == 0);
+	}
+	fileHandler.unloadImage(bottomUp);
+	fileHandler.unloadImage(topDown);
+}
+
+TEST(BMPWithOtherColorMasksIsRejected) {
+	FileHandler fileHandler;
+	std::string original = TestImages::createBMP(10, 10, 32, 124, false, 48);
+	// Red and blue masks swapped - the bytes of a pixel are red, green, blue
+	original[54] = '\xFF', original[56] = '\0';
+	original[62] = '\0', original[64] = '\xFF';
+	const std::string filePath = TestImages::writeFile("masks.bmp", original);
+	EncodeOptions region;
+	region.region.y = 2, region.region.height = 6;
+	size_t changedBytes = 0;
+	CHECK(!fileHandler.encodeMessage(filePath, "Message", EncodeOptions()));
+	CHECK(!fileHandler.encodeMessage(filePath, "Message", region));
+	CHECK(!fileHandler.updateMessage(filePath, "Message", EncodeOptions(), changedBytes));
+	CHECK(TestImages::readFile(filePath) == original);
+}
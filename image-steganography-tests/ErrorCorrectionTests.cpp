@@ -0,0 +1,78 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/ErrorCorrection.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+
+/// <summary>
+/// Flip one bit in each of the given number of bytes of every block of the encoded message
+/// </summary>
+/// <param name="encoded">Message with the parity bytes, modified in place</param>
+/// <param name="level">Level of error correction the message has been encoded with</param>
+/// <param name="errorsPerBlock">Number of broken bytes in every block</param>
+/// <returns>Returns the number of broken bytes</returns>
+static size_t breakBlocks(std::string& encoded, int level, size_t errorsPerBlock) {
+	const size_t blockLength = ErrorCorrection::getBlockDataLength(level) + ErrorCorrection::getParityLength(level);
+	size_t broken = 0;
+	for (size_t start = 0; start < encoded.length(); start += blockLength) {
+		const size_t length = std::min(blockLength, encoded.length() - start);
+		// Spread over the block, so data and parity bytes are both broken
+		for (size_t i = 0; i < errorsPerBlock && i < length; i++) {
+			encoded[start + i * length / errorsPerBlock] ^= (char)(1 << (i % 8));
+			broken++;
+		}
+	}
+	return broken;
+}
+
+TEST(ErrorCorrectionFixesHalfOfTheParityInEveryBlock) {
+	ErrorCorrection errorCorrection;
+	const std::string message = TestImages::createBytes(1000, 27);
+	for (int level = 1; level <= 3; level++) {
+		std::string encoded = errorCorrection.encode(message, level);
+		CHECK(encoded.length() == errorCorrection.getEncodedLength(message.length(), level));
+
+		const size_t broken = breakBlocks(encoded, level, ErrorCorrection::getParityLength(level) / 2);
+		std::string decoded;
+		CHECK(errorCorrection.decode(encoded, message.length(), level, decoded) == (long long)broken);
+		CHECK(decoded == message);
+	}
+}
+
+TEST(ErrorCorrectionNeverReturnsAWrongMessageAsFixed) {
+	ErrorCorrection errorCorrection;
+	const std::string message = TestImages::createBytes(600, 28);
+	for (int level = 1; level <= 3; level++) {
+		std::string encoded = errorCorrection.encode(message, level);
+		breakBlocks(encoded, level, ErrorCorrection::getParityLength(level) / 2 + 1);
+		std::string decoded;
+		const long long fixed = errorCorrection.decode(encoded, message.length(), level, decoded);
+		CHECK(fixed < 0 || decoded != message);
+	}
+}
+
+TEST(ErrorCorrectionKeepsTheMessageOfAnImageWithFlippedBits) {
+	FileHandler fileHandler;
+	ImageHandler imageHandler;
+	const std::string message = "Message that survives flipped lowest bits of the image";
+	for (int level = 0; level <= 2; level++) {
+		Image image;
+		CHECK(fileHandler.loadImage(TestImages::writeFile("fec.ppm", TestImages::createPPM(64, 64, 29)), image));
+
+		EncodeOptions options;
+		options.fecLevel = level;
+		CHECK(imageHandler.encodeMessageInImage(image, message, options));
+
+		// Last bits of the payload are the data, with error correction their bytes all lie in the last block
+		std::vector<bool> bits;
+		CHECK(imageHandler.readPayloadBits(image, bits));
+		for (size_t i = 1; i <= 3; i++) {
+			bits[bits.size() - i * 8 * 5] = !bits[bits.size() - i * 8 * 5];
+		}
+		CHECK(imageHandler.writePayloadBits(image, bits));
+
+		const std::string decoded = imageHandler.decodeMessageInImage(image);
+		CHECK(level == 0 ? decoded != message : decoded == message);
+		fileHandler.unloadImage(image);
+	}
+}
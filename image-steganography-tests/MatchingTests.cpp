@@ -0,0 +1,82 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+
+/// <summary>
+/// Encode the message into a copy of the image with LSB matching
+/// </summary>
+/// <param name="fileHandler">File handler that encodes the image</param>
+/// <param name="original">Bytes of the image</param>
+/// <param name="message">Message that will be encoded</param>
+/// <param name="options">Options chosen for encoding, LSB matching is turned on</param>
+/// <param name="encoded">Modifies the passed bytes with the encoded image</param>
+/// <returns>Returns true if the message has been encoded and decodes back</returns>
+static bool encodeMatching(const FileHandler& fileHandler, const std::string& original, const std::string& message,
+	EncodeOptions options, std::string& encoded) {
+	options.lsbMatching = true;
+	const std::string filePath = TestImages::writeFile("matching.ppm", original);
+	std::string decoded;
+	if (!fileHandler.encodeMessage(filePath, message, options) || !fileHandler.readEncodedMessage(filePath, decoded)) {
+		return false;
+	}
+	encoded = TestImages::readFile(filePath);
+	return decoded == message;
+}
+
+TEST(MatchingChangesEveryChannelByOne) {
+	FileHandler fileHandler;
+	const std::string original = TestImages::createPPM(80, 80, 44);
+	const std::string message = "Message stored by adding or subtracting one";
+	EncodeOptions plain, corrected, matrix;
+	plain.matchingSeed = corrected.matchingSeed = matrix.matchingSeed = 7;
+	corrected.fecLevel = 1;
+	matrix.matrixLevel = 2;
+	for (const EncodeOptions& options : { plain, corrected, matrix }) {
+		std::string encoded;
+		CHECK(encodeMatching(fileHandler, original, message, options, encoded));
+
+		// Unlike replacing the lowest bit, a change by one could carry into the higher bits
+		size_t carried = 0;
+		for (size_t i = 0; i < encoded.size(); i++) {
+			const int difference = (uint8_t)encoded[i] - (uint8_t)original[i];
+			CHECK(difference >= -1 && difference <= 1);
+			carried += ((uint8_t)encoded[i] ^ (uint8_t)original[i]) > 1 ? 1 : 0;
+		}
+		CHECK(carried > 0);
+	}
+}
+
+TEST(MatchingNeverWrapsAroundTheChannelRange) {
+	FileHandler fileHandler;
+	// Header of a .ppm with pixels of only the lowest and the highest value
+	std::string original = TestImages::createPPM(60, 60, 0);
+	const size_t headerLength = original.size() - 60 * 60 * 3;
+	for (size_t i = headerLength; i < original.size(); i++) {
+		original[i] = (i / 3) % 2 == 0 ? '\0' : '\xFF';
+	}
+
+	EncodeOptions options;
+	options.matchingSeed = 8;
+	std::string encoded;
+	CHECK(encodeMatching(fileHandler, original, "Message in the darkest and brightest pixels", options, encoded));
+	for (size_t i = headerLength; i < encoded.size(); i++) {
+		const int difference = (uint8_t)encoded[i] - (uint8_t)original[i];
+		CHECK(difference >= -1 && difference <= 1);
+	}
+}
+
+TEST(MatchingWithTheSameSeedGivesTheSameImage) {
+	FileHandler fileHandler;
+	const std::string original = TestImages::createPPM(50, 50, 45);
+	const std::string message = "Message that is stored three times";
+	EncodeOptions options;
+	options.matchingSeed = 9;
+	std::string first, second, third;
+	CHECK(encodeMatching(fileHandler, original, message, options, first));
+	CHECK(encodeMatching(fileHandler, original, message, options, second));
+	options.matchingSeed = 10;
+	CHECK(encodeMatching(fileHandler, original, message, options, third));
+	CHECK(first == second);
+	CHECK(first != third);
+}
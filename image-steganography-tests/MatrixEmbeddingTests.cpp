@@ -0,0 +1,74 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+#include "../image-steganography/src/MatrixEmbedding.hpp"
+
+/// <summary>
+/// Encode the message into a copy of the image and count the bytes of the file that changed
+/// </summary>
+/// <param name="fileHandler">File handler that encodes the image</param>
+/// <param name="original">Bytes of the image</param>
+/// <param name="message">Message that will be encoded</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <param name="changedBytes">Modifies the passed count with the number of bytes that changed</param>
+/// <returns>Returns true if the message has been encoded and decodes back</returns>
+static bool encodeAndCount(const FileHandler& fileHandler, const std::string& original, const std::string& message,
+	const EncodeOptions& options, size_t& changedBytes) {
+	const std::string filePath = TestImages::writeFile("matrix.ppm", original);
+	std::string decoded;
+	if (!fileHandler.encodeMessage(filePath, message, options) || !fileHandler.readEncodedMessage(filePath, decoded)) {
+		return false;
+	}
+
+	const std::string encoded = TestImages::readFile(filePath);
+	changedBytes = 0;
+	for (size_t i = 0; i < encoded.size(); i++) {
+		changedBytes += encoded[i] != original[i] ? 1 : 0;
+	}
+	return decoded == message;
+}
+
+TEST(MatrixEmbeddingDecodesAtEverySupportedLevel) {
+	FileHandler fileHandler;
+	const std::string original = TestImages::createPPM(100, 100, 43);
+	const std::string message = TestImages::createBytes(100, 430);
+	for (int level = 2; level <= 7; level++) {
+		CHECK(MatrixEmbedding::isSupportedLevel(level));
+		EncodeOptions options;
+		options.matrixLevel = level;
+		options.fecLevel = level % 2;
+		size_t changedBytes = 0;
+		CHECK(encodeAndCount(fileHandler, original, message, options, changedBytes));
+	}
+}
+
+TEST(MatrixEmbeddingChangesFewerChannels) {
+	FileHandler fileHandler;
+	const std::string original = TestImages::createPPM(100, 100, 44);
+	const std::string message = TestImages::createBytes(300, 440);
+
+	// Error correction stores the message with the header, the same layout matrix embedding uses
+	EncodeOptions plain, matrix;
+	plain.fecLevel = 1;
+	matrix.fecLevel = 1;
+	matrix.matrixLevel = 3;
+	size_t plainChanges = 0, matrixChanges = 0;
+	CHECK(encodeAndCount(fileHandler, original, message, plain, plainChanges));
+	CHECK(encodeAndCount(fileHandler, original, message, matrix, matrixChanges));
+	// One change per 3 bits at most, against about one per 2 bits when every bit has its own channel
+	CHECK(matrixChanges * 4 < plainChanges * 3);
+}
+
+TEST(MatrixEmbeddingRejectsUnsupportedLevels) {
+	FileHandler fileHandler;
+	const std::string original = TestImages::createPPM(30, 30, 45);
+	const std::string filePath = TestImages::writeFile("level.ppm", original);
+	for (int level : { 1, 8 }) {
+		CHECK(!MatrixEmbedding::isSupportedLevel(level));
+		EncodeOptions options;
+		options.matrixLevel = level;
+		CHECK(!fileHandler.encodeMessage(filePath, "Message", options));
+		CHECK(TestImages::readFile(filePath) == original);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+
+TEST(PGMKeepsTheMessageAndTheHigherBytes) {
+	FileHandler fileHandler;
+	const std::string message = "Message stored in the lower bytes of the samples";
+	for (uint32_t maxValue : { 255, 65535 }) {
+		const std::string original = TestImages::createPGM(50, 40, maxValue, 47);
+		const std::string filePath = TestImages::writeFile("samples.pgm", original);
+		CHECK(fileHandler.encodeMessage(filePath, message, EncodeOptions()));
+
+		std::string decoded;
+		CHECK(fileHandler.readEncodedMessage(filePath, decoded));
+		CHECK(decoded == message);
+
+		// Only the lowest bit of the lower byte of a sample could change, the higher byte of 16 bit samples never does
+		const std::string encoded = TestImages::readFile(filePath);
+		const size_t sampleLength = maxValue > 255 ? 2 : 1;
+		const size_t headerLength = original.size() - 50 * 40 * sampleLength;
+		CHECK(encoded.size() == original.size());
+		CHECK(encoded.compare(0, headerLength, original, 0, headerLength) == 0);
+		size_t changedBytes = 0;
+		for (size_t i = headerLength; i < encoded.size(); i++) {
+			const bool lowerByte = (i - headerLength) % sampleLength == sampleLength - 1;
+			CHECK(encoded[i] == original[i] || (lowerByte && ((uint8_t)encoded[i] ^ (uint8_t)original[i]) == 1));
+			changedBytes += encoded[i] != original[i] ? 1 : 0;
+		}
+		CHECK(changedBytes > 0);
+	}
+}
+
+TEST(PGMUpdateKeepsTheHigherBytes) {
+	FileHandler fileHandler;
+	const std::string original = TestImages::createPGM(50, 40, 65535, 48);
+	const std::string filePath = TestImages::writeFile("update.pgm", original);
+	CHECK(fileHandler.encodeMessage(filePath, "First message of the image", EncodeOptions()));
+	size_t changedBytes = 0;
+	CHECK(fileHandler.updateMessage(filePath, "Other message of the image", EncodeOptions(), changedBytes));
+	CHECK(changedBytes > 0);
+
+	std::string decoded;
+	CHECK(fileHandler.readEncodedMessage(filePath, decoded));
+	CHECK(decoded == "Other message of the image");
+	const std::string encoded = TestImages::readFile(filePath);
+	const size_t headerLength = original.size() - 50 * 40 * 2;
+	for (size_t i = headerLength; i < encoded.size(); i += 2) {
+		CHECK(encoded[i] == original[i]);
+	}
+}
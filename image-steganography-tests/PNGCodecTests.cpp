@@ -0,0 +1,103 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/Deflater.hpp"
+#include "../image-steganography/src/Inflater.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+
+/// <summary>
+/// Compress the data with the deflater, passed to it in pieces of an odd length
+/// </summary>
+/// <param name="data">Data to compress</param>
+/// <param name="bestCompression">Search harder for matches</param>
+/// <returns>Returns the zlib stream</returns>
+static std::string deflate(const std::string& data, bool bestCompression) {
+	std::string compressed;
+	Deflater deflater([&compressed](const uint8_t* bytes, size_t length) {
+		compressed.append((const char*)bytes, length);
+		return true;
+	}, bestCompression);
+	for (size_t offset = 0; offset < data.size(); offset += 1007) {
+		deflater.write((const uint8_t*)data.data() + offset, std::min((size_t)1007, data.size() - offset));
+	}
+	deflater.finish();
+	return compressed;
+}
+
+/// <summary>
+/// Decompress the zlib stream with the inflater, pulled from it in pieces of an odd length
+/// </summary>
+/// <param name="compressed">zlib stream</param>
+/// <param name="length">Number of bytes of the decompressed data</param>
+/// <param name="data">Modifies the passed data with the decompressed bytes</param>
+/// <returns>Returns true if the stream has been decompressed and its checksum matches</returns>
+static bool inflate(const std::string& compressed, size_t length, std::string& data) {
+	size_t offset = 0;
+	Inflater inflater([&](uint8_t* buffer, size_t size) {
+		const size_t count = std::min(size, compressed.size() - offset);
+		std::memcpy(buffer, compressed.data() + offset, count);
+		offset += count;
+		return count;
+	});
+	data.assign(length, '\0');
+	for (size_t start = 0; start < length; start += 4093) {
+		if (!inflater.read((uint8_t*)&data[start], std::min((size_t)4093, length - start))) {
+			return false;
+		}
+	}
+	return inflater.finish();
+}
+
+TEST(DeflateOutputInflatesToTheSameBytes) {
+	std::string repeated;
+	while (repeated.size() < 300000) {
+		repeated += "row " + std::to_string(repeated.size() % 977) + " of pixels that repeat; ";
+	}
+	const std::string inputs[] = { "", TestImages::createBytes(70000, 32), repeated, std::string(200000, '\0') };
+	for (const std::string& input : inputs) {
+		for (bool bestCompression : { false, true }) {
+			std::string output;
+			CHECK(inflate(deflate(input, bestCompression), input.size(), output));
+			CHECK(output == input);
+		}
+	}
+}
+
+TEST(DeflateCompressesRepeatedBytes) {
+	const std::string zeros(200000, '\0');
+	CHECK(deflate(zeros, false).size() < 1000);
+	CHECK(deflate(zeros, true).size() <= deflate(zeros, false).size());
+}
+
+TEST(InflateRejectsABrokenChecksum) {
+	const std::string input = TestImages::createBytes(5000, 33);
+	std::string compressed = deflate(input, false);
+	compressed.back() ^= 1;
+	std::string output;
+	CHECK(!inflate(compressed, input.size(), output));
+}
+
+TEST(PNGKeepsTheMessageAndThePixels) {
+	FileHandler fileHandler;
+	const std::string message = "Message stored in the pixels of a .png file";
+	for (uint8_t colorType : { 0, 2, 4, 6 }) {
+		const std::string original = TestImages::writeFile("original.png", TestImages::createPNG(90, 70, colorType, 34 + colorType));
+		const std::string encoded = TestImages::writeFile("encoded.png", TestImages::readFile(original));
+		CHECK(fileHandler.encodeMessage(encoded, message));
+
+		std::string decoded;
+		CHECK(fileHandler.readEncodedMessage(encoded, decoded));
+		CHECK(decoded == message);
+
+		// Written file inflates back to the same pixels, only their lowest bits could differ
+		Image before, after;
+		CHECK(fileHandler.loadImage(original, before));
+		CHECK(fileHandler.loadImage(encoded, after));
+		CHECK(before.width == after.width && before.height == after.height && before.channels == after.channels);
+		for (size_t i = 0; i < before.getChannelCount(); i++) {
+			CHECK((before.pixels[i] | 1) == (after.pixels[i] | 1));
+		}
+		fileHandler.unloadImage(before);
+		fileHandler.unloadImage(after);
+	}
+}
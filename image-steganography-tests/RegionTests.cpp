@@ -0,0 +1,62 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+
+TEST(RegionKeepsTheMessageAndThePixelsAroundIt) {
+	FileHandler fileHandler;
+	const uint32_t width = 120, height = 90;
+	const std::string original = TestImages::createPPM(width, height, 42);
+	const size_t headerLength = original.size() - (size_t)width * height * 3;
+	const std::string message = "Message confined to a part of the picture";
+
+	RegionOfInterest rectangle, rows;
+	rectangle.x = 10, rectangle.y = 20, rectangle.width = 50, rectangle.height = 30;
+	rows.y = 40, rows.height = 12; // width 0 takes the whole rows
+	for (const RegionOfInterest& region : { rectangle, rows }) {
+		const std::string filePath = TestImages::writeFile("region.ppm", original);
+		EncodeOptions options;
+		options.region = region;
+		CHECK(fileHandler.encodeMessage(filePath, message, options));
+
+		std::string decoded;
+		CHECK(fileHandler.decodeMessageInRegion(filePath, region, decoded));
+		CHECK(decoded == message);
+
+		// Only bytes of the pixels inside the region could have changed
+		const std::string encoded = TestImages::readFile(filePath);
+		CHECK(encoded.size() == original.size());
+		const uint32_t regionWidth = region.width == 0 ? width - region.x : region.width;
+		for (size_t i = 0; i < encoded.size(); i++) {
+			if (encoded[i] == original[i]) {
+				continue;
+			}
+			CHECK(i >= headerLength);
+			const size_t pixel = (i - headerLength) / 3;
+			const size_t x = pixel % width, y = pixel / width;
+			CHECK(x >= region.x && x < region.x + regionWidth && y >= region.y && y < region.y + region.height);
+		}
+	}
+}
+
+TEST(RegionOutsideTheImageIsRejected) {
+	FileHandler fileHandler;
+	const std::string original = TestImages::createPPM(40, 30, 43);
+	const std::string filePath = TestImages::writeFile("outside.ppm", original);
+
+	EncodeOptions options;
+	options.region.x = 30, options.region.y = 25, options.region.width = 20, options.region.height = 10;
+	CHECK(!fileHandler.encodeMessage(filePath, "Message", options));
+	CHECK(TestImages::readFile(filePath) == original);
+}
+
+TEST(RegionTooSmallForTheMessageIsRejected) {
+	FileHandler fileHandler;
+	const std::string original = TestImages::createPPM(40, 30, 44);
+	const std::string filePath = TestImages::writeFile("small.ppm", original);
+
+	EncodeOptions options;
+	options.region.x = 5, options.region.y = 5, options.region.width = 4, options.region.height = 4;
+	CHECK(!fileHandler.encodeMessage(filePath, std::string(100, 'x'), options));
+	CHECK(TestImages::readFile(filePath) == original);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+
+/// <summary>
+/// Decode the message by streaming it and join the chunks passed to the sink
+/// </summary>
+/// <param name="fileHandler">File handler that decodes the image</param>
+/// <param name="filePath">Path of the image</param>
+/// <param name="chunkLength">Number of bytes passed to the sink at once</param>
+/// <param name="message">Modifies the passed message with the joined chunks</param>
+/// <returns>Returns true if the message has been streamed and only the last chunk has been shorter</returns>
+static bool streamMessage(const FileHandler& fileHandler, const std::string& filePath, size_t chunkLength, std::string& message) {
+	message.clear();
+	bool shortChunk = false, ordered = true;
+	const bool status = fileHandler.streamEncodedMessage(filePath, [&](const char* chunk, size_t length) {
+		ordered = ordered && !shortChunk && length > 0 && length <= chunkLength;
+		shortChunk = length < chunkLength;
+		message.append(chunk, length);
+		return true;
+	}, chunkLength);
+	return status && ordered;
+}
+
+TEST(StreamingMatchesTheWholeDecodeInEveryFormat) {
+	FileHandler fileHandler;
+	std::string message;
+	for (int i = 0; i < 5; i++) {
+		message += "Message passed on a few bytes at a time. ";
+	}
+	const std::pair<std::string, std::string> images[] = {
+		{ "stream.ppm", TestImages::createPPM(100, 80, 48) },
+		{ "stream.bmp", TestImages::createBMP(100, 80, 24, 40, false, 48) },
+		{ "streamv5.bmp", TestImages::createBMP(100, 80, 32, 124, true, 48) },
+		{ "stream.pgm", TestImages::createPGM(100, 80, 255, 48) },
+		{ "stream16.pgm", TestImages::createPGM(100, 80, 65535, 48) },
+		{ "stream.tga", TestImages::createTGA(100, 80, 24, false, false, 48) },
+		{ "streamrle.tga", TestImages::createTGA(100, 80, 32, true, true, 48) },
+		{ "stream.png", TestImages::createPNG(100, 80, 2, 48) }
+	};
+	EncodeOptions plain, corrected, matrix, adaptive;
+	corrected.fecLevel = 1;
+	matrix.matrixLevel = 3;
+	adaptive.adaptive = true;
+	for (const auto& image : images) {
+		for (const EncodeOptions& options : { plain, corrected, matrix, adaptive }) {
+			const std::string filePath = TestImages::writeFile(image.first, image.second);
+			CHECK(fileHandler.encodeMessage(filePath, message, options));
+
+			std::string decoded;
+			CHECK(fileHandler.readEncodedMessage(filePath, decoded));
+			CHECK(decoded == message);
+			for (size_t chunkLength : { 1, 7, 64, 4096 }) {
+				std::string streamed;
+				CHECK(streamMessage(fileHandler, filePath, chunkLength, streamed));
+				CHECK(streamed == message);
+			}
+		}
+	}
+}
+
+TEST(StreamingStopsWhenTheSinkDoes) {
+	FileHandler fileHandler;
+	const std::string filePath = TestImages::writeFile("stop.bmp", TestImages::createBMP(60, 40, 24, 40, false, 49));
+	CHECK(fileHandler.encodeMessage(filePath, "Message that is not read to its end", EncodeOptions()));
+
+	size_t chunks = 0;
+	CHECK(!fileHandler.streamEncodedMessage(filePath, [&](const char*, size_t) {
+		chunks++;
+		return false;
+	}, 8));
+	CHECK(chunks == 1);
+}
+
+TEST(StreamingOfAnImageWithoutMessageFails) {
+	FileHandler fileHandler;
+	const std::string filePath = TestImages::writeFile("empty.pgm", TestImages::createPGM(60, 40, 255, 50));
+	size_t chunks = 0;
+	CHECK(!fileHandler.streamEncodedMessage(filePath, [&](const char*, size_t) {
+		chunks++;
+		return true;
+	}, 8));
+	CHECK(chunks == 0);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+
+TEST(TGAKeepsTheMessageInEveryLayout) {
+	FileHandler fileHandler;
+	const std::string message = "Message stored in a .tga of any layout";
+	for (uint8_t pixelDepth : { 8, 24, 32 }) {
+		for (bool runLength : { false, true }) {
+			for (bool topDown : { false, true }) {
+				const std::string original = TestImages::createTGA(40, 25, pixelDepth, runLength, topDown, 47 + pixelDepth);
+				const std::string originalPath = TestImages::writeFile("original.tga", original);
+				const std::string filePath = TestImages::writeFile("layout.tga", original);
+				CHECK(fileHandler.encodeMessage(filePath, message, EncodeOptions()));
+
+				std::string decoded;
+				CHECK(fileHandler.readEncodedMessage(filePath, decoded));
+				CHECK(decoded == message);
+
+				// Header is written back unchanged, the pixels differ only in the lowest bits
+				const std::string encoded = TestImages::readFile(filePath);
+				CHECK(encoded.compare(0, 18, original, 0, 18) == 0);
+				CHECK(runLength || encoded.size() == original.size());
+				Image before, after;
+				CHECK(fileHandler.loadImage(originalPath, before));
+				CHECK(fileHandler.loadImage(filePath, after));
+				CHECK(before.getChannelCount() == after.getChannelCount());
+				for (size_t i = 0; i < before.getChannelCount(); i++) {
+					CHECK((before.pixels[i] ^ after.pixels[i]) <= 1);
+				}
+				fileHandler.unloadImage(before);
+				fileHandler.unloadImage(after);
+			}
+		}
+	}
+}
+
+TEST(TGARunLengthEncodedPixelsMatchTheUncompressedOnes) {
+	FileHandler fileHandler;
+	// Same pixels stored once uncompressed and once run length encoded
+	const std::string uncompressed = TestImages::createTGA(150, 20, 24, false, false, 48);
+	const std::string runLength = TestImages::createTGA(150, 20, 24, true, false, 48);
+	CHECK(runLength.size() < uncompressed.size());
+	const std::string uncompressedPath = TestImages::writeFile("uncompressed.tga", uncompressed);
+	const std::string runLengthPath = TestImages::writeFile("runlength.tga", runLength);
+
+	Image raw, decompressed;
+	CHECK(fileHandler.loadImage(uncompressedPath, raw));
+	CHECK(fileHandler.loadImage(runLengthPath, decompressed));
+	CHECK(raw.getChannelCount() == decompressed.getChannelCount());
+	CHECK(std::memcmp(raw.pixels, decompressed.pixels, raw.getChannelCount()) == 0);
+	fileHandler.unloadImage(raw);
+	fileHandler.unloadImage(decompressed);
+}
+
+TEST(TGARunLengthEncodedUpdateKeepsTheMessage) {
+	FileHandler fileHandler;
+	// Pixels of run length encoded images have no fixed position, the whole file is written again
+	const std::string filePath = TestImages::writeFile("update.tga", TestImages::createTGA(60, 30, 32, true, true, 49));
+	CHECK(fileHandler.encodeMessage(filePath, "First message of the image", EncodeOptions()));
+	size_t changedBytes = 0;
+	CHECK(fileHandler.updateMessage(filePath, "Other message of the image", EncodeOptions(), changedBytes));
+	CHECK(changedBytes > 0);
+
+	std::string decoded;
+	CHECK(fileHandler.readEncodedMessage(filePath, decoded));
+	CHECK(decoded == "Other message of the image");
+}
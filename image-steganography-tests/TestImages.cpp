@@ -0,0 +1,253 @@
+#pragma once
+#include "TestImages.hpp"
+#include "../image-steganography/src/Helpers.hpp"
+
+/// <summary>
+/// Directory holding the files of the tests, created on the first call
+/// </summary>
+/// <returns>Returns the path of the directory</returns>
+std::filesystem::path TestImages::getDirectory() {
+	static const std::filesystem::path directory = []() {
+		std::filesystem::path path = std::filesystem::temp_directory_path() / "steganography-tests";
+		std::filesystem::create_directories(path);
+		return path;
+	}();
+	return directory;
+}
+
+/// <summary>
+/// Save the bytes to the file in the directory of the tests, any older file is replaced
+/// </summary>
+/// <param name="name">Name of the file</param>
+/// <param name="data">Bytes of the file</param>
+/// <returns>Returns the path of the file</returns>
+std::string TestImages::writeFile(const std::string& name, const std::string& data) {
+	const std::string filePath = (getDirectory() / name).string();
+	std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+	file.write(data.data(), (std::streamsize)data.size());
+	return filePath;
+}
+
+/// <summary>
+/// Read every byte of the file
+/// </summary>
+/// <param name="filePath">Path of the file</param>
+/// <returns>Returns the bytes of the file, empty if it could not be read</returns>
+std::string TestImages::readFile(const std::string& filePath) {
+	std::ifstream file(filePath, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/// <summary>
+/// Create random bytes, the same seed gives the same bytes
+/// </summary>
+/// <param name="length">Number of bytes</param>
+/// <param name="seed">Seed of the generator</param>
+/// <returns>Returns the bytes</returns>
+std::string TestImages::createBytes(size_t length, uint32_t seed) {
+	std::mt19937 generator(seed);
+	std::string bytes(length, '\0');
+	for (char& byte : bytes) {
+		byte = (char)(generator() & 0xFF);
+	}
+	return bytes;
+}
+
+/// <summary>
+/// Create a binary .ppm file with random pixels
+/// </summary>
+/// <param name="width">Width of the image</param>
+/// <param name="height">Height of the image</param>
+/// <param name="seed">Seed of the pixels</param>
+/// <returns>Returns the bytes of the file</returns>
+std::string TestImages::createPPM(uint32_t width, uint32_t height, uint32_t seed) {
+	return "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n" + createBytes((size_t)width * height * 3, seed);
+}
+
+/// <summary>
+/// Create an 8 bit .png file with random pixels, its image data is stored in uncompressed deflate blocks
+/// </summary>
+/// <param name="width">Width of the image</param>
+/// <param name="height">Height of the image</param>
+/// <param name="colorType">Color type of the file - 0 gray, 2 RGB, 4 gray with alpha, 6 RGB with alpha</param>
+/// <param name="seed">Seed of the pixels</param>
+/// <returns>Returns the bytes of the file</returns>
+std::string TestImages::createPNG(uint32_t width, uint32_t height, uint8_t colorType, uint32_t seed) {
+	auto appendNumber = [](std::string& data, uint32_t value) {
+		for (int shift = 24; shift >= 0; shift -= 8) {
+			data.push_back((char)((value >> shift) & 0xFF));
+		}
+	};
+	auto appendChunk = [&appendNumber](std::string& file, const std::string& type, const std::string& data) {
+		appendNumber(file, (uint32_t)data.size());
+		const std::string chunk = type + data;
+		file += chunk;
+		appendNumber(file, Helpers::crc32(0, (const uint8_t*)chunk.data(), chunk.size()));
+	};
+
+	// Every row starts with filter type 0 - the bytes are stored as they are
+	const size_t channels = colorType == 0 ? 1 : colorType == 2 ? 3 : colorType == 4 ? 2 : 4;
+	const std::string pixels = createBytes((size_t)width * height * channels, seed);
+	std::string rows;
+	for (size_t y = 0; y < height; y++) {
+		rows.push_back('\0');
+		rows.append(pixels, y * width * channels, width * channels);
+	}
+
+	// zlib stream of stored blocks of at most 65535 bytes, each with its length and its complement
+	std::string data = "\x78\x01";
+	size_t offset = 0;
+	do {
+		const uint16_t length = (uint16_t)std::min(rows.size() - offset, (size_t)0xFFFF);
+		data.push_back(offset + length == rows.size() ? 1 : 0);
+		data.push_back((char)(length & 0xFF));
+		data.push_back((char)(length >> 8));
+		data.push_back((char)(~length & 0xFF));
+		data.push_back((char)((~length >> 8) & 0xFF));
+		data.append(rows, offset, length);
+		offset += length;
+	} while (offset < rows.size());
+	appendNumber(data, Helpers::adler32(1, (const uint8_t*)rows.data(), rows.size()));
+
+	std::string header;
+	appendNumber(header, width);
+	appendNumber(header, height);
+	header += std::string{ 8, (char)colorType, 0, 0, 0 };
+
+	std::string file = "\x89PNG\r\n\x1A\n";
+	appendChunk(file, "IHDR", header);
+	appendChunk(file, "IDAT", data);
+	appendChunk(file, "IEND", "");
+	return file;
+}
+
+/// <summary>
+/// Create an uncompressed .bmp file with random pixels and random padding bytes
+/// 32 bit images with a V4 or V5 info header store their pixels as bit fields with the standard masks
+/// </summary>
+/// <param name="width">Width of the image</param>
+/// <param name="height">Height of the image</param>
+/// <param name="bitsPerPixel">Bits of every pixel - 24 or 32</param>
+/// <param name="infoHeaderSize">Size of the info header - 40, 108 or 124</param>
+/// <param name="topDown">Store the rows from the top of the picture, with negative height</param>
+/// <param name="seed">Seed of the pixels</param>
+/// <returns>Returns the bytes of the file</returns>
+std::string TestImages::createBMP(uint32_t width, uint32_t height, uint16_t bitsPerPixel, uint32_t infoHeaderSize, bool topDown, uint32_t seed) {
+	auto appendNumber = [](std::string& data, uint32_t value, int length) {
+		for (int i = 0; i < length; i++) {
+			data.push_back((char)((value >> (8 * i)) & 0xFF));
+		}
+	};
+
+	const uint32_t rowLength = (width * bitsPerPixel / 8 + 3) / 4 * 4;
+	const uint32_t dataOffset = 14 + infoHeaderSize;
+	const bool bitFields = bitsPerPixel == 32 && infoHeaderSize >= 108;
+	std::string file = "BM";
+	appendNumber(file, dataOffset + rowLength * height, 4);
+	appendNumber(file, 0, 4);
+	appendNumber(file, dataOffset, 4);
+
+	appendNumber(file, infoHeaderSize, 4);
+	appendNumber(file, width, 4);
+	appendNumber(file, topDown ? (uint32_t)-(int32_t)height : height, 4);
+	appendNumber(file, 1, 2);
+	appendNumber(file, bitsPerPixel, 2);
+	appendNumber(file, bitFields ? 3 : 0, 4); // BI_BITFIELDS or BI_RGB
+	appendNumber(file, rowLength * height, 4);
+	appendNumber(file, 2835, 4);
+	appendNumber(file, 2835, 4);
+	appendNumber(file, 0, 4);
+	appendNumber(file, 0, 4);
+	if (infoHeaderSize >= 108) {
+		// Red, green, blue and alpha masks, then the color space, its end points and the gamma are left empty
+		appendNumber(file, bitFields ? 0x00FF0000 : 0, 4);
+		appendNumber(file, bitFields ? 0x0000FF00 : 0, 4);
+		appendNumber(file, bitFields ? 0x000000FF : 0, 4);
+		appendNumber(file, bitFields ? 0xFF000000 : 0, 4);
+		file += "BGRs";
+		file.append(infoHeaderSize - 60, '\0');
+	}
+	const size_t pixelLength = (size_t)width * bitsPerPixel / 8;
+	const std::string pixels = createBytes(pixelLength * height, seed);
+	for (uint32_t y = 0; y < height; y++) {
+		file.append(pixels, y * pixelLength, pixelLength);
+		file.append(rowLength - pixelLength, '\0');
+	}
+	return file;
+}
+
+/// <summary>
+/// Create a .tga file with random pixels, every pixel repeats the previous one in its row half of the time
+/// Run length encoded rows are split into run packets of the repeated pixels and raw packets of the rest
+/// </summary>
+/// <param name="width">Width of the image</param>
+/// <param name="height">Height of the image</param>
+/// <param name="pixelDepth">Bits of every pixel - 8 for grayscale, 24 or 32 for true color</param>
+/// <param name="runLength">Store the pixels run length encoded</param>
+/// <param name="topDown">Store the rows from the top of the picture</param>
+/// <param name="seed">Seed of the pixels</param>
+/// <returns>Returns the bytes of the file</returns>
+std::string TestImages::createTGA(uint32_t width, uint32_t height, uint8_t pixelDepth, bool runLength, bool topDown, uint32_t seed) {
+	const size_t pixelLength = pixelDepth / 8;
+	const size_t rowLength = width * pixelLength;
+	std::string pixels = createBytes(rowLength * height, seed);
+	const std::string repeats = createBytes((size_t)width * height, seed + 1);
+	for (size_t i = 0; i < (size_t)width * height; i++) {
+		if (i % width != 0 && (uint8_t)repeats[i] < 128) {
+			pixels.replace(i * pixelLength, pixelLength, pixels, (i - 1) * pixelLength, pixelLength);
+		}
+	}
+
+	// No image id and no color map, image type 3 or 2 and 8 more with run length encoding
+	std::string file(18, '\0');
+	file[2] = (char)((pixelDepth == 8 ? 3 : 2) | (runLength ? 8 : 0));
+	file[12] = (char)(width & 0xFF), file[13] = (char)(width >> 8);
+	file[14] = (char)(height & 0xFF), file[15] = (char)(height >> 8);
+	file[16] = (char)pixelDepth;
+	file[17] = (char)((pixelDepth == 32 ? 8 : 0) | (topDown ? 0x20 : 0)); // alpha bits and the origin
+	if (!runLength) {
+		return file + pixels;
+	}
+
+	// Packets never cross the end of a row, each one holds at most 128 pixels
+	for (size_t y = 0; y < height; y++) {
+		const char* row = &pixels[y * rowLength];
+		auto samePixel = [&](size_t a, size_t b) {
+			return std::memcmp(row + a * pixelLength, row + b * pixelLength, pixelLength) == 0;
+		};
+		size_t x = 0;
+		while (x < width) {
+			size_t count = 1;
+			while (x + count < width && count < 128 && samePixel(x, x + count)) {
+				count++;
+			}
+			if (count > 1) {
+				file.push_back((char)(0x80 | (count - 1)));
+				file.append(row + x * pixelLength, pixelLength);
+			}
+			else {
+				while (x + count < width && count < 128 && !(x + count + 1 < width && samePixel(x + count, x + count + 1))) {
+					count++;
+				}
+				file.push_back((char)(count - 1));
+				file.append(row + x * pixelLength, count * pixelLength);
+			}
+			x += count;
+		}
+	}
+	return file;
+}
+
+/// <summary>
+/// Create a binary .pgm file with random samples, 16 bit big endian samples when the maximum value is above 255
+/// </summary>
+/// <param name="width">Width of the image</param>
+/// <param name="height">Height of the image</param>
+/// <param name="maxValue">Maximum value of a sample - 255 or 65535</param>
+/// <param name="seed">Seed of the samples</param>
+/// <returns>Returns the bytes of the file</returns>
+std::string TestImages::createPGM(uint32_t width, uint32_t height, uint32_t maxValue, uint32_t seed) {
+	const size_t sampleLength = maxValue > 255 ? 2 : 1;
+	const std::string header = "P5\n" + std::to_string(width) + " " + std::to_string(height) + "\n" + std::to_string(maxValue) + "\n";
+	return header + createBytes((size_t)width * height * sampleLength, seed);
+}
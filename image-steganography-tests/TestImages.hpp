@@ -0,0 +1,90 @@
+#pragma once
+#include <string>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <cstring>
+#include <cstdint>
+
+/// <summary>
+/// Class creating the images the tests encode into, the bytes of every format are written out by hand
+/// so the codecs are checked against files they did not write themselves
+/// </summary>
+class TestImages {
+public:
+	/// <summary>
+	/// Directory holding the files of the tests, created on the first call
+	/// </summary>
+	/// <returns>Returns the path of the directory</returns>
+	static std::filesystem::path getDirectory();
+	/// <summary>
+	/// Save the bytes to the file in the directory of the tests, any older file is replaced
+	/// </summary>
+	/// <param name="name">Name of the file</param>
+	/// <param name="data">Bytes of the file</param>
+	/// <returns>Returns the path of the file</returns>
+	static std::string writeFile(const std::string& name, const std::string& data);
+	/// <summary>
+	/// Read every byte of the file
+	/// </summary>
+	/// <param name="filePath">Path of the file</param>
+	/// <returns>Returns the bytes of the file, empty if it could not be read</returns>
+	static std::string readFile(const std::string& filePath);
+	/// <summary>
+	/// Create random bytes, the same seed gives the same bytes
+	/// </summary>
+	/// <param name="length">Number of bytes</param>
+	/// <param name="seed">Seed of the generator</param>
+	/// <returns>Returns the bytes</returns>
+	static std::string createBytes(size_t length, uint32_t seed);
+	/// <summary>
+	/// Create a binary .ppm file with random pixels
+	/// </summary>
+	/// <param name="width">Width of the image</param>
+	/// <param name="height">Height of the image</param>
+	/// <param name="seed">Seed of the pixels</param>
+	/// <returns>Returns the bytes of the file</returns>
+	static std::string createPPM(uint32_t width, uint32_t height, uint32_t seed);
+	/// <summary>
+	/// Create an 8 bit .png file with random pixels, its image data is stored in uncompressed deflate blocks
+	/// </summary>
+	/// <param name="width">Width of the image</param>
+	/// <param name="height">Height of the image</param>
+	/// <param name="colorType">Color type of the file - 0 gray, 2 RGB, 4 gray with alpha, 6 RGB with alpha</param>
+	/// <param name="seed">Seed of the pixels</param>
+	/// <returns>Returns the bytes of the file</returns>
+	static std::string createPNG(uint32_t width, uint32_t height, uint8_t colorType, uint32_t seed);
+	/// <summary>
+	/// Create an uncompressed .bmp file with random pixels, rows are padded with zeros
+	/// 32 bit images with a V4 or V5 info header store their pixels as bit fields with the standard masks
+	/// </summary>
+	/// <param name="width">Width of the image</param>
+	/// <param name="height">Height of the image</param>
+	/// <param name="bitsPerPixel">Bits of every pixel - 24 or 32</param>
+	/// <param name="infoHeaderSize">Size of the info header - 40, 108 or 124</param>
+	/// <param name="topDown">Store the rows from the top of the picture, with negative height</param>
+	/// <param name="seed">Seed of the pixels</param>
+	/// <returns>Returns the bytes of the file</returns>
+	static std::string createBMP(uint32_t width, uint32_t height, uint16_t bitsPerPixel, uint32_t infoHeaderSize, bool topDown, uint32_t seed);
+	/// <summary>
+	/// Create a .tga file with random pixels, every pixel repeats the previous one in its row half of the time
+	/// Run length encoded rows are split into run packets of the repeated pixels and raw packets of the rest
+	/// </summary>
+	/// <param name="width">Width of the image</param>
+	/// <param name="height">Height of the image</param>
+	/// <param name="pixelDepth">Bits of every pixel - 8 for grayscale, 24 or 32 for true color</param>
+	/// <param name="runLength">Store the pixels run length encoded</param>
+	/// <param name="topDown">Store the rows from the top of the picture</param>
+	/// <param name="seed">Seed of the pixels</param>
+	/// <returns>Returns the bytes of the file</returns>
+	static std::string createTGA(uint32_t width, uint32_t height, uint8_t pixelDepth, bool runLength, bool topDown, uint32_t seed);
+	/// <summary>
+	/// Create a binary .pgm file with random samples, 16 bit big endian samples when the maximum value is above 255
+	/// </summary>
+	/// <param name="width">Width of the image</param>
+	/// <param name="height">Height of the image</param>
+	/// <param name="maxValue">Maximum value of a sample - 255 or 65535</param>
+	/// <param name="seed">Seed of the samples</param>
+	/// <returns>Returns the bytes of the file</returns>
+	static std::string createPGM(uint32_t width, uint32_t height, uint32_t maxValue, uint32_t seed);
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include "TestRunner.hpp"
+
+/// <summary>
+/// Every registered test, in the order the files have been initialized
+/// </summary>
+/// <returns>Returns the list of the tests</returns>
+std::vector<TestCase>& TestRunner::getTests() {
+	// Created on the first use, so tests of any file could register before main
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+/// <summary>
+/// Register the test, called by the TEST macro before main
+/// </summary>
+/// <param name="name">Name of the test</param>
+/// <param name="run">Function of the test, it throws TestFailure when a check fails</param>
+/// <returns>Returns true, so it could initialize a static variable</returns>
+bool TestRunner::add(const std::string& name, const std::function<void()>& run) {
+	getTests().push_back({ name, run });
+	return true;
+}
+
+/// <summary>
+/// Run every test whose name contains the filter and print the result of each
+/// </summary>
+/// <param name="filter">Part of the name of the tests to run, empty runs all of them</param>
+/// <returns>Returns the number of failed tests</returns>
+int TestRunner::runAll(const std::string& filter) {
+	int passed = 0, failed = 0;
+	for (const TestCase& test : getTests()) {
+		if (test.name.find(filter) == std::string::npos) {
+			continue;
+		}
+
+		std::string error;
+		try {
+			test.run();
+		}
+		catch (const TestFailure& failure) {
+			error = failure.message;
+		}
+		catch (const std::exception& exception) {
+			error = std::string("exception: ") + exception.what();
+		}
+
+		if (error.empty()) {
+			passed++;
+			std::cout << "[ OK ] " << test.name << std::endl;
+		}
+		else {
+			failed++;
+			std::cout << "[FAIL] " << test.name << " - " << error << std::endl;
+		}
+	}
+
+	std::cout << passed << " passed, " << failed << " failed" << std::endl;
+	return failed;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <iostream>
+
+/// <summary>
+/// Check failed in a test, carries the place and the condition that did not hold
+/// </summary>
+struct TestFailure {
+	std::string message;
+};
+
+/// <summary>
+/// Single test registered by the TEST macro
+/// </summary>
+struct TestCase {
+	std::string name;
+	std::function<void()> run;
+};
+
+/// <summary>
+/// Class that collects every test of the program and runs them one after another
+/// </summary>
+class TestRunner {
+private:
+	/// <summary>
+	/// Every registered test, in the order the files have been initialized
+	/// </summary>
+	/// <returns>Returns the list of the tests</returns>
+	static std::vector<TestCase>& getTests();
+
+public:
+	/// <summary>
+	/// Register the test, called by the TEST macro before main
+	/// </summary>
+	/// <param name="name">Name of the test</param>
+	/// <param name="run">Function of the test, it throws TestFailure when a check fails</param>
+	/// <returns>Returns true, so it could initialize a static variable</returns>
+	static bool add(const std::string& name, const std::function<void()>& run);
+	/// <summary>
+	/// Run every test whose name contains the filter and print the result of each
+	/// </summary>
+	/// <param name="filter">Part of the name of the tests to run, empty runs all of them</param>
+	/// <returns>Returns the number of failed tests</returns>
+	static int runAll(const std::string& filter);
+};
+
+// Define a test function and register it with the runner
+#define TEST(name) \
+	static void name(); \
+	static const bool name##Registered = TestRunner::add(#name, name); \
+	static void name()
+
+// Fail the test when the condition does not hold
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			throw TestFailure{ std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": " + #condition }; \
+		} \
+	} while (false)
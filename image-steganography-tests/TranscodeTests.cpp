@@ -0,0 +1,63 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+
+TEST(TranscodeKeepsThePayloadInEveryFormat) {
+	FileHandler fileHandler;
+	const std::string message = "Message that moves from one format to another";
+	EncodeOptions plain, corrected, adaptive;
+	corrected.fecLevel = 2;
+	adaptive.adaptive = true;
+	for (const EncodeOptions& options : { plain, corrected, adaptive }) {
+		const std::string sourcePath = TestImages::writeFile("source.ppm", TestImages::createPPM(70, 50, 41));
+		CHECK(fileHandler.encodeMessage(sourcePath, message, options));
+
+		// Every format in turn, each one transcoded from the previous one
+		std::string previousPath = sourcePath;
+		const std::pair<std::string, FileType> targets[] = {
+			{ "target.bmp", FileType::BMP }, { "target.png", FileType::PNG }, { "target.tga", FileType::TGA }, { "target.ppm", FileType::PPM }
+		};
+		for (const auto& target : targets) {
+			const std::string targetPath = (TestImages::getDirectory() / target.first).string();
+			std::filesystem::remove(targetPath);
+			size_t payloadBits = 0;
+			CHECK(fileHandler.transcodeImage(previousPath, targetPath, target.second, payloadBits));
+			CHECK(payloadBits > message.size() * 8);
+			CHECK(fileHandler.detectFileType(targetPath) == target.second);
+
+			std::string decoded;
+			CHECK(fileHandler.readEncodedMessage(targetPath, decoded));
+			CHECK(decoded == message);
+			previousPath = targetPath;
+		}
+	}
+}
+
+TEST(TranscodeWithoutMessageKeepsThePicture) {
+	FileHandler fileHandler;
+	const std::string sourcePath = TestImages::writeFile("plain.ppm", TestImages::createPPM(33, 21, 42));
+	const std::string targetPath = (TestImages::getDirectory() / "plain.bmp").string();
+	std::filesystem::remove(targetPath);
+
+	size_t payloadBits = 1;
+	CHECK(fileHandler.transcodeImage(sourcePath, targetPath, FileType::BMP, payloadBits));
+	CHECK(payloadBits == 0);
+
+	// .bmp stores the rows from the bottom and the channels as blue, green, red
+	Image source, target;
+	CHECK(fileHandler.loadImage(sourcePath, source));
+	CHECK(fileHandler.loadImage(targetPath, target));
+	CHECK(source.width == target.width && source.height == target.height && source.channels == target.channels);
+	for (uint32_t y = 0; y < source.height; y++) {
+		const uint8_t* sourceRow = source.getTopRow() + y * source.getRowStride();
+		const uint8_t* targetRow = target.getTopRow() + y * target.getRowStride();
+		for (uint32_t x = 0; x < source.width; x++) {
+			for (int c = 0; c < 3; c++) {
+				CHECK(sourceRow[x * 3 + c] == targetRow[x * 3 + 2 - c]);
+			}
+		}
+	}
+	fileHandler.unloadImage(source);
+	fileHandler.unloadImage(target);
+}
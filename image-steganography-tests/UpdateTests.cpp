@@ -0,0 +1,84 @@
+#pragma once
+#include "TestRunner.hpp"
+#include "TestImages.hpp"
+#include "../image-steganography/src/FileHandler.hpp"
+
+/// <summary>
+/// Count the bytes that differ between two files of the same length
+/// </summary>
+/// <param name="first">Bytes of the first file</param>
+/// <param name="second">Bytes of the second file</param>
+/// <returns>Returns the number of different bytes</returns>
+static size_t countDifferentBytes(const std::string& first, const std::string& second) {
+	size_t count = 0;
+	for (size_t i = 0; i < first.size() && i < second.size(); i++) {
+		count += first[i] != second[i] ? 1 : 0;
+	}
+	return count;
+}
+
+TEST(UpdateWritesOnlyTheChannelsThatDifferFromTheNewMessage) {
+	FileHandler fileHandler;
+	const std::string original = TestImages::createPPM(80, 80, 36);
+	const std::string oldMessage = "Message stored first, it will be replaced";
+	const std::string newMessage = "Message stored later, it has replaced it!";
+
+	EncodeOptions plain, corrected, matrix;
+	corrected.fecLevel = 1;
+	matrix.matrixLevel = 2;
+	for (const EncodeOptions& options : { plain, corrected, matrix }) {
+		// Image encoded with the new message from the start
+		const std::string expectedPath = TestImages::writeFile("expected.ppm", original);
+		CHECK(fileHandler.encodeMessage(expectedPath, newMessage, options));
+		const std::string expected = TestImages::readFile(expectedPath);
+
+		const std::string updatedPath = TestImages::writeFile("updated.ppm", original);
+		CHECK(fileHandler.encodeMessage(updatedPath, oldMessage, options));
+		const std::string encoded = TestImages::readFile(updatedPath);
+
+		size_t changedBytes = 0;
+		CHECK(fileHandler.updateMessage(updatedPath, newMessage, options, changedBytes));
+		const std::string updated = TestImages::readFile(updatedPath);
+		CHECK(changedBytes > 0 && changedBytes == countDifferentBytes(encoded, updated));
+		for (size_t i = 0; i < updated.size(); i++) {
+			CHECK((updated[i] | 1) == (encoded[i] | 1));
+		}
+		if (options.matrixLevel == 0) {
+			// Every bit is stored in its own channel, so the update ends exactly where a fresh encoding does
+			CHECK(updated == expected);
+		}
+		else {
+			// Channel changed in a group depends on the bits already there, so only the number of changes is bounded
+			CHECK(changedBytes < countDifferentBytes(original, expected));
+		}
+
+		std::string decoded;
+		CHECK(fileHandler.readEncodedMessage(updatedPath, decoded));
+		CHECK(decoded == newMessage);
+	}
+}
+
+TEST(UpdateWithTheSameMessageChangesNothing) {
+	FileHandler fileHandler;
+	const std::string message = "Message that is stored twice";
+	const std::string filePath = TestImages::writeFile("same.ppm", TestImages::createPPM(40, 40, 37));
+	CHECK(fileHandler.encodeMessage(filePath, message));
+	const std::string encoded = TestImages::readFile(filePath);
+
+	size_t changedBytes = 1;
+	CHECK(fileHandler.updateMessage(filePath, message, EncodeOptions(), changedBytes));
+	CHECK(changedBytes == 0);
+	CHECK(TestImages::readFile(filePath) == encoded);
+}
+
+TEST(UpdateOfAnImageWithoutMessageEncodesIt) {
+	FileHandler fileHandler;
+	const std::string message = "First message of the image";
+	const std::string filePath = TestImages::writeFile("empty.ppm", TestImages::createPPM(40, 40, 38));
+
+	size_t changedBytes = 0;
+	CHECK(fileHandler.updateMessage(filePath, message, EncodeOptions(), changedBytes));
+	std::string decoded;
+	CHECK(fileHandler.readEncodedMessage(filePath, decoded));
+	CHECK(decoded == message);
+}
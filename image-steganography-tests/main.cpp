@@ -0,0 +1,13 @@
+#include <iostream>
+
+#include "TestRunner.hpp"
+
+/// <summary>
+/// Main method of the tests
+/// </summary>
+/// <param name="argc">Number of arguments</param>
+/// <param name="argv">List of arguments, the first one filters the tests by their name</param>
+/// <returns>Returns 0 if every test passed, 1 otherwise</returns>
+int main(int argc, char* argv[]) {
+	return TestRunner::runAll(argc > 1 ? argv[1] : "") == 0 ? 0 : 1;
+}
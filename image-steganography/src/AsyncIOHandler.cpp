@@ -0,0 +1,586 @@
+#pragma once
+#include "AsyncIOHandler.hpp"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+
+namespace {
+	/// <summary>
+	/// Largest number of bytes read or written by a single request, longer files take more requests
+	/// </summary>
+	const size_t maxRequestLength = 1 << 30;
+}
+
+/// <summary>
+/// Create the ring and map its queues
+/// </summary>
+/// <returns>Returns false if io_uring is not available</returns>
+bool AsyncIOHandler::setupRing() {
+	io_uring_params params;
+	std::memset(&params, 0, sizeof(params));
+	int fd = (int)syscall(__NR_io_uring_setup, _queueDepth, &params);
+	if (fd < 0) {
+		return false;
+	}
+	_ringFd = fd;
+
+	// Plain read and write requests came together with this feature, older kernels use the blocking fallback
+	if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+		closeRing();
+		return false;
+	}
+
+	_submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	_completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (singleMap) {
+		_submissionRingSize = _completionRingSize = std::max(_submissionRingSize, _completionRingSize);
+	}
+
+	void* mapped = mmap(nullptr, _submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (mapped == MAP_FAILED) {
+		closeRing();
+		return false;
+	}
+	_submissionRing = mapped;
+
+	if (singleMap) {
+		_completionRing = _submissionRing;
+	}
+	else {
+		mapped = mmap(nullptr, _completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if (mapped == MAP_FAILED) {
+			closeRing();
+			return false;
+		}
+		_completionRing = mapped;
+	}
+
+	_submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+	mapped = mmap(nullptr, _submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (mapped == MAP_FAILED) {
+		closeRing();
+		return false;
+	}
+	_submissionEntries = mapped;
+	_submissionEntryCount = params.sq_entries;
+
+	char* submission = (char*)_submissionRing;
+	_submissionHead = (unsigned*)(submission + params.sq_off.head);
+	_submissionTail = (unsigned*)(submission + params.sq_off.tail);
+	_submissionMask = (unsigned*)(submission + params.sq_off.ring_mask);
+	_submissionArray = (unsigned*)(submission + params.sq_off.array);
+
+	char* completion = (char*)_completionRing;
+	_completionHead = (unsigned*)(completion + params.cq_off.head);
+	_completionTail = (unsigned*)(completion + params.cq_off.tail);
+	_completionMask = (unsigned*)(completion + params.cq_off.ring_mask);
+	_completionEntries = completion + params.cq_off.cqes;
+	return true;
+}
+
+/// <summary>
+/// Unmap the queues and close the ring
+/// </summary>
+void AsyncIOHandler::closeRing() {
+	if (_submissionEntries != nullptr) {
+		munmap(_submissionEntries, _submissionEntriesSize);
+	}
+	if (_completionRing != nullptr && _completionRing != _submissionRing) {
+		munmap(_completionRing, _completionRingSize);
+	}
+	if (_submissionRing != nullptr) {
+		munmap(_submissionRing, _submissionRingSize);
+	}
+	if (_ringFd >= 0) {
+		close(_ringFd);
+	}
+
+	_submissionEntries = nullptr;
+	_completionRing = nullptr;
+	_submissionRing = nullptr;
+	_ringFd = -1;
+	_unsubmitted = 0;
+}
+
+/// <summary>
+/// Add a read or write of the file to the submission ring, it is submitted with the next submitAndWait
+/// </summary>
+/// <param name="write">Write the data instead of reading it</param>
+/// <param name="fd">Opened file</param>
+/// <param name="buffer">Buffer to read to or write from</param>
+/// <param name="length">Number of bytes</param>
+/// <param name="offset">Position in the file</param>
+/// <param name="userData">Value returned with the completion</param>
+/// <returns>Returns false if the submission ring is full</returns>
+bool AsyncIOHandler::queueRequest(bool write, int fd, void* buffer, size_t length, uint64_t offset, uint64_t userData) {
+	// Only this thread adds entries, the kernel moves the head as it consumes them
+	const unsigned tail = *_submissionTail;
+	const unsigned head = __atomic_load_n(_submissionHead, __ATOMIC_ACQUIRE);
+	if (tail - head >= _submissionEntryCount) {
+		return false;
+	}
+
+	const unsigned index = tail & *_submissionMask;
+	io_uring_sqe* entry = (io_uring_sqe*)_submissionEntries + index;
+	std::memset(entry, 0, sizeof(io_uring_sqe));
+	entry->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+	entry->fd = fd;
+	entry->addr = (uint64_t)(uintptr_t)buffer;
+	entry->len = (uint32_t)length;
+	entry->off = offset;
+	entry->user_data = userData;
+	_submissionArray[index] = index;
+
+	__atomic_store_n(_submissionTail, tail + 1, __ATOMIC_RELEASE);
+	_unsubmitted++;
+	return true;
+}
+
+/// <summary>
+/// Submit the queued requests and wait for at least the given number of completions
+/// </summary>
+/// <param name="waitFor">Number of completions to wait for, 0 to only submit</param>
+/// <returns>Returns false if the kernel rejected the requests</returns>
+bool AsyncIOHandler::submitAndWait(unsigned waitFor) {
+	while (true) {
+		int result = (int)syscall(__NR_io_uring_enter, _ringFd, _unsubmitted, waitFor,
+			waitFor > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+		if (result >= 0) {
+			_unsubmitted -= std::min((unsigned)result, _unsubmitted);
+			if (_unsubmitted == 0) {
+				return true;
+			}
+			continue;
+		}
+
+		if (errno == EINTR) {
+			continue;
+		}
+		// The completion queue is full, the caller reaps it and calls again
+		return errno == EAGAIN || errno == EBUSY;
+	}
+}
+
+/// <summary>
+/// Remove the requests that have been queued but not taken by the kernel
+/// </summary>
+/// <param name="userData">Modifies the passed list with the values given to the removed requests</param>
+void AsyncIOHandler::takeUnsubmitted(std::vector<uint64_t>& userData) {
+	const unsigned head = __atomic_load_n(_submissionHead, __ATOMIC_ACQUIRE);
+	const unsigned tail = *_submissionTail;
+	for (unsigned i = head; i != tail; i++) {
+		const io_uring_sqe* entry = (const io_uring_sqe*)_submissionEntries + _submissionArray[i & *_submissionMask];
+		userData.push_back(entry->user_data);
+	}
+	__atomic_store_n(_submissionTail, head, __ATOMIC_RELEASE);
+	_unsubmitted = 0;
+}
+
+/// <summary>
+/// Take the next completion from the completion ring
+/// </summary>
+/// <param name="userData">Modifies the passed value with the value given to the request</param>
+/// <param name="result">Modifies the passed result with number of bytes or negative error</param>
+/// <returns>Returns false if there is no completion</returns>
+bool AsyncIOHandler::popCompletion(uint64_t& userData, int& result) {
+	const unsigned head = *_completionHead;
+	if (head == __atomic_load_n(_completionTail, __ATOMIC_ACQUIRE)) {
+		return false;
+	}
+
+	const io_uring_cqe* entry = (const io_uring_cqe*)_completionEntries + (head & *_completionMask);
+	userData = entry->user_data;
+	result = entry->res;
+	__atomic_store_n(_completionHead, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/// <summary>
+/// Process the files through the ring, reads and writes are asynchronous, tasks run on the workers
+/// </summary>
+/// <param name="paths">Paths of the files</param>
+/// <param name="readLength">Number of bytes read from the beginning of every file, 0 for the whole file</param>
+/// <param name="task">Work done for every file</param>
+/// <param name="statuses">Modifies the passed statuses with the result for every file</param>
+void AsyncIOHandler::processWithRing(const std::vector<std::string>& paths, size_t readLength, const FileTask& task, std::vector<char>& statuses) {
+	const size_t count = paths.size();
+	const size_t workerCount = std::min((size_t)std::max(1u, std::thread::hardware_concurrency()), count);
+	// Files opened but not finished - reading, waiting for a worker, processed or writing
+	const size_t maxActive = _queueDepth + 2 * workerCount;
+	std::vector<FileState> files(count);
+	std::vector<size_t> reserved(count, 0);
+
+	// Shared with the workers, guarded by the mutex
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<size_t> ready;
+	std::deque<size_t> processed;
+	size_t finished = 0;
+	size_t bytesInFlight = 0;
+	bool stopping = false;
+
+	// Called with the mutex locked
+	auto finish = [&](size_t index, bool status) {
+		statuses[index] = status;
+		bytesInFlight -= reserved[index];
+		finished++;
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < workerCount; t++) {
+		workers.emplace_back([&]() {
+			while (true) {
+				size_t index;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					condition.wait(lock, [&]() { return stopping || !ready.empty(); });
+					if (ready.empty()) {
+						return;
+					}
+					index = ready.front();
+					ready.pop_front();
+				}
+
+				FileState& file = files[index];
+				bool status = task(index, file.data, file.output);
+				std::string().swap(file.data);
+
+				std::lock_guard<std::mutex> lock(mutex);
+				if (status && !file.output.empty()) {
+					processed.push_back(index);
+				}
+				else {
+					finish(index, status);
+				}
+				condition.notify_all();
+			}
+		});
+	}
+
+	// Queue the next part of the read or write of the file
+	auto queueNext = [&](size_t index) {
+		FileState& file = files[index];
+		std::string& buffer = file.writing ? file.output : file.data;
+		const size_t length = std::min(buffer.size() - file.done, maxRequestLength);
+		return queueRequest(file.writing, file.fd, &buffer[file.done], length, file.done, index);
+	};
+
+	size_t next = 0;
+	size_t opened = 0;
+	unsigned inFlight = 0;
+	bool broken = false;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			auto canOpen = [&]() {
+				return !broken && next < count && opened - finished < maxActive && bytesInFlight < _maxBytesInFlight;
+			};
+			// Nothing could be submitted and nothing is in flight, wait for the workers
+			condition.wait(lock, [&]() {
+				return finished == count || inFlight > 0 || !processed.empty() || canOpen() || (broken && next < count);
+			});
+			if (finished == count) {
+				break;
+			}
+
+			// Write back the output of the processed files
+			while (!processed.empty() && inFlight < _queueDepth) {
+				const size_t index = processed.front();
+				processed.pop_front();
+				FileState& file = files[index];
+				file.fd = broken ? -1 : open(paths[index].c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+				if (file.fd < 0) {
+					finish(index, false);
+					continue;
+				}
+				file.writing = true;
+				file.done = 0;
+				queueNext(index);
+				inFlight++;
+			}
+
+			// Once the ring fails no new file is started
+			while (broken && next < count) {
+				finish(next++, false);
+			}
+
+			// Start reading the next files while there is room
+			while (canOpen() && inFlight < _queueDepth) {
+				const size_t index = next++;
+				FileState& file = files[index];
+				struct stat info;
+				file.fd = open(paths[index].c_str(), O_RDONLY | O_CLOEXEC);
+				if (file.fd < 0 || fstat(file.fd, &info) != 0) {
+					if (file.fd >= 0) {
+						close(file.fd);
+					}
+					finish(index, false);
+					continue;
+				}
+
+				size_t length = (size_t)info.st_size;
+				if (readLength > 0) {
+					length = std::min(length, readLength);
+				}
+				file.data.resize(length);
+				reserved[index] = length;
+				bytesInFlight += length;
+				opened++;
+				if (length == 0) {
+					close(file.fd);
+					ready.push_back(index);
+					condition.notify_all();
+					continue;
+				}
+				queueNext(index);
+				inFlight++;
+			}
+		}
+
+		if (inFlight == 0) {
+			continue;
+		}
+		if (!broken && !submitAndWait(1)) {
+			std::cout << "Error: asynchronous I/O failed, remaining files are skipped" << std::endl;
+			broken = true;
+			// Requests the kernel has not taken will never complete
+			std::vector<uint64_t> dropped;
+			takeUnsubmitted(dropped);
+			for (uint64_t index : dropped) {
+				inFlight--;
+				close(files[index].fd);
+				std::lock_guard<std::mutex> lock(mutex);
+				finish((size_t)index, false);
+			}
+		}
+		else if (broken) {
+			// Requests already taken by the kernel still complete, their buffers are kept until then
+			submitAndWait(1);
+		}
+
+		// Handle every completion, files that are not done yet queue their next part
+		uint64_t userData;
+		int result;
+		while (popCompletion(userData, result)) {
+			inFlight--;
+			const size_t index = (size_t)userData;
+			FileState& file = files[index];
+			const std::string& buffer = file.writing ? file.output : file.data;
+			if (result == -EINTR || result == -EAGAIN) {
+				result = 0;
+			}
+			else if (result < 0 || (result == 0 && file.writing)) {
+				close(file.fd);
+				std::lock_guard<std::mutex> lock(mutex);
+				finish(index, false);
+				continue;
+			}
+
+			file.done += (size_t)result;
+			// Read ends early if the file has been shortened in the meantime
+			const bool complete = file.done == buffer.size() || (result == 0 && !file.writing && file.done > 0);
+			if (!complete && !broken) {
+				queueNext(index);
+				inFlight++;
+				continue;
+			}
+
+			close(file.fd);
+			file.fd = -1;
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!complete) {
+				finish(index, false);
+			}
+			else if (!file.writing) {
+				file.data.resize(file.done);
+				ready.push_back(index);
+				condition.notify_all();
+			}
+			else {
+				std::string().swap(file.output);
+				finish(index, true);
+			}
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	if (broken) {
+		closeRing();
+	}
+}
+
+/// <summary>
+/// Read the beginning or the whole file with blocking calls
+/// </summary>
+/// <param name="filePath">Path of the file</param>
+/// <param name="readLength">Number of bytes from the beginning, 0 for the whole file</param>
+/// <param name="data">Modifies the passed data with the content of the file</param>
+/// <returns>Returns false if the file could not be read</returns>
+bool AsyncIOHandler::readFile(const std::string& filePath, size_t readLength, std::string& data) {
+	int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return false;
+	}
+
+	size_t length = (size_t)info.st_size;
+	if (readLength > 0) {
+		length = std::min(length, readLength);
+	}
+	data.resize(length);
+
+	size_t done = 0;
+	while (done < length) {
+		ssize_t result = pread(fd, &data[done], std::min(length - done, maxRequestLength), (off_t)done);
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		if (result <= 0) {
+			break;
+		}
+		done += (size_t)result;
+	}
+	close(fd);
+
+	data.resize(done);
+	return done == length || done > 0;
+}
+
+/// <summary>
+/// Replace the content of the file with blocking calls
+/// </summary>
+/// <param name="filePath">Path of the file</param>
+/// <param name="data">New content of the file</param>
+/// <returns>Returns false if the file could not be written</returns>
+bool AsyncIOHandler::writeFile(const std::string& filePath, const std::string& data) {
+	int fd = open(filePath.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+
+	size_t done = 0;
+	while (done < data.size()) {
+		ssize_t result = pwrite(fd, &data[done], std::min(data.size() - done, maxRequestLength), (off_t)done);
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		if (result <= 0) {
+			break;
+		}
+		done += (size_t)result;
+	}
+	close(fd);
+	return done == data.size();
+}
+#else
+bool AsyncIOHandler::setupRing() { return false; }
+void AsyncIOHandler::closeRing() {}
+bool AsyncIOHandler::queueRequest(bool write, int fd, void* buffer, size_t length, uint64_t offset, uint64_t userData) { return false; }
+bool AsyncIOHandler::submitAndWait(unsigned waitFor) { return false; }
+void AsyncIOHandler::takeUnsubmitted(std::vector<uint64_t>& userData) {}
+bool AsyncIOHandler::popCompletion(uint64_t& userData, int& result) { return false; }
+void AsyncIOHandler::processWithRing(const std::vector<std::string>& paths, size_t readLength, const FileTask& task, std::vector<char>& statuses) {
+	processBlocking(paths, readLength, task, statuses);
+}
+
+bool AsyncIOHandler::readFile(const std::string& filePath, size_t readLength, std::string& data) {
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	size_t length = (size_t)file.tellg();
+	if (readLength > 0) {
+		length = std::min(length, readLength);
+	}
+	data.resize(length);
+	file.seekg(0);
+	file.read(&data[0], (std::streamsize)length);
+	data.resize((size_t)file.gcount());
+	return data.size() == length;
+}
+
+bool AsyncIOHandler::writeFile(const std::string& filePath, const std::string& data) {
+	std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+	file.write(data.data(), (std::streamsize)data.size());
+	return file.good();
+}
+#endif
+
+/// <summary>
+/// Process the files in parallel with blocking reads and writes
+/// </summary>
+/// <param name="paths">Paths of the files</param>
+/// <param name="readLength">Number of bytes read from the beginning of every file, 0 for the whole file</param>
+/// <param name="task">Work done for every file</param>
+/// <param name="statuses">Modifies the passed statuses with the result for every file</param>
+void AsyncIOHandler::processBlocking(const std::vector<std::string>& paths, size_t readLength, const FileTask& task, std::vector<char>& statuses) const {
+	Helpers::parallelFor(paths.size(), [&](size_t i) {
+		std::string data;
+		std::string output;
+		if (!readFile(paths[i], readLength, data)) {
+			return;
+		}
+
+		bool status = task(i, data, output);
+		if (status && !output.empty()) {
+			std::string().swap(data);
+			status = writeFile(paths[i], output);
+		}
+		statuses[i] = status;
+	});
+}
+
+/// <summary>
+/// Determine if the files are processed through io_uring
+/// </summary>
+/// <returns>Returns true if the ring has been created</returns>
+bool AsyncIOHandler::usesIOUring() const {
+	return _ringFd >= 0;
+}
+
+/// <summary>
+/// Read every file, run the task on it and write its output back to the same file
+/// Files are processed in any order, the task could run on any thread
+/// </summary>
+/// <param name="paths">Paths of the files</param>
+/// <param name="readLength">Number of bytes read from the beginning of every file, 0 for the whole file</param>
+/// <param name="task">Work done for every file</param>
+/// <param name="statuses">Modifies the passed statuses with the result for every file</param>
+void AsyncIOHandler::processFiles(const std::vector<std::string>& paths, size_t readLength, const FileTask& task, std::vector<char>& statuses) {
+	statuses.assign(paths.size(), 0);
+	if (paths.empty()) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(_ringMutex, std::try_to_lock);
+	if (lock.owns_lock() && _ringFd >= 0) {
+		processWithRing(paths, readLength, task, statuses);
+	}
+	else {
+		processBlocking(paths, readLength, task, statuses);
+	}
+}
@@ -0,0 +1,182 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "Helpers.hpp"
+
+/// <summary>
+/// Class for reading and writing many files at once, e.g. every image of a directory
+///
+/// On Linux the reads and writes go through io_uring - one thread keeps up to the queue depth of them in flight
+/// and hands every file that has been read to a pool of workers, the data the workers return is written back
+/// to the same file through the ring. Without io_uring (old kernel, disabled by seccomp or other systems)
+/// every worker reads, processes and writes its file with blocking calls.
+/// </summary>
+class AsyncIOHandler {
+public:
+	/// <summary>
+	/// Work done for every file - index of the file, its data and output that replaces the file when it is not empty
+	/// Returns false if the file could not be processed
+	/// </summary>
+	typedef std::function<bool(size_t, std::string&, std::string&)> FileTask;
+
+private:
+	/// <summary>
+	/// State of a single file going through the ring
+	/// </summary>
+	struct FileState {
+		int fd = -1;
+		std::string data;
+		std::string output;
+		size_t done = 0;
+		bool writing = false;
+	};
+
+	/// <summary>
+	/// Number of reads and writes in flight at once, also the number of entries of the ring
+	/// </summary>
+	unsigned _queueDepth;
+	/// <summary>
+	/// Number of bytes of files read but not finished yet, limits the memory held by the pipeline
+	/// </summary>
+	size_t _maxBytesInFlight;
+	/// <summary>
+	/// Only one thread could drive the ring, others fall back to blocking I/O
+	/// </summary>
+	std::mutex _ringMutex;
+
+	int _ringFd = -1;
+	void* _submissionRing = nullptr;
+	size_t _submissionRingSize = 0;
+	void* _completionRing = nullptr;
+	size_t _completionRingSize = 0;
+	void* _submissionEntries = nullptr;
+	size_t _submissionEntriesSize = 0;
+	unsigned _submissionEntryCount = 0;
+	unsigned* _submissionHead = nullptr;
+	unsigned* _submissionTail = nullptr;
+	unsigned* _submissionMask = nullptr;
+	unsigned* _submissionArray = nullptr;
+	unsigned* _completionHead = nullptr;
+	unsigned* _completionTail = nullptr;
+	unsigned* _completionMask = nullptr;
+	void* _completionEntries = nullptr;
+	/// <summary>
+	/// Number of entries added to the submission ring but not submitted to the kernel yet
+	/// </summary>
+	unsigned _unsubmitted = 0;
+
+	/// <summary>
+	/// Create the ring and map its queues
+	/// </summary>
+	/// <returns>Returns false if io_uring is not available</returns>
+	bool setupRing();
+	/// <summary>
+	/// Unmap the queues and close the ring
+	/// </summary>
+	void closeRing();
+	/// <summary>
+	/// Add a read or write of the file to the submission ring, it is submitted with the next submitAndWait
+	/// </summary>
+	/// <param name="write">Write the data instead of reading it</param>
+	/// <param name="fd">Opened file</param>
+	/// <param name="buffer">Buffer to read to or write from</param>
+	/// <param name="length">Number of bytes</param>
+	/// <param name="offset">Position in the file</param>
+	/// <param name="userData">Value returned with the completion</param>
+	/// <returns>Returns false if the submission ring is full</returns>
+	bool queueRequest(bool write, int fd, void* buffer, size_t length, uint64_t offset, uint64_t userData);
+	/// <summary>
+	/// Submit the queued requests and wait for at least the given number of completions
+	/// </summary>
+	/// <param name="waitFor">Number of completions to wait for, 0 to only submit</param>
+	/// <returns>Returns false if the kernel rejected the requests</returns>
+	bool submitAndWait(unsigned waitFor);
+	/// <summary>
+	/// Remove the requests that have been queued but not taken by the kernel
+	/// </summary>
+	/// <param name="userData">Modifies the passed list with the values given to the removed requests</param>
+	void takeUnsubmitted(std::vector<uint64_t>& userData);
+	/// <summary>
+	/// Take the next completion from the completion ring
+	/// </summary>
+	/// <param name="userData">Modifies the passed value with the value given to the request</param>
+	/// <param name="result">Modifies the passed result with number of bytes or negative error</param>
+	/// <returns>Returns false if there is no completion</returns>
+	bool popCompletion(uint64_t& userData, int& result);
+	/// <summary>
+	/// Process the files through the ring, reads and writes are asynchronous, tasks run on the workers
+	/// </summary>
+	/// <param name="paths">Paths of the files</param>
+	/// <param name="readLength">Number of bytes read from the beginning of every file, 0 for the whole file</param>
+	/// <param name="task">Work done for every file</param>
+	/// <param name="statuses">Modifies the passed statuses with the result for every file</param>
+	void processWithRing(const std::vector<std::string>& paths, size_t readLength, const FileTask& task, std::vector<char>& statuses);
+	/// <summary>
+	/// Process the files in parallel with blocking reads and writes
+	/// </summary>
+	/// <param name="paths">Paths of the files</param>
+	/// <param name="readLength">Number of bytes read from the beginning of every file, 0 for the whole file</param>
+	/// <param name="task">Work done for every file</param>
+	/// <param name="statuses">Modifies the passed statuses with the result for every file</param>
+	void processBlocking(const std::vector<std::string>& paths, size_t readLength, const FileTask& task, std::vector<char>& statuses) const;
+	/// <summary>
+	/// Read the beginning or the whole file with blocking calls
+	/// </summary>
+	/// <param name="filePath">Path of the file</param>
+	/// <param name="readLength">Number of bytes from the beginning, 0 for the whole file</param>
+	/// <param name="data">Modifies the passed data with the content of the file</param>
+	/// <returns>Returns false if the file could not be read</returns>
+	static bool readFile(const std::string& filePath, size_t readLength, std::string& data);
+	/// <summary>
+	/// Replace the content of the file with blocking calls
+	/// </summary>
+	/// <param name="filePath">Path of the file</param>
+	/// <param name="data">New content of the file</param>
+	/// <returns>Returns false if the file could not be written</returns>
+	static bool writeFile(const std::string& filePath, const std::string& data);
+
+public:
+	/// <summary>
+	/// Constructor, falls back to blocking I/O if the ring could not be created
+	/// </summary>
+	/// <param name="queueDepth">Number of reads and writes in flight at once</param>
+	/// <param name="maxBytesInFlight">Number of bytes of files held by the pipeline at once</param>
+	AsyncIOHandler(unsigned queueDepth = 32, size_t maxBytesInFlight = 256 * 1024 * 1024) {
+		_queueDepth = std::max(1u, queueDepth);
+		_maxBytesInFlight = maxBytesInFlight;
+		setupRing();
+	}
+	/// <summary>
+	/// Destructor
+	/// </summary>
+	~AsyncIOHandler() {
+		closeRing();
+	}
+
+	/// <summary>
+	/// Determine if the files are processed through io_uring
+	/// </summary>
+	/// <returns>Returns true if the ring has been created</returns>
+	bool usesIOUring() const;
+	/// <summary>
+	/// Read every file, run the task on it and write its output back to the same file
+	/// Files are processed in any order, the task could run on any thread
+	/// </summary>
+	/// <param name="paths">Paths of the files</param>
+	/// <param name="readLength">Number of bytes read from the beginning of every file, 0 for the whole file</param>
+	/// <param name="task">Work done for every file</param>
+	/// <param name="statuses">Modifies the passed statuses with the result for every file</param>
+	void processFiles(const std::vector<std::string>& paths, size_t readLength, const FileTask& task, std::vector<char>& statuses);
+};
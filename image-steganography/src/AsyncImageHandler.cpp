@@ -0,0 +1,161 @@
+#pragma once
+#include "AsyncImageHandler.hpp"
+
+/// <summary>
+/// Report the stage to the progress callback, if there is one
+/// </summary>
+/// <param name="progress">Progress callback of the operation</param>
+/// <param name="stage">Stage that starts</param>
+/// <param name="index">Number of stages done before</param>
+/// <param name="count">Number of stages of the operation</param>
+void AsyncImageHandler::reportProgress(const ProgressCallback& progress, AsyncStage stage, int index, int count) {
+	if (progress) {
+		progress(stage, (double)index / count);
+	}
+}
+
+/// <summary>
+/// Read the image with its pixels on the I/O executor
+/// The image must be released by FileHandler::unloadImage once it is not needed
+/// </summary>
+/// <param name="filePath">Filepath from which the image data will be read from</param>
+/// <param name="image">Modifies the passed image with the images data</param>
+/// <param name="token">Token that cancels the stage before it starts</param>
+/// <returns>Returns true if the image has been read, nothing is left to release otherwise</returns>
+Task<bool> AsyncImageHandler::loadImage(std::string filePath, Image& image, CancellationToken token) {
+	co_await _ioExecutor->schedule();
+	if (token.isCancelled()) {
+		co_return false;
+	}
+	co_return _fileHandler->loadImage(filePath, image);
+}
+
+/// <summary>
+/// Check if the loaded image holds an encoded message on the compute executor
+/// </summary>
+/// <param name="image">Image loaded with its pixels</param>
+/// <param name="encoded">Modifies the passed flag, true if the image holds an encoded message</param>
+/// <param name="token">Token that cancels the stage before it starts</param>
+/// <returns>Returns false if the stage has been cancelled</returns>
+Task<bool> AsyncImageHandler::probeImage(const Image& image, bool& encoded, CancellationToken token) {
+	co_await _computeExecutor->schedule();
+	if (token.isCancelled()) {
+		co_return false;
+	}
+	encoded = _fileHandler->probeImage(image);
+	co_return true;
+}
+
+/// <summary>
+/// Encode the message into the loaded image on the compute executor
+/// </summary>
+/// <param name="image">Image loaded with its pixels</param>
+/// <param name="message">Message that will be encoded</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <param name="token">Token that cancels the stage before it starts</param>
+/// <returns>Returns true if the message has been encoded</returns>
+Task<bool> AsyncImageHandler::embedMessage(Image& image, std::string message, EncodeOptions options, CancellationToken token) {
+	co_await _computeExecutor->schedule();
+	if (token.isCancelled()) {
+		co_return false;
+	}
+	co_return _fileHandler->embedMessage(image, message, options);
+}
+
+/// <summary>
+/// Decode the message from the loaded image on the compute executor
+/// </summary>
+/// <param name="image">Image loaded with its pixels</param>
+/// <param name="message">Modifies the passed message with the decoded one</param>
+/// <param name="token">Token that cancels the stage before it starts</param>
+/// <returns>Returns false if the image does not hold an encoded message or the stage has been cancelled</returns>
+Task<bool> AsyncImageHandler::extractMessage(const Image& image, std::string& message, CancellationToken token) {
+	co_await _computeExecutor->schedule();
+	if (token.isCancelled()) {
+		co_return false;
+	}
+	co_return _fileHandler->extractMessage(image, message);
+}
+
+/// <summary>
+/// Save the loaded image to the file on the I/O executor
+/// </summary>
+/// <param name="filePath">Filepath to which the image data will be saved to</param>
+/// <param name="image">Image loaded with its pixels</param>
+/// <param name="token">Token that cancels the stage before it starts</param>
+/// <returns>Returns true if the image has been saved</returns>
+Task<bool> AsyncImageHandler::saveImage(std::string filePath, const Image& image, CancellationToken token) {
+	co_await _ioExecutor->schedule();
+	if (token.isCancelled()) {
+		co_return false;
+	}
+	co_return _fileHandler->saveImage(filePath, image);
+}
+
+/// <summary>
+/// Load the image, check it holds no message, encode the message and save the image - asynchronous FileHandler::encodeMessage
+/// </summary>
+/// <param name="filePath">Filepath of the image</param>
+/// <param name="message">Message that will be encoded</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <param name="token">Token that stops the operation before its next stage, the file stays untouched unless saving has started</param>
+/// <param name="progress">Callback called before every stage, could be empty</param>
+/// <returns>Returns true if the message has been encoded and saved</returns>
+Task<bool> AsyncImageHandler::encodeMessage(std::string filePath, std::string message, EncodeOptions options, CancellationToken token, ProgressCallback progress) {
+	const int stageCount = 4;
+	Image image;
+	reportProgress(progress, AsyncStage::STAGE_LOAD, 0, stageCount);
+	if (!co_await loadImage(filePath, image, token)) {
+		co_return false;
+	}
+
+	// Image that holds a message already could not take another one
+	bool encoded = true;
+	reportProgress(progress, AsyncStage::STAGE_PROBE, 1, stageCount);
+	bool status = co_await probeImage(image, encoded, token) && !encoded;
+	if (status) {
+		reportProgress(progress, AsyncStage::STAGE_EMBED, 2, stageCount);
+		status = co_await embedMessage(image, std::move(message), options, token);
+	}
+	if (status) {
+		reportProgress(progress, AsyncStage::STAGE_SAVE, 3, stageCount);
+		status = co_await saveImage(filePath, image, token);
+	}
+
+	_fileHandler->unloadImage(image);
+	if (status) {
+		reportProgress(progress, AsyncStage::STAGE_DONE, stageCount, stageCount);
+	}
+	co_return status;
+}
+
+/// <summary>
+/// Load the image, check it holds a message and decode it - asynchronous FileHandler::readEncodedMessage
+/// </summary>
+/// <param name="filePath">Filepath of the image</param>
+/// <param name="message">Modifies the passed message with the decoded one</param>
+/// <param name="token">Token that stops the operation before its next stage</param>
+/// <param name="progress">Callback called before every stage, could be empty</param>
+/// <returns>Returns true if the message has been decoded</returns>
+Task<bool> AsyncImageHandler::decodeMessage(std::string filePath, std::string& message, CancellationToken token, ProgressCallback progress) {
+	const int stageCount = 3;
+	Image image;
+	reportProgress(progress, AsyncStage::STAGE_LOAD, 0, stageCount);
+	if (!co_await loadImage(filePath, image, token)) {
+		co_return false;
+	}
+
+	bool encoded = false;
+	reportProgress(progress, AsyncStage::STAGE_PROBE, 1, stageCount);
+	bool status = co_await probeImage(image, encoded, token) && encoded;
+	if (status) {
+		reportProgress(progress, AsyncStage::STAGE_EXTRACT, 2, stageCount);
+		status = co_await extractMessage(image, message, token);
+	}
+
+	_fileHandler->unloadImage(image);
+	if (status) {
+		reportProgress(progress, AsyncStage::STAGE_DONE, stageCount, stageCount);
+	}
+	co_return status;
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <atomic>
+#include <functional>
+
+#include "structs.hpp"
+#include "enums.hpp"
+#include "FileHandler.hpp"
+#include "Executor.hpp"
+#include "Task.hpp"
+
+/// <summary>
+/// Class for encoding and decoding the images as coroutines, so many images in flight share a few threads
+///
+/// Every stage (load, probe, embed, extract, save) first moves onto its executor - loading and saving onto the I/O one,
+/// the rest onto the compute one - which lets the other images waiting there go first.
+/// Cancellation is checked before every stage, a cancelled operation releases the image and does not write the file.
+/// Arguments taken by reference must stay alive until the task finishes, the rest are copied into the coroutine.
+/// </summary>
+class AsyncImageHandler {
+public:
+	/// <summary>
+	/// Token shared by the caller and the operation, the caller cancels it and the operation stops before its next stage
+	/// Copies of the token share the same state
+	/// </summary>
+	class CancellationToken {
+	private:
+		std::shared_ptr<std::atomic<bool>> _cancelled;
+
+	public:
+		CancellationToken() : _cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+		/// <summary>
+		/// Ask every operation holding the token to stop
+		/// </summary>
+		void cancel() const {
+			_cancelled->store(true);
+		}
+		/// <summary>
+		/// Check if the token has been cancelled
+		/// </summary>
+		/// <returns>Returns true if the token has been cancelled</returns>
+		bool isCancelled() const {
+			return _cancelled->load();
+		}
+	};
+
+	/// <summary>
+	/// Called before every stage of the operation and once it succeeds - the stage and the fraction of the operation done, 0 - 1
+	/// Called on the thread of one of the executors
+	/// </summary>
+	typedef std::function<void(AsyncStage, double)> ProgressCallback;
+
+private:
+	/// <summary>
+	/// Pointer to File Handler that does the work of every stage
+	/// </summary>
+	const FileHandler* _fileHandler;
+	/// <summary>
+	/// Pointer to executor on which the files are read and written
+	/// </summary>
+	Executor* _ioExecutor;
+	/// <summary>
+	/// Pointer to executor on which the pixels are processed
+	/// </summary>
+	Executor* _computeExecutor;
+
+	/// <summary>
+	/// Report the stage to the progress callback, if there is one
+	/// </summary>
+	/// <param name="progress">Progress callback of the operation</param>
+	/// <param name="stage">Stage that starts</param>
+	/// <param name="index">Number of stages done before</param>
+	/// <param name="count">Number of stages of the operation</param>
+	static void reportProgress(const ProgressCallback& progress, AsyncStage stage, int index, int count);
+
+public:
+	/// <summary>
+	/// Constructor, the same executor could be passed for both
+	/// </summary>
+	/// <param name="fileHandler">File Handler that does the work of every stage</param>
+	/// <param name="ioExecutor">Executor on which the files are read and written</param>
+	/// <param name="computeExecutor">Executor on which the pixels are processed</param>
+	AsyncImageHandler(const FileHandler* fileHandler, Executor* ioExecutor, Executor* computeExecutor) {
+		_fileHandler = fileHandler;
+		_ioExecutor = ioExecutor;
+		_computeExecutor = computeExecutor;
+	}
+	~AsyncImageHandler() {}
+
+	/// <summary>
+	/// Read the image with its pixels on the I/O executor
+	/// The image must be released by FileHandler::unloadImage once it is not needed
+	/// </summary>
+	/// <param name="filePath">Filepath from which the image data will be read from</param>
+	/// <param name="image">Modifies the passed image with the images data</param>
+	/// <param name="token">Token that cancels the stage before it starts</param>
+	/// <returns>Returns true if the image has been read, nothing is left to release otherwise</returns>
+	Task<bool> loadImage(std::string filePath, Image& image, CancellationToken token = CancellationToken());
+	/// <summary>
+	/// Check if the loaded image holds an encoded message on the compute executor
+	/// </summary>
+	/// <param name="image">Image loaded with its pixels</param>
+	/// <param name="encoded">Modifies the passed flag, true if the image holds an encoded message</param>
+	/// <param name="token">Token that cancels the stage before it starts</param>
+	/// <returns>Returns false if the stage has been cancelled</returns>
+	Task<bool> probeImage(const Image& image, bool& encoded, CancellationToken token = CancellationToken());
+	/// <summary>
+	/// Encode the message into the loaded image on the compute executor
+	/// </summary>
+	/// <param name="image">Image loaded with its pixels</param>
+	/// <param name="message">Message that will be encoded</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <param name="token">Token that cancels the stage before it starts</param>
+	/// <returns>Returns true if the message has been encoded</returns>
+	Task<bool> embedMessage(Image& image, std::string message, EncodeOptions options, CancellationToken token = CancellationToken());
+	/// <summary>
+	/// Decode the message from the loaded image on the compute executor
+	/// </summary>
+	/// <param name="image">Image loaded with its pixels</param>
+	/// <param name="message">Modifies the passed message with the decoded one</param>
+	/// <param name="token">Token that cancels the stage before it starts</param>
+	/// <returns>Returns false if the image does not hold an encoded message or the stage has been cancelled</returns>
+	Task<bool> extractMessage(const Image& image, std::string& message, CancellationToken token = CancellationToken());
+	/// <summary>
+	/// Save the loaded image to the file on the I/O executor
+	/// </summary>
+	/// <param name="filePath">Filepath to which the image data will be saved to</param>
+	/// <param name="image">Image loaded with its pixels</param>
+	/// <param name="token">Token that cancels the stage before it starts</param>
+	/// <returns>Returns true if the image has been saved</returns>
+	Task<bool> saveImage(std::string filePath, const Image& image, CancellationToken token = CancellationToken());
+
+	/// <summary>
+	/// Load the image, check it holds no message, encode the message and save the image - asynchronous FileHandler::encodeMessage
+	/// </summary>
+	/// <param name="filePath">Filepath of the image</param>
+	/// <param name="message">Message that will be encoded</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <param name="token">Token that stops the operation before its next stage, the file stays untouched unless saving has started</param>
+	/// <param name="progress">Callback called before every stage, could be empty</param>
+	/// <returns>Returns true if the message has been encoded and saved</returns>
+	Task<bool> encodeMessage(std::string filePath, std::string message, EncodeOptions options, CancellationToken token = CancellationToken(), ProgressCallback progress = nullptr);
+	/// <summary>
+	/// Load the image, check it holds a message and decode it - asynchronous FileHandler::readEncodedMessage
+	/// </summary>
+	/// <param name="filePath">Filepath of the image</param>
+	/// <param name="message">Modifies the passed message with the decoded one</param>
+	/// <param name="token">Token that stops the operation before its next stage</param>
+	/// <param name="progress">Callback called before every stage, could be empty</param>
+	/// <returns>Returns true if the message has been decoded</returns>
+	Task<bool> decodeMessage(std::string filePath, std::string& message, CancellationToken token = CancellationToken(), ProgressCallback progress = nullptr);
+};
@@ -0,0 +1,225 @@
+#pragma once
+#include "BMPCodec.hpp"
+#include "Helpers.hpp"
+
+/// <summary>
+/// Determine from the first bytes of the file if it is a .bmp file - starts with "BM"
+/// </summary>
+/// <param name="bytes">First bytes of the file</param>
+/// <param name="length">Number of bytes, at most sniffLength</param>
+/// <returns>Returns true if the file is a .bmp file</returns>
+bool BMPCodec::sniff(const uint8_t* bytes, size_t length) {
+	return length >= 2 && bytes[0] == 'B' && bytes[1] == 'M';
+}
+
+/// <summary>
+/// Read the header of a .bmp file - the file header and an info header of any version from BITMAPINFOHEADER to BITMAPV5HEADER
+/// Every byte up to the pixel data is kept, so the header is written back exactly as it has been read
+/// </summary>
+/// <param name="file">Input Stream of the .bmp file - opened file or its data in memory</param>
+/// <param name="image">Image to which header data will be saved</param>
+/// <returns>Returns if the .bmp header has been successfully read</returns>
+bool BMPCodec::readHeader(std::istream& file, Image& image) {
+	image.fileType = FileType::BMP;
+
+	// File header and the size of the info header tell how many bytes come before the pixel data
+	BMPImage bmpImage;
+	std::string& header = bmpImage.rawHeader;
+	header.resize(_fileHeaderSize + sizeof(uint32_t));
+	file.read(&header[0], header.size());
+	if (!file.good() || header[0] != 'B' || header[1] != 'M') {
+		return false;
+	}
+	image.dataOffset = readField<uint32_t>(header, 10);
+	bmpImage.infoHeaderSize = readField<uint32_t>(header, 14);
+	if (bmpImage.infoHeaderSize < _minInfoHeaderSize || bmpImage.infoHeaderSize > _maxInfoHeaderSize
+		|| image.dataOffset < _fileHeaderSize + bmpImage.infoHeaderSize || image.dataOffset > _maxDataOffset) {
+		return false;
+	}
+
+	// Rest of the info header, color masks of V4 / V5 headers and anything else up to the pixel data in a single read
+	const size_t readLength = header.size();
+	header.resize(image.dataOffset);
+	file.read(&header[readLength], header.size() - readLength);
+	if (!file.good()) {
+		return false;
+	}
+
+	bmpImage.fileType = readField<uint16_t>(header, 0);
+	image.fileSize = bmpImage.fileSize = readField<uint32_t>(header, 2);
+	bmpImage.reserved = readField<uint32_t>(header, 6);
+	bmpImage.dataOffset = image.dataOffset;
+	const int32_t width = readField<int32_t>(header, 18);
+	const int32_t height = readField<int32_t>(header, 22);
+	bmpImage.planes = readField<uint16_t>(header, 26);
+	image.bitsPerPixel = bmpImage.bitsPerPixel = readField<uint16_t>(header, 28);
+	image.channels = (uint8_t)(bmpImage.bitsPerPixel / 8);
+	bmpImage.compression = readField<uint32_t>(header, 30);
+	image.dataSize = bmpImage.dataSize = readField<uint32_t>(header, 34);
+	bmpImage.xPixelsPerMeter = readField<uint32_t>(header, 38);
+	bmpImage.yPixelsPerMeter = readField<uint32_t>(header, 42);
+	bmpImage.colorsInColorTable = readField<uint32_t>(header, 46);
+	bmpImage.importantColorCount = readField<uint32_t>(header, 50);
+	if (width <= 0 || height == 0 || height == INT32_MIN) {
+		return false;
+	}
+
+	// Masks are in the info header from V2 on, the 40 byte one is followed by them when it uses bit fields
+	const bool bitFields = bmpImage.compression == _bitFields || bmpImage.compression == _alphaBitFields;
+	const size_t maskCount = bmpImage.infoHeaderSize >= 56 || bmpImage.compression == _alphaBitFields ? 4 : 3;
+	if (bitFields && header.size() >= _masksOffset + maskCount * sizeof(uint32_t)) {
+		bmpImage.redMask = readField<uint32_t>(header, _masksOffset);
+		bmpImage.greenMask = readField<uint32_t>(header, _masksOffset + 4);
+		bmpImage.blueMask = readField<uint32_t>(header, _masksOffset + 8);
+		bmpImage.alphaMask = maskCount == 4 ? readField<uint32_t>(header, _masksOffset + 12) : 0;
+	}
+
+	// Negative height stores the rows from the top of the picture, the pixels keep the order of the file
+	bmpImage.topDown = height < 0;
+	image.width = bmpImage.width = (uint32_t)width;
+	image.height = bmpImage.height = (uint32_t)(height < 0 ? -height : height);
+	image.rowDirection = bmpImage.topDown ? 1 : -1;
+	image.bmp = bmpImage;
+
+	// Rows are stored without compression and padded to 4 bytes, the last one may miss its padding
+	const uint64_t rowBytes = (image.getRowLength() + 3) / 4 * 4;
+	const uint64_t remaining = Helpers::getRemainingLength(file);
+	return image.fitsInFile(rowBytes, remaining == UINT64_MAX ? remaining : remaining + rowBytes - image.getRowLength());
+}
+
+/// <summary>
+/// Read the pixels of a .bmp file, the header has been read and the pixels allocated
+/// </summary>
+/// <param name="file">Input Stream of the .bmp file - opened file or its data in memory</param>
+/// <param name="image">Image to which data will be saved</param>
+/// <returns>Returns if the .bmp image has been successfully read</returns>
+bool BMPCodec::readPixels(std::istream& file, Image& image) {
+	const size_t rowLength = image.getRowLength();
+	const int paddingAmount = (4 - rowLength % 4) % 4;
+
+	file.seekg(image.dataOffset);
+	for (size_t y = 0; y < image.height; ++y) {
+		// Pixels of the row are stored one after another, so the whole row is read at once
+		file.read((char*)image.pixels + y * rowLength, (std::streamsize)rowLength);
+		if ((size_t)file.gcount() != rowLength) {
+			return false;
+		}
+		// Account for each padding after each row
+		file.ignore(paddingAmount);
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Save the image data to a .bmp file, the header read from the file or made by createHeader is written unchanged
+/// </summary>
+/// <param name="file">Output Stream to which the .bmp file is saved</param>
+/// <param name="image">Image from which data will be read from</param>
+/// <returns>Returns if the .bmp image has been successfully saved</returns>
+bool BMPCodec::write(std::ostream& file, const Image& image) {
+	if (image.bmp.rawHeader.size() != image.dataOffset) {
+		return false;
+	}
+	file.write(image.bmp.rawHeader.data(), image.bmp.rawHeader.size());
+
+	// Write the pixel data to the file
+	const size_t rowLength = image.getRowLength();
+	const int paddingAmount = (4 - rowLength % 4) % 4;
+	unsigned char bmpPad[3] = {0, 0, 0};
+	
+	for (size_t y = 0; y < image.height; ++y) {
+		// Pixels of the row are stored one after another, so the whole row is written at once
+		file.write((const char*)image.pixels + y * rowLength, (std::streamsize)rowLength);
+		file.write(reinterpret_cast<char*>(bmpPad), paddingAmount);
+	}
+
+	// The caller closes the file, return success
+	return file.good();
+}
+
+/// <summary>
+/// Position of the channel in the file, so a changed channel could be written in place
+/// Rows are stored one after another, each padded to 4 bytes
+/// </summary>
+/// <param name="image">Image read from the file, only header data is used</param>
+/// <param name="channel">Index of the channel - byte of the pixels</param>
+/// <param name="offset">Modifies the passed offset with the position of the channel in the file</param>
+/// <returns>Returns false if the channel has no fixed position in the file</returns>
+bool BMPCodec::getChannelOffset(const Image& image, size_t channel, uint64_t& offset) {
+	if (!isSupportedLayout(image.bmp)) {
+		return false;
+	}
+
+	const uint64_t rowLength = image.getRowLength();
+	const uint64_t paddedRowLength = (rowLength + 3) / 4 * 4;
+	offset = image.dataOffset + channel / rowLength * paddedRowLength + channel % rowLength;
+	return true;
+}
+
+/// <summary>
+/// Fill the header for saving the pixels as an uncompressed 24 or 32 bit bottom up .bmp file, e.g. pixels read from another format
+/// Only width, height and channels of the image are used, the rest of the header is replaced
+/// </summary>
+/// <param name="image">Image which header will be filled</param>
+/// <returns>Returns false if the channels of the image could not be stored without a color table</returns>
+bool BMPCodec::createHeader(Image& image) {
+	if (image.channels != 3 && image.channels != 4) {
+		return false;
+	}
+
+	const uint32_t headerSize = 54;
+	const uint32_t paddedRowLength = (uint32_t)(image.getRowLength() + 3) / 4 * 4;
+	image.fileType = FileType::BMP;
+	image.bitsPerPixel = image.channels * 8;
+	image.dataOffset = headerSize;
+	image.dataSize = paddedRowLength * image.height;
+	image.fileSize = headerSize + image.dataSize;
+
+	BMPImage bmpImage = {};
+	bmpImage.fileType = FileType::BMP;
+	bmpImage.fileSize = image.fileSize;
+	bmpImage.dataOffset = image.dataOffset;
+	bmpImage.infoHeaderSize = 40;
+	bmpImage.width = image.width;
+	bmpImage.height = image.height;
+	bmpImage.planes = 1;
+	bmpImage.bitsPerPixel = image.bitsPerPixel;
+	bmpImage.dataSize = image.dataSize;
+	// 72 DPI
+	bmpImage.xPixelsPerMeter = 2835;
+	bmpImage.yPixelsPerMeter = 2835;
+
+	std::string& header = bmpImage.rawHeader;
+	header.assign(headerSize, '\0');
+	writeField<uint16_t>(header, 0, bmpImage.fileType);
+	writeField<uint32_t>(header, 2, bmpImage.fileSize);
+	writeField<uint32_t>(header, 10, bmpImage.dataOffset);
+	writeField<uint32_t>(header, 14, bmpImage.infoHeaderSize);
+	writeField<uint32_t>(header, 18, bmpImage.width);
+	writeField<uint32_t>(header, 22, bmpImage.height);
+	writeField<uint16_t>(header, 26, bmpImage.planes);
+	writeField<uint16_t>(header, 28, bmpImage.bitsPerPixel);
+	writeField<uint32_t>(header, 34, bmpImage.dataSize);
+	writeField<uint32_t>(header, 38, bmpImage.xPixelsPerMeter);
+	writeField<uint32_t>(header, 42, bmpImage.yPixelsPerMeter);
+	image.bmp = bmpImage;
+	image.rowDirection = -1;
+	return true;
+}
+
+/// <summary>
+/// Check if every channel is a byte of its own - 24 or 32 bits without compression,
+/// or 32 bit bit fields with the standard masks of the blue, green, red and optional alpha byte
+/// </summary>
+/// <param name="bmp">Header of the .bmp file</param>
+/// <returns>Returns true if the layout of the pixels is supported</returns>
+bool BMPCodec::isSupportedLayout(const BMPImage& bmp) {
+	if (bmp.compression == _uncompressed) {
+		return bmp.bitsPerPixel == 24 || bmp.bitsPerPixel == 32;
+	}
+	// Bytes of a pixel are blue, green, red and alpha or unused, as without compression
+	return (bmp.compression == _bitFields || bmp.compression == _alphaBitFields) && bmp.bitsPerPixel == 32
+		&& bmp.redMask == 0x00FF0000 && bmp.greenMask == 0x0000FF00 && bmp.blueMask == 0x000000FF
+		&& (bmp.alphaMask == 0xFF000000 || bmp.alphaMask == 0);
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cctype>
+#include <cstdint>
+
+#include "structs.hpp"
+#include "enums.hpp"
+
+/// <summary>
+/// Codec for reading and writing .bmp images, registered in CodecRegistry
+/// </summary>
+class BMPCodec {
+private:
+	/// <summary>
+	/// Number of bytes of the file header, the info header follows
+	/// </summary>
+	static const uint32_t _fileHeaderSize = 14;
+	/// <summary>
+	/// Number of bytes of the smallest supported info header - BITMAPINFOHEADER
+	/// </summary>
+	static const uint32_t _minInfoHeaderSize = 40;
+	/// <summary>
+	/// Number of bytes of the largest supported info header - BITMAPV5HEADER
+	/// </summary>
+	static const uint32_t _maxInfoHeaderSize = 124;
+	/// <summary>
+	/// Largest number of bytes before the pixel data that is accepted, anything bigger is a broken file
+	/// </summary>
+	static const uint32_t _maxDataOffset = 16 * 1024 * 1024;
+	/// <summary>
+	/// Compression of pixels stored as they are - BI_RGB
+	/// </summary>
+	static const uint32_t _uncompressed = 0;
+	/// <summary>
+	/// Compression of pixels described by the red, green and blue masks - BI_BITFIELDS
+	/// </summary>
+	static const uint32_t _bitFields = 3;
+	/// <summary>
+	/// Compression of pixels described by the red, green, blue and alpha masks - BI_ALPHABITFIELDS
+	/// </summary>
+	static const uint32_t _alphaBitFields = 6;
+	/// <summary>
+	/// Position of the color masks, they end the V2 - V5 info headers or follow the 40 byte info header
+	/// </summary>
+	static const size_t _masksOffset = 54;
+
+	/// <summary>
+	/// Read the little endian number from the bytes of the header
+	/// </summary>
+	/// <param name="header">Bytes of the header</param>
+	/// <param name="offset">Position of the number in the header</param>
+	/// <returns>Returns the number</returns>
+	template <typename T>
+	static T readField(const std::string& header, size_t offset) {
+		T value = 0;
+		for (size_t i = 0; i < sizeof(T); i++) {
+			value |= (T)((T)(uint8_t)header[offset + i] << (8 * i));
+		}
+		return value;
+	}
+	/// <summary>
+	/// Store the little endian number into the bytes of the header
+	/// </summary>
+	/// <param name="header">Bytes of the header</param>
+	/// <param name="offset">Position of the number in the header</param>
+	/// <param name="value">Number that is stored</param>
+	template <typename T>
+	static void writeField(std::string& header, size_t offset, T value) {
+		for (size_t i = 0; i < sizeof(T); i++) {
+			header[offset + i] = (char)((value >> (8 * i)) & 0xFF);
+		}
+	}
+
+public:
+	/// <summary>
+	/// Type of the files handled by this codec
+	/// </summary>
+	static constexpr FileType fileType = FileType::BMP;
+	/// <summary>
+	/// Layout of the channels as they are read and written - blue, green, red order
+	/// Rows are stored from the bottom of the picture unless the height is negative, see Image::rowDirection
+	/// Pixels moved to another format are reordered when the layouts differ
+	/// </summary>
+	static constexpr bool reversedChannels = true;
+
+	/// <summary>
+	/// Determine from the first bytes of the file if it is a .bmp file - starts with "BM"
+	/// </summary>
+	/// <param name="bytes">First bytes of the file</param>
+	/// <param name="length">Number of bytes, at most sniffLength</param>
+	/// <returns>Returns true if the file is a .bmp file</returns>
+	static bool sniff(const uint8_t* bytes, size_t length);
+	/// <summary>
+	/// Read the header of a .bmp file - the file header and an info header of any version from BITMAPINFOHEADER to BITMAPV5HEADER
+	/// Every byte up to the pixel data is kept, so the header is written back exactly as it has been read
+	/// </summary>
+	/// <param name="file">Input Stream of the .bmp file - opened file or its data in memory</param>
+	/// <param name="image">Image to which header data will be saved</param>
+	/// <returns>Returns if the .bmp header has been successfully read</returns>
+	static bool readHeader(std::istream& file, Image& image);
+	/// <summary>
+	/// Read the pixels of a .bmp file, the header has been read and the pixels allocated
+	/// </summary>
+	/// <param name="file">Input Stream of the .bmp file - opened file or its data in memory</param>
+	/// <param name="image">Image to which data will be saved</param>
+	/// <returns>Returns if the .bmp image has been successfully read</returns>
+	static bool readPixels(std::istream& file, Image& image);
+	/// <summary>
+	/// Save the image data to a .bmp file, the header read from the file or made by createHeader is written unchanged
+	/// </summary>
+	/// <param name="file">Output Stream to which the .bmp file is saved</param>
+	/// <param name="image">Image from which data will be read from</param>
+	/// <returns>Returns if the .bmp image has been successfully saved</returns>
+	static bool write(std::ostream& file, const Image& image);
+	/// <summary>
+	/// Position of the channel in the file, so a changed channel could be written in place
+	/// Rows are stored one after another, each padded to 4 bytes
+	/// </summary>
+	/// <param name="image">Image read from the file, only header data is used</param>
+	/// <param name="channel">Index of the channel - byte of the pixels</param>
+	/// <param name="offset">Modifies the passed offset with the position of the channel in the file</param>
+	/// <returns>Returns false if the channel has no fixed position in the file</returns>
+	static bool getChannelOffset(const Image& image, size_t channel, uint64_t& offset);
+	/// <summary>
+	/// Fill the header for saving the pixels as an uncompressed 24 or 32 bit bottom up .bmp file, e.g. pixels read from another format
+	/// Only width, height and channels of the image are used, the rest of the header is replaced
+	/// </summary>
+	/// <param name="image">Image which header will be filled</param>
+	/// <returns>Returns false if the channels of the image could not be stored without a color table</returns>
+	static bool createHeader(Image& image);
+	/// <summary>
+	/// Check if every channel is a byte of its own - 24 or 32 bits without compression,
+	/// or 32 bit bit fields with the standard masks of the blue, green, red and optional alpha byte
+	/// </summary>
+	/// <param name="bmp">Header of the .bmp file</param>
+	/// <returns>Returns true if the layout of the pixels is supported</returns>
+	static bool isSupportedLayout(const BMPImage& bmp);
+};
@@ -0,0 +1,416 @@
+#pragma once
+#include "BenchmarkHandler.hpp"
+
+/// <summary>
+/// Calculate the throughput in MB/s
+/// </summary>
+/// <param name="bytes">Number of bytes processed</param>
+/// <param name="start">Time when the processing started</param>
+/// <returns>Returns throughput in MB/s</returns>
+double BenchmarkHandler::getThroughput(size_t bytes, std::chrono::steady_clock::time_point start) const {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return (double)bytes / 1024 / 1024 / std::max(elapsed.count(), 1e-9);
+}
+
+/// <summary>
+/// Measure encoding and decoding of the error correction for every level
+/// Decoding is measured on intact data and on data with flipped bytes in every block
+/// </summary>
+void BenchmarkHandler::benchmarkErrorCorrection() const {
+	std::mt19937 random(42);
+	std::string message(_benchmarkBytes, '\0');
+	for (char& c : message) {
+		c = (char)random();
+	}
+
+	std::cout << "Error correction (" << _benchmarkBytes / 1024 / 1024 << " MB message)" << std::endl;
+	std::cout << std::setw(8) << "Level" << std::setw(10) << "Parity" << std::setw(12) << "Overhead"
+		<< std::setw(14) << "Encode MB/s" << std::setw(14) << "Decode MB/s" << std::setw(22) << "Decode fixing MB/s" << std::endl;
+
+	for (int level = 0; level <= 3; level++) {
+		const int parityLength = ErrorCorrection::getParityLength(level);
+
+		auto start = std::chrono::steady_clock::now();
+		std::string encoded = _errorCorrection->encode(message, level);
+		double encodeSpeed = getThroughput(message.length(), start);
+
+		std::string decoded;
+		start = std::chrono::steady_clock::now();
+		_errorCorrection->decode(encoded, message.length(), level, decoded);
+		double decodeSpeed = getThroughput(message.length(), start);
+
+		// Flip a bit in half of the bytes every block could fix
+		for (size_t block = 0; block < encoded.length() && parityLength > 0; block += 255) {
+			for (int i = 0; i < parityLength / 4; i++) {
+				encoded[block + random() % std::min<size_t>(255, encoded.length() - block)] ^= 1 << (random() % 8);
+			}
+		}
+		start = std::chrono::steady_clock::now();
+		bool fixed = _errorCorrection->decode(encoded, message.length(), level, decoded) >= 0 && decoded == message;
+		double fixingSpeed = getThroughput(message.length(), start);
+
+		std::cout << std::fixed << std::setprecision(1)
+			<< std::setw(8) << level << std::setw(10) << parityLength
+			<< std::setw(11) << 100.0 * (encoded.length() - message.length()) / message.length() << "%"
+			<< std::setw(14) << encodeSpeed << std::setw(14) << decodeSpeed;
+		if (parityLength > 0) {
+			std::cout << std::setw(22) << fixingSpeed << (fixed ? "" : " (failed)");
+		}
+		std::cout << std::endl;
+	}
+	std::cout << std::endl;
+}
+
+/// <summary>
+/// Measure compression of PNG image data in both modes and its decompression
+/// Data looks like filtered rows of a photo - mostly small differences with some noise
+/// </summary>
+void BenchmarkHandler::benchmarkCompression() const {
+	std::mt19937 random(42);
+	std::normal_distribution<double> noise(0, 3);
+	std::vector<uint8_t> data(_benchmarkBytes);
+	for (uint8_t& value : data) {
+		value = (uint8_t)(int)std::lround(noise(random));
+	}
+
+	std::cout << "PNG compression (" << _benchmarkBytes / 1024 / 1024 << " MB of filtered rows)" << std::endl;
+	std::cout << std::setw(8) << "Mode" << std::setw(10) << "Ratio" << std::setw(16) << "Compress MB/s" << std::setw(18) << "Decompress MB/s" << std::endl;
+
+	for (bool best : { false, true }) {
+		std::string compressed;
+		Deflater deflater([&compressed](const uint8_t* bytes, size_t length) {
+			compressed.append((const char*)bytes, length);
+			return true;
+		}, best);
+		auto start = std::chrono::steady_clock::now();
+		deflater.write(data.data(), data.size());
+		deflater.finish();
+		double compressSpeed = getThroughput(data.size(), start);
+
+		size_t position = 0;
+		Inflater inflater([&](uint8_t* buffer, size_t size) {
+			const size_t count = std::min(size, compressed.length() - position);
+			std::memcpy(buffer, compressed.data() + position, count);
+			position += count;
+			return count;
+		});
+		std::vector<uint8_t> decompressed(data.size());
+		start = std::chrono::steady_clock::now();
+		bool valid = inflater.read(decompressed.data(), decompressed.size()) && inflater.finish() && decompressed == data;
+		double decompressSpeed = getThroughput(data.size(), start);
+
+		std::cout << std::fixed << std::setprecision(1)
+			<< std::setw(8) << (best ? "best" : "fast") << std::setw(9) << 100.0 * compressed.length() / data.size() << "%"
+			<< std::setw(16) << compressSpeed << std::setw(18) << decompressSpeed << (valid ? "" : " (failed)") << std::endl;
+	}
+	std::cout << std::endl;
+}
+
+/// <summary>
+/// Measure the cost map of the adaptive mode on a single thread and split into tiles on every thread,
+/// and choosing the channels for a message filling half of the image
+/// </summary>
+void BenchmarkHandler::benchmarkCostMap() const {
+	// Photo-like image - smooth gradient with noise, 12 MP
+	Image image;
+	image.width = 4000;
+	image.height = 3000;
+	image.bitsPerPixel = 24;
+	image.channels = 3;
+	const size_t pixelCount = (size_t)image.width * image.height;
+	std::vector<uint8_t> pixels(image.getChannelCount());
+	image.pixels = pixels.data();
+	std::mt19937 random(42);
+	std::normal_distribution<double> noise(0, 4);
+	uint8_t* bytes = image.pixels;
+	for (size_t i = 0; i < pixels.size(); i++) {
+		const double gradient = (double)(i / image.channels % image.width) * 200 / image.width;
+		bytes[i] = (uint8_t)std::clamp((int)std::lround(gradient + noise(random)), 0, 255);
+	}
+
+#ifdef SIMD_SSE2
+	std::cout << "Cost map (" << pixelCount / 1000000 << " MP, SSE2)" << std::endl;
+#else
+	std::cout << "Cost map (" << pixelCount / 1000000 << " MP, scalar)" << std::endl;
+#endif
+	std::cout << std::setw(12) << "Stage" << std::setw(12) << "MP/s" << std::endl;
+
+	CostMapHandler costMapHandler;
+	std::vector<uint16_t> texture;
+	std::vector<uint32_t> histogram;
+	for (bool parallel : { false, true }) {
+		auto start = std::chrono::steady_clock::now();
+		costMapHandler.computeTextureMap(image, texture, histogram, parallel);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << std::fixed << std::setprecision(1) << std::setw(12) << (parallel ? "map, tiles" : "map, serial")
+			<< std::setw(12) << pixelCount / 1e6 / std::max(elapsed.count(), 1e-9) << std::endl;
+	}
+
+	std::vector<uint32_t> channels;
+	auto start = std::chrono::steady_clock::now();
+	bool valid = costMapHandler.selectChannels(image, 0, image.getChannelCount() / 2, channels);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << std::setw(12) << "select" << std::setw(12) << pixelCount / 1e6 / std::max(elapsed.count(), 1e-9)
+		<< (valid ? "" : " (failed)") << std::endl << std::endl;
+}
+
+/// <summary>
+/// Measure replacing the lowest bit of every channel with random bits on a single thread and split into bands on every thread
+/// </summary>
+void BenchmarkHandler::benchmarkSanitize() const {
+	Image image;
+	image.width = 4000;
+	image.height = 3000;
+	image.bitsPerPixel = 24;
+	image.channels = 3;
+	const size_t length = image.getChannelCount();
+	std::vector<uint8_t> pixels(length);
+	image.pixels = pixels.data();
+
+	SanitizeHandler sanitizeHandler;
+#ifdef SIMD_SSE2
+	std::cout << "Sanitize (" << length / 1024 / 1024 << " MB, SSE2)" << std::endl;
+#else
+	std::cout << "Sanitize (" << length / 1024 / 1024 << " MB, scalar)" << std::endl;
+#endif
+	std::cout << std::setw(12) << "Stage" << std::setw(12) << "MB/s" << std::endl;
+	for (bool parallel : { false, true }) {
+		auto start = std::chrono::steady_clock::now();
+		sanitizeHandler.sanitizeImage(image, 1, 42, parallel);
+		std::cout << std::fixed << std::setprecision(1) << std::setw(12) << (parallel ? "bands" : "serial")
+			<< std::setw(12) << getThroughput(length, start) << std::endl;
+	}
+
+	// LSB matching of an image in which about half of the lowest bits have been replaced
+	const uint8_t* bytes = (const uint8_t*)image.pixels;
+	std::vector<uint8_t> original(bytes, bytes + length);
+	sanitizeHandler.sanitizeImage(image, 1, 43, true);
+	auto start = std::chrono::steady_clock::now();
+	sanitizeHandler.matchImage(image, original.data(), length, 44);
+	std::cout << std::setw(12) << "match" << std::setw(12) << getThroughput(length, start) << std::endl;
+	std::cout << std::endl;
+}
+
+/// <summary>
+/// Measure hiding random data with matrix embedding of every level against the plain replacement (level 0),
+/// and the number of changed channels per hidden bit
+/// </summary>
+void BenchmarkHandler::benchmarkMatrixEmbedding() const {
+	const size_t length = _benchmarkBytes / 8;
+	std::mt19937 generator(42);
+	std::string data(length, '\0');
+	for (char& c : data) {
+		c = (char)generator();
+	}
+	std::vector<uint8_t> carrier(MatrixEmbedding::getCarrierLength(length * 8, 7));
+	for (uint8_t& c : carrier) {
+		c = (uint8_t)generator();
+	}
+
+	MatrixEmbedding matrixEmbedding;
+	std::cout << "Matrix embedding (" << length / 1024 << " KB of data)" << std::endl;
+	std::cout << std::setw(12) << "Level" << std::setw(14) << "embed MB/s" << std::setw(14) << "extract MB/s"
+		<< std::setw(14) << "changes/bit" << std::setw(14) << "channels/bit" << std::endl;
+	for (int level = 0; level <= 7; level++) {
+		if (!MatrixEmbedding::isSupportedLevel(level)) {
+			continue;
+		}
+		std::vector<uint8_t> channels(carrier.begin(), carrier.begin() + MatrixEmbedding::getCarrierLength(length * 8, level));
+		auto start = std::chrono::steady_clock::now();
+		size_t changed = matrixEmbedding.embed(channels.data(), data, level);
+		double embedThroughput = getThroughput(length, start);
+
+		start = std::chrono::steady_clock::now();
+		bool valid = matrixEmbedding.extract(channels.data(), length, level) == data;
+		double extractThroughput = getThroughput(length, start);
+
+		std::cout << std::fixed << std::setprecision(1) << std::setw(12) << level << std::setw(14) << embedThroughput
+			<< std::setw(14) << extractThroughput << std::setprecision(3) << std::setw(14) << (double)changed / (length * 8)
+			<< std::setw(14) << (double)channels.size() / (length * 8) << (valid ? "" : " (failed)") << std::endl;
+	}
+	std::cout << std::endl;
+}
+
+/// <summary>
+/// Measure moving coroutines between the stages of the asynchronous operations,
+/// many operations in flight at once share a pool of two threads
+/// Then encode and decode images in a temporary directory through the asynchronous handler - load, probe, embed or extract and save
+/// </summary>
+void BenchmarkHandler::benchmarkCoroutines() const {
+	const size_t operationCount = 10000;
+	const int stageCount = 5;
+	ThreadPoolExecutor executor(2);
+
+	// Start every operation at once and wait until all of them finish, returns the number of them that succeeded
+	auto runAll = [](size_t count, const std::function<Task<bool>(size_t)>& operation) {
+		std::atomic<size_t> succeeded(0);
+		size_t finished = 0;
+		std::mutex mutex;
+		std::condition_variable condition;
+		for (size_t i = 0; i < count; i++) {
+			Task<bool>::start(operation(i), [&](bool status) {
+				succeeded += status ? 1 : 0;
+				// Notified under the lock, the waiting thread could return and destroy the condition right after it is released
+				std::lock_guard<std::mutex> lock(mutex);
+				if (++finished == count) {
+					condition.notify_one();
+				}
+			});
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&]() { return finished == count; });
+		return succeeded.load();
+	};
+	auto schedule = [&]() -> Task<bool> {
+		for (int stage = 0; stage < stageCount; stage++) {
+			co_await executor.schedule();
+		}
+		co_return true;
+	};
+
+	std::cout << "Coroutines (" << operationCount << " operations, " << stageCount << " stages, " << executor.size() << " threads)" << std::endl;
+	std::cout << std::setw(12) << "Stage" << std::setw(12) << "stages/s" << std::endl;
+	auto start = std::chrono::steady_clock::now();
+	runAll(operationCount, [&](size_t) { return schedule(); });
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << std::fixed << std::setprecision(0) << std::setw(12) << "schedule"
+		<< std::setw(12) << operationCount * stageCount / elapsed.count() << std::endl;
+	std::cout << std::endl;
+
+	// Photo-like .ppm images with a different message for each, every image is encoded and decoded at once
+	const size_t imageCount = 64;
+	const uint32_t width = 512;
+	const uint32_t height = 512;
+	const size_t messageLength = 8 * 1024;
+	const size_t imageBytes = (size_t)width * height * 3;
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "steganography-benchmark";
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	if (!std::filesystem::create_directories(directory, error)) {
+		std::cout << "Error: unable to create " << directory.string() << std::endl;
+		return;
+	}
+
+	std::mt19937 random(42);
+	std::vector<std::string> paths(imageCount);
+	std::vector<std::string> messages(imageCount);
+	std::string pixels(imageBytes, '\0');
+	for (size_t i = 0; i < imageCount; i++) {
+		for (size_t c = 0; c < imageBytes; c++) {
+			pixels[c] = (char)(c / 3 % width * 200 / width + random() % 16);
+		}
+		paths[i] = (directory / (std::to_string(i) + ".ppm")).string();
+		std::ofstream file(paths[i], std::ios::binary);
+		file << "P6\n" << width << " " << height << "\n255\n";
+		file.write(pixels.data(), pixels.size());
+
+		messages[i].resize(messageLength);
+		for (char& c : messages[i]) {
+			c = (char)('a' + random() % 26);
+		}
+	}
+
+	FileHandler fileHandler;
+	ThreadPoolExecutor ioExecutor(2);
+	AsyncImageHandler asyncImageHandler(&fileHandler, &ioExecutor, &executor);
+	std::vector<std::string> decoded(imageCount);
+	std::cout << "Asynchronous images (" << imageCount << " images of " << width << "x" << height << ", "
+		<< ioExecutor.size() << " I/O and " << executor.size() << " compute threads)" << std::endl;
+	std::cout << std::setw(12) << "Operation" << std::setw(12) << "images/s" << std::setw(12) << "MB/s" << std::endl;
+	for (bool encode : { true, false }) {
+		start = std::chrono::steady_clock::now();
+		const size_t succeeded = runAll(imageCount, [&](size_t i) {
+			return encode ? asyncImageHandler.encodeMessage(paths[i], messages[i], EncodeOptions())
+				: asyncImageHandler.decodeMessage(paths[i], decoded[i]);
+		});
+		elapsed = std::chrono::steady_clock::now() - start;
+		const bool valid = succeeded == imageCount && (encode || decoded == messages);
+		std::cout << std::fixed << std::setprecision(1) << std::setw(12) << (encode ? "encode" : "decode")
+			<< std::setw(12) << imageCount / elapsed.count() << std::setw(12) << (double)imageCount * imageBytes / 1024 / 1024 / elapsed.count()
+			<< (valid ? "" : " (failed)") << std::endl;
+	}
+	std::filesystem::remove_all(directory, error);
+	std::cout << std::endl;
+}
+
+/// <summary>
+/// Run every benchmark and print the results
+/// </summary>
+void BenchmarkHandler::runBenchmarks() const {
+	benchmarkErrorCorrection();
+	benchmarkCompression();
+	benchmarkCostMap();
+	benchmarkSanitize();
+	benchmarkMatrixEmbedding();
+	benchmarkCoroutines();
+}
+
+
+/// <summary>
+/// Send requests to the running server from many connections at once and print the latency percentiles
+/// Every connection sends its next request once the previous one has been answered
+/// </summary>
+/// <param name="socketPath">Path of the server's Unix domain socket</param>
+/// <param name="operation">Operation sent in every request</param>
+/// <param name="path">Path of the image sent in every request</param>
+/// <param name="requests">Number of requests sent in total</param>
+/// <param name="connections">Number of connections sending the requests at once</param>
+/// <returns>Returns false if the server could not be reached</returns>
+bool BenchmarkHandler::runLoadTest(const std::string& socketPath, DaemonOperation operation, const std::string& path, size_t requests, size_t connections) const {
+	connections = std::max<size_t>(1, std::min(connections, requests));
+	std::vector<std::vector<double>> latencies(connections); // in microseconds
+	std::atomic<size_t> failed(0);
+	std::atomic<size_t> next(0);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> clients;
+	for (size_t c = 0; c < connections; c++) {
+		clients.emplace_back([&, c]() {
+			int fd = DaemonHandler::connectToServer(socketPath);
+			if (fd < 0) {
+				failed++;
+				return;
+			}
+
+			std::string response;
+			for (size_t i = next++; i < requests; i = next++) {
+				auto sent = std::chrono::steady_clock::now();
+				std::string request = DaemonHandler::createRequest((uint32_t)i, operation, 0, path, "");
+				if (!DaemonHandler::sendFrame(fd, request) || !DaemonHandler::receiveFrame(fd, response)) {
+					failed++;
+					break;
+				}
+				std::chrono::duration<double, std::micro> latency = std::chrono::steady_clock::now() - sent;
+				latencies[c].push_back(latency.count());
+				if (response.length() < 5 || response[4] != DaemonStatus::STATUS_OK) {
+					failed++;
+				}
+			}
+			DaemonHandler::closeConnection(fd);
+		});
+	}
+	for (std::thread& client : clients) {
+		client.join();
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::vector<double> all;
+	for (const std::vector<double>& connectionLatencies : latencies) {
+		all.insert(all.end(), connectionLatencies.begin(), connectionLatencies.end());
+	}
+	if (all.empty()) {
+		std::cout << "Error: unable to reach the server at " << socketPath << std::endl;
+		return false;
+	}
+
+	std::sort(all.begin(), all.end());
+	auto percentile = [&all](double p) {
+		return all[std::min(all.size() - 1, (size_t)(p / 100 * all.size()))];
+	};
+	std::cout << std::fixed << std::setprecision(1)
+		<< "Requests: " << all.size() << " (failed " << failed << ") over " << connections << " connections" << std::endl
+		<< "Throughput: " << all.size() / std::max(elapsed.count(), 1e-9) << " requests/s" << std::endl
+		<< "Latency us - p50: " << percentile(50) << " p90: " << percentile(90) << " p99: " << percentile(99)
+		<< " p99.9: " << percentile(99.9) << " max: " << all.back() << std::endl;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include "ErrorCorrection.hpp"
+#include "DaemonHandler.hpp"
+#include "Inflater.hpp"
+#include "Deflater.hpp"
+#include "CostMapHandler.hpp"
+#include "SanitizeHandler.hpp"
+#include "MatrixEmbedding.hpp"
+#include "Executor.hpp"
+#include "Task.hpp"
+#include "AsyncImageHandler.hpp"
+
+/// <summary>
+/// Class for measuring the throughput of the encoding stages
+/// </summary>
+class BenchmarkHandler {
+private:
+	/// <summary>
+	/// Pointer to error correction that is measured
+	/// </summary>
+	ErrorCorrection* _errorCorrection;
+	/// <summary>
+	/// Number of bytes processed by every measurement
+	/// </summary>
+	const size_t _benchmarkBytes = 8 * 1024 * 1024;
+
+	/// <summary>
+	/// Calculate the throughput in MB/s
+	/// </summary>
+	/// <param name="bytes">Number of bytes processed</param>
+	/// <param name="start">Time when the processing started</param>
+	/// <returns>Returns throughput in MB/s</returns>
+	double getThroughput(size_t bytes, std::chrono::steady_clock::time_point start) const;
+	/// <summary>
+	/// Measure encoding and decoding of the error correction for every level
+	/// Decoding is measured on intact data and on data with flipped bytes in every block
+	/// </summary>
+	void benchmarkErrorCorrection() const;
+	/// <summary>
+	/// Measure compression of PNG image data in both modes and its decompression
+	/// Data looks like filtered rows of a photo - mostly small differences with some noise
+	/// </summary>
+	void benchmarkCompression() const;
+	/// <summary>
+	/// Measure the cost map of the adaptive mode on a single thread and split into tiles on every thread,
+	/// and choosing the channels for a message filling half of the image
+	/// </summary>
+	void benchmarkCostMap() const;
+	/// <summary>
+	/// Measure replacing the lowest bit of every channel with random bits on a single thread and split into bands on every thread
+	/// </summary>
+	void benchmarkSanitize() const;
+	/// <summary>
+	/// Measure hiding random data with matrix embedding of every level against the plain replacement (level 0),
+	/// and the number of changed channels per hidden bit
+	/// </summary>
+	void benchmarkMatrixEmbedding() const;
+	/// <summary>
+	/// Measure moving coroutines between the stages of the asynchronous operations,
+	/// many operations in flight at once share a pool of two threads
+	/// Then encode and decode images in a temporary directory through the asynchronous handler - load, probe, embed or extract and save
+	/// </summary>
+	void benchmarkCoroutines() const;
+
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	BenchmarkHandler() {
+		_errorCorrection = new ErrorCorrection();
+	}
+	/// <summary>
+	/// Destructor
+	/// </summary>
+	~BenchmarkHandler() {
+		delete _errorCorrection;
+	}
+
+	/// <summary>
+	/// Run every benchmark and print the results
+	/// </summary>
+	void runBenchmarks() const;
+	/// <summary>
+	/// Send requests to the running server from many connections at once and print the latency percentiles
+	/// Every connection sends its next request once the previous one has been answered
+	/// </summary>
+	/// <param name="socketPath">Path of the server's Unix domain socket</param>
+	/// <param name="operation">Operation sent in every request</param>
+	/// <param name="path">Path of the image sent in every request</param>
+	/// <param name="requests">Number of requests sent in total</param>
+	/// <param name="connections">Number of connections sending the requests at once</param>
+	/// <returns>Returns false if the server could not be reached</returns>
+	bool runLoadTest(const std::string& socketPath, DaemonOperation operation, const std::string& path, size_t requests, size_t connections) const;
+};
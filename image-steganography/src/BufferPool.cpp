@@ -0,0 +1,91 @@
+#pragma once
+#include "BufferPool.hpp"
+
+/// <summary>
+/// Destructor - releases every buffer that is still in the pool
+/// </summary>
+BufferPool::~BufferPool() {
+	for (auto& pixels : _freePixels) {
+		delete[] pixels.first;
+	}
+}
+
+/// <summary>
+/// Take the smallest free pixel buffer that holds the given number of bytes or allocate a new one
+/// The pixels are cleared, so a short read never leaves the pixels of an earlier image in the buffer
+/// </summary>
+/// <param name="length">Number of bytes needed - every channel of every pixel</param>
+/// <returns>Returns pointer to the pixels</returns>
+uint8_t* BufferPool::acquirePixels(size_t length) {
+	std::pair<uint8_t*, size_t> pixels;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		size_t best = _freePixels.size();
+		for (size_t i = 0; i < _freePixels.size(); i++) {
+			if (_freePixels[i].second >= length && (best == _freePixels.size() || _freePixels[i].second < _freePixels[best].second)) {
+				best = i;
+			}
+		}
+
+		if (best < _freePixels.size()) {
+			pixels = _freePixels[best];
+			_freePixels.erase(_freePixels.begin() + best);
+		}
+		else {
+			pixels = { new uint8_t[length], length };
+		}
+		_usedPixels[pixels.first] = pixels.second;
+	}
+
+	std::memset(pixels.first, 0, length);
+	return pixels.first;
+}
+
+/// <summary>
+/// Give the pixel buffer back to the pool
+/// </summary>
+/// <param name="pixels">Pixels taken with acquirePixels</param>
+/// <returns>Returns false if the buffer was not taken from this pool</returns>
+bool BufferPool::releasePixels(uint8_t* pixels) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto used = _usedPixels.find(pixels);
+	if (used == _usedPixels.end()) {
+		return false;
+	}
+
+	if (_freePixels.size() < _maxFree) {
+		_freePixels.push_back({ pixels, used->second });
+	}
+	else {
+		delete[] pixels;
+	}
+	_usedPixels.erase(used);
+	return true;
+}
+
+/// <summary>
+/// Take a free byte buffer, it is empty but keeps the memory of earlier requests
+/// </summary>
+/// <returns>Returns empty buffer</returns>
+std::string BufferPool::acquireBuffer() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_freeBuffers.empty()) {
+		return std::string();
+	}
+
+	std::string buffer = std::move(_freeBuffers.back());
+	_freeBuffers.pop_back();
+	return buffer;
+}
+
+/// <summary>
+/// Give the byte buffer back to the pool
+/// </summary>
+/// <param name="buffer">Buffer that is no longer used</param>
+void BufferPool::releaseBuffer(std::string&& buffer) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_freeBuffers.size() < _maxFree) {
+		buffer.clear();
+		_freeBuffers.push_back(std::move(buffer));
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <cstring>
+
+#include "structs.hpp"
+
+/// <summary>
+/// Pool of pixel and byte buffers that are reused across requests instead of being allocated every time
+/// Safe to use from many threads at once
+/// </summary>
+class BufferPool {
+private:
+	std::mutex _mutex;
+	/// <summary>
+	/// Free pixel buffers and their capacity in bytes
+	/// </summary>
+	std::vector<std::pair<uint8_t*, size_t>> _freePixels;
+	/// <summary>
+	/// Capacity of every pixel buffer handed out by the pool
+	/// </summary>
+	std::unordered_map<uint8_t*, size_t> _usedPixels;
+	/// <summary>
+	/// Free byte buffers, cleared but with their memory kept
+	/// </summary>
+	std::vector<std::string> _freeBuffers;
+	/// <summary>
+	/// Number of free buffers of each kind kept in the pool, the rest is released
+	/// </summary>
+	size_t _maxFree;
+
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="maxFree">Number of free buffers of each kind kept in the pool</param>
+	BufferPool(size_t maxFree) {
+		_maxFree = maxFree;
+	}
+	/// <summary>
+	/// Destructor - releases every buffer that is still in the pool
+	/// </summary>
+	~BufferPool();
+
+	/// <summary>
+	/// Take the smallest free pixel buffer that holds the given number of bytes or allocate a new one
+	/// The pixels are cleared, so a short read never leaves the pixels of an earlier image in the buffer
+	/// </summary>
+	/// <param name="length">Number of bytes needed - every channel of every pixel</param>
+	/// <returns>Returns pointer to the pixels</returns>
+	uint8_t* acquirePixels(size_t length);
+	/// <summary>
+	/// Give the pixel buffer back to the pool
+	/// </summary>
+	/// <param name="pixels">Pixels taken with acquirePixels</param>
+	/// <returns>Returns false if the buffer was not taken from this pool</returns>
+	bool releasePixels(uint8_t* pixels);
+	/// <summary>
+	/// Take a free byte buffer, it is empty but keeps the memory of earlier requests
+	/// </summary>
+	/// <returns>Returns empty buffer</returns>
+	std::string acquireBuffer();
+	/// <summary>
+	/// Give the byte buffer back to the pool
+	/// </summary>
+	/// <param name="buffer">Buffer that is no longer used</param>
+	void releaseBuffer(std::string&& buffer);
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#include "enums.hpp"
+#include "BMPCodec.hpp"
+#include "PPMCodec.hpp"
+#include "PNGCodec.hpp"
+#include "PGMCodec.hpp"
+#include "TGACodec.hpp"
+
+/// <summary>
+/// Empty value carrying the codec type, passed to the functions of CodecRegistry::dispatch
+/// </summary>
+template <typename Codec>
+struct CodecTag {
+	typedef Codec type;
+};
+
+/// <summary>
+/// List of the image codecs known at compile time
+/// Every codec provides static fileType, reversedChannels, sniff, readHeader, readPixels, write, getChannelOffset and createHeader
+/// </summary>
+template <typename... Codecs>
+class CodecRegistry {
+public:
+	/// <summary>
+	/// Number of bytes from the beginning of the file needed to recognize any of the formats
+	/// </summary>
+	static const size_t sniffLength = 8;
+
+	/// <summary>
+	/// Recognize the format of the file from its first bytes
+	/// </summary>
+	/// <param name="bytes">First bytes of the file</param>
+	/// <param name="length">Number of bytes, could be less than sniffLength for short files</param>
+	/// <returns>Returns type of the file, UNKNOWN if no codec recognizes it</returns>
+	static FileType sniff(const uint8_t* bytes, size_t length) {
+		FileType fileType = FileType::UNKNOWN;
+		((fileType == FileType::UNKNOWN && Codecs::sniff(bytes, length) ? (fileType = Codecs::fileType, true) : false) || ...);
+		return fileType;
+	}
+
+	/// <summary>
+	/// Call the function with the CodecTag of the codec handling the given type
+	/// </summary>
+	/// <param name="fileType">Type of the file</param>
+	/// <param name="function">Function taking CodecTag and returning bool</param>
+	/// <returns>Returns result of the function, false if no codec handles the type</returns>
+	template <typename Function>
+	static bool dispatch(FileType fileType, Function&& function) {
+		bool result = false;
+		bool found = ((Codecs::fileType == fileType ? (result = function(CodecTag<Codecs>()), true) : false) || ...);
+		return found && result;
+	}
+};
+
+/// <summary>
+/// Codecs of all supported image formats, a new format only needs its codec added here
+/// TGA has no signature, so it is sniffed last
+/// </summary>
+typedef CodecRegistry<BMPCodec, PPMCodec, PNGCodec, PGMCodec, TGACodec> ImageCodecs;
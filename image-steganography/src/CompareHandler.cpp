@@ -0,0 +1,302 @@
+#pragma once
+#include "CompareHandler.hpp"
+
+namespace {
+	int countBits(uint32_t value) {
+		int count = 0;
+		for (; value != 0; value &= value - 1) {
+			count++;
+		}
+		return count;
+	}
+}
+
+/// <summary>
+/// Compare a single row and add the differences to the statistics of the band
+/// </summary>
+/// <param name="original">Bytes of the row of the original image</param>
+/// <param name="modified">Bytes of the row of the modified image</param>
+/// <param name="length">Number of bytes of the row</param>
+/// <param name="statistics">Statistics of the band</param>
+/// <param name="first">Modifies the passed index with the first changed byte of the row, length if none changed</param>
+/// <param name="last">Modifies the passed index with the last changed byte of the row</param>
+void CompareHandler::compareRow(const uint8_t* original, const uint8_t* modified, size_t length, BandStatistics& statistics, size_t& first, size_t& last) {
+	first = length;
+	last = 0;
+	size_t i = 0;
+
+#ifdef SIMD_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi8(0x01);
+	const __m128i pairs = _mm_set1_epi8(0x55);
+	const __m128i quads = _mm_set1_epi8(0x33);
+	const __m128i nibbles = _mm_set1_epi8(0x0F);
+	__m128i changedBytes = zero;
+	__m128i changedBits = zero;
+	__m128i changedLowestBits = zero;
+	__m128i squaredError = zero;
+	__m128i maxDifference = zero;
+	// Only the blocks with the first and the last change are searched for the exact byte at the end
+	size_t firstBlock = length;
+	size_t lastBlock = 0;
+	int firstMask = 0;
+	int lastMask = 0;
+	for (; i + 16 <= length; i += 16) {
+		const __m128i a = _mm_loadu_si128((const __m128i*)(original + i));
+		const __m128i b = _mm_loadu_si128((const __m128i*)(modified + i));
+		const __m128i x = _mm_xor_si128(a, b);
+		const __m128i same = _mm_cmpeq_epi8(x, zero);
+		const int mask = ~_mm_movemask_epi8(same) & 0xFFFF;
+		if (mask == 0) {
+			continue;
+		}
+		if (firstBlock == length) {
+			firstBlock = i;
+			firstMask = mask;
+		}
+		lastBlock = i;
+		lastMask = mask;
+
+		// Bits set in every byte, the bytes are then summed into 2 64 bit lanes
+		__m128i bits = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi16(x, 1), pairs));
+		bits = _mm_add_epi8(_mm_and_si128(bits, quads), _mm_and_si128(_mm_srli_epi16(bits, 2), quads));
+		bits = _mm_and_si128(_mm_add_epi8(bits, _mm_srli_epi16(bits, 4)), nibbles);
+		changedBits = _mm_add_epi64(changedBits, _mm_sad_epu8(bits, zero));
+		changedBytes = _mm_add_epi64(changedBytes, _mm_sad_epu8(_mm_andnot_si128(same, one), zero));
+		changedLowestBits = _mm_add_epi64(changedLowestBits, _mm_sad_epu8(_mm_and_si128(x, one), zero));
+
+		const __m128i difference = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+		maxDifference = _mm_max_epu8(maxDifference, difference);
+		const __m128i low = _mm_unpacklo_epi8(difference, zero);
+		const __m128i high = _mm_unpackhi_epi8(difference, zero);
+		const __m128i squares = _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high));
+		squaredError = _mm_add_epi64(squaredError, _mm_add_epi64(_mm_unpacklo_epi32(squares, zero), _mm_unpackhi_epi32(squares, zero)));
+	}
+
+	alignas(16) uint64_t sums[2];
+	_mm_store_si128((__m128i*)sums, changedBytes);
+	statistics.changedBytes += (size_t)(sums[0] + sums[1]);
+	_mm_store_si128((__m128i*)sums, changedBits);
+	statistics.changedBits += (size_t)(sums[0] + sums[1]);
+	_mm_store_si128((__m128i*)sums, changedLowestBits);
+	statistics.changedLowestBits += (size_t)(sums[0] + sums[1]);
+	_mm_store_si128((__m128i*)sums, squaredError);
+	statistics.squaredError += sums[0] + sums[1];
+	alignas(16) uint8_t differences[16];
+	_mm_store_si128((__m128i*)differences, maxDifference);
+	statistics.maxDifference = std::max(statistics.maxDifference, *std::max_element(differences, differences + 16));
+
+	if (firstBlock != length) {
+		int bit = 0;
+		while (((firstMask >> bit) & 1) == 0) {
+			bit++;
+		}
+		first = firstBlock + bit;
+		bit = 15;
+		while (((lastMask >> bit) & 1) == 0) {
+			bit--;
+		}
+		last = lastBlock + bit;
+	}
+#endif
+
+	for (; i < length; i++) {
+		const uint8_t x = original[i] ^ modified[i];
+		if (x == 0) {
+			continue;
+		}
+		const int difference = std::abs((int)original[i] - (int)modified[i]);
+		statistics.changedBytes++;
+		statistics.changedBits += countBits(x);
+		statistics.changedLowestBits += x & 1;
+		statistics.squaredError += (uint64_t)(difference * difference);
+		statistics.maxDifference = std::max(statistics.maxDifference, (uint8_t)difference);
+		first = std::min(first, i);
+		last = i;
+	}
+}
+
+/// <summary>
+/// Compare the rows of a single band
+/// </summary>
+/// <param name="original">Original image</param>
+/// <param name="modified">Modified image of the same dimensions</param>
+/// <param name="firstRow">First row of the band, rows are counted from the top of the picture</param>
+/// <param name="lastRow">Row after the last row of the band</param>
+/// <param name="statistics">Modifies the passed statistics with the differences of the band</param>
+void CompareHandler::compareBand(const Image& original, const Image& modified, uint32_t firstRow, uint32_t lastRow, BandStatistics& statistics) const {
+	// Rows are walked with the signed stride of every image, so the pictures are compared even if one is stored upside down
+	const size_t rowLength = original.getRowLength();
+	const uint8_t* originalTop = original.getTopRow();
+	const uint8_t* modifiedTop = modified.getTopRow();
+	for (uint32_t y = firstRow; y < lastRow; y++) {
+		size_t first = 0;
+		size_t last = 0;
+		compareRow(originalTop + y * original.getRowStride(), modifiedTop + y * modified.getRowStride(), rowLength, statistics, first, last);
+		if (first == rowLength) {
+			continue;
+		}
+
+		statistics.changed = true;
+		statistics.minX = std::min(statistics.minX, (uint32_t)(first / original.channels));
+		statistics.maxX = std::max(statistics.maxX, (uint32_t)(last / original.channels));
+		statistics.minY = std::min(statistics.minY, y);
+		statistics.maxY = y;
+	}
+}
+
+/// <summary>
+/// Compare the header fields of both images, every field that differs is added to the report
+/// </summary>
+/// <param name="original">Original image, only header data is used</param>
+/// <param name="modified">Modified image, only header data is used</param>
+/// <param name="report">Modifies the passed report with the header differences</param>
+void CompareHandler::compareHeaders(const Image& original, const Image& modified, CompareReport& report) const {
+	auto compareField = [&](const std::string& name, const auto& a, const auto& b) {
+		if (a == b) {
+			return;
+		}
+		std::ostringstream difference;
+		difference << name << ": " << +a << " -> " << +b;
+		report.headerDifferences.push_back(difference.str());
+	};
+	auto compareText = [&](const std::string& name, const std::string& a, const std::string& b) {
+		if (a != b) {
+			report.headerDifferences.push_back(name + ": \"" + a + "\" -> \"" + b + "\"");
+		}
+	};
+
+	auto typeName = [](FileType fileType) {
+		auto name = fileTypeToString.find(fileType);
+		return name != fileTypeToString.end() ? name->second : std::string("UNKNOWN");
+	};
+
+	compareText("file type", typeName(original.fileType), typeName(modified.fileType));
+	compareField("width", original.width, modified.width);
+	compareField("height", original.height, modified.height);
+	compareField("bits per pixel", original.bitsPerPixel, modified.bitsPerPixel);
+	compareField("channels", original.channels, modified.channels);
+	if (original.fileType != modified.fileType) {
+		return;
+	}
+
+	switch (original.fileType) {
+	case FileType::BMP:
+		compareField("file size", original.fileSize, modified.fileSize);
+		compareField("reserved", original.bmp.reserved, modified.bmp.reserved);
+		compareField("data offset", original.dataOffset, modified.dataOffset);
+		compareField("info header size", original.bmp.infoHeaderSize, modified.bmp.infoHeaderSize);
+		compareField("top down", original.bmp.topDown, modified.bmp.topDown);
+		compareField("planes", original.bmp.planes, modified.bmp.planes);
+		compareField("compression", original.bmp.compression, modified.bmp.compression);
+		compareField("data size", original.dataSize, modified.dataSize);
+		compareField("x pixels per meter", original.bmp.xPixelsPerMeter, modified.bmp.xPixelsPerMeter);
+		compareField("y pixels per meter", original.bmp.yPixelsPerMeter, modified.bmp.yPixelsPerMeter);
+		compareField("colors in color table", original.bmp.colorsInColorTable, modified.bmp.colorsInColorTable);
+		compareField("important color count", original.bmp.importantColorCount, modified.bmp.importantColorCount);
+		break;
+	case FileType::PPM:
+		compareText("magic number", original.ppm.magicNumber, modified.ppm.magicNumber);
+		compareText("comments", original.ppm.comments, modified.ppm.comments);
+		compareField("max value", original.ppm.max_value, modified.ppm.max_value);
+		break;
+	case FileType::PNG:
+		compareField("bit depth", original.png.bitDepth, modified.png.bitDepth);
+		compareField("color type", original.png.colorType, modified.png.colorType);
+		compareField("compression method", original.png.compressionMethod, modified.png.compressionMethod);
+		compareField("filter method", original.png.filterMethod, modified.png.filterMethod);
+		compareField("interlace method", original.png.interlaceMethod, modified.png.interlaceMethod);
+		// Chunks are written back unchanged, any difference means some chunk has been lost or modified
+		if (original.png.chunksBeforeData != modified.png.chunksBeforeData) {
+			report.headerDifferences.push_back("chunks before data: " + std::to_string(original.png.chunksBeforeData.size())
+				+ " -> " + std::to_string(modified.png.chunksBeforeData.size()) + ", content differs");
+		}
+		if (original.png.chunksAfterData != modified.png.chunksAfterData) {
+			report.headerDifferences.push_back("chunks after data: " + std::to_string(original.png.chunksAfterData.size())
+				+ " -> " + std::to_string(modified.png.chunksAfterData.size()) + ", content differs");
+		}
+		break;
+	case FileType::PGM:
+		compareText("magic number", original.pgm.magicNumber, modified.pgm.magicNumber);
+		compareText("comments", original.pgm.comments, modified.pgm.comments);
+		compareField("max value", original.pgm.maxValue, modified.pgm.maxValue);
+		if (original.pgm.highBytes != modified.pgm.highBytes) {
+			report.headerDifferences.push_back("higher bytes of the samples differ");
+		}
+		break;
+	case FileType::TGA:
+		compareField("id length", original.tga.idLength, modified.tga.idLength);
+		compareField("image type", original.tga.imageType, modified.tga.imageType);
+		compareField("pixel depth", original.tga.pixelDepth, modified.tga.pixelDepth);
+		compareField("descriptor", original.tga.descriptor, modified.tga.descriptor);
+		if (original.tga.trailer != modified.tga.trailer) {
+			report.headerDifferences.push_back("trailer: " + std::to_string(original.tga.trailer.size())
+				+ " -> " + std::to_string(modified.tga.trailer.size()) + " bytes, content differs");
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/// <summary>
+/// Compare the pixels of both images - changed bytes and bits, bounding box of the changes and PSNR
+/// </summary>
+/// <param name="original">Original image with its pixels</param>
+/// <param name="modified">Modified image with its pixels</param>
+/// <param name="report">Modifies the passed report with the differences of the pixels</param>
+/// <param name="parallel">Compare the bands in parallel</param>
+/// <returns>Returns false if the images have different dimensions</returns>
+bool CompareHandler::comparePixels(const Image& original, const Image& modified, CompareReport& report, bool parallel) const {
+	report.sameDimensions = original.width == modified.width && original.height == modified.height && original.channels == modified.channels;
+	if (!report.sameDimensions) {
+		return false;
+	}
+
+	const size_t bandCount = (original.height + _bandRows - 1) / _bandRows;
+	std::vector<BandStatistics> bands(bandCount);
+	auto compareTask = [&](size_t band) {
+		const uint32_t firstRow = (uint32_t)(band * _bandRows);
+		compareBand(original, modified, firstRow, std::min(firstRow + _bandRows, original.height), bands[band]);
+	};
+	if (parallel) {
+		Helpers::parallelFor(bandCount, compareTask);
+	}
+	else {
+		for (size_t band = 0; band < bandCount; band++) {
+			compareTask(band);
+		}
+	}
+
+	BandStatistics total;
+	for (const BandStatistics& band : bands) {
+		total.changedBytes += band.changedBytes;
+		total.changedBits += band.changedBits;
+		total.changedLowestBits += band.changedLowestBits;
+		total.squaredError += band.squaredError;
+		total.maxDifference = std::max(total.maxDifference, band.maxDifference);
+		if (band.changed) {
+			total.changed = true;
+			total.minX = std::min(total.minX, band.minX);
+			total.minY = std::min(total.minY, band.minY);
+			total.maxX = std::max(total.maxX, band.maxX);
+			total.maxY = std::max(total.maxY, band.maxY);
+		}
+	}
+
+	report.totalBytes = original.getChannelCount();
+	report.changedBytes = total.changedBytes;
+	report.changedBits = total.changedBits;
+	report.changedHigherBits = total.changedBits - total.changedLowestBits;
+	report.maxDifference = total.maxDifference;
+	if (total.changed) {
+		report.minX = total.minX;
+		report.minY = total.minY;
+		report.maxX = total.maxX;
+		report.maxY = total.maxY;
+	}
+	// Mean squared error over every channel, the peak is 255
+	report.psnr = total.squaredError == 0 ? std::numeric_limits<double>::infinity()
+		: 10 * std::log10(255.0 * 255.0 * report.totalBytes / total.squaredError);
+	return true;
+}
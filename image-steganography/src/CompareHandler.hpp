@@ -0,0 +1,85 @@
+#pragma once
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "simd.hpp"
+#include "structs.hpp"
+#include "enums.hpp"
+#include "Helpers.hpp"
+
+/// <summary>
+/// Class for comparing the original image with the modified one, e.g. the carrier before and after encoding
+///
+/// Pixels are XORed 16 bytes at once with SSE2, the image is split into bands of rows compared in parallel.
+/// Every band counts the changed bytes and bits, the squared error and the bounding box, the bands are added together at the end.
+/// </summary>
+class CompareHandler {
+private:
+	/// <summary>
+	/// Differences found in a band of rows
+	/// </summary>
+	struct BandStatistics {
+		size_t changedBytes = 0;
+		size_t changedBits = 0;
+		size_t changedLowestBits = 0;
+		uint64_t squaredError = 0;
+		uint8_t maxDifference = 0;
+		bool changed = false;
+		uint32_t minX = UINT32_MAX;
+		uint32_t minY = UINT32_MAX;
+		uint32_t maxX = 0;
+		uint32_t maxY = 0;
+	};
+
+	/// <summary>
+	/// Number of rows compared by a single task
+	/// </summary>
+	const int _bandRows = 64;
+
+	/// <summary>
+	/// Compare a single row and add the differences to the statistics of the band
+	/// </summary>
+	/// <param name="original">Bytes of the row of the original image</param>
+	/// <param name="modified">Bytes of the row of the modified image</param>
+	/// <param name="length">Number of bytes of the row</param>
+	/// <param name="statistics">Statistics of the band</param>
+	/// <param name="first">Modifies the passed index with the first changed byte of the row, length if none changed</param>
+	/// <param name="last">Modifies the passed index with the last changed byte of the row</param>
+	static void compareRow(const uint8_t* original, const uint8_t* modified, size_t length, BandStatistics& statistics, size_t& first, size_t& last);
+	/// <summary>
+	/// Compare the rows of a single band
+	/// </summary>
+	/// <param name="original">Original image</param>
+	/// <param name="modified">Modified image of the same dimensions</param>
+	/// <param name="firstRow">First row of the band</param>
+	/// <param name="lastRow">Row after the last row of the band</param>
+	/// <param name="statistics">Modifies the passed statistics with the differences of the band</param>
+	void compareBand(const Image& original, const Image& modified, uint32_t firstRow, uint32_t lastRow, BandStatistics& statistics) const;
+
+public:
+	CompareHandler() {}
+	~CompareHandler() {}
+
+	/// <summary>
+	/// Compare the header fields of both images, every field that differs is added to the report
+	/// </summary>
+	/// <param name="original">Original image, only header data is used</param>
+	/// <param name="modified">Modified image, only header data is used</param>
+	/// <param name="report">Modifies the passed report with the header differences</param>
+	void compareHeaders(const Image& original, const Image& modified, CompareReport& report) const;
+	/// <summary>
+	/// Compare the pixels of both images - changed bytes and bits, bounding box of the changes and PSNR
+	/// </summary>
+	/// <param name="original">Original image with its pixels</param>
+	/// <param name="modified">Modified image with its pixels</param>
+	/// <param name="report">Modifies the passed report with the differences of the pixels</param>
+	/// <param name="parallel">Compare the bands in parallel</param>
+	/// <returns>Returns false if the images have different dimensions</returns>
+	bool comparePixels(const Image& original, const Image& modified, CompareReport& report, bool parallel = true) const;
+};
@@ -3,6 +3,7 @@
 
 /// <summary>
 /// Determines if the file path is to supported image file.
+/// Existing files are recognized by their first bytes, so a misnamed image is still supported.
 /// </summary>
 /// <param name="path">Path to image</param>
 /// <returns></returns>
@@ -12,8 +13,100 @@ bool ConsoleHandler::isSupportedFileFormat(const std::string& path) const {
 		return false;
     }
 	
-    // Return true if the file at the given path has a supported format .ppm or .bmp, false otherwise
-    return Helpers::endsWith(path, ".ppm") || Helpers::endsWith(path, ".bmp");
+    // Missing file is left to be reported when it is read, only its extension is checked
+    if (!std::filesystem::exists(path)) {
+        return Helpers::endsWith(path, ".ppm") || Helpers::endsWith(path, ".bmp") || Helpers::endsWith(path, ".png")
+            || Helpers::endsWith(path, ".pgm") || Helpers::endsWith(path, ".tga");
+    }
+
+    // Return true if the content of the file has a supported format, false otherwise
+    return _fileHandler->detectFileType(path) != FileType::UNKNOWN;
+}
+
+/// <summary>
+/// Parses the optional encoding options passed after the required arguments, e.g. --fec 2
+/// </summary>
+/// <param name="argc">Number of arguments</param>
+/// <param name="argv">Arguments passed by user</param>
+/// <param name="first">Index of the first optional argument</param>
+/// <param name="allowRegion">Accept --roi and --rows, only for flags that read and write a single region</param>
+/// <returns>Returns true if every option is valid</returns>
+bool ConsoleHandler::parseEncodeOptions(int argc, char* argv[], int first, bool allowRegion) {
+    _encodeOptions = EncodeOptions();
+    // Coordinates of the region must be plain numbers
+    auto parseCoordinate = [](const char* text, uint32_t& value) {
+        char* end = nullptr;
+        unsigned long long parsed = std::strtoull(text, &end, 10);
+        if (!std::isdigit((unsigned char)text[0]) || *end != '\0' || parsed > UINT32_MAX) {
+            return false;
+        }
+        value = (uint32_t)parsed;
+        return true;
+    };
+    for (int i = first; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--roi" && allowRegion && i + 4 < argc) { // Rectangle of the image the message is confined to
+            RegionOfInterest& region = _encodeOptions.region;
+            if (!parseCoordinate(argv[i + 1], region.x) || !parseCoordinate(argv[i + 2], region.y)
+                || !parseCoordinate(argv[i + 3], region.width) || !parseCoordinate(argv[i + 4], region.height)
+                || region.width == 0 || region.height == 0) {
+                printMessage(Messages::MSG_INVALID_OPTION, option);
+                return false;
+            }
+            i += 4;
+        }
+        else if (option == "--rows" && allowRegion && i + 2 < argc) { // Band of whole rows the message is confined to
+            RegionOfInterest& region = _encodeOptions.region;
+            if (!parseCoordinate(argv[i + 1], region.y) || !parseCoordinate(argv[i + 2], region.height) || region.height == 0) {
+                printMessage(Messages::MSG_INVALID_OPTION, option);
+                return false;
+            }
+            i += 2;
+        }
+        else if (option == "--fec" && i + 1 < argc) { // Level of error correction
+            std::string level = argv[++i];
+            if (level.length() != 1 || ErrorCorrection::getParityLength(level[0] - '0') < 0) {
+                printMessage(Messages::MSG_INVALID_OPTION, option);
+                return false;
+            }
+            _encodeOptions.fecLevel = level[0] - '0';
+        }
+        else if (option == "--matrix" && i + 1 < argc) { // Hide k bits in 2^k - 1 channels with at most one change
+            std::string level = argv[++i];
+            if (level.length() != 1 || !std::isdigit((unsigned char)level[0]) || level[0] == '0' || !MatrixEmbedding::isSupportedLevel(level[0] - '0')) {
+                printMessage(Messages::MSG_INVALID_OPTION, option);
+                return false;
+            }
+            _encodeOptions.matrixLevel = level[0] - '0';
+        }
+        else if (option == "--matching") { // Change the lowest bits by +1 / -1 instead of replacing them
+            _encodeOptions.lsbMatching = true;
+        }
+        else if (option == "--adaptive") { // Store the message in the most textured pixels
+            _encodeOptions.adaptive = true;
+        }
+        else if (option == "--compression" && i + 1 < argc) { // How hard PNG images are compressed
+            std::string level = argv[++i];
+            if (level != "fast" && level != "best") {
+                printMessage(Messages::MSG_INVALID_OPTION, option);
+                return false;
+            }
+            _encodeOptions.bestCompression = level == "best";
+        }
+        else {
+            printMessage(Messages::MSG_INVALID_OPTION, option);
+            return false;
+        }
+    }
+
+    // Cost map chooses the pixels of the whole image, a region is read without the rest of it
+    // Matrix embedding needs groups of channels following each other, the cost map picks single channels
+    // LSB matching could change the upper 7 bits the cost map is calculated from
+    if (_encodeOptions.adaptive && (_encodeOptions.region.height > 0 || _encodeOptions.matrixLevel != 0 || _encodeOptions.lsbMatching)) {
+        printMessage(Messages::MSG_INVALID_OPTION, "--adaptive");
+        return false;
+    }
+    return true;
 }
 
 /// <summary>
@@ -37,6 +130,7 @@ void ConsoleHandler::handleInfoFlag() {
 	std::cout << "Width: " << _image.width << " Height: " << _image.height << std::endl;
 	std::cout << "Pixels: " << _image.width * _image.height << std::endl;
     std::cout << "Bits per Pixel: " << _image.bitsPerPixel << std::endl;
+    std::cout << "Channels: " << (int)_image.channels << std::endl;
     std::cout << "Last Modified Time: " << _image.last_modified_time << std::endl;
 }
 
@@ -51,12 +145,12 @@ void ConsoleHandler::handleEncodeFlag(const std::string& msg) {
     }
 
     // Open the file at filePath and encode the message into it
-    if (!_fileHandler->checkIfCanWrite(_filePath, msg)) {
+    if (!_fileHandler->checkIfCanWrite(_filePath, msg, _encodeOptions)) {
         printMessage(Messages::MSG_UNABLE_TO_WRITE);
         return;
     }
 
-    if (!_fileHandler->encodeMessage(_filePath, msg)) {
+    if (!_fileHandler->encodeMessage(_filePath, msg, _encodeOptions)) {
 		printMessage(Messages::MSG_UNABLE_TO_ENCODE);
 		return;
     }
@@ -64,6 +158,32 @@ void ConsoleHandler::handleEncodeFlag(const std::string& msg) {
     std::cout << "Successfully encoded message:\n" << msg << std::endl;
 }
 
+/// <summary>
+/// Handles the Update Flag and replaces the message stored in the image, only the differing LSBs are changed.
+/// </summary>
+/// <param name="msg">New message</param>
+void ConsoleHandler::handleUpdateFlag(const std::string& msg) {
+    if (!isSupportedFileFormat(_filePath)) {
+        printMessage(Messages::MSG_UNSUPPORTED_FILE_FROMAT);
+        return;
+    }
+
+    // The image could already hold a message, only its size matters
+    if (!_fileHandler->checkIfCanWrite(_filePath, msg, _encodeOptions)) {
+        printMessage(Messages::MSG_UNABLE_TO_WRITE);
+        return;
+    }
+
+    size_t changedBytes = 0;
+    if (!_fileHandler->updateMessage(_filePath, msg, _encodeOptions, changedBytes)) {
+        printMessage(Messages::MSG_UNABLE_TO_ENCODE);
+        return;
+    }
+
+    std::cout << "Successfully updated message:\n" << msg << std::endl;
+    std::cout << "Changed bytes: " << changedBytes << std::endl;
+}
+
 /// <summary>
 /// Handles the Decode Flag and decodes the image to retrieve the message encoded in Image.
 /// </summary>
@@ -74,6 +194,17 @@ void ConsoleHandler::handleDecodeFlag() {
         return;
     }
 
+    // Message confined to a region is read from the region only
+    if (_encodeOptions.region.height > 0) {
+        std::string msg;
+        if (!_fileHandler->decodeMessageInRegion(_filePath, _encodeOptions.region, msg)) {
+            printMessage(Messages::MSG_UNABLE_TO_DECODE);
+            return;
+        }
+        std::cout << "Successfully Decoded message:\n" << msg << std::endl;
+        return;
+    }
+
     // Open the file at filePath and decode any message stored in it
     if (!_fileHandler->checkIfCanRead(_filePath)) {
         printMessage(Messages::MSG_UNABLE_TO_READ);
@@ -106,14 +237,476 @@ void ConsoleHandler::handleCheckFlag(const std::string& msg) {
         return;
     }
 	
-    if (!_fileHandler->checkIfCanWrite(_filePath, msg)) {
+    if (!_fileHandler->checkIfCanWrite(_filePath, msg, _encodeOptions)) {
         printMessage(Messages::MSG_UNABLE_TO_WRITE);
+        std::cout << "Message is too long for this file." << std::endl;
         return;
     }
 
 	std::cout << "Message can be encoded in file" << std::endl;
 }
 
+/// <summary>
+/// Handles the Split Encode Flag and encodes the message across the images in the directory.
+/// </summary>
+/// <param name="msg"></param>
+void ConsoleHandler::handleSplitEncodeFlag(const std::string& msg) {
+    if (!std::filesystem::is_directory(_filePath)) {
+        printMessage(Messages::MSG_NOT_A_DIRECTORY);
+        return;
+    }
+
+    size_t shardsUsed = 0;
+    if (!_shardHandler->encodeShards(_filePath, msg, _encodeOptions, shardsUsed)) {
+        printMessage(Messages::MSG_UNABLE_TO_ENCODE);
+        return;
+    }
+
+    std::cout << "Successfully encoded message across " << shardsUsed << " images" << std::endl;
+}
+
+/// <summary>
+/// Handles the Split Decode Flag and puts the message back together from the images in the directory.
+/// </summary>
+void ConsoleHandler::handleSplitDecodeFlag() {
+    if (!std::filesystem::is_directory(_filePath)) {
+        printMessage(Messages::MSG_NOT_A_DIRECTORY);
+        return;
+    }
+
+    std::vector<std::string> messages;
+    if (!_shardHandler->decodeShards(_filePath, messages)) {
+        printMessage(Messages::MSG_UNABLE_TO_DECODE);
+        return;
+    }
+
+    for (const std::string& msg : messages) {
+        std::cout << "Successfully Decoded message:\n" << msg << std::endl;
+    }
+}
+
+/// <summary>
+/// Handles the Benchmark Flag and prints the throughput of the encoding stages.
+/// </summary>
+void ConsoleHandler::handleBenchmarkFlag() {
+    BenchmarkHandler benchmark;
+    benchmark.runBenchmarks();
+}
+
+/// <summary>
+/// Handles the Capacity Flag and prints how long message fits in the image, computed from the header only.
+/// For a directory it finds the image with the smallest capacity that fits the message.
+/// </summary>
+/// <param name="messageLength">Length of the message that should fit, 0 if not given</param>
+void ConsoleHandler::handleCapacityFlag(size_t messageLength) {
+    CapacityReport report;
+    if (std::filesystem::is_directory(_filePath)) {
+        std::string carrierPath;
+        if (!_fileHandler->findSmallestCarrier(_filePath, messageLength, _encodeOptions, carrierPath, report)) {
+            std::cout << "No image in the directory fits a message of " << messageLength << " B" << std::endl;
+            return;
+        }
+
+        std::cout << "Smallest image that fits: " << carrierPath << std::endl;
+        std::cout << "Max message length: " << report.maxMessageLength << " B" << std::endl;
+        return;
+    }
+
+    if (!isSupportedFileFormat(_filePath)) {
+        printMessage(Messages::MSG_UNSUPPORTED_FILE_FROMAT);
+        return;
+    }
+
+    if (!_fileHandler->getCapacity(_filePath, messageLength, _encodeOptions, report)) {
+        printMessage(Messages::MSG_UNABLE_TO_READ);
+        return;
+    }
+
+    std::cout << "Max message length: " << report.maxMessageLength << " B" << std::endl;
+    std::cout << "Channels available: " << report.availableChannels << std::endl;
+    if (messageLength > 0) {
+        std::cout << "Channels needed for " << messageLength << " B: " << report.requiredChannels << std::endl;
+        if (report.fits) {
+            std::cout << "Message fits, " << report.maxMessageLength - messageLength << " B to spare" << std::endl;
+        }
+        else {
+            std::cout << "Message does not fit, " << messageLength - std::min(messageLength, report.maxMessageLength) << " B too long" << std::endl;
+        }
+    }
+}
+
+/// <summary>
+/// Handles the Serve Flag and handles requests over the Unix domain socket until stopped.
+/// </summary>
+/// <param name="workerCount">Number of threads handling the requests</param>
+void ConsoleHandler::handleServeFlag(size_t workerCount) {
+    DaemonHandler daemon(_fileHandler);
+    daemon.run(_filePath, workerCount);
+}
+
+/// <summary>
+/// Handles the Load Test Flag and measures the latency of the running server.
+/// </summary>
+/// <param name="operation">Name of the operation - decode, probe or capacity</param>
+/// <param name="imagePath">Path of the image sent in every request</param>
+/// <param name="requests">Number of requests sent in total</param>
+/// <param name="connections">Number of connections sending the requests at once</param>
+void ConsoleHandler::handleLoadTestFlag(const std::string& operation, const std::string& imagePath, size_t requests, size_t connections) {
+    DaemonOperation daemonOperation;
+    if (operation == "decode") {
+        daemonOperation = DaemonOperation::OP_DECODE;
+    }
+    else if (operation == "probe") {
+        daemonOperation = DaemonOperation::OP_PROBE;
+    }
+    else if (operation == "capacity") {
+        daemonOperation = DaemonOperation::OP_CAPACITY;
+    }
+    else {
+        printMessage(Messages::MSG_INVALID_OPTION, operation);
+        return;
+    }
+
+    BenchmarkHandler benchmark;
+    benchmark.runLoadTest(_filePath, daemonOperation, imagePath, requests, connections);
+}
+
+/// <summary>
+/// Handles the Steganalysis Flag and scores how likely the image holds a message hidden by any program.
+/// For a directory every image is analyzed.
+/// </summary>
+void ConsoleHandler::handleSteganalysisFlag() {
+    SteganalysisReport report;
+    if (!std::filesystem::is_directory(_filePath)) {
+        if (!isSupportedFileFormat(_filePath)) {
+            printMessage(Messages::MSG_UNSUPPORTED_FILE_FROMAT);
+            return;
+        }
+        if (!_fileHandler->analyzeImage(_filePath, report)) {
+            printMessage(Messages::MSG_UNABLE_TO_READ);
+            return;
+        }
+        printSteganalysisReport(report);
+        return;
+    }
+
+    std::vector<SteganalysisReport> reports;
+    auto start = std::chrono::steady_clock::now();
+    size_t failed = _fileHandler->analyzeDirectory(_filePath, reports);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t suspicious = 0;
+    for (const SteganalysisReport& imageReport : reports) {
+        printSteganalysisReport(imageReport);
+        suspicious += imageReport.suspicious;
+    }
+    std::cout << "Analyzed " << reports.size() << " images in " << seconds << " s, " << suspicious << " suspicious";
+    if (failed > 0) {
+        std::cout << ", " << failed << " could not be read";
+    }
+    std::cout << std::endl;
+}
+
+/// <summary>
+/// Handles the Scan Flag and lists the images holding a message in the directory tree, unchanged files are taken from the index.
+/// </summary>
+/// <param name="indexPath">Path of the index file</param>
+void ConsoleHandler::handleScanFlag(const std::string& indexPath) {
+    if (!std::filesystem::is_directory(_filePath)) {
+        printMessage(Messages::MSG_NOT_A_DIRECTORY);
+        return;
+    }
+
+    std::vector<ProbeRecord> records;
+    size_t probed = 0;
+    auto start = std::chrono::steady_clock::now();
+    bool saved = _fileHandler->scanDirectory(_filePath, indexPath, records, probed);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t images = 0;
+    size_t encoded = 0;
+    for (const ProbeRecord& record : records) {
+        images += record.fileType != FileType::UNKNOWN;
+        if (!record.encoded) {
+            continue;
+        }
+        encoded++;
+        std::cout << "ENCODED " << record.filePath << " format: " << fileTypeToString.at(record.fileType)
+            << " message length: " << record.messageLength << " capacity: " << record.capacity << std::endl;
+    }
+    std::cout << "Scanned " << records.size() << " files in " << seconds << " s, " << images << " images, "
+        << encoded << " encoded, " << probed << " new or changed files probed" << std::endl;
+    if (!saved) {
+        std::cout << "Error: the index could not be saved to " << indexPath << std::endl;
+    }
+}
+
+/// <summary>
+/// Handles the Sanitize Flag and replaces the lowest bits of the image or every image in the directory with random bits.
+/// </summary>
+/// <param name="bitCount">Number of the lowest bits of every channel</param>
+void ConsoleHandler::handleSanitizeFlag(int bitCount) {
+    if (bitCount < 1 || bitCount > SanitizeHandler::maxBitCount) {
+        printMessage(Messages::MSG_INVALID_OPTION, std::to_string(bitCount));
+        return;
+    }
+
+    if (!std::filesystem::is_directory(_filePath)) {
+        if (!isSupportedFileFormat(_filePath)) {
+            printMessage(Messages::MSG_UNSUPPORTED_FILE_FROMAT);
+            return;
+        }
+        if (!_fileHandler->sanitizeImage(_filePath, bitCount)) {
+            printMessage(Messages::MSG_UNABLE_TO_WRITE);
+            return;
+        }
+        std::cout << "Successfully sanitized " << _filePath << std::endl;
+        return;
+    }
+
+    std::vector<std::string> paths = _fileHandler->listImages(_filePath);
+    std::vector<char> statuses;
+    auto start = std::chrono::steady_clock::now();
+    _fileHandler->sanitizeImages(paths, bitCount, statuses);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t sanitized = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (statuses[i]) {
+            sanitized++;
+        }
+        else {
+            std::cout << "Error: could not sanitize " << paths[i] << std::endl;
+        }
+    }
+    std::cout << "Sanitized " << sanitized << " of " << paths.size() << " images in " << seconds << " s" << std::endl;
+}
+
+/// <summary>
+/// Handles the Compare Flag and prints what changed between the original and the modified image.
+/// </summary>
+/// <param name="modifiedPath">Path of the modified image, the original is the file path</param>
+void ConsoleHandler::handleCompareFlag(const std::string& modifiedPath) {
+    if (!isSupportedFileFormat(_filePath) || !isSupportedFileFormat(modifiedPath)) {
+        printMessage(Messages::MSG_UNSUPPORTED_FILE_FROMAT);
+        return;
+    }
+
+    CompareReport report;
+    if (!_fileHandler->compareImages(_filePath, modifiedPath, report)) {
+        printMessage(Messages::MSG_UNABLE_TO_READ);
+        return;
+    }
+
+    if (report.headerDifferences.empty()) {
+        std::cout << "Header: identical" << std::endl;
+    }
+    for (const std::string& difference : report.headerDifferences) {
+        std::cout << "Header: " << difference << std::endl;
+    }
+    std::cout << "Header bytes changed: " << report.headerBytesChanged << std::endl;
+    if (!report.sameDimensions) {
+        std::cout << "Error: the images have different dimensions, pixels are not compared" << std::endl;
+        return;
+    }
+
+    std::cout << std::fixed << std::setprecision(4)
+        << "Changed bytes: " << report.changedBytes << " of " << report.totalBytes
+        << " (" << 100.0 * report.changedBytes / std::max<size_t>(report.totalBytes, 1) << " %)" << std::endl
+        << "Changed bits: " << report.changedBits << ", " << report.changedHigherBits << " of them above the lowest bit" << std::endl
+        << "Max difference: " << (int)report.maxDifference << std::endl;
+    if (report.changedBytes > 0) {
+        std::cout << "Changed area: " << report.minX << "," << report.minY << " - " << report.maxX << "," << report.maxY << std::endl;
+    }
+    std::cout << std::setprecision(2) << "PSNR: " << report.psnr << " dB" << std::endl;
+}
+
+/// <summary>
+/// Handles the Transcode Flag and saves the image in the format given by the extension of the target, keeping its message.
+/// </summary>
+/// <param name="targetPath">Path of the transcoded image, the source is the file path</param>
+void ConsoleHandler::handleTranscodeFlag(const std::string& targetPath) {
+    if (!isSupportedFileFormat(_filePath)) {
+        printMessage(Messages::MSG_UNSUPPORTED_FILE_FROMAT);
+        return;
+    }
+
+    FileType targetType = FileType::UNKNOWN;
+    if (Helpers::endsWith(targetPath, ".bmp")) {
+        targetType = FileType::BMP;
+    }
+    else if (Helpers::endsWith(targetPath, ".ppm")) {
+        targetType = FileType::PPM;
+    }
+    else if (Helpers::endsWith(targetPath, ".png")) {
+        targetType = FileType::PNG;
+    }
+    else if (Helpers::endsWith(targetPath, ".pgm")) {
+        targetType = FileType::PGM;
+    }
+    else if (Helpers::endsWith(targetPath, ".tga")) {
+        targetType = FileType::TGA;
+    }
+    if (targetType == FileType::UNKNOWN) {
+        printMessage(Messages::MSG_UNSUPPORTED_FILE_FROMAT);
+        return;
+    }
+
+    size_t payloadBits = 0;
+    if (!_fileHandler->transcodeImage(_filePath, targetPath, targetType, payloadBits)) {
+        printMessage(Messages::MSG_UNABLE_TO_WRITE);
+        return;
+    }
+
+    std::cout << "Transcoded " << _filePath << " to " << fileTypeToString.at(targetType) << " " << targetPath << std::endl;
+    if (payloadBits > 0) {
+        std::cout << "Message preserved and verified: " << payloadBits << " payload bits" << std::endl;
+    }
+}
+
+/// <summary>
+/// Private helper for printing the result of the steganalysis of a single image.
+/// </summary>
+/// <param name="report">Result of the steganalysis</param>
+void ConsoleHandler::printSteganalysisReport(const SteganalysisReport& report) const {
+    std::cout << std::fixed << std::setprecision(3)
+        << (report.suspicious ? "SUSPICIOUS " : "clean      ") << report.filePath
+        << " score: " << report.score
+        << " chi-square: " << report.chiSquareProbability << " (prefix " << report.chiSquarePrefix << ")"
+        << " rs: " << report.rsEstimate
+        << (report.ownMarker ? " [msgEncoded marker]" : "") << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+}
+
+/// <summary>
+/// Handles the Watch Flag and handles every file arriving in the directory until stopped.
+/// </summary>
+/// <param name="operation">Name of the operation - probe, decode or encode</param>
+/// <param name="outputDirectory">Directory for the results of decode and encode</param>
+/// <param name="workerCount">Number of threads handling the files</param>
+void ConsoleHandler::handleWatchFlag(const std::string& operation, const std::string& outputDirectory, size_t workerCount) {
+    DaemonOperation watchOperation;
+    if (operation == "probe") {
+        watchOperation = DaemonOperation::OP_PROBE;
+    }
+    else if (operation == "decode") {
+        watchOperation = DaemonOperation::OP_DECODE;
+    }
+    else if (operation == "encode") {
+        watchOperation = DaemonOperation::OP_ENCODE;
+    }
+    else {
+        printMessage(Messages::MSG_INVALID_OPTION, operation);
+        return;
+    }
+
+    WatchHandler watch(_fileHandler, watchOperation, outputDirectory, _encodeOptions);
+    watch.run(_filePath, workerCount);
+}
+
+/// <summary>
+/// Handles the Decode Stream Flag and writes the message out in chunks as it is extracted, before the rest of the image is read.
+/// </summary>
+/// <param name="outputPath">Path of the file for the message, empty to write the raw message to the standard output</param>
+void ConsoleHandler::handleDecodeStreamFlag(const std::string& outputPath) {
+    if (!isSupportedFileFormat(_filePath)) {
+        printMessage(Messages::MSG_UNSUPPORTED_FILE_FROMAT);
+        return;
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath, std::ios::binary);
+        if (!file.is_open()) {
+            printMessage(Messages::MSG_UNABLE_TO_WRITE);
+            return;
+        }
+    }
+    std::ostream& output = outputPath.empty() ? std::cout : file;
+
+    // Every chunk is flushed, so the reader gets the message while the image is still being read
+    size_t written = 0;
+    double firstByteSeconds = 0;
+    auto start = std::chrono::steady_clock::now();
+    bool status = _fileHandler->streamEncodedMessage(_filePath, [&](const char* data, size_t length) {
+        if (written == 0) {
+            firstByteSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        output.write(data, (std::streamsize)length);
+        output.flush();
+        written += length;
+        return output.good();
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!status) {
+        printMessage(Messages::MSG_UNABLE_TO_DECODE);
+        return;
+    }
+    if (!outputPath.empty()) {
+        std::cout << "Successfully Decoded " << written << " bytes to " << outputPath
+            << ", first byte after " << firstByteSeconds * 1000 << " ms, done in " << seconds * 1000 << " ms" << std::endl;
+    }
+}
+
+/// <summary>
+/// Handles the Video Encode Flag and encodes the content of the payload file across the frames of the video.
+/// </summary>
+/// <param name="outputPath">Path to which the encoded video will be saved</param>
+/// <param name="payloadPath">Path of the file that will be encoded</param>
+void ConsoleHandler::handleVideoEncodeFlag(const std::string& outputPath, const std::string& payloadPath) {
+    if (!Helpers::endsWith(_filePath, ".y4m")) {
+        printMessage(Messages::MSG_UNSUPPORTED_FILE_FROMAT);
+        return;
+    }
+
+    std::ifstream payloadFile(payloadPath, std::ios::binary);
+    if (!payloadFile.is_open()) {
+        printMessage(Messages::MSG_UNABLE_TO_READ);
+        return;
+    }
+    std::string payload((std::istreambuf_iterator<char>(payloadFile)), std::istreambuf_iterator<char>());
+
+    Y4MHandler video;
+    if (!video.encodeMessage(_filePath, outputPath, payload)) {
+        printMessage(Messages::MSG_UNABLE_TO_ENCODE);
+        return;
+    }
+
+    std::cout << "Successfully encoded " << payload.length() << " B in " << outputPath << std::endl;
+}
+
+/// <summary>
+/// Handles the Video Decode Flag and writes the message decoded from the video to the output file.
+/// </summary>
+/// <param name="outputPath">Path of the output file, - for the console</param>
+void ConsoleHandler::handleVideoDecodeFlag(const std::string& outputPath) {
+    if (!Helpers::endsWith(_filePath, ".y4m")) {
+        printMessage(Messages::MSG_UNSUPPORTED_FILE_FROMAT);
+        return;
+    }
+
+    Y4MHandler video;
+    if (outputPath == "-") {
+        if (!video.decodeMessage(_filePath, std::cout)) {
+            printMessage(Messages::MSG_UNABLE_TO_DECODE);
+        }
+        return;
+    }
+
+    std::ofstream output(outputPath, std::ios::binary);
+    if (!output.is_open()) {
+        printMessage(Messages::MSG_UNABLE_TO_WRITE);
+        return;
+    }
+    if (!video.decodeMessage(_filePath, output)) {
+        printMessage(Messages::MSG_UNABLE_TO_DECODE);
+        return;
+    }
+
+    std::cout << "Successfully decoded message to " << outputPath << std::endl;
+}
+
 /// <summary>
 /// Handles the Help Flag and prints the help message.
 /// </summary>
@@ -122,18 +715,97 @@ void ConsoleHandler::handleHelpFlag() {
     std::cout << "-i (--info): This flag expects a file path to be specified later. The program should check if the path leads to a file with" <<
         "a supported format(e.g..png or .jpg).If the file has an unsupported format(e.g..gif or .txt), the program should display an error message." << 
         "If the file has a supported format, the program should display information about the formatand the file(e.g.image size, memory usage, " <<
-            " and last modification timestamp)." << std::endl << std::endl
+            " and last modification timestamp)." << std::endl <<
+        "Supported formats are .bmp (24 and 32 bit), .ppm (P6), .png (8 bit gray, gray with alpha, RGB and RGBA), .pgm (P5, 8 and 16 bit)" <<
+        "and .tga (8, 24 and 32 bit, uncompressed or run length encoded). Every channel of every pixel holds a bit, for 16 bit" <<
+        ".pgm the lower byte of every sample." << std::endl << std::endl
 		
         << "-e (--encrypt): This flag expects a file path and a message to be specified later.The message should be enclosed in quotation marks to be" <<
         "treated as a single argument.The program should open the image file and save the specified message in it.As with the - i flag," <<
-        "the program should handle errors if the file has an unsupported format." << std::endl << std::endl
+        "the program should handle errors if the file has an unsupported format." << std::endl <<
+        "Optional --fec <0-3> after the message adds Reed-Solomon parity (8, 16 or 32 bytes per 255 byte block) so the message" <<
+        "survives flipped bits in the image. The header of such image is stored 3 times and decoded by majority vote." << std::endl <<
+        "Optional --compression fast|best chooses how hard a .png image is compressed when it is saved, fast by default." << std::endl <<
+        "Optional --adaptive stores the message in the most textured pixels instead of from the first pixel, so flat areas like sky" <<
+        "stay untouched. The pixels are chosen from the upper 7 bits, so decoding finds them without any option." << std::endl <<
+        "Optional --matrix <2-7> hides k bits in every 2^k - 1 channels by changing at most one of them (Hamming code matrix embedding)," <<
+        "so fewer bytes of the image change at the price of capacity. The level is stored in the header, decoding needs no option." << std::endl <<
+        "Optional --matching changes the bytes whose last bit must differ by +1 or -1 at random instead of replacing the last bit," <<
+        "which hides the pairs of values that replacement leaves in the histogram. Decoding needs no option." << std::endl <<
+        "Optional --roi <x> <y> <width> <height> or --rows <y> <height> confines the message to the region, rows counted in the order" <<
+        "they are stored in the file. For .bmp and .ppm only the rows of the region are read and written, so separate regions of" <<
+        "the same image could be encoded at the same time. The region is recorded with the message and must be passed to -d." << std::endl << std::endl
 		
+        << "-u (--update): This flag expects a file path and a message to be specified later, with the same options as -e." <<
+        "The message replaces the one already stored in the image. Only the bytes whose last bit differs are changed and," <<
+        "for .bmp and .ppm, only those bytes are written to the file." << std::endl << std::endl
+
         << "-d (--decrypt): This flag expects a file path to be specified later.The program should open the file and try to read a message from it." << 
-        "As with the other flags, the program should handle errors if the file has an unsupported format." << std::endl << std::endl
+        "As with the other flags, the program should handle errors if the file has an unsupported format." << std::endl <<
+        "Optional --roi <x> <y> <width> <height> or --rows <y> <height> reads the message encoded into that region only." << std::endl << std::endl
 		
         << "-c (--check): This flag expects a file path and a message to be specified later.The flag should check if the specified message can" <<
         "be saved in the file or if a message is already hidden in" << std::endl << std::endl
 
+        << "-se (--split-encode): This flag expects a directory path and a message to be specified later. The message is split" <<
+        "across the images in the directory when it is too long for one image. Every part stores its position, the number of parts" <<
+        "and the id of the message." << std::endl << std::endl
+
+        << "-sd (--split-decode): This flag expects a directory path to be specified later. The program decodes every image in the" <<
+        "directory and puts the message back together, the images could be in any order." << std::endl << std::endl
+
+        << "-cp (--capacity): This flag expects a file or directory path and optionally a message length in bytes and --fec, --matrix, --roi or --rows." <<
+        "Only the header of the image is read. For a file it prints the longest message that fits and whether the given length fits." <<
+        "For a directory it finds the image with the smallest capacity that still fits the given length." << std::endl << std::endl
+
+        << "-sv (--serve): This flag expects a socket path and optionally a number of worker threads. The program listens on the" <<
+        "Unix domain socket and handles encode, decode, probe and capacity requests until it receives SIGINT or SIGTERM." <<
+        "Requests are length prefixed frames, see DaemonHandler for the layout." << std::endl << std::endl
+
+        << "-lt (--load-test): This flag expects a socket path, an operation (decode, probe or capacity), an image path and" <<
+        "optionally the number of requests and connections. It sends the requests to the running server and prints" <<
+        "the latency percentiles." << std::endl << std::endl
+
+        << "-sa (--steganalysis): This flag expects a file or directory path. Every image is checked for a message hidden in" <<
+        "the LSBs by any program, using the chi-square pair of values test and RS analysis. The score estimates the part of" <<
+        "the image carrying a message. Images above 0.3, failing the chi-square test or holding the constant message of this program" <<
+        "are suspicious." << std::endl << std::endl
+
+        << "-sc (--scan): This flag expects a directory path and optionally a path of the index file. Every file in the directory" <<
+        "tree is probed and the images holding a message are listed with the message length and capacity. Results are saved" <<
+        "to the index (.stegindex in the directory by default), so the next scan reads only new or changed files." << std::endl << std::endl
+
+        << "-sn (--sanitize): This flag expects a file or directory path and optionally a number of bits (1 - 8, 1 by default)." <<
+        "The lowest bits of every channel are replaced with random bits, which wipes a message hidden in them by any program." <<
+        "Pixels of .bmp and .ppm files are overwritten in place." << std::endl << std::endl
+
+        << "-cmp (--compare): This flag expects the path of the original image and the path of the modified one, e.g. a carrier" <<
+        "before and after encoding. It prints the header fields that differ, the changed bytes before the pixel data, the changed" <<
+        "bytes and bits of the pixels, the area they lie in and the PSNR." << std::endl << std::endl
+
+        << "-tc (--transcode): This flag expects the path of an image and the path of the transcoded image, its extension" <<
+        "(.bmp, .ppm, .png, .pgm or .tga) chooses the format. Rows and channels are reordered for the new format and a stored message is moved" <<
+        "over without encoding it again, then the saved file is read back to verify the message." << std::endl << std::endl
+
+        << "-w (--watch): This flag expects a directory path, an operation (probe, decode or encode), an output directory for decode" <<
+        "and encode and optionally a number of worker threads and encoding options. Every file written or moved into the directory" <<
+        "is probed, decoded to <output>/<name>.txt or encoded with the content of its sidecar <name>.msg to <output>/<name>," <<
+        "and the latency from its arrival is printed. Runs until it receives SIGINT or SIGTERM." << std::endl << std::endl
+
+        << "-ds (--decode-stream): This flag expects a filepath and optionally an output path. The message is extracted a window" <<
+        "of pixels at a time and written out in chunks, every block of error correction is fixed as soon as it is read, so the" <<
+        "first bytes arrive before the rest of the image is read. Without an output path the raw message is written to the" <<
+        "standard output, otherwise its length and the time to the first byte are printed." << std::endl << std::endl
+
+        << "-ve (--video-encode): This flag expects an input .y4m video, an output path and a payload file. The content of the" <<
+        "payload file is spread across the frames of the video, one bit in every sample. Frames are streamed and processed" <<
+        "in parallel, so the video is never fully loaded in memory." << std::endl << std::endl
+
+        << "-vd (--video-decode): This flag expects a .y4m video and an output file path, or - to print the message." <<
+        "Only the frames that hold the message are read." << std::endl << std::endl
+
+        << "-b (--benchmark): This flag measures the throughput of encoding stages, e.g. error correction for every level." << std::endl << std::endl
+
         << "-h (--help): This flag prints the 'manual' for this program how it should be operated and what each flag expects," << 
         "which is what you are reading right now :)" << std::endl;
 }
@@ -176,6 +848,12 @@ void ConsoleHandler::printMessage(Messages msg, std::string arg) const {
     case Messages::MSG_MISSING_MESSAGE_TO_ENCODE:
         std::cout << "Error: missing message argument for " << arg << " flag" << std::endl;
         break;
+    case Messages::MSG_NOT_A_DIRECTORY:
+        std::cout << "Error: path is not a directory" << std::endl;
+        break;
+    case Messages::MSG_INVALID_OPTION:
+        std::cout << "Error: invalid option " << arg << std::endl;
+        break;
     default:
 		std::cout << "Error: unknown message" << std::endl;
         break;
@@ -214,13 +892,32 @@ void ConsoleHandler::handleConsoleInput(int argc, char* argv[]) {
             printMessage(Messages::MSG_MISSING_MESSAGE_TO_ENCODE, arg);
             return;
         }
+        if (!parseEncodeOptions(argc, argv, 4, true)) {
+            return;
+        }
         handleEncodeFlag(argv[3]);
     }
+    else if (arg == "-u" || arg == "--update") { // Update flag
+        if (argc <= 2) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        } else if (argc <= 3) {
+            printMessage(Messages::MSG_MISSING_MESSAGE_TO_ENCODE, arg);
+            return;
+        }
+        if (!parseEncodeOptions(argc, argv, 4)) {
+            return;
+        }
+        handleUpdateFlag(argv[3]);
+    }
     else if (arg == "-d" || arg == "--decode") { // Decode flag
         if (argc <= 2) {
             printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
             return;
         }
+        if (!parseEncodeOptions(argc, argv, 3, true)) {
+            return;
+        }
         handleDecodeFlag();
     }
     else if (arg == "-c" || arg == "--check") { // Check flag
@@ -232,8 +929,151 @@ void ConsoleHandler::handleConsoleInput(int argc, char* argv[]) {
             printMessage(Messages::MSG_MISSING_MESSAGE_TO_ENCODE, arg);
             return;
         }
+        if (!parseEncodeOptions(argc, argv, 4)) {
+            return;
+        }
         handleCheckFlag(argv[3]);
     }
+    else if (arg == "-se" || arg == "--split-encode") { // Split Encode flag
+        if (argc <= 2) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        else if (argc <= 3) {
+            printMessage(Messages::MSG_MISSING_MESSAGE_TO_ENCODE, arg);
+            return;
+        }
+        if (!parseEncodeOptions(argc, argv, 4)) {
+            return;
+        }
+        handleSplitEncodeFlag(argv[3]);
+    }
+    else if (arg == "-sd" || arg == "--split-decode") { // Split Decode flag
+        if (argc <= 2) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        handleSplitDecodeFlag();
+    }
+    else if (arg == "-cp" || arg == "--capacity") { // Capacity flag
+        if (argc <= 2) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        // Message length is optional, options start right after it
+        size_t messageLength = 0;
+        int firstOption = 3;
+        if (argc > 3 && std::isdigit((unsigned char)argv[3][0])) {
+            messageLength = std::strtoull(argv[3], nullptr, 10);
+            firstOption = 4;
+        }
+        if (!parseEncodeOptions(argc, argv, firstOption, true)) {
+            return;
+        }
+        handleCapacityFlag(messageLength);
+    }
+    else if (arg == "-sv" || arg == "--serve") { // Serve flag
+        if (argc <= 2) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        size_t workers = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : std::thread::hardware_concurrency();
+        handleServeFlag(workers);
+    }
+    else if (arg == "-lt" || arg == "--load-test") { // Load Test flag
+        if (argc <= 4) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        size_t requests = argc > 5 ? std::strtoull(argv[5], nullptr, 10) : 10000;
+        size_t connections = argc > 6 ? std::strtoull(argv[6], nullptr, 10) : 8;
+        handleLoadTestFlag(argv[3], argv[4], requests, connections);
+    }
+    else if (arg == "-sa" || arg == "--steganalysis") { // Steganalysis flag
+        if (argc <= 2) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        handleSteganalysisFlag();
+    }
+    else if (arg == "-sc" || arg == "--scan") { // Scan flag
+        if (argc <= 2) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        // Index is kept in the scanned directory unless another path is given
+        handleScanFlag(argc > 3 ? argv[3] : (std::filesystem::path(_filePath) / ".stegindex").string());
+    }
+    else if (arg == "-sn" || arg == "--sanitize") { // Sanitize flag
+        if (argc <= 2) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        handleSanitizeFlag(argc > 3 ? std::atoi(argv[3]) : 1);
+    }
+    else if (arg == "-cmp" || arg == "--compare") { // Compare flag
+        if (argc <= 3) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        handleCompareFlag(argv[3]);
+    }
+    else if (arg == "-tc" || arg == "--transcode") { // Transcode flag
+        if (argc <= 3) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        handleTranscodeFlag(argv[3]);
+    }
+    else if (arg == "-w" || arg == "--watch") { // Watch flag
+        if (argc <= 3) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        // Probe writes nothing, decode and encode need the output directory
+        const std::string operation = argv[3];
+        int next = 4;
+        std::string outputDirectory;
+        if (operation != "probe") {
+            if (argc <= 4) {
+                printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+                return;
+            }
+            outputDirectory = argv[next++];
+        }
+        size_t workers = std::thread::hardware_concurrency();
+        if (argc > next && std::isdigit((unsigned char)argv[next][0])) {
+            workers = std::strtoull(argv[next++], nullptr, 10);
+        }
+        if (!parseEncodeOptions(argc, argv, next)) {
+            return;
+        }
+        handleWatchFlag(operation, outputDirectory, workers);
+    }
+    else if (arg == "-ds" || arg == "--decode-stream") { // Decode Stream flag
+        if (argc <= 2) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        handleDecodeStreamFlag(argc > 3 ? argv[3] : "");
+    }
+    else if (arg == "-ve" || arg == "--video-encode") { // Video Encode flag
+        if (argc <= 4) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        handleVideoEncodeFlag(argv[3], argv[4]);
+    }
+    else if (arg == "-vd" || arg == "--video-decode") { // Video Decode flag
+        if (argc <= 3) {
+            printMessage(Messages::MSG_MISSING_FILEPATH_ARGUMENT, arg);
+            return;
+        }
+        handleVideoDecodeFlag(argv[3]);
+    }
+    else if (arg == "-b" || arg == "--benchmark") { // Benchmark flag
+        handleBenchmarkFlag();
+    }
     else if (arg == "-h" || arg == "--help") { // Help flag
         handleHelpFlag();
     }
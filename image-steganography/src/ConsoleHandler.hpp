@@ -5,6 +5,11 @@
 #include "Helpers.hpp"
 #include "structs.hpp"
 #include "FileHandler.hpp"
+#include "ShardHandler.hpp"
+#include "BenchmarkHandler.hpp"
+#include "DaemonHandler.hpp"
+#include "WatchHandler.hpp"
+#include "Y4MHandler.hpp"
 
 /// <summary>
 /// Main class for handling the program
@@ -17,6 +22,14 @@ private:
 	/// </summary>
 	FileHandler* _fileHandler;
 	/// <summary>
+	/// Pointer to shard handler
+	/// </summary>
+	ShardHandler* _shardHandler;
+	/// <summary>
+	/// Options for encoding passed by user after the required arguments
+	/// </summary>
+	EncodeOptions _encodeOptions;
+	/// <summary>
 	/// filePath to the file
 	/// </summary>
 	std::string _filePath;
@@ -27,11 +40,21 @@ private:
 
 	/// <summary>
 	/// Determines if the file path is to supported image file.
+	/// Existing files are recognized by their first bytes, so a misnamed image is still supported.
 	/// </summary>
 	/// <param name="path">Path to image</param>
 	/// <returns></returns>
 	bool isSupportedFileFormat(const std::string& path) const;
 	/// <summary>
+	/// Parses the optional encoding options passed after the required arguments, e.g. --fec 2
+	/// </summary>
+	/// <param name="argc">Number of arguments</param>
+	/// <param name="argv">Arguments passed by user</param>
+	/// <param name="first">Index of the first optional argument</param>
+	/// <param name="allowRegion">Accept --roi and --rows, only for flags that read and write a single region</param>
+	/// <returns>Returns true if every option is valid</returns>
+	bool parseEncodeOptions(int argc, char* argv[], int first, bool allowRegion = false);
+	/// <summary>
 	/// Handles the Info Flag and prints the image info.
 	/// </summary>
 	void handleInfoFlag();
@@ -41,6 +64,11 @@ private:
 	/// <param name="msg"></param>
 	void handleEncodeFlag(const std::string& msg);
 	/// <summary>
+	/// Handles the Update Flag and replaces the message stored in the image, only the differing LSBs are changed.
+	/// </summary>
+	/// <param name="msg">New message</param>
+	void handleUpdateFlag(const std::string& msg);
+	/// <summary>
 	/// Handles the Decode Flag and decodes the image to retrieve the message encoded in Image.
 	/// </summary>
 	void handleDecodeFlag();
@@ -50,6 +78,91 @@ private:
 	/// <param name="msg"></param>
 	void handleCheckFlag(const std::string& msg);
 	/// <summary>
+	/// Handles the Split Encode Flag and encodes the message across the images in the directory.
+	/// </summary>
+	/// <param name="msg"></param>
+	void handleSplitEncodeFlag(const std::string& msg);
+	/// <summary>
+	/// Handles the Split Decode Flag and puts the message back together from the images in the directory.
+	/// </summary>
+	void handleSplitDecodeFlag();
+	/// <summary>
+	/// Handles the Benchmark Flag and prints the throughput of the encoding stages.
+	/// </summary>
+	void handleBenchmarkFlag();
+	/// <summary>
+	/// Handles the Capacity Flag and prints how long message fits in the image, computed from the header only.
+	/// For a directory it finds the image with the smallest capacity that fits the message.
+	/// </summary>
+	/// <param name="messageLength">Length of the message that should fit, 0 if not given</param>
+	void handleCapacityFlag(size_t messageLength);
+	/// <summary>
+	/// Handles the Serve Flag and handles requests over the Unix domain socket until stopped.
+	/// </summary>
+	/// <param name="workerCount">Number of threads handling the requests</param>
+	void handleServeFlag(size_t workerCount);
+	/// <summary>
+	/// Handles the Load Test Flag and measures the latency of the running server.
+	/// </summary>
+	/// <param name="operation">Name of the operation - decode, probe or capacity</param>
+	/// <param name="imagePath">Path of the image sent in every request</param>
+	/// <param name="requests">Number of requests sent in total</param>
+	/// <param name="connections">Number of connections sending the requests at once</param>
+	void handleLoadTestFlag(const std::string& operation, const std::string& imagePath, size_t requests, size_t connections);
+	/// <summary>
+	/// Handles the Steganalysis Flag and scores how likely the image holds a message hidden by any program.
+	/// For a directory every image is analyzed.
+	/// </summary>
+	void handleSteganalysisFlag();
+	/// <summary>
+	/// Handles the Scan Flag and lists the images holding a message in the directory tree, unchanged files are taken from the index.
+	/// </summary>
+	/// <param name="indexPath">Path of the index file</param>
+	void handleScanFlag(const std::string& indexPath);
+	/// <summary>
+	/// Handles the Sanitize Flag and replaces the lowest bits of the image or every image in the directory with random bits.
+	/// </summary>
+	/// <param name="bitCount">Number of the lowest bits of every channel</param>
+	void handleSanitizeFlag(int bitCount);
+	/// <summary>
+	/// Handles the Compare Flag and prints what changed between the original and the modified image.
+	/// </summary>
+	/// <param name="modifiedPath">Path of the modified image, the original is the file path</param>
+	void handleCompareFlag(const std::string& modifiedPath);
+	/// <summary>
+	/// Handles the Transcode Flag and saves the image in the format given by the extension of the target, keeping its message.
+	/// </summary>
+	/// <param name="targetPath">Path of the transcoded image, the source is the file path</param>
+	void handleTranscodeFlag(const std::string& targetPath);
+	/// <summary>
+	/// Handles the Watch Flag and handles every file arriving in the directory until stopped.
+	/// </summary>
+	/// <param name="operation">Name of the operation - probe, decode or encode</param>
+	/// <param name="outputDirectory">Directory for the results of decode and encode</param>
+	/// <param name="workerCount">Number of threads handling the files</param>
+	void handleWatchFlag(const std::string& operation, const std::string& outputDirectory, size_t workerCount);
+	/// <summary>
+	/// Handles the Decode Stream Flag and writes the message out in chunks as it is extracted, before the rest of the image is read.
+	/// </summary>
+	/// <param name="outputPath">Path of the file for the message, empty to write the raw message to the standard output</param>
+	void handleDecodeStreamFlag(const std::string& outputPath);
+	/// <summary>
+	/// Private helper for printing the result of the steganalysis of a single image.
+	/// </summary>
+	/// <param name="report">Result of the steganalysis</param>
+	void printSteganalysisReport(const SteganalysisReport& report) const;
+	/// <summary>
+	/// Handles the Video Encode Flag and encodes the content of the payload file across the frames of the video.
+	/// </summary>
+	/// <param name="outputPath">Path to which the encoded video will be saved</param>
+	/// <param name="payloadPath">Path of the file that will be encoded</param>
+	void handleVideoEncodeFlag(const std::string& outputPath, const std::string& payloadPath);
+	/// <summary>
+	/// Handles the Video Decode Flag and writes the message decoded from the video to the output file.
+	/// </summary>
+	/// <param name="outputPath">Path of the output file, - for the console</param>
+	void handleVideoDecodeFlag(const std::string& outputPath);
+	/// <summary>
 	/// Handles the Help Flag and prints the help message.
 	/// </summary>
 	void handleHelpFlag();
@@ -65,13 +178,14 @@ public:
 	/// </summary>
 	ConsoleHandler() {
 		_fileHandler = new FileHandler();
+		_shardHandler = new ShardHandler(_fileHandler);
 		_image = Image();
 	}
 	/// <summary>
 	/// Destructor
 	/// </summary>
 	~ConsoleHandler() {
-		_fileHandler->~FileHandler();
+		delete _shardHandler;
 		delete _fileHandler;
 	}
 	/// <summary>
@@ -0,0 +1,186 @@
+#pragma once
+#include "CostMapHandler.hpp"
+
+/// <summary>
+/// Calculate the texture of every byte of the row - sum of the differences to its 4 neighbours in the same channel
+/// </summary>
+/// <param name="up">Row above, the row itself for the first row</param>
+/// <param name="row">Bytes of the row</param>
+/// <param name="down">Row below, the row itself for the last row</param>
+/// <param name="length">Number of bytes of the row</param>
+/// <param name="channels">Number of channels of a pixel - distance to the left and right neighbour</param>
+/// <param name="output">Texture of every byte</param>
+void CostMapHandler::computeRowTexture(const uint8_t* up, const uint8_t* row, const uint8_t* down, size_t length, size_t channels, uint16_t* output) {
+	auto scalar = [&](size_t i) {
+		// Pixels on the edge use themselves as the missing neighbour
+		const int center = row[i] >> 1;
+		const int left = (i >= channels ? row[i - channels] : row[i]) >> 1;
+		const int right = (i + channels < length ? row[i + channels] : row[i]) >> 1;
+		output[i] = (uint16_t)(std::abs(center - left) + std::abs(center - right)
+			+ std::abs(center - (up[i] >> 1)) + std::abs(center - (down[i] >> 1)));
+	};
+
+	size_t i = 0;
+	for (; i < channels && i < length; i++) {
+		scalar(i);
+	}
+
+#ifdef SIMD_SSE2
+	// 16 bytes at once, the right neighbour is read 16 + channels bytes ahead
+	const __m128i mask = _mm_set1_epi8(0x7F);
+	const __m128i zero = _mm_setzero_si128();
+	auto load = [&](const uint8_t* bytes) {
+		return _mm_and_si128(_mm_srli_epi16(_mm_loadu_si128((const __m128i*)bytes), 1), mask);
+	};
+	auto difference = [](__m128i a, __m128i b) {
+		return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+	};
+	for (; i + 16 + channels <= length; i += 16) {
+		const __m128i center = load(row + i);
+		// Each pair of differences is at most 254, so it still fits in a byte
+		const __m128i horizontal = _mm_adds_epu8(difference(center, load(row + i - channels)), difference(center, load(row + i + channels)));
+		const __m128i vertical = _mm_adds_epu8(difference(center, load(up + i)), difference(center, load(down + i)));
+		_mm_storeu_si128((__m128i*)(output + i), _mm_add_epi16(_mm_unpacklo_epi8(horizontal, zero), _mm_unpacklo_epi8(vertical, zero)));
+		_mm_storeu_si128((__m128i*)(output + i + 8), _mm_add_epi16(_mm_unpackhi_epi8(horizontal, zero), _mm_unpackhi_epi8(vertical, zero)));
+	}
+#endif
+
+	for (; i < length; i++) {
+		scalar(i);
+	}
+}
+
+/// <summary>
+/// Calculate the texture of the pixels in the given rows and count how many pixels have every texture
+/// </summary>
+/// <param name="image">Image with its pixels</param>
+/// <param name="firstRow">First row of the tile</param>
+/// <param name="lastRow">Row after the last row of the tile</param>
+/// <param name="texture">Texture map of the whole image</param>
+/// <param name="histogram">Histogram of the tile</param>
+void CostMapHandler::computeTile(const Image& image, int firstRow, int lastRow, uint16_t* texture, uint32_t* histogram) const {
+	const size_t channels = image.channels;
+	const size_t width = image.width;
+	const size_t rowLength = width * channels;
+	const uint8_t* pixels = (const uint8_t*)image.pixels;
+	std::vector<uint16_t> bytes(rowLength);
+
+	for (int y = firstRow; y < lastRow; y++) {
+		const uint8_t* row = pixels + y * rowLength;
+		const uint8_t* up = y > 0 ? row - rowLength : row;
+		const uint8_t* down = y + 1 < (int)image.height ? row + rowLength : row;
+		computeRowTexture(up, row, down, rowLength, channels, bytes.data());
+
+		uint16_t* output = texture + y * width;
+		for (size_t x = 0; x < width; x++) {
+			const uint16_t* channel = &bytes[x * channels];
+			uint16_t value = 0;
+			for (size_t c = 0; c < channels; c++) {
+				value += channel[c];
+			}
+			output[x] = value;
+			histogram[value]++;
+		}
+	}
+}
+
+/// <summary>
+/// Calculate the texture of every pixel, the image is split into tiles of rows computed in parallel
+/// </summary>
+/// <param name="image">Image with its pixels</param>
+/// <param name="texture">Modifies the passed map with texture of every pixel</param>
+/// <param name="histogram">Modifies the passed histogram with number of pixels with every texture</param>
+/// <param name="parallel">Compute the tiles in parallel</param>
+void CostMapHandler::computeTextureMap(const Image& image, std::vector<uint16_t>& texture, std::vector<uint32_t>& histogram, bool parallel) const {
+	const size_t pixelCount = (size_t)image.width * image.height;
+	texture.resize(pixelCount);
+	histogram.assign(_maxTexture + 1, 0);
+	if (pixelCount == 0) {
+		return;
+	}
+
+	// Every tile counts its own histogram, they are added together at the end
+	const size_t tileCount = (image.height + _tileRows - 1) / _tileRows;
+	std::vector<std::vector<uint32_t>> histograms(tileCount, std::vector<uint32_t>(_maxTexture + 1, 0));
+	auto computeTask = [&](size_t tile) {
+		const int firstRow = (int)tile * _tileRows;
+		computeTile(image, firstRow, std::min(firstRow + _tileRows, (int)image.height), texture.data(), histograms[tile].data());
+	};
+	if (parallel) {
+		Helpers::parallelFor(tileCount, computeTask);
+	}
+	else {
+		for (size_t tile = 0; tile < tileCount; tile++) {
+			computeTask(tile);
+		}
+	}
+
+	for (const std::vector<uint32_t>& tileHistogram : histograms) {
+		for (int value = 0; value <= _maxTexture; value++) {
+			histogram[value] += tileHistogram[value];
+		}
+	}
+}
+
+/// <summary>
+/// Number of channels the adaptive mode could use - every channel of the whole pixels after the given channel
+/// </summary>
+/// <param name="image">Image, only header data is used</param>
+/// <param name="firstChannel">First channel that could hold the message</param>
+/// <returns>Returns number of channels</returns>
+size_t CostMapHandler::getAvailableChannels(const Image& image, size_t firstChannel) const {
+	const size_t pixelCount = (size_t)image.width * image.height;
+	const size_t firstPixel = (firstChannel + image.channels - 1) / image.channels;
+	return firstPixel < pixelCount ? (pixelCount - firstPixel) * image.channels : 0;
+}
+
+/// <summary>
+/// Choose the channels that hold the bits, every channel of the pixels with the highest texture in order of their position
+/// </summary>
+/// <param name="image">Image with its pixels</param>
+/// <param name="firstChannel">First channel that could hold the message, channels before are not chosen</param>
+/// <param name="bitCount">Number of bits that will be stored</param>
+/// <param name="channels">Modifies the passed list with index of the channel for every bit</param>
+/// <returns>Returns false if the image does not have enough pixels</returns>
+bool CostMapHandler::selectChannels(const Image& image, size_t firstChannel, size_t bitCount, std::vector<uint32_t>& channels) const {
+	if (bitCount > getAvailableChannels(image, firstChannel)) {
+		return false;
+	}
+
+	std::vector<uint16_t> texture;
+	std::vector<uint32_t> histogram;
+	computeTextureMap(image, texture, histogram);
+
+	// Pixels holding the constant message and the header are left out
+	const size_t pixelCount = texture.size();
+	const size_t pixelLength = image.channels;
+	const size_t firstPixel = (firstChannel + pixelLength - 1) / pixelLength;
+	for (size_t i = 0; i < firstPixel; i++) {
+		histogram[texture[i]]--;
+	}
+
+	// Find the lowest texture that is still used - every pixel above it is used, at it only the first few
+	const size_t pixelsNeeded = (bitCount + pixelLength - 1) / pixelLength;
+	size_t above = 0;
+	int threshold = _maxTexture;
+	while (threshold > 0 && above + histogram[threshold] < pixelsNeeded) {
+		above += histogram[threshold--];
+	}
+	size_t atThreshold = pixelsNeeded - above;
+
+	channels.clear();
+	channels.reserve(pixelsNeeded * pixelLength);
+	for (size_t i = firstPixel; i < pixelCount && channels.size() < bitCount; i++) {
+		if (texture[i] < threshold || (texture[i] == threshold && atThreshold == 0)) {
+			continue;
+		}
+		if (texture[i] == threshold) {
+			atThreshold--;
+		}
+		for (size_t c = 0; c < pixelLength; c++) {
+			channels.push_back((uint32_t)(i * pixelLength + c));
+		}
+	}
+	channels.resize(std::min(channels.size(), bitCount));
+	return channels.size() == bitCount;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <cstdlib>
+
+#include "simd.hpp"
+#include "structs.hpp"
+#include "Helpers.hpp"
+
+/// <summary>
+/// Class for choosing the channels that hold the message in the adaptive mode
+///
+/// Every pixel gets a texture - sum of absolute differences to its 4 neighbours over every channel.
+/// Only the upper 7 bits are used, so the embedding does not change the map and the decoder computes the same one.
+/// The message goes to the pixels with the highest texture, where the changed bits are hard to detect,
+/// ties are broken by the position so the choice is repeatable.
+/// </summary>
+class CostMapHandler {
+private:
+	/// <summary>
+	/// Number of rows computed by a single task
+	/// </summary>
+	const int _tileRows = 32;
+	/// <summary>
+	/// Highest texture of a pixel - up to 4 channels, 4 neighbours, 7 bits each
+	/// </summary>
+	static const int _maxTexture = 4 * 4 * 127;
+
+	/// <summary>
+	/// Calculate the texture of every byte of the row - sum of the differences to its 4 neighbours in the same channel
+	/// </summary>
+	/// <param name="up">Row above, the row itself for the first row</param>
+	/// <param name="row">Bytes of the row</param>
+	/// <param name="down">Row below, the row itself for the last row</param>
+	/// <param name="length">Number of bytes of the row</param>
+	/// <param name="channels">Number of channels of a pixel - distance to the left and right neighbour</param>
+	/// <param name="output">Texture of every byte</param>
+	static void computeRowTexture(const uint8_t* up, const uint8_t* row, const uint8_t* down, size_t length, size_t channels, uint16_t* output);
+	/// <summary>
+	/// Calculate the texture of the pixels in the given rows and count how many pixels have every texture
+	/// </summary>
+	/// <param name="image">Image with its pixels</param>
+	/// <param name="firstRow">First row of the tile</param>
+	/// <param name="lastRow">Row after the last row of the tile</param>
+	/// <param name="texture">Texture map of the whole image</param>
+	/// <param name="histogram">Histogram of the tile</param>
+	void computeTile(const Image& image, int firstRow, int lastRow, uint16_t* texture, uint32_t* histogram) const;
+
+public:
+	CostMapHandler() {}
+	~CostMapHandler() {}
+
+	/// <summary>
+	/// Calculate the texture of every pixel, the image is split into tiles of rows computed in parallel
+	/// </summary>
+	/// <param name="image">Image with its pixels</param>
+	/// <param name="texture">Modifies the passed map with texture of every pixel</param>
+	/// <param name="histogram">Modifies the passed histogram with number of pixels with every texture</param>
+	/// <param name="parallel">Compute the tiles in parallel</param>
+	void computeTextureMap(const Image& image, std::vector<uint16_t>& texture, std::vector<uint32_t>& histogram, bool parallel = true) const;
+	/// <summary>
+	/// Number of channels the adaptive mode could use - every channel of the whole pixels after the given channel
+	/// </summary>
+	/// <param name="image">Image, only header data is used</param>
+	/// <param name="firstChannel">First channel that could hold the message</param>
+	/// <returns>Returns number of channels</returns>
+	size_t getAvailableChannels(const Image& image, size_t firstChannel) const;
+	/// <summary>
+	/// Choose the channels that hold the bits, every channel of the pixels with the highest texture in order of their position
+	/// </summary>
+	/// <param name="image">Image with its pixels</param>
+	/// <param name="firstChannel">First channel that could hold the message, channels before are not chosen</param>
+	/// <param name="bitCount">Number of bits that will be stored</param>
+	/// <param name="channels">Modifies the passed list with index of the channel for every bit</param>
+	/// <returns>Returns false if the image does not have enough pixels</returns>
+	bool selectChannels(const Image& image, size_t firstChannel, size_t bitCount, std::vector<uint32_t>& channels) const;
+};
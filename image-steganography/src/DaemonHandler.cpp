@@ -0,0 +1,490 @@
+#pragma once
+#include "DaemonHandler.hpp"
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <errno.h>
+#include <cstring>
+
+namespace {
+	// Event loop woken up by SIGINT or SIGTERM, the handler may only touch these
+	volatile sig_atomic_t signalReceived = 0;
+	int signalWakeFd = -1;
+
+	void handleSignal(int) {
+		signalReceived = 1;
+		uint64_t one = 1;
+		if (signalWakeFd >= 0) {
+			ssize_t written = write(signalWakeFd, &one, sizeof(one));
+			(void)written;
+		}
+	}
+}
+#endif
+
+namespace {
+	void appendUint32(std::string& data, uint32_t value) {
+		for (int i = 0; i < 4; i++) {
+			data.push_back((char)((value >> (8 * i)) & 0xFF));
+		}
+	}
+
+	uint32_t readUint32(const std::string& data, size_t offset) {
+		const unsigned char* bytes = (const unsigned char*)data.data() + offset;
+		return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+}
+
+/// <summary>
+/// Worker loop - takes the requests from the queue until the server stops
+/// </summary>
+void DaemonHandler::workerLoop() {
+	while (true) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(_jobsMutex);
+			_jobsCondition.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+			if (_jobs.empty()) {
+				return;
+			}
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+
+		std::string response = _bufferPool->acquireBuffer();
+		try {
+			handleRequest(job.body, response);
+		}
+		catch (const std::exception&) {
+			// Request that could not be handled, e.g. out of memory, fails alone and the server keeps running
+			response.clear();
+			appendUint32(response, job.body.length() >= 4 ? readUint32(job.body, 0) : 0);
+			response.push_back((char)DaemonStatus::STATUS_ERROR);
+		}
+		_bufferPool->releaseBuffer(std::move(job.body));
+		{
+			std::lock_guard<std::mutex> lock(_resultsMutex);
+			_results.push_back({ job.connectionId, std::move(response) });
+		}
+		wake();
+	}
+}
+
+/// <summary>
+/// Handle a single request and build its response
+/// </summary>
+/// <param name="request">Body of the request frame</param>
+/// <param name="response">Buffer to which body of the response frame will be saved</param>
+void DaemonHandler::handleRequest(const std::string& request, std::string& response) const {
+	const size_t headerLength = 4 + 1 + 1 + 4;
+	uint32_t id = request.length() >= 4 ? readUint32(request, 0) : 0;
+	appendUint32(response, id);
+	if (request.length() < headerLength || headerLength + readUint32(request, 6) > request.length()) {
+		response.push_back((char)DaemonStatus::STATUS_BAD_REQUEST);
+		return;
+	}
+
+	const uint8_t operation = request[4];
+	EncodeOptions options;
+	options.fecLevel = (uint8_t)request[5];
+	const uint32_t pathLength = readUint32(request, 6);
+	const std::string path = request.substr(headerLength, pathLength);
+	const size_t messageStart = headerLength + pathLength;
+
+	bool status = false;
+	std::string data;
+	switch (operation) {
+	case DaemonOperation::OP_ENCODE:
+		status = _fileHandler->encodeMessage(path, request.substr(messageStart), options);
+		break;
+	case DaemonOperation::OP_DECODE:
+		status = _fileHandler->readEncodedMessage(path, data);
+		break;
+	case DaemonOperation::OP_PROBE:
+		status = true;
+		data = _fileHandler->checkIfCanRead(path) ? "1" : "0";
+		break;
+	case DaemonOperation::OP_CAPACITY: {
+		CapacityReport report;
+		status = _fileHandler->getCapacity(path, 0, options, report);
+		data = std::to_string(report.maxMessageLength);
+		break;
+	}
+	default:
+		response.push_back((char)DaemonStatus::STATUS_BAD_REQUEST);
+		return;
+	}
+
+	response.push_back((char)(status ? DaemonStatus::STATUS_OK : DaemonStatus::STATUS_ERROR));
+	response += data;
+}
+
+#ifdef __linux__
+/// <summary>
+/// Cut every complete frame from the connection's input and queue it for the workers
+/// </summary>
+/// <param name="connectionId">Id of the connection</param>
+/// <param name="connection">Connection that has read new data</param>
+/// <returns>Returns false if the connection sent an invalid frame</returns>
+bool DaemonHandler::queueFrames(uint64_t connectionId, Connection& connection) {
+	size_t offset = 0;
+	while (connection.input.length() - offset >= 4) {
+		const uint32_t length = readUint32(connection.input, offset);
+		if (length > _maxFrameLength) {
+			return false;
+		}
+		if (connection.input.length() - offset - 4 < length) {
+			break;
+		}
+
+		std::string body = _bufferPool->acquireBuffer();
+		body.assign(connection.input, offset + 4, length);
+		offset += 4 + length;
+		connection.pendingJobs++;
+		{
+			std::lock_guard<std::mutex> lock(_jobsMutex);
+			_jobs.push_back({ connectionId, std::move(body) });
+		}
+		_jobsCondition.notify_one();
+	}
+	connection.input.erase(0, offset);
+	return true;
+}
+
+/// <summary>
+/// Write as much of the pending output as the socket accepts
+/// </summary>
+/// <param name="connection">Connection with pending output</param>
+/// <returns>Returns false if the connection is broken</returns>
+bool DaemonHandler::flushOutput(Connection& connection) const {
+	while (connection.outputOffset < connection.output.length()) {
+		ssize_t written = send(connection.fd, connection.output.data() + connection.outputOffset,
+			connection.output.length() - connection.outputOffset, MSG_NOSIGNAL);
+		if (written < 0) {
+			return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+		}
+		connection.outputOffset += written;
+	}
+	connection.output.clear();
+	connection.outputOffset = 0;
+	return true;
+}
+
+/// <summary>
+/// Wake up the event loop
+/// </summary>
+void DaemonHandler::wake() const {
+	uint64_t one = 1;
+	ssize_t written = write(_wakeFd, &one, sizeof(one));
+	(void)written;
+}
+
+/// <summary>
+/// Listen on the socket and handle requests until the process receives SIGINT or SIGTERM
+/// </summary>
+/// <param name="socketPath">Path of the Unix domain socket</param>
+/// <param name="workerCount">Number of threads handling the requests</param>
+/// <returns>Returns false if the server could not be started</returns>
+bool DaemonHandler::run(const std::string& socketPath, size_t workerCount) {
+	sockaddr_un address = {};
+	if (socketPath.length() >= sizeof(address.sun_path)) {
+		std::cout << "Error: socket path is too long" << std::endl;
+		return false;
+	}
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+	int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	unlink(socketPath.c_str());
+	if (listenFd < 0 || bind(listenFd, (sockaddr*)&address, sizeof(address)) < 0 || listen(listenFd, SOMAXCONN) < 0) {
+		std::cout << "Error: unable to listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+		if (listenFd >= 0) {
+			close(listenFd);
+		}
+		return false;
+	}
+
+	int epollFd = epoll_create1(EPOLL_CLOEXEC);
+	_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.u64 = 0; // 0 - listening socket, 1 - wake up, rest - connection ids
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+	event.data.u64 = 1;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, _wakeFd, &event);
+
+	signalWakeFd = _wakeFd;
+	signalReceived = 0;
+	signal(SIGINT, handleSignal);
+	signal(SIGTERM, handleSignal);
+
+	// Workers share warm pixel and frame buffers, every image read by them comes from the pool
+	workerCount = std::max<size_t>(1, workerCount);
+	BufferPool bufferPool(workerCount * 2);
+	_bufferPool = &bufferPool;
+	_fileHandler->setBufferPool(&bufferPool);
+	_stopping = false;
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < workerCount; i++) {
+		workers.emplace_back(&DaemonHandler::workerLoop, this);
+	}
+	std::cout << "Listening on " << socketPath << " with " << workerCount << " workers" << std::endl;
+
+	std::unordered_map<uint64_t, Connection> connections;
+	uint64_t nextConnectionId = 2;
+	auto closeClient = [&](uint64_t id) {
+		auto found = connections.find(id);
+		if (found == connections.end()) {
+			return;
+		}
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, found->second.fd, nullptr);
+		close(found->second.fd);
+		connections.erase(found);
+	};
+	auto updateEvents = [&](uint64_t id, Connection& connection) {
+		epoll_event update = {};
+		update.events = (connection.closing ? 0u : (uint32_t)(EPOLLIN | EPOLLRDHUP)) | (connection.output.empty() ? 0u : (uint32_t)EPOLLOUT);
+		update.data.u64 = id;
+		epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &update);
+	};
+
+	// Move the responses of the finished requests to the output of their connections
+	auto deliverResults = [&]() {
+		std::vector<Job> results;
+		{
+			std::lock_guard<std::mutex> lock(_resultsMutex);
+			results.swap(_results);
+		}
+		for (Job& result : results) {
+			auto found = connections.find(result.connectionId);
+			if (found == connections.end()) {
+				_bufferPool->releaseBuffer(std::move(result.body));
+				continue;
+			}
+			Connection& connection = found->second;
+			connection.pendingJobs--;
+			appendUint32(connection.output, (uint32_t)result.body.length());
+			connection.output += result.body;
+			_bufferPool->releaseBuffer(std::move(result.body));
+			if (!flushOutput(connection) || (connection.closing && connection.pendingJobs == 0 && connection.output.empty())) {
+				closeClient(result.connectionId);
+				continue;
+			}
+			updateEvents(result.connectionId, connection);
+		}
+	};
+
+	std::vector<epoll_event> events(256);
+	char readBuffer[64 * 1024];
+	while (!signalReceived) {
+		int count = epoll_wait(epollFd, events.data(), (int)events.size(), -1);
+		if (count < 0 && errno != EINTR) {
+			break;
+		}
+
+		for (int i = 0; i < count; i++) {
+			const uint64_t id = events[i].data.u64;
+			if (id == 0) { // New connections
+				int clientFd;
+				while ((clientFd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+					Connection connection;
+					connection.fd = clientFd;
+					epoll_event clientEvent = {};
+					clientEvent.events = EPOLLIN | EPOLLRDHUP;
+					clientEvent.data.u64 = nextConnectionId;
+					epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &clientEvent);
+					connections.emplace(nextConnectionId++, std::move(connection));
+				}
+				continue;
+			}
+
+			if (id == 1) { // Finished requests
+				uint64_t value;
+				ssize_t readBytes = read(_wakeFd, &value, sizeof(value));
+				(void)readBytes;
+				deliverResults();
+				continue;
+			}
+
+			auto found = connections.find(id);
+			if (found == connections.end()) {
+				continue;
+			}
+			Connection& connection = found->second;
+			if (events[i].events & EPOLLOUT) {
+				if (!flushOutput(connection) || (connection.closing && connection.pendingJobs == 0 && connection.output.empty())) {
+					closeClient(id);
+					continue;
+				}
+				updateEvents(id, connection);
+			}
+			if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+				ssize_t readBytes;
+				while ((readBytes = recv(connection.fd, readBuffer, sizeof(readBuffer), 0)) > 0) {
+					connection.input.append(readBuffer, readBytes);
+				}
+				bool broken = readBytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR;
+				if (broken || !queueFrames(id, connection)) {
+					closeClient(id);
+					continue;
+				}
+				if (readBytes == 0) { // Client has finished sending, answer what is still pending
+					connection.closing = true;
+					if (connection.pendingJobs == 0 && connection.output.empty()) {
+						closeClient(id);
+						continue;
+					}
+					updateEvents(id, connection);
+				}
+			}
+		}
+	}
+
+	// Let the workers finish the queued requests and stop, the flag is set under the lock so no worker misses the wake up
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		_stopping = true;
+	}
+	_jobsCondition.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	// Answer the drained requests before closing, a client that stops reading holds the shutdown for at most a second
+	deliverResults();
+	for (auto& connection : connections) {
+		const int fd = connection.second.fd;
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+		timeval timeout = { 1, 0 };
+		setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+		flushOutput(connection.second);
+		close(fd);
+	}
+	_fileHandler->setBufferPool(nullptr);
+	_bufferPool = nullptr;
+	signalWakeFd = -1;
+	close(_wakeFd);
+	close(epollFd);
+	close(listenFd);
+	unlink(socketPath.c_str());
+	std::cout << "Server stopped" << std::endl;
+	return true;
+}
+
+/// <summary>
+/// Connect to the server listening on the socket
+/// </summary>
+/// <param name="socketPath">Path of the Unix domain socket</param>
+/// <returns>Returns connected file descriptor or -1</returns>
+int DaemonHandler::connectToServer(const std::string& socketPath) {
+	sockaddr_un address = {};
+	if (socketPath.length() >= sizeof(address.sun_path)) {
+		return -1;
+	}
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd >= 0 && connect(fd, (sockaddr*)&address, sizeof(address)) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/// <summary>
+/// Send a whole frame, blocking until it is written
+/// </summary>
+/// <param name="fd">Connected socket</param>
+/// <param name="body">Body of the frame</param>
+/// <returns>Returns true if the frame has been written</returns>
+bool DaemonHandler::sendFrame(int fd, const std::string& body) {
+	std::string frame;
+	appendUint32(frame, (uint32_t)body.length());
+	frame += body;
+	size_t offset = 0;
+	while (offset < frame.length()) {
+		ssize_t written = send(fd, frame.data() + offset, frame.length() - offset, MSG_NOSIGNAL);
+		if (written <= 0 && errno != EINTR) {
+			return false;
+		}
+		offset += std::max<ssize_t>(written, 0);
+	}
+	return true;
+}
+
+/// <summary>
+/// Receive a whole frame, blocking until it is read
+/// </summary>
+/// <param name="fd">Connected socket</param>
+/// <param name="body">Buffer to which body of the frame will be saved</param>
+/// <returns>Returns true if the frame has been read</returns>
+bool DaemonHandler::receiveFrame(int fd, std::string& body) {
+	auto receiveAll = [fd](char* data, size_t length) {
+		size_t offset = 0;
+		while (offset < length) {
+			ssize_t readBytes = recv(fd, data + offset, length - offset, 0);
+			if (readBytes <= 0 && errno != EINTR) {
+				return false;
+			}
+			offset += std::max<ssize_t>(readBytes, 0);
+		}
+		return true;
+	};
+
+	std::string length(4, '\0');
+	if (!receiveAll(&length[0], 4) || readUint32(length, 0) > _maxFrameLength) {
+		return false;
+	}
+	body.resize(readUint32(length, 0));
+	return body.empty() || receiveAll(&body[0], body.length());
+}
+
+/// <summary>
+/// Close the connection
+/// </summary>
+/// <param name="fd">Connected socket</param>
+void DaemonHandler::closeConnection(int fd) {
+	close(fd);
+}
+#else
+bool DaemonHandler::queueFrames(uint64_t connectionId, Connection& connection) { return false; }
+bool DaemonHandler::flushOutput(Connection& connection) const { return false; }
+void DaemonHandler::wake() const {}
+
+bool DaemonHandler::run(const std::string& socketPath, size_t workerCount) {
+	std::cout << "Error: server mode is supported only on Linux" << std::endl;
+	return false;
+}
+
+int DaemonHandler::connectToServer(const std::string& socketPath) { return -1; }
+bool DaemonHandler::sendFrame(int fd, const std::string& body) { return false; }
+bool DaemonHandler::receiveFrame(int fd, std::string& body) { return false; }
+void DaemonHandler::closeConnection(int fd) {}
+#endif
+
+/// <summary>
+/// Build the body of a request frame
+/// </summary>
+/// <param name="id">Id echoed back in the response</param>
+/// <param name="operation">Requested operation</param>
+/// <param name="fecLevel">Level of error correction for encode and capacity</param>
+/// <param name="path">Path of the image</param>
+/// <param name="message">Message to encode, empty for other operations</param>
+/// <returns>Returns body of the request</returns>
+std::string DaemonHandler::createRequest(uint32_t id, DaemonOperation operation, uint8_t fecLevel, const std::string& path, const std::string& message) {
+	std::string body;
+	appendUint32(body, id);
+	body.push_back((char)operation);
+	body.push_back((char)fecLevel);
+	appendUint32(body, (uint32_t)path.length());
+	body += path;
+	body += message;
+	return body;
+}
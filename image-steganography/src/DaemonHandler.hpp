@@ -0,0 +1,156 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <iostream>
+#include <cstdint>
+
+#include "enums.hpp"
+#include "structs.hpp"
+#include "FileHandler.hpp"
+#include "BufferPool.hpp"
+
+/// <summary>
+/// Long running server that handles encode, decode, probe and capacity requests over a Unix domain socket
+///
+/// Every message is a frame - 4 byte little endian length followed by the body
+/// Request body:  [u32 id][u8 operation][u8 fec level][u32 path length][path][message to encode]
+/// Response body: [u32 id][u8 status][data] - decoded message, "1"/"0" for probe or capacity in bytes
+///
+/// One thread runs the event loop that accepts connections, reads and writes the frames without blocking,
+/// the requests are handled by a pool of workers that share the warm buffer pool
+/// </summary>
+class DaemonHandler {
+private:
+	/// <summary>
+	/// Request read from a connection waiting for a worker
+	/// </summary>
+	struct Job {
+		uint64_t connectionId;
+		std::string body;
+	};
+	/// <summary>
+	/// State of a single client connection owned by the event loop
+	/// </summary>
+	struct Connection {
+		int fd;
+		std::string input;
+		std::string output;
+		size_t outputOffset = 0;
+		size_t pendingJobs = 0;
+		bool closing = false;
+	};
+
+	/// <summary>
+	/// Pointer to file handler that handles the requests
+	/// </summary>
+	FileHandler* _fileHandler;
+	/// <summary>
+	/// Pool of pixels and frame buffers reused across requests
+	/// </summary>
+	BufferPool* _bufferPool;
+	/// <summary>
+	/// Largest accepted frame, protects the server from broken clients
+	/// </summary>
+	static const uint32_t _maxFrameLength = 64 * 1024 * 1024;
+
+	std::mutex _jobsMutex;
+	std::condition_variable _jobsCondition;
+	std::deque<Job> _jobs;
+	std::mutex _resultsMutex;
+	std::vector<Job> _results;
+	std::atomic<bool> _stopping;
+	/// <summary>
+	/// File descriptor used by the workers and signals to wake up the event loop
+	/// </summary>
+	int _wakeFd = -1;
+
+	/// <summary>
+	/// Worker loop - takes the requests from the queue until the server stops
+	/// </summary>
+	void workerLoop();
+	/// <summary>
+	/// Handle a single request and build its response
+	/// </summary>
+	/// <param name="request">Body of the request frame</param>
+	/// <param name="response">Buffer to which body of the response frame will be saved</param>
+	void handleRequest(const std::string& request, std::string& response) const;
+	/// <summary>
+	/// Cut every complete frame from the connection's input and queue it for the workers
+	/// </summary>
+	/// <param name="connectionId">Id of the connection</param>
+	/// <param name="connection">Connection that has read new data</param>
+	/// <returns>Returns false if the connection sent an invalid frame</returns>
+	bool queueFrames(uint64_t connectionId, Connection& connection);
+	/// <summary>
+	/// Write as much of the pending output as the socket accepts
+	/// </summary>
+	/// <param name="connection">Connection with pending output</param>
+	/// <returns>Returns false if the connection is broken</returns>
+	bool flushOutput(Connection& connection) const;
+	/// <summary>
+	/// Wake up the event loop
+	/// </summary>
+	void wake() const;
+
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="fileHandler">File handler used to handle the requests</param>
+	DaemonHandler(FileHandler* fileHandler) {
+		_fileHandler = fileHandler;
+		_bufferPool = nullptr;
+		_stopping = false;
+	}
+	~DaemonHandler() {}
+
+	/// <summary>
+	/// Listen on the socket and handle requests until the process receives SIGINT or SIGTERM
+	/// </summary>
+	/// <param name="socketPath">Path of the Unix domain socket</param>
+	/// <param name="workerCount">Number of threads handling the requests</param>
+	/// <returns>Returns false if the server could not be started</returns>
+	bool run(const std::string& socketPath, size_t workerCount);
+
+	/// <summary>
+	/// Connect to the server listening on the socket
+	/// </summary>
+	/// <param name="socketPath">Path of the Unix domain socket</param>
+	/// <returns>Returns connected file descriptor or -1</returns>
+	static int connectToServer(const std::string& socketPath);
+	/// <summary>
+	/// Build the body of a request frame
+	/// </summary>
+	/// <param name="id">Id echoed back in the response</param>
+	/// <param name="operation">Requested operation</param>
+	/// <param name="fecLevel">Level of error correction for encode and capacity</param>
+	/// <param name="path">Path of the image</param>
+	/// <param name="message">Message to encode, empty for other operations</param>
+	/// <returns>Returns body of the request</returns>
+	static std::string createRequest(uint32_t id, DaemonOperation operation, uint8_t fecLevel, const std::string& path, const std::string& message);
+	/// <summary>
+	/// Send a whole frame, blocking until it is written
+	/// </summary>
+	/// <param name="fd">Connected socket</param>
+	/// <param name="body">Body of the frame</param>
+	/// <returns>Returns true if the frame has been written</returns>
+	static bool sendFrame(int fd, const std::string& body);
+	/// <summary>
+	/// Receive a whole frame, blocking until it is read
+	/// </summary>
+	/// <param name="fd">Connected socket</param>
+	/// <param name="body">Buffer to which body of the frame will be saved</param>
+	/// <returns>Returns true if the frame has been read</returns>
+	static bool receiveFrame(int fd, std::string& body);
+	/// <summary>
+	/// Close the connection
+	/// </summary>
+	/// <param name="fd">Connected socket</param>
+	static void closeConnection(int fd);
+};
@@ -0,0 +1,497 @@
+#pragma once
+#include "Deflater.hpp"
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="sink">Function that takes the compressed data, returns false to stop on error</param>
+/// <param name="bestCompression">Search harder for matches - smaller output, slower</param>
+Deflater::Deflater(std::function<bool(const uint8_t*, size_t)> sink, bool bestCompression)
+	: _sink(sink), _buffer(_windowSize + _blockSize + _maxMatch), _head((size_t)1 << _hashBits, -1), _previous(_buffer.size(), -1) {
+	_maxChain = bestCompression ? 1024 : 4;
+	_niceLength = bestCompression ? _maxMatch : 16;
+	_lazyMatching = bestCompression;
+	_symbols.reserve(_maxSymbols);
+
+	// zlib header - deflate with 32 KB window, the level is only informative
+	writeBits(0x78, 8);
+	writeBits(bestCompression ? 0xDA : 0x01, 8);
+}
+
+/// <summary>
+/// Hash of the 3 bytes starting at the position
+/// </summary>
+/// <param name="position">Position in the buffer</param>
+/// <returns>Returns the hash</returns>
+uint32_t Deflater::hash(size_t position) const {
+	const uint32_t value = _buffer[position] | _buffer[position + 1] << 8 | _buffer[position + 2] << 16;
+	return (value * 2654435761u) >> (32 - _hashBits);
+}
+
+/// <summary>
+/// Add the position to the hash chains
+/// </summary>
+/// <param name="position">Position in the buffer</param>
+void Deflater::insert(size_t position) {
+	if (position + _minMatch > _filled) {
+		return;
+	}
+
+	const uint32_t h = hash(position);
+	_previous[position] = _head[h];
+	_head[h] = (int32_t)position;
+}
+
+/// <summary>
+/// Find the longest earlier match for the bytes starting at the position
+/// </summary>
+/// <param name="position">Position in the buffer</param>
+/// <param name="end">End of the bytes that could be matched</param>
+/// <param name="distance">Modifies the passed distance with the distance of the match</param>
+/// <returns>Returns length of the match, 0 if there is none</returns>
+size_t Deflater::findMatch(size_t position, size_t end, size_t& distance) const {
+	if (position + _minMatch > end) {
+		return 0;
+	}
+
+	const size_t limit = std::min(_maxMatch, end - position);
+	const uint8_t* current = &_buffer[position];
+	size_t best = _minMatch - 1;
+	size_t chain = _maxChain;
+	for (int32_t candidate = _head[hash(position)]; candidate >= 0 && chain-- > 0; candidate = _previous[candidate]) {
+		if (position - candidate > _windowSize) { // Chains go back in the buffer, so the rest is even farther
+			break;
+		}
+
+		const uint8_t* earlier = &_buffer[candidate];
+		// Only a candidate that could be longer than the best one is compared
+		if (earlier[best] != current[best] || earlier[0] != current[0]) {
+			continue;
+		}
+		size_t length = 0;
+		while (length < limit && earlier[length] == current[length]) {
+			length++;
+		}
+		if (length > best) {
+			best = length;
+			distance = position - candidate;
+			if (best >= _niceLength || best == limit) {
+				break;
+			}
+		}
+	}
+	return best >= _minMatch ? best : 0;
+}
+
+/// <summary>
+/// Turn the bytes of the buffer into symbols, from the current position up to the given end
+/// Matches could reach past the end, up to the last byte in the buffer
+/// </summary>
+/// <param name="end">Position at which the compression stops</param>
+void Deflater::compress(size_t end) {
+	// Every position before the current one is already in the hash chains
+	while (_position < end) {
+		size_t distance = 0;
+		size_t length = findMatch(_position, _filled, distance);
+		insert(_position);
+
+		if (_lazyMatching && length > 0 && length < _niceLength && _position + 1 < end) {
+			size_t nextDistance = 0;
+			if (findMatch(_position + 1, _filled, nextDistance) > length) {
+				// Better match starts at the next byte, this one stays a literal
+				length = 0;
+			}
+		}
+
+		if (length > 0) {
+			_symbols.push_back({ (uint16_t)length, (uint16_t)distance });
+			for (size_t i = 1; i < length; i++) {
+				insert(_position + i);
+			}
+			_position += length;
+		}
+		else {
+			_symbols.push_back({ _buffer[_position], 0 });
+			_position++;
+		}
+
+		if (_symbols.size() >= _maxSymbols) {
+			writeBlock(false);
+		}
+	}
+}
+
+/// <summary>
+/// Drop the bytes that are farther than the window from the current position to make room for new data
+/// The current block must be written before
+/// </summary>
+void Deflater::slide() {
+	if (_position <= _windowSize) {
+		return;
+	}
+
+	const size_t shift = _position - _windowSize;
+	std::memmove(_buffer.data(), _buffer.data() + shift, _filled - shift);
+	std::memmove(_previous.data(), _previous.data() + shift, (_filled - shift) * sizeof(int32_t));
+	_filled -= shift;
+	_position -= shift;
+	_blockStart -= shift;
+
+	// Positions in the chains move with the data, the dropped ones end the chains
+	auto rebase = [shift](int32_t& value) {
+		value = value >= (int32_t)shift ? value - (int32_t)shift : -1;
+	};
+	std::for_each(_head.begin(), _head.end(), rebase);
+	std::for_each(_previous.begin(), _previous.begin() + _filled, rebase);
+}
+
+/// <summary>
+/// Write the bits to the output, least significant first
+/// </summary>
+/// <param name="bits">Bits to write</param>
+/// <param name="count">Number of bits</param>
+void Deflater::writeBits(uint32_t bits, int count) {
+	_bitBuffer |= (uint64_t)bits << _bitCount;
+	_bitCount += count;
+	while (_bitCount >= 8) {
+		_output.push_back((char)(_bitBuffer & 0xFF));
+		_bitBuffer >>= 8;
+		_bitCount -= 8;
+	}
+}
+
+/// <summary>
+/// Pass the whole bytes of the output to the sink
+/// </summary>
+/// <param name="force">Pass the output even if it is short</param>
+void Deflater::flushOutput(bool force) {
+	if (_output.empty() || (!force && _output.size() < _outputSize)) {
+		return;
+	}
+
+	if (!_error && !_sink((const uint8_t*)_output.data(), _output.size())) {
+		_error = true;
+	}
+	_output.clear();
+}
+
+/// <summary>
+/// Write the symbols of the current block as one block - dynamic, fixed or stored, whichever is the shortest
+/// </summary>
+/// <param name="last">This is the last block of the stream</param>
+void Deflater::writeBlock(bool last) {
+	if (_symbols.empty() && !last) {
+		return;
+	}
+
+	uint32_t literalFrequencies[286] = {};
+	uint32_t distanceFrequencies[30] = {};
+	uint64_t extraBits = 0;
+	for (const Symbol& symbol : _symbols) {
+		if (symbol.distance == 0) {
+			literalFrequencies[symbol.literalOrLength]++;
+			continue;
+		}
+		const int length = lengthSymbol(symbol.literalOrLength);
+		const int distance = distanceSymbol(symbol.distance);
+		literalFrequencies[257 + length]++;
+		distanceFrequencies[distance]++;
+		extraBits += Inflater::lengthExtra[length] + Inflater::distanceExtra[distance];
+	}
+	literalFrequencies[256] = 1;
+
+	uint8_t literalLengths[288] = {};
+	uint8_t distanceLengths[32] = {};
+	buildLengths(literalFrequencies, 286, 15, literalLengths);
+	buildLengths(distanceFrequencies, 30, 15, distanceLengths);
+	if (std::count(distanceLengths, distanceLengths + 30, 0) == 30) {
+		distanceLengths[0] = 1; // At least one distance code must be stored
+	}
+
+	// Lengths of both codes as one sequence with runs replaced by the repeat symbols 16, 17 and 18
+	int literalCount = 286, distanceCount = 30;
+	while (literalCount > 257 && literalLengths[literalCount - 1] == 0) {
+		literalCount--;
+	}
+	while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) {
+		distanceCount--;
+	}
+	std::vector<uint8_t> lengths(literalLengths, literalLengths + literalCount);
+	lengths.insert(lengths.end(), distanceLengths, distanceLengths + distanceCount);
+
+	std::vector<std::pair<uint8_t, uint8_t>> runs; // Symbol and value of its extra bits
+	uint32_t codeLengthFrequencies[19] = {};
+	for (size_t i = 0; i < lengths.size();) {
+		size_t run = 1;
+		while (i + run < lengths.size() && lengths[i + run] == lengths[i]) {
+			run++;
+		}
+
+		if (lengths[i] == 0 && run >= 3) {
+			run = std::min(run, (size_t)138);
+			runs.push_back(run <= 10 ? std::make_pair((uint8_t)17, (uint8_t)(run - 3)) : std::make_pair((uint8_t)18, (uint8_t)(run - 11)));
+		}
+		else if (lengths[i] != 0 && run >= 4) {
+			// The value itself is stored once, the repeats after it
+			runs.push_back({ lengths[i], 0 });
+			run = 1 + std::min(run - 1, (size_t)6);
+			runs.push_back({ 16, (uint8_t)(run - 4) });
+		}
+		else {
+			run = 1;
+			runs.push_back({ lengths[i], 0 });
+		}
+		i += run;
+	}
+	for (const auto& run : runs) {
+		codeLengthFrequencies[run.first]++;
+	}
+	uint8_t codeLengthLengths[19] = {};
+	buildLengths(codeLengthFrequencies, 19, 7, codeLengthLengths);
+	int codeLengthCount = 19;
+	while (codeLengthCount > 4 && codeLengthLengths[Inflater::codeLengthOrder[codeLengthCount - 1]] == 0) {
+		codeLengthCount--;
+	}
+
+	// Size of the block in bits for every type of block
+	uint64_t dynamicBits = 3 + 14 + 3 * codeLengthCount + extraBits;
+	uint64_t fixedBits = 3 + extraBits;
+	for (const auto& run : runs) {
+		dynamicBits += codeLengthLengths[run.first] + (run.first == 16 ? 2 : run.first == 17 ? 3 : run.first == 18 ? 7 : 0);
+	}
+	for (int symbol = 0; symbol < 286; symbol++) {
+		dynamicBits += (uint64_t)literalFrequencies[symbol] * literalLengths[symbol];
+		fixedBits += (uint64_t)literalFrequencies[symbol] * (symbol < 144 ? 8 : symbol < 256 ? 9 : symbol < 280 ? 7 : 8);
+	}
+	for (int symbol = 0; symbol < 30; symbol++) {
+		dynamicBits += (uint64_t)distanceFrequencies[symbol] * distanceLengths[symbol];
+		fixedBits += (uint64_t)distanceFrequencies[symbol] * 5;
+	}
+	const size_t blockLength = _position - _blockStart;
+	const uint64_t storedBits = (blockLength + 5 * std::max((size_t)1, (blockLength + 65534) / 65535)) * 8 + 7;
+
+	if (storedBits < dynamicBits && storedBits < fixedBits) {
+		size_t offset = 0;
+		do {
+			const size_t length = std::min(blockLength - offset, (size_t)65535);
+			writeBits(last && offset + length == blockLength ? 1 : 0, 1);
+			writeBits(0, 2);
+			writeBits(0, (8 - _bitCount % 8) % 8);
+			writeBits((uint32_t)length, 16);
+			writeBits((uint32_t)~length & 0xFFFF, 16);
+			_output.append((const char*)&_buffer[_blockStart + offset], length);
+			offset += length;
+		} while (offset < blockLength);
+	}
+	else if (fixedBits <= dynamicBits) {
+		writeBits(last ? 1 : 0, 1);
+		writeBits(1, 2);
+		uint8_t fixedLiterals[288], fixedDistances[30];
+		std::memset(fixedLiterals, 8, 144);
+		std::memset(fixedLiterals + 144, 9, 112);
+		std::memset(fixedLiterals + 256, 7, 24);
+		std::memset(fixedLiterals + 280, 8, 8);
+		std::memset(fixedDistances, 5, 30);
+		writeSymbols(fixedLiterals, fixedDistances);
+	}
+	else {
+		writeBits(last ? 1 : 0, 1);
+		writeBits(2, 2);
+		writeBits(literalCount - 257, 5);
+		writeBits(distanceCount - 1, 5);
+		writeBits(codeLengthCount - 4, 4);
+		for (int i = 0; i < codeLengthCount; i++) {
+			writeBits(codeLengthLengths[Inflater::codeLengthOrder[i]], 3);
+		}
+
+		uint16_t codeLengthCodes[19];
+		buildCodes(codeLengthLengths, 19, codeLengthCodes);
+		for (const auto& run : runs) {
+			writeBits(codeLengthCodes[run.first], codeLengthLengths[run.first]);
+			if (run.first >= 16) {
+				writeBits(run.second, run.first == 16 ? 2 : run.first == 17 ? 3 : 7);
+			}
+		}
+		writeSymbols(literalLengths, distanceLengths);
+	}
+
+	_symbols.clear();
+	_blockStart = _position;
+	flushOutput(false);
+}
+
+/// <summary>
+/// Write the symbols of the block with the given codes
+/// </summary>
+/// <param name="literalLengths">Code lengths of the literal / length code</param>
+/// <param name="distanceLengths">Code lengths of the distance code</param>
+void Deflater::writeSymbols(const uint8_t* literalLengths, const uint8_t* distanceLengths) {
+	uint16_t literalCodes[288], distanceCodes[30];
+	buildCodes(literalLengths, 288, literalCodes);
+	buildCodes(distanceLengths, 30, distanceCodes);
+
+	for (const Symbol& symbol : _symbols) {
+		if (symbol.distance == 0) {
+			writeBits(literalCodes[symbol.literalOrLength], literalLengths[symbol.literalOrLength]);
+			continue;
+		}
+
+		const int length = lengthSymbol(symbol.literalOrLength);
+		writeBits(literalCodes[257 + length], literalLengths[257 + length]);
+		writeBits(symbol.literalOrLength - Inflater::lengthBase[length], Inflater::lengthExtra[length]);
+		const int distance = distanceSymbol(symbol.distance);
+		writeBits(distanceCodes[distance], distanceLengths[distance]);
+		writeBits(symbol.distance - Inflater::distanceBase[distance], Inflater::distanceExtra[distance]);
+	}
+	writeBits(literalCodes[256], literalLengths[256]);
+}
+
+/// <summary>
+/// Calculate code lengths of the Huffman code for the frequencies, no code is longer than the limit
+/// </summary>
+/// <param name="frequencies">Frequency of every symbol</param>
+/// <param name="count">Number of symbols</param>
+/// <param name="limit">Longest code allowed</param>
+/// <param name="lengths">Lengths to which the code will be saved</param>
+void Deflater::buildLengths(const uint32_t* frequencies, int count, int limit, uint8_t* lengths) {
+	std::memset(lengths, 0, count);
+	std::vector<int> used;
+	std::vector<uint64_t> weights;
+	for (int symbol = 0; symbol < count; symbol++) {
+		if (frequencies[symbol] > 0) {
+			used.push_back(symbol);
+			weights.push_back(frequencies[symbol]);
+		}
+	}
+	if (used.size() == 1) {
+		// Incomplete code is rejected by some decoders, so an unused symbol gets the other code
+		lengths[used[0]] = 1;
+		lengths[used[0] == 0 ? 1 : 0] = 1;
+	}
+	if (used.size() <= 1) {
+		return;
+	}
+
+	// Too long codes are made shorter by flattening the frequencies until the tree fits the limit
+	const size_t leaves = used.size();
+	while (true) {
+		typedef std::pair<uint64_t, size_t> Node;
+		std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+		std::vector<size_t> parents(2 * leaves - 1);
+		for (size_t i = 0; i < leaves; i++) {
+			queue.push({ weights[i], i });
+		}
+		for (size_t next = leaves; queue.size() > 1; next++) {
+			Node first = queue.top();
+			queue.pop();
+			Node second = queue.top();
+			queue.pop();
+			parents[first.second] = parents[second.second] = next;
+			queue.push({ first.first + second.first, next });
+		}
+
+		// Parents are created after their children, so depths are known going from the root down
+		std::vector<int> depths(2 * leaves - 1, 0);
+		int deepest = 0;
+		for (size_t node = 2 * leaves - 2; node-- > 0;) {
+			depths[node] = depths[parents[node]] + 1;
+			deepest = std::max(deepest, depths[node]);
+		}
+
+		if (deepest <= limit) {
+			for (size_t i = 0; i < leaves; i++) {
+				lengths[used[i]] = (uint8_t)depths[i];
+			}
+			return;
+		}
+		for (uint64_t& weight : weights) {
+			weight = (weight >> 1) | 1;
+		}
+	}
+}
+
+/// <summary>
+/// Calculate the canonical codes for the code lengths
+/// Codes are stored from the most significant bit, so they are saved reversed to be written by writeBits
+/// </summary>
+/// <param name="lengths">Code lengths</param>
+/// <param name="count">Number of symbols</param>
+/// <param name="codes">Codes to which the result will be saved</param>
+void Deflater::buildCodes(const uint8_t* lengths, int count, uint16_t* codes) {
+	uint16_t counts[16] = {};
+	for (int symbol = 0; symbol < count; symbol++) {
+		counts[lengths[symbol]]++;
+	}
+	counts[0] = 0;
+
+	uint16_t nextCode[16] = {};
+	for (int length = 1, code = 0; length < 16; length++) {
+		code = (code + counts[length - 1]) << 1;
+		nextCode[length] = code;
+	}
+
+	for (int symbol = 0; symbol < count; symbol++) {
+		const int length = lengths[symbol];
+		const uint16_t code = length > 0 ? nextCode[length]++ : 0;
+		uint16_t reversed = 0;
+		for (int bit = 0; bit < length; bit++) {
+			reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+		}
+		codes[symbol] = reversed;
+	}
+}
+
+/// <summary>
+/// Symbol of the length, 0 - 28 (257 - 285 in the code)
+/// </summary>
+int Deflater::lengthSymbol(size_t length) {
+	return (int)(std::upper_bound(Inflater::lengthBase, Inflater::lengthBase + 29, length) - Inflater::lengthBase) - 1;
+}
+
+/// <summary>
+/// Symbol of the distance, 0 - 29
+/// </summary>
+int Deflater::distanceSymbol(size_t distance) {
+	return (int)(std::upper_bound(Inflater::distanceBase, Inflater::distanceBase + 30, distance) - Inflater::distanceBase) - 1;
+}
+
+/// <summary>
+/// Add the data to the stream, full blocks are compressed and passed to the sink
+/// </summary>
+/// <param name="data">Data to compress</param>
+/// <param name="length">Number of bytes</param>
+/// <returns>Returns false if the sink failed</returns>
+bool Deflater::write(const uint8_t* data, size_t length) {
+	while (length > 0 && !_error) {
+		const size_t count = std::min(length, _buffer.size() - _filled);
+		std::memcpy(&_buffer[_filled], data, count);
+		_adler = Helpers::adler32(_adler, data, count);
+		_filled += count;
+		data += count;
+		length -= count;
+
+		if (_filled == _buffer.size()) {
+			// Keep the longest match worth of data after the compressed part, so matches are not cut short
+			compress(_filled - _maxMatch);
+			writeBlock(false);
+			slide();
+		}
+	}
+	return !_error;
+}
+
+/// <summary>
+/// Compress the rest of the data and end the stream
+/// </summary>
+/// <returns>Returns false if the sink failed</returns>
+bool Deflater::finish() {
+	compress(_filled);
+	writeBlock(true);
+
+	writeBits(0, (8 - _bitCount % 8) % 8);
+	for (int shift = 24; shift >= 0; shift -= 8) {
+		writeBits((_adler >> shift) & 0xFF, 8);
+	}
+	flushOutput(true);
+	return !_error;
+}
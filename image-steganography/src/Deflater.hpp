@@ -0,0 +1,183 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "Helpers.hpp"
+#include "Inflater.hpp"
+
+/// <summary>
+/// Class for compressing data into a zlib (deflate) stream, e.g. the image data of PNG
+/// Data is pushed in pieces of any size and the compressed stream is passed to the sink block by block,
+/// so only the 32 KB window and the current block are kept in memory
+/// </summary>
+class Deflater {
+private:
+	/// <summary>
+	/// Single symbol of the block - literal byte or match of the given length and distance
+	/// </summary>
+	struct Symbol {
+		uint16_t literalOrLength;
+		uint16_t distance; // 0 for literal
+	};
+
+	/// <summary>
+	/// Farthest distance a match could reach
+	/// </summary>
+	static constexpr size_t _windowSize = 32768;
+	/// <summary>
+	/// Number of new bytes compressed at once, the buffer holds them together with the window
+	/// </summary>
+	static constexpr size_t _blockSize = 131072;
+	/// <summary>
+	/// Longest match
+	/// </summary>
+	static constexpr size_t _maxMatch = 258;
+	static constexpr size_t _minMatch = 3;
+	static constexpr int _hashBits = 15;
+	/// <summary>
+	/// Largest number of symbols of a single block
+	/// </summary>
+	static constexpr size_t _maxSymbols = 32768;
+	/// <summary>
+	/// Number of compressed bytes passed to the sink at once
+	/// </summary>
+	static constexpr size_t _outputSize = 65536;
+
+	std::function<bool(const uint8_t*, size_t)> _sink;
+	/// <summary>
+	/// Number of positions checked for a match and length after which the search stops
+	/// </summary>
+	size_t _maxChain;
+	size_t _niceLength;
+	/// <summary>
+	/// Check if the match starting at the next byte is longer before taking the match
+	/// </summary>
+	bool _lazyMatching;
+
+	std::vector<uint8_t> _buffer;
+	/// <summary>
+	/// Number of bytes in the buffer and the position of the first byte that was not compressed yet
+	/// </summary>
+	size_t _filled = 0;
+	size_t _position = 0;
+	/// <summary>
+	/// Position of the first byte of the current block
+	/// </summary>
+	size_t _blockStart = 0;
+	/// <summary>
+	/// Last position with the hash of its 3 bytes, and the previous position with the same hash
+	/// </summary>
+	std::vector<int32_t> _head;
+	std::vector<int32_t> _previous;
+	std::vector<Symbol> _symbols;
+
+	std::string _output;
+	uint64_t _bitBuffer = 0;
+	int _bitCount = 0;
+	uint32_t _adler = 1;
+	bool _error = false;
+
+	/// <summary>
+	/// Hash of the 3 bytes starting at the position
+	/// </summary>
+	/// <param name="position">Position in the buffer</param>
+	/// <returns>Returns the hash</returns>
+	uint32_t hash(size_t position) const;
+	/// <summary>
+	/// Add the position to the hash chains
+	/// </summary>
+	/// <param name="position">Position in the buffer</param>
+	void insert(size_t position);
+	/// <summary>
+	/// Find the longest earlier match for the bytes starting at the position
+	/// </summary>
+	/// <param name="position">Position in the buffer</param>
+	/// <param name="end">End of the bytes that could be matched</param>
+	/// <param name="distance">Modifies the passed distance with the distance of the match</param>
+	/// <returns>Returns length of the match, 0 if there is none</returns>
+	size_t findMatch(size_t position, size_t end, size_t& distance) const;
+	/// <summary>
+	/// Turn the bytes of the buffer into symbols, from the current position up to the given end
+	/// Matches could reach past the end, up to the last byte in the buffer
+	/// </summary>
+	/// <param name="end">Position at which the compression stops</param>
+	void compress(size_t end);
+	/// <summary>
+	/// Drop the bytes that are farther than the window from the current position to make room for new data
+	/// The current block must be written before
+	/// </summary>
+	void slide();
+	/// <summary>
+	/// Write the bits to the output, least significant first
+	/// </summary>
+	/// <param name="bits">Bits to write</param>
+	/// <param name="count">Number of bits</param>
+	void writeBits(uint32_t bits, int count);
+	/// <summary>
+	/// Pass the whole bytes of the output to the sink
+	/// </summary>
+	/// <param name="force">Pass the output even if it is short</param>
+	void flushOutput(bool force);
+	/// <summary>
+	/// Write the symbols of the current block as one block - dynamic, fixed or stored, whichever is the shortest
+	/// </summary>
+	/// <param name="last">This is the last block of the stream</param>
+	void writeBlock(bool last);
+	/// <summary>
+	/// Write the symbols of the block with the given codes
+	/// </summary>
+	/// <param name="literalLengths">Code lengths of the literal / length code</param>
+	/// <param name="distanceLengths">Code lengths of the distance code</param>
+	void writeSymbols(const uint8_t* literalLengths, const uint8_t* distanceLengths);
+	/// <summary>
+	/// Calculate code lengths of the Huffman code for the frequencies, no code is longer than the limit
+	/// </summary>
+	/// <param name="frequencies">Frequency of every symbol</param>
+	/// <param name="count">Number of symbols</param>
+	/// <param name="limit">Longest code allowed</param>
+	/// <param name="lengths">Lengths to which the code will be saved</param>
+	static void buildLengths(const uint32_t* frequencies, int count, int limit, uint8_t* lengths);
+	/// <summary>
+	/// Calculate the canonical codes for the code lengths
+	/// Codes are stored from the most significant bit, so they are saved reversed to be written by writeBits
+	/// </summary>
+	/// <param name="lengths">Code lengths</param>
+	/// <param name="count">Number of symbols</param>
+	/// <param name="codes">Codes to which the result will be saved</param>
+	static void buildCodes(const uint8_t* lengths, int count, uint16_t* codes);
+	/// <summary>
+	/// Symbol of the length, 0 - 28 (257 - 285 in the code)
+	/// </summary>
+	static int lengthSymbol(size_t length);
+	/// <summary>
+	/// Symbol of the distance, 0 - 29
+	/// </summary>
+	static int distanceSymbol(size_t distance);
+
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="sink">Function that takes the compressed data, returns false to stop on error</param>
+	/// <param name="bestCompression">Search harder for matches - smaller output, slower</param>
+	Deflater(std::function<bool(const uint8_t*, size_t)> sink, bool bestCompression);
+	~Deflater() {}
+
+	/// <summary>
+	/// Add the data to the stream, full blocks are compressed and passed to the sink
+	/// </summary>
+	/// <param name="data">Data to compress</param>
+	/// <param name="length">Number of bytes</param>
+	/// <returns>Returns false if the sink failed</returns>
+	bool write(const uint8_t* data, size_t length);
+	/// <summary>
+	/// Compress the rest of the data and end the stream
+	/// </summary>
+	/// <returns>Returns false if the sink failed</returns>
+	bool finish();
+};
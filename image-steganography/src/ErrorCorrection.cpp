@@ -0,0 +1,350 @@
+#pragma once
+#include "ErrorCorrection.hpp"
+
+/// <summary>
+/// Constructor - builds the field and multiplication tables and the generator polynomials
+/// </summary>
+ErrorCorrection::ErrorCorrection() {
+	// GF(256) with primitive polynomial x^8 + x^4 + x^3 + x^2 + 1 and generator 2
+	int x = 1;
+	for (int i = 0; i < 255; i++) {
+		_exp[i] = (uint8_t)x;
+		_log[x] = (uint8_t)i;
+		x <<= 1;
+		if (x & 0x100) {
+			x ^= 0x11D;
+		}
+	}
+	for (int i = 255; i < 512; i++) {
+		_exp[i] = _exp[i - 255];
+	}
+	_log[0] = 0; // never used, log of 0 is undefined
+
+	_mul.assign(256 * 256, 0);
+	for (int a = 1; a < 256; a++) {
+		for (int b = 1; b < 256; b++) {
+			_mul[a * 256 + b] = _exp[_log[a] + _log[b]];
+		}
+	}
+
+	// g(x) = (x - 2^0) * (x - 2^1) * ... * (x - 2^(parity - 1))
+	for (int level = 1; level <= _maxLevel; level++) {
+		std::vector<uint8_t> generator = { 1 };
+		for (int i = 0; i < getParityLength(level); i++) {
+			generator = polyMultiply(generator, { 1, power(2, i) });
+		}
+		_generators[level] = generator;
+	}
+}
+
+uint8_t ErrorCorrection::divide(uint8_t a, uint8_t b) const {
+	if (a == 0) {
+		return 0;
+	}
+	return _exp[(_log[a] + 255 - _log[b]) % 255];
+}
+
+uint8_t ErrorCorrection::power(uint8_t x, int exponent) const {
+	int e = (_log[x] * exponent) % 255;
+	return _exp[e < 0 ? e + 255 : e];
+}
+
+uint8_t ErrorCorrection::inverse(uint8_t x) const {
+	return _exp[255 - _log[x]];
+}
+
+std::vector<uint8_t> ErrorCorrection::polyScale(const std::vector<uint8_t>& p, uint8_t x) const {
+	std::vector<uint8_t> result(p.size());
+	for (size_t i = 0; i < p.size(); i++) {
+		result[i] = multiply(p[i], x);
+	}
+	return result;
+}
+
+std::vector<uint8_t> ErrorCorrection::polyAdd(const std::vector<uint8_t>& p, const std::vector<uint8_t>& q) const {
+	// Polynomials are stored highest degree first, so they are aligned to the end
+	std::vector<uint8_t> result(std::max(p.size(), q.size()), 0);
+	for (size_t i = 0; i < p.size(); i++) {
+		result[i + result.size() - p.size()] = p[i];
+	}
+	for (size_t i = 0; i < q.size(); i++) {
+		result[i + result.size() - q.size()] ^= q[i];
+	}
+	return result;
+}
+
+std::vector<uint8_t> ErrorCorrection::polyMultiply(const std::vector<uint8_t>& p, const std::vector<uint8_t>& q) const {
+	std::vector<uint8_t> result(p.size() + q.size() - 1, 0);
+	for (size_t j = 0; j < q.size(); j++) {
+		for (size_t i = 0; i < p.size(); i++) {
+			result[i + j] ^= multiply(p[i], q[j]);
+		}
+	}
+	return result;
+}
+
+uint8_t ErrorCorrection::polyEval(const std::vector<uint8_t>& p, uint8_t x) const {
+	const uint8_t* row = &_mul[x * 256];
+	uint8_t y = 0;
+	for (uint8_t coefficient : p) {
+		y = row[y] ^ coefficient;
+	}
+	return y;
+}
+
+/// <summary>
+/// Number of parity bytes added to every block for the given level
+/// Every block could fix up to half of that many broken bytes
+/// </summary>
+/// <param name="level">Level of error correction - 0 (none) to 3</param>
+/// <returns>Returns number of parity bytes or -1 for unsupported level</returns>
+int ErrorCorrection::getParityLength(int level) {
+	switch (level) {
+	case 0:
+		return 0;
+	case 1:
+		return 8;
+	case 2:
+		return 16;
+	case 3:
+		return 32;
+	default:
+		return -1;
+	}
+}
+
+/// <summary>
+/// Number of message bytes in every full block, the last block of the message could be shorter
+/// Blocks follow each other, so the message could be fixed a block at a time as it is read
+/// </summary>
+/// <param name="level">Level of error correction - 0 (none) to 3</param>
+/// <returns>Returns number of message bytes or 0 if the message is not split into blocks</returns>
+size_t ErrorCorrection::getBlockDataLength(int level) {
+	const int parityLength = getParityLength(level);
+	return parityLength > 0 ? _blockLength - parityLength : 0;
+}
+
+/// <summary>
+/// Determine how many bytes the message takes after adding the parity bytes
+/// </summary>
+/// <param name="length">Length of the message</param>
+/// <param name="level">Level of error correction</param>
+/// <returns>Returns the length of the encoded message</returns>
+size_t ErrorCorrection::getEncodedLength(size_t length, int level) const {
+	const int parityLength = getParityLength(level);
+	if (parityLength <= 0) {
+		return length;
+	}
+
+	const size_t dataLength = _blockLength - parityLength;
+	const size_t blocks = (length + dataLength - 1) / dataLength;
+	return length + blocks * parityLength;
+}
+
+/// <summary>
+/// Determine the longest message that after adding the parity bytes fits in the given length
+/// </summary>
+/// <param name="encodedLength">Number of bytes available for the encoded message</param>
+/// <param name="level">Level of error correction</param>
+/// <returns>Returns the length of the longest message</returns>
+size_t ErrorCorrection::getMessageLength(size_t encodedLength, int level) const {
+	const int parityLength = getParityLength(level);
+	if (parityLength <= 0) {
+		return encodedLength;
+	}
+
+	// Full blocks plus whatever is left of the last, shortened block
+	const size_t remainder = encodedLength % _blockLength;
+	size_t length = (encodedLength / _blockLength) * (_blockLength - parityLength);
+	if (remainder > (size_t)parityLength) {
+		length += remainder - parityLength;
+	}
+	return length;
+}
+
+/// <summary>
+/// Calculate the parity bytes of a single block
+/// </summary>
+/// <param name="data">Data bytes of the block</param>
+/// <param name="length">Number of data bytes</param>
+/// <param name="parityLength">Number of parity bytes</param>
+/// <param name="parity">Pointer to which parity bytes will be saved</param>
+/// <param name="level">Level of error correction</param>
+void ErrorCorrection::encodeBlock(const uint8_t* data, size_t length, int parityLength, uint8_t* parity, int level) const {
+	const uint8_t* generator = _generators[level].data();
+	std::fill(parity, parity + parityLength, 0);
+
+	// Remainder of the division by the generator polynomial, kept in a shift register
+	for (size_t i = 0; i < length; i++) {
+		const uint8_t feedback = data[i] ^ parity[0];
+		std::copy(parity + 1, parity + parityLength, parity);
+		parity[parityLength - 1] = 0;
+		if (feedback != 0) {
+			const uint8_t* row = &_mul[feedback * 256];
+			for (int j = 0; j < parityLength; j++) {
+				parity[j] ^= row[generator[j + 1]];
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Find and fix the errors in a single block - data followed by parity
+/// </summary>
+/// <param name="block">Block that will be fixed in place</param>
+/// <param name="parityLength">Number of parity bytes at the end of the block</param>
+/// <returns>Returns number of bytes fixed or -1 if there are too many errors</returns>
+int ErrorCorrection::decodeBlock(std::vector<uint8_t>& block, int parityLength) const {
+	// Syndromes, with one leading 0 so the indexes match the error evaluator
+	std::vector<uint8_t> syndromes(parityLength + 1, 0);
+	bool hasErrors = false;
+	for (int i = 0; i < parityLength; i++) {
+		syndromes[i + 1] = polyEval(block, _exp[i]);
+		hasErrors |= syndromes[i + 1] != 0;
+	}
+	if (!hasErrors) { // Most blocks are intact
+		return 0;
+	}
+
+	// Berlekamp-Massey - find the error locator polynomial
+	std::vector<uint8_t> errorLocator = { 1 };
+	std::vector<uint8_t> oldLocator = { 1 };
+	for (int i = 0; i < parityLength; i++) {
+		const int k = i + 1;
+		uint8_t delta = syndromes[k];
+		for (size_t j = 1; j < errorLocator.size(); j++) {
+			delta ^= multiply(errorLocator[errorLocator.size() - 1 - j], syndromes[k - j]);
+		}
+
+		oldLocator.push_back(0);
+		if (delta != 0) {
+			if (oldLocator.size() > errorLocator.size()) {
+				std::vector<uint8_t> newLocator = polyScale(oldLocator, delta);
+				oldLocator = polyScale(errorLocator, inverse(delta));
+				errorLocator = newLocator;
+			}
+			errorLocator = polyAdd(errorLocator, polyScale(oldLocator, delta));
+		}
+	}
+	while (!errorLocator.empty() && errorLocator[0] == 0) {
+		errorLocator.erase(errorLocator.begin());
+	}
+
+	const int errors = (int)errorLocator.size() - 1;
+	if (errors * 2 > parityLength) {
+		return -1;
+	}
+
+	// Chien search - positions where the reversed locator has roots
+	std::vector<uint8_t> reversedLocator(errorLocator.rbegin(), errorLocator.rend());
+	std::vector<size_t> positions;
+	for (size_t i = 0; i < block.size(); i++) {
+		if (polyEval(reversedLocator, power(2, (int)i)) == 0) {
+			positions.push_back(block.size() - 1 - i);
+		}
+	}
+	if ((int)positions.size() != errors) {
+		return -1;
+	}
+
+	// Forney - calculate the magnitude of every error
+	std::vector<uint8_t> locator = { 1 };
+	std::vector<uint8_t> roots;
+	for (size_t position : positions) {
+		const int coefficient = (int)(block.size() - 1 - position);
+		roots.push_back(power(2, coefficient));
+		locator = polyMultiply(locator, { roots.back(), 1 });
+	}
+
+	std::vector<uint8_t> reversedSyndromes(syndromes.rbegin(), syndromes.rend());
+	std::vector<uint8_t> product = polyMultiply(reversedSyndromes, locator);
+	std::vector<uint8_t> evaluator(product.end() - (locator.size()), product.end());
+
+	for (size_t i = 0; i < roots.size(); i++) {
+		const uint8_t rootInverse = inverse(roots[i]);
+		uint8_t locatorPrime = 1;
+		for (size_t j = 0; j < roots.size(); j++) {
+			if (j != i) {
+				locatorPrime = multiply(locatorPrime, 1 ^ multiply(rootInverse, roots[j]));
+			}
+		}
+		if (locatorPrime == 0) {
+			return -1;
+		}
+
+		const uint8_t y = multiply(roots[i], polyEval(evaluator, rootInverse));
+		block[positions[i]] ^= divide(y, locatorPrime);
+	}
+
+	// Make sure the fixed block is a valid codeword
+	for (int i = 0; i < parityLength; i++) {
+		if (polyEval(block, _exp[i]) != 0) {
+			return -1;
+		}
+	}
+	return errors;
+}
+
+/// <summary>
+/// Add the parity bytes to every block of the message
+/// </summary>
+/// <param name="message">Message that is going to be encoded</param>
+/// <param name="level">Level of error correction</param>
+/// <returns>Returns the encoded message</returns>
+std::string ErrorCorrection::encode(const std::string& message, int level) const {
+	const int parityLength = getParityLength(level);
+	if (parityLength <= 0) {
+		return message;
+	}
+
+	const size_t dataLength = _blockLength - parityLength;
+	std::string encoded(getEncodedLength(message.length(), level), '\0');
+	const uint8_t* data = (const uint8_t*)message.data();
+	uint8_t* output = (uint8_t*)&encoded[0];
+	for (size_t offset = 0; offset < message.length(); offset += dataLength) {
+		const size_t length = std::min(dataLength, message.length() - offset);
+		std::copy(data + offset, data + offset + length, output);
+		encodeBlock(data + offset, length, parityLength, output + length, level);
+		output += length + parityLength;
+	}
+	return encoded;
+}
+
+/// <summary>
+/// Fix the errors in every block and strip the parity bytes
+/// </summary>
+/// <param name="encoded">Encoded message read from the image</param>
+/// <param name="length">Length of the original message</param>
+/// <param name="level">Level of error correction</param>
+/// <param name="message">Modifies the passed message with the decoded one</param>
+/// <returns>Returns number of bytes fixed or -1 if some block had too many errors</returns>
+long long ErrorCorrection::decode(const std::string& encoded, size_t length, int level, std::string& message) const {
+	const int parityLength = getParityLength(level);
+	if (parityLength < 0 || encoded.length() != getEncodedLength(length, level)) {
+		return -1;
+	}
+	if (parityLength == 0) {
+		message = encoded;
+		return 0;
+	}
+
+	const size_t dataLength = _blockLength - parityLength;
+	long long fixed = 0;
+	message.clear();
+	message.reserve(length);
+	std::vector<uint8_t> block;
+	size_t position = 0;
+	for (size_t offset = 0; offset < length; offset += dataLength) {
+		const size_t blockDataLength = std::min(dataLength, length - offset);
+		block.assign(encoded.begin() + position, encoded.begin() + position + blockDataLength + parityLength);
+		position += blockDataLength + parityLength;
+
+		const int errors = decodeBlock(block, parityLength);
+		if (errors < 0) {
+			return -1;
+		}
+		fixed += errors;
+		message.append((const char*)block.data(), blockDataLength);
+	}
+	return fixed;
+}
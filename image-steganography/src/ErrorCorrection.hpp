@@ -0,0 +1,116 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+/// <summary>
+/// Reed-Solomon code over GF(256) that lets the message survive flipped bits in the image
+/// Message is split into blocks of up to 255 bytes and each block gets its own parity bytes
+/// </summary>
+class ErrorCorrection {
+private:
+	/// <summary>
+	/// Length of the full Reed-Solomon block - data and parity
+	/// </summary>
+	static const int _blockLength = 255;
+	/// <summary>
+	/// Highest supported level of error correction
+	/// </summary>
+	static const int _maxLevel = 3;
+
+	/// <summary>
+	/// Powers of the generator, doubled so the sum of two logarithms never has to be wrapped
+	/// </summary>
+	uint8_t _exp[512];
+	/// <summary>
+	/// Logarithms of the field elements
+	/// </summary>
+	uint8_t _log[256];
+	/// <summary>
+	/// Full multiplication table, one row per multiplier
+	/// </summary>
+	std::vector<uint8_t> _mul;
+	/// <summary>
+	/// Generator polynomial for every level, highest degree first
+	/// </summary>
+	std::vector<uint8_t> _generators[_maxLevel + 1];
+
+	uint8_t multiply(uint8_t a, uint8_t b) const { return _mul[a * 256 + b]; }
+	uint8_t divide(uint8_t a, uint8_t b) const;
+	uint8_t power(uint8_t x, int exponent) const;
+	uint8_t inverse(uint8_t x) const;
+	std::vector<uint8_t> polyScale(const std::vector<uint8_t>& p, uint8_t x) const;
+	std::vector<uint8_t> polyAdd(const std::vector<uint8_t>& p, const std::vector<uint8_t>& q) const;
+	std::vector<uint8_t> polyMultiply(const std::vector<uint8_t>& p, const std::vector<uint8_t>& q) const;
+	uint8_t polyEval(const std::vector<uint8_t>& p, uint8_t x) const;
+
+	/// <summary>
+	/// Calculate the parity bytes of a single block
+	/// </summary>
+	/// <param name="data">Data bytes of the block</param>
+	/// <param name="length">Number of data bytes</param>
+	/// <param name="parityLength">Number of parity bytes</param>
+	/// <param name="parity">Pointer to which parity bytes will be saved</param>
+	/// <param name="level">Level of error correction</param>
+	void encodeBlock(const uint8_t* data, size_t length, int parityLength, uint8_t* parity, int level) const;
+	/// <summary>
+	/// Find and fix the errors in a single block - data followed by parity
+	/// </summary>
+	/// <param name="block">Block that will be fixed in place</param>
+	/// <param name="parityLength">Number of parity bytes at the end of the block</param>
+	/// <returns>Returns number of bytes fixed or -1 if there are too many errors</returns>
+	int decodeBlock(std::vector<uint8_t>& block, int parityLength) const;
+
+public:
+	/// <summary>
+	/// Constructor - builds the field and multiplication tables and the generator polynomials
+	/// </summary>
+	ErrorCorrection();
+	~ErrorCorrection() {}
+
+	/// <summary>
+	/// Number of parity bytes added to every block for the given level
+	/// Every block could fix up to half of that many broken bytes
+	/// </summary>
+	/// <param name="level">Level of error correction - 0 (none) to 3</param>
+	/// <returns>Returns number of parity bytes or -1 for unsupported level</returns>
+	static int getParityLength(int level);
+	/// <summary>
+	/// Number of message bytes in every full block, the last block of the message could be shorter
+	/// Blocks follow each other, so the message could be fixed a block at a time as it is read
+	/// </summary>
+	/// <param name="level">Level of error correction - 0 (none) to 3</param>
+	/// <returns>Returns number of message bytes or 0 if the message is not split into blocks</returns>
+	static size_t getBlockDataLength(int level);
+	/// <summary>
+	/// Determine how many bytes the message takes after adding the parity bytes
+	/// </summary>
+	/// <param name="length">Length of the message</param>
+	/// <param name="level">Level of error correction</param>
+	/// <returns>Returns the length of the encoded message</returns>
+	size_t getEncodedLength(size_t length, int level) const;
+	/// <summary>
+	/// Determine the longest message that after adding the parity bytes fits in the given length
+	/// </summary>
+	/// <param name="encodedLength">Number of bytes available for the encoded message</param>
+	/// <param name="level">Level of error correction</param>
+	/// <returns>Returns the length of the longest message</returns>
+	size_t getMessageLength(size_t encodedLength, int level) const;
+	/// <summary>
+	/// Add the parity bytes to every block of the message
+	/// </summary>
+	/// <param name="message">Message that is going to be encoded</param>
+	/// <param name="level">Level of error correction</param>
+	/// <returns>Returns the encoded message</returns>
+	std::string encode(const std::string& message, int level) const;
+	/// <summary>
+	/// Fix the errors in every block and strip the parity bytes
+	/// </summary>
+	/// <param name="encoded">Encoded message read from the image</param>
+	/// <param name="length">Length of the original message</param>
+	/// <param name="level">Level of error correction</param>
+	/// <param name="message">Modifies the passed message with the decoded one</param>
+	/// <returns>Returns number of bytes fixed or -1 if some block had too many errors</returns>
+	long long decode(const std::string& encoded, size_t length, int level, std::string& message) const;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include "Executor.hpp"
+
+/// <summary>
+/// Constructor, starts the threads
+/// </summary>
+/// <param name="threadCount">Number of threads, by default one for every core</param>
+ThreadPoolExecutor::ThreadPoolExecutor(size_t threadCount) {
+	threadCount = std::max<size_t>(1, threadCount);
+	for (size_t t = 0; t < threadCount; t++) {
+		_threads.emplace_back([this]() { workerLoop(); });
+	}
+}
+
+/// <summary>
+/// Destructor, runs the work that is left and joins the threads
+/// </summary>
+ThreadPoolExecutor::~ThreadPoolExecutor() {
+	{
+		std::lock_guard<std::mutex> lock(_queueMutex);
+		_stopping = true;
+	}
+	_queueCondition.notify_all();
+	for (std::thread& thread : _threads) {
+		thread.join();
+	}
+}
+
+/// <summary>
+/// Loop of every thread, runs the posted work until the executor is stopped and the queue is empty
+/// </summary>
+void ThreadPoolExecutor::workerLoop() {
+	while (true) {
+		std::function<void()> work;
+		{
+			std::unique_lock<std::mutex> lock(_queueMutex);
+			_queueCondition.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+			if (_queue.empty()) {
+				return;
+			}
+			work = std::move(_queue.front());
+			_queue.pop_front();
+		}
+		work();
+	}
+}
+
+/// <summary>
+/// Add the work to the queue, one of the threads runs it
+/// </summary>
+/// <param name="work">Work that will be run</param>
+void ThreadPoolExecutor::post(std::function<void()> work) {
+	{
+		std::lock_guard<std::mutex> lock(_queueMutex);
+		_queue.push_back(std::move(work));
+	}
+	_queueCondition.notify_one();
+}
+
+/// <summary>
+/// Number of threads of the executor
+/// </summary>
+/// <returns>Returns number of threads</returns>
+size_t ThreadPoolExecutor::size() const {
+	return _threads.size();
+}
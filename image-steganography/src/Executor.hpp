@@ -0,0 +1,86 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <coroutine>
+#include <algorithm>
+
+/// <summary>
+/// Interface of the executor on which the coroutines of the asynchronous operations are resumed
+/// Any scheduler of the application could be plugged in by implementing post
+/// </summary>
+class Executor {
+public:
+	/// <summary>
+	/// Awaitable that suspends the coroutine and resumes it on the executor
+	/// </summary>
+	struct ScheduleAwaiter {
+		Executor* executor;
+
+		bool await_ready() const noexcept {
+			return false;
+		}
+		void await_suspend(std::coroutine_handle<> handle) const {
+			executor->post([handle]() { handle.resume(); });
+		}
+		void await_resume() const noexcept {}
+	};
+
+	virtual ~Executor() {}
+
+	/// <summary>
+	/// Run the work on one of the threads of the executor, the work must not block for long
+	/// </summary>
+	/// <param name="work">Work that will be run</param>
+	virtual void post(std::function<void()> work) = 0;
+	/// <summary>
+	/// Move the awaiting coroutine onto the executor, e.g. co_await executor.schedule()
+	/// Work posted by others before runs first, so many coroutines share the threads of the executor
+	/// </summary>
+	/// <returns>Returns awaitable that resumes the coroutine on the executor</returns>
+	ScheduleAwaiter schedule() {
+		return ScheduleAwaiter{ this };
+	}
+};
+
+/// <summary>
+/// Executor with a fixed number of threads taking the work from a single queue in the order it was posted
+/// </summary>
+class ThreadPoolExecutor : public Executor {
+private:
+	std::mutex _queueMutex;
+	std::condition_variable _queueCondition;
+	std::deque<std::function<void()>> _queue;
+	std::vector<std::thread> _threads;
+	bool _stopping = false;
+
+	/// <summary>
+	/// Loop of every thread, runs the posted work until the executor is stopped and the queue is empty
+	/// </summary>
+	void workerLoop();
+
+public:
+	/// <summary>
+	/// Constructor, starts the threads
+	/// </summary>
+	/// <param name="threadCount">Number of threads, by default one for every core</param>
+	ThreadPoolExecutor(size_t threadCount = std::thread::hardware_concurrency());
+	/// <summary>
+	/// Destructor, runs the work that is left and joins the threads
+	/// </summary>
+	~ThreadPoolExecutor();
+
+	/// <summary>
+	/// Add the work to the queue, one of the threads runs it
+	/// </summary>
+	/// <param name="work">Work that will be run</param>
+	void post(std::function<void()> work) override;
+	/// <summary>
+	/// Number of threads of the executor
+	/// </summary>
+	/// <returns>Returns number of threads</returns>
+	size_t size() const;
+};
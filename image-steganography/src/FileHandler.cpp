@@ -3,6 +3,7 @@
 
 /// <summary>
 /// Read the image depending on the file type and return the image data
+/// The type is recognized from the first bytes of the file, so the extension does not matter
 /// </summary>
 /// <param name="filePath">Filepath from which the image data will be read from</param>
 /// <param name="image">Image to which data will be saved</param>
@@ -18,21 +19,66 @@ bool FileHandler::readImage(const std::string& filePath, Image& image) const {
 	std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(filePath);
 	image.last_modified_time = std::to_string(last_write_time.time_since_epoch().count());
 	
-	bool status = true;
-	if(Helpers::endsWith(filePath, ".bmp")) {
-		status = readBMPImage(file, image);
-	}
-	else if(Helpers::endsWith(filePath, ".ppm")) {
-		status = readPPMImage(file, image);
-	}
+	bool status = readImage(file, image);
 
 	// Close the file and return success
 	file.close();
 	return status;
 }
 
+/// <summary>
+/// Read the image from the stream, the type is recognized from its first bytes
+/// </summary>
+/// <param name="file">Input Stream of the image - opened file or its data in memory</param>
+/// <param name="image">Image to which data will be saved</param>
+/// <returns>Returns if the image has been successfully read</returns>
+bool FileHandler::readImage(std::istream& file, Image& image) const {
+	FileType fileType = sniffFileType(file);
+	bool status = ImageCodecs::dispatch(fileType, [&](auto codec) {
+		typedef typename decltype(codec)::type Codec;
+		if (!Codec::readHeader(file, image)) {
+			return false;
+		}
+		allocatePixels(image);
+		return Codec::readPixels(file, image);
+	});
+	if (!status) {
+		releaseImage(image);
+	}
+	return status;
+}
+
+/// <summary>
+/// Read only the header of the image depending on the file type, pixels are not read
+/// </summary>
+/// <param name="filePath">Filepath from which the header will be read from</param>
+/// <param name="image">Image to which header data will be saved</param>
+/// <returns>Returns if the header has been successfully read</returns>
+bool FileHandler::readImageHeader(const std::string& filePath, Image& image) const {
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	return readImageHeader(file, image);
+}
+
+/// <summary>
+/// Read only the header of the image from the stream, pixels are not read
+/// </summary>
+/// <param name="file">Input Stream of the image - opened file or its data in memory</param>
+/// <param name="image">Image to which header data will be saved</param>
+/// <returns>Returns if the header has been successfully read</returns>
+bool FileHandler::readImageHeader(std::istream& file, Image& image) const {
+	FileType fileType = sniffFileType(file);
+	return ImageCodecs::dispatch(fileType, [&](auto codec) {
+		return decltype(codec)::type::readHeader(file, image);
+	});
+}
+
 /// <summary>
 /// Save the modified pixels data with encoded message to the image
+/// The image is saved in the format it has been read from
 /// </summary>
 /// <param name="filePath">Filepath to which the modfied image data will be saved</param>
 /// <param name="image">Image that holds the modfied data of the image</param>
@@ -44,13 +90,7 @@ bool FileHandler::writeImage(const std::string& filePath, const Image& image) co
 		return false;
 	}
 
-	bool status = true;
-	if (Helpers::endsWith(filePath, ".bmp")) {
-		status = writeBMPImage(file, image);
-	}
-	else if (Helpers::endsWith(filePath, ".ppm")) {
-		status = writePPMImage(file, image);
-	}
+	bool status = writeImage(file, image);
 
 	// Close the file and return success
 	file.close();
@@ -58,189 +98,307 @@ bool FileHandler::writeImage(const std::string& filePath, const Image& image) co
 }
 
 /// <summary>
-/// Helper method for writeImage that saves the modfied image data to a .ppm file
+/// Save the image to the stream in the format it has been read from
 /// </summary>
-/// <param name="file">Input File Stream that has opened the requested .ppm file</param>
-/// <param name="image">Image from which data will be read from</param>
-/// <returns>Returns if the .ppm image has been successfully saved</returns>
-bool FileHandler::writePPMImage(std::ofstream& file, const Image& image) const {
-	file << image.ppm.magicNumber << std::endl;
-	if (image.ppm.comments != "") {
-		file << image.ppm.comments;
-	}
-	file << image.width << " " << image.height << std::endl;
-	file << image.ppm.max_value << std::endl;
-	
-	const size_t size = image.width * image.height * 3;
-	file.write((char*)image.pixels, size);
-
-	// Close the file and return success
-	file.close();
-	return true;
+/// <param name="file">Output Stream to which the image is saved - opened file or a buffer in memory</param>
+/// <param name="image">Image that holds the modfied data of the image</param>
+/// <returns>Returns if the image has been successfully saved</returns>
+bool FileHandler::writeImage(std::ostream& file, const Image& image) const {
+	return ImageCodecs::dispatch(image.fileType, [&](auto codec) {
+		return decltype(codec)::type::write(file, image);
+	});
 }
 
 /// <summary>
-/// Helper method for writeImage that saves the modfied image data to a .bmp file
+/// Read the first bytes of the stream and recognize its format, the stream is left at its beginning
 /// </summary>
-/// <param name="file">Input File Stream that has opened the requested .bmp file</param>
-/// <param name="image">Image from which data will be read from</param>
-/// <returns>Returns if the .bmp image has been successfully saved</returns>
-bool FileHandler::writeBMPImage(std::ofstream& file, const Image& image) const {
-	uint16_t fileType = image.fileType;
-	file.write((char*)&fileType, sizeof(fileType));
-
-	file.write((char*)&image.fileSize, sizeof(image.fileSize));
-
-	file.write((char*)&image.bmp.reserved, sizeof(image.bmp.reserved));
+/// <param name="file">Input Stream of the image - opened file or its data in memory</param>
+/// <returns>Returns type of the image, UNKNOWN if no codec recognizes it</returns>
+FileType FileHandler::sniffFileType(std::istream& file) const {
+	uint8_t bytes[ImageCodecs::sniffLength];
+	file.read((char*)bytes, sizeof(bytes));
+	size_t length = (size_t)file.gcount();
+	file.clear();
+	file.seekg(0);
+	return ImageCodecs::sniff(bytes, length);
+}
 
-	file.write((char*)&image.dataOffset, sizeof(image.dataOffset));
+/// <summary>
+/// Encode the message into the image that has been read, the image must be a supported carrier without another message
+/// </summary>
+/// <param name="image">Image read with its pixels</param>
+/// <param name="message">Message that will be encoded</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <returns>Returns true if the message has been encoded</returns>
+bool FileHandler::encodeReadImage(Image& image, const std::string& message, const EncodeOptions& options) const {
+	// Decode the message length from the first pixel
+	if (!_imageHandler->isSupportedCarrier(image) || _imageHandler->checkIfImageIsEncoded(image)) {
+		return false;
+	}
 
-	// write the header size
-	file.write((char*)&image.bmp.infoHeaderSize, sizeof(image.bmp.infoHeaderSize));
+	// Encode message in image
+	image.png.bestCompression = options.bestCompression;
+	return _imageHandler->encodeMessageInImage(image, message, options);
+}
 
-	// write the image width and height
-	file.write((char*)&image.width, sizeof(image.width));
-	file.write((char*)&image.height, sizeof(image.height));
+/// <summary>
+/// Analyze the image that has been read and score how likely it holds a message hidden by any program
+/// </summary>
+/// <param name="filePath">Filepath of the image, saved to the report</param>
+/// <param name="image">Image read with its pixels</param>
+/// <param name="report">Modifies the passed report with the result of the analysis</param>
+/// <param name="parallel">Analyze the parts of the image in parallel</param>
+/// <returns>Returns true if the image could be analyzed</returns>
+bool FileHandler::analyzeReadImage(const std::string& filePath, const Image& image, SteganalysisReport& report, bool parallel) const {
+	if (!_imageHandler->isSupportedCarrier(image)) {
+		return false;
+	}
 
-	file.write((char*)&image.bmp.planes, sizeof(image.bmp.planes));
-	// write the bits per pixel
-	file.write((char*)&image.bitsPerPixel, sizeof(image.bitsPerPixel));
+	report = _steganalysisHandler->analyzeImage(image, parallel);
+	report.filePath = filePath;
+	report.ownMarker = _imageHandler->checkIfImageIsEncoded(image);
+	report.suspicious = report.suspicious || report.ownMarker;
+	return true;
+}
 
-	file.write((char*)&image.bmp.compression, sizeof(image.bmp.compression));
-	file.write((char*)&image.dataSize, sizeof(image.dataSize));
-	file.write((char*)&image.bmp.xPixelsPerMeter, sizeof(image.bmp.xPixelsPerMeter));
-	file.write((char*)&image.bmp.yPixelsPerMeter, sizeof(image.bmp.yPixelsPerMeter));
-	file.write((char*)&image.bmp.colorsInColorTable, sizeof(image.bmp.colorsInColorTable));
-	file.write((char*)&image.bmp.importantColorCount, sizeof(image.bmp.importantColorCount));
-	
-	// Seek to the pixel data
-	file.seekp(image.dataOffset);
-	// Write the pixel data to the file
-	const int paddingAmount = (4 - (image.width * (image.bitsPerPixel / 8)) % 4) % 4;
-	unsigned char bmpPad[3] = {0, 0, 0};
-	
-	int bytesPerPixel = image.bitsPerPixel / 8;
-	for (int y = 0; y < image.height; ++y) {
-		for (int x = 0; x < image.width; ++x) {
-			file.write((char*)&image.pixels[y * image.width + x], bytesPerPixel);
+/// <summary>
+/// Write only the changed channels to the positions of the file they have been read from
+/// </summary>
+/// <param name="filePath">Filepath from which the image has been read</param>
+/// <param name="image">Image with the modified pixels</param>
+/// <param name="channels">Index of every changed channel in ascending order</param>
+/// <returns>Returns false if the format does not store the pixels at fixed positions or the file could not be written</returns>
+bool FileHandler::writeChangedChannels(const std::string& filePath, const Image& image, const std::vector<size_t>& channels) const {
+	// Channels close to each other are joined into a single write, unless padding of the file lies between them
+	struct Run {
+		uint64_t offset;
+		size_t first;
+		size_t last;
+	};
+	std::vector<Run> runs;
+	bool mapped = ImageCodecs::dispatch(image.fileType, [&](auto codec) {
+		uint64_t offset = 0;
+		uint64_t lastOffset = 0;
+		for (size_t channel : channels) {
+			if (!decltype(codec)::type::getChannelOffset(image, channel, offset)) {
+				return false;
+			}
+			if (!runs.empty() && channel - runs.back().last <= _inPlaceGap && offset - lastOffset == channel - runs.back().last) {
+				runs.back().last = channel;
+			}
+			else {
+				runs.push_back({ offset, channel, channel });
+			}
+			lastOffset = offset;
 		}
-		file.write(reinterpret_cast<char*>(bmpPad), paddingAmount);
+		return true;
+	});
+	if (!mapped) {
+		return false;
 	}
 
-	// Close the file and return success
-	return true;
+	std::fstream file(filePath, std::ios::in | std::ios::out | std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	const char* bytes = (const char*)image.pixels;
+	for (const Run& run : runs) {
+		file.seekp(run.offset);
+		file.write(bytes + run.first, run.last - run.first + 1);
+	}
+	return file.good();
 }
 
 /// <summary>
-/// Helper method for readImage that reads the image data from a .ppm file
+/// Write every pixel to the position of the file it has been read from, the header is left untouched
 /// </summary>
-/// <param name="file">Input File Stream that has opened the requested .ppm file</param>
-/// <param name="image">Image to which data will be saved</param>
-/// <returns>Returns if the .ppm image has been successfully read</returns>
-bool FileHandler::readPPMImage(std::ifstream& file, Image& image) const {
-	// Read the BMP file header
-	image.fileType = FileType::PPM;
-	image.bitsPerPixel = 24;
-	
-	PPMImage ppm;
-	std::getline(file, ppm.magicNumber);
-	if (ppm.magicNumber != "P6" && ppm.magicNumber != "P3") {
-		std::cout << "Error: Invalid PPM format" << std::endl;
-		return false;
-	}
-
-	// Read the next three lines and extract the image width, height, and maximum value
-	std::string line;
-	for (int i = 0; i < 2; ++i) {
-		std::getline(file, line);
-		std::stringstream ss(line);
-		if (line[0] == '#') {
-			ppm.comments += line + "\n";
-			// Skip commented lines
-			--i;
-			continue;
-		}
-		if (i == 0) {
-			// Extract the width and height from the same line
-			ss >> image.width >> image.height;
-			ppm.width = image.width;
-			ppm.height = image.height;
+/// <param name="filePath">Filepath from which the image has been read</param>
+/// <param name="image">Image with the modified pixels</param>
+/// <returns>Returns false if the format does not store the pixels at fixed positions or the file could not be written</returns>
+bool FileHandler::writePixels(const std::string& filePath, const Image& image) const {
+	const size_t rowLength = image.getRowLength();
+	std::vector<uint64_t> offsets(image.height);
+	bool mapped = ImageCodecs::dispatch(image.fileType, [&](auto codec) {
+		for (size_t y = 0; y < image.height; y++) {
+			if (!decltype(codec)::type::getChannelOffset(image, y * rowLength, offsets[y])) {
+				return false;
+			}
 		}
-		else if (i == 1) {
-			// Extract the maximum value
-			ss >> ppm.max_value;
+		return true;
+	});
+	if (!mapped) {
+		return false;
+	}
+
+	std::fstream file(filePath, std::ios::in | std::ios::out | std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	// Rows following each other in the file are written without seeking, e.g. every row of .ppm
+	const char* bytes = (const char*)image.pixels;
+	for (size_t y = 0; y < image.height; y++) {
+		if (y == 0 || offsets[y] != offsets[y - 1] + rowLength) {
+			file.seekp(offsets[y]);
 		}
+		file.write(bytes + y * rowLength, rowLength);
 	}
-	
-	image.ppm = ppm;
-	image.dataSize = image.width * image.height * sizeof(Pixel);
-	image.fileSize = image.dataSize + sizeof(image.ppm.magicNumber);
-	image.fileSize += sizeof(image.ppm.height) + sizeof(image.ppm.width) + sizeof(image.ppm.max_value);
-	image.fileSize += sizeof(image.ppm.comments);
-
-	// Allocate memory for the pixels
-	image.pixels = new Pixel[image.width * image.height];
-	
-	const size_t size = image.width * image.height * 3;
-	// Read the pixel data
-	file.read((char*)image.pixels, size);
+	return file.good();
+}
 
-	return true;
+/// <summary>
+/// Random seed for the sanitization, different for every call
+/// </summary>
+/// <returns>Returns the seed</returns>
+uint64_t FileHandler::createSeed() const {
+	std::random_device device;
+	const uint64_t time = (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+	return (((uint64_t)device() << 32) | device()) ^ time;
 }
 
 /// <summary>
-/// Helper method for readImage that reads the image data from a .bmp file
+/// Read the bytes of the file before the pixel data, only for formats storing the pixels at fixed positions
 /// </summary>
-/// <param name="file">Input File Stream that has opened the requested .bmp file</param>
-/// <param name="image">Image to which data will be saved</param>
-/// <returns>Returns if the .bmp image has been successfully read</returns>
-bool FileHandler::readBMPImage(std::ifstream& file, Image& image) const {
-	BMPImage bmpImage;
-	// Read the BMP file header
-	image.fileType = FileType::BMP;
-	uint16_t fileType;
-	file.read((char*)&fileType, sizeof(fileType));
-	
-	file.read((char*)&image.fileSize, sizeof(image.fileSize));
+/// <param name="filePath">Filepath of the image</param>
+/// <param name="image">Image read from the file, only header data is used</param>
+/// <param name="header">Modifies the passed data with the bytes before the first pixel</param>
+/// <returns>Returns false if the pixels have no fixed position or the file could not be read</returns>
+bool FileHandler::readRawHeader(const std::string& filePath, const Image& image, std::string& header) const {
+	uint64_t offset = 0;
+	bool mapped = ImageCodecs::dispatch(image.fileType, [&](auto codec) {
+		return decltype(codec)::type::getChannelOffset(image, 0, offset);
+	});
+	std::ifstream file(filePath, std::ios::binary);
+	if (!mapped || !file.is_open()) {
+		return false;
+	}
 
-	file.read((char*)&bmpImage.reserved, sizeof(bmpImage.reserved));
+	header.resize((size_t)offset);
+	file.read(&header[0], (std::streamsize)offset);
+	return (uint64_t)file.gcount() == offset;
+}
 
-	file.read((char*)&image.dataOffset, sizeof(image.dataOffset));
+/// <summary>
+/// Read only the rows of the region, the pixels of the region are saved to a separate image
+/// For .bmp and .ppm only the bytes of the region are read, .png has no fixed positions so it is read whole
+/// </summary>
+/// <param name="filePath">Filepath of the image</param>
+/// <param name="region">Region chosen by the user, modified with the resolved width</param>
+/// <param name="image">Modifies the passed image with the header data, pixels are read only for .png</param>
+/// <param name="band">Modifies the passed image with the pixels of the region</param>
+/// <returns>Returns false if the region does not fit in the image or the file could not be read, nothing is left to release then</returns>
+bool FileHandler::readRegionPixels(const std::string& filePath, RegionOfInterest& region, Image& image, Image& band) const {
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open() || !readImageHeader(file, image) || !_imageHandler->isSupportedCarrier(image)
+		|| !_imageHandler->resolveRegion(image, region)) {
+		return false;
+	}
 
-	// Read the header size
-	file.read((char*)&bmpImage.infoHeaderSize, sizeof(bmpImage.infoHeaderSize));
+	const size_t rowLength = (size_t)region.width * image.channels;
+	std::vector<uint64_t> offsets(region.height);
+	bool mapped = ImageCodecs::dispatch(image.fileType, [&](auto codec) {
+		for (size_t r = 0; r < region.height; r++) {
+			const size_t channel = ((size_t)(region.y + r) * image.width + region.x) * image.channels;
+			if (!decltype(codec)::type::getChannelOffset(image, channel, offsets[r])) {
+				return false;
+			}
+		}
+		return true;
+	});
 
-	// Read the image width and height
-	file.read((char*)&image.width, sizeof(image.width));
-	file.read((char*)&image.height, sizeof(image.height));
+	// Band shares the header data, only its size differs
+	band = image;
+	band.width = region.width;
+	band.height = region.height;
+	band.pixels = nullptr;
+	if (!mapped) {
+		file.seekg(0);
+		if (!readImage(file, image)) {
+			return false;
+		}
+		allocatePixels(band);
+		for (size_t r = 0; r < region.height; r++) {
+			std::memcpy(band.pixels + r * rowLength, image.pixels + ((size_t)(region.y + r) * image.width + region.x) * image.channels, rowLength);
+		}
+		return true;
+	}
 
-	file.read((char*)&bmpImage.planes, sizeof(bmpImage.planes));
-	// Read the bits per pixel
-	file.read((char*)&image.bitsPerPixel, sizeof(image.bitsPerPixel));
+	allocatePixels(band);
+	char* bytes = (char*)band.pixels;
+	for (size_t r = 0; r < region.height; r++) {
+		file.seekg(offsets[r]);
+		file.read(bytes + r * rowLength, rowLength);
+	}
+	if (!file.good()) {
+		releaseImage(band);
+		return false;
+	}
+	return true;
+}
 
-	file.read((char*)&bmpImage.compression, sizeof(bmpImage.compression));
-	file.read((char*)&image.dataSize, sizeof(image.dataSize));
-	file.read((char*)&bmpImage.xPixelsPerMeter, sizeof(bmpImage.xPixelsPerMeter));
-	file.read((char*)&bmpImage.yPixelsPerMeter, sizeof(bmpImage.yPixelsPerMeter));
-	file.read((char*)&bmpImage.colorsInColorTable, sizeof(bmpImage.colorsInColorTable));
-	file.read((char*)&bmpImage.importantColorCount, sizeof(bmpImage.importantColorCount));
+/// <summary>
+/// Write the pixels of the region back to the positions of the file they have been read from
+/// Bytes outside the region are left untouched, so separate regions of a .bmp or .ppm could be written at the same time
+/// </summary>
+/// <param name="filePath">Filepath of the image</param>
+/// <param name="region">Region resolved by readRegionPixels</param>
+/// <param name="image">Image read by readRegionPixels, a .png is saved whole with the pixels of the region copied in</param>
+/// <param name="band">Pixels of the region</param>
+/// <returns>Returns true if the region has been saved</returns>
+bool FileHandler::writeRegionPixels(const std::string& filePath, const RegionOfInterest& region, Image& image, const Image& band) const {
+	const size_t rowLength = (size_t)region.width * image.channels;
+	if (image.pixels != nullptr) {
+		for (size_t r = 0; r < region.height; r++) {
+			std::memcpy(image.pixels + ((size_t)(region.y + r) * image.width + region.x) * image.channels, band.pixels + r * rowLength, rowLength);
+		}
+		return writeImage(filePath, image);
+	}
 
-	image.pixels = new Pixel[image.width * image.height];
-	image.bmp = bmpImage;
-	
-	const int paddingAmount = (4 - (image.width * (image.bitsPerPixel / 8)) % 4) % 4;
+	std::fstream file(filePath, std::ios::in | std::ios::out | std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
 
-	file.seekg(image.dataOffset);
-	int bytesPerPixel = image.bitsPerPixel / 8;
-	for (int y = 0; y < image.height; ++y) {
-		for (int x = 0; x < image.width; ++x) {
-			file.read((char*)&image.pixels[y * image.width + x], bytesPerPixel);
+	const char* bytes = (const char*)band.pixels;
+	bool mapped = ImageCodecs::dispatch(image.fileType, [&](auto codec) {
+		for (size_t r = 0; r < region.height; r++) {
+			uint64_t offset = 0;
+			const size_t channel = ((size_t)(region.y + r) * image.width + region.x) * image.channels;
+			if (!decltype(codec)::type::getChannelOffset(image, channel, offset)) {
+				return false;
+			}
+			file.seekp(offset);
+			file.write(bytes + r * rowLength, rowLength);
 		}
-		// Account for each padding after each row
-		file.ignore(paddingAmount);
+		return true;
+	});
+	return mapped && file.good();
+}
+
+/// <summary>
+/// Encode the message into the region of the image, only the region is read and written
+/// </summary>
+/// <param name="filePath">Filepath of the image</param>
+/// <param name="message">Message that will be encoded</param>
+/// <param name="options">Options chosen for encoding with the region</param>
+/// <returns>Returns true if the message has been encoded and saved</returns>
+bool FileHandler::encodeMessageInRegion(const std::string& filePath, const std::string& message, const EncodeOptions& options) const {
+	// Region is recorded with the message resolved, so the same region is found when it is decoded
+	EncodeOptions regionOptions = options;
+	Image image;
+	Image band;
+	if (!readRegionPixels(filePath, regionOptions.region, image, band)) {
+		return false;
 	}
 
-	return true;
+	image.png.bestCompression = options.bestCompression;
+	bool status = !_imageHandler->checkIfImageIsEncoded(band)
+		&& _imageHandler->encodeMessageInImage(band, message, regionOptions)
+		&& writeRegionPixels(filePath, regionOptions.region, image, band);
+	releaseImage(band);
+	releaseImage(image);
+	return status;
 }
 
 /// <summary>
@@ -248,30 +406,136 @@ bool FileHandler::readBMPImage(std::ifstream& file, Image& image) const {
 /// </summary>
 /// <param name="filePath">Filepath to which the modfied image data will be saved to</param>
 /// <param name="message"></param>
+/// <param name="options">Options chosen for encoding, by default the message is encoded without extended options</param>
 /// <returns></returns>
-bool FileHandler::encodeMessage(const std::string& filePath, const std::string& message) const {
-	Image image;
-	if (!readImage(filePath, image)) {
-		return false;
+bool FileHandler::encodeMessage(const std::string& filePath, const std::string& message, const EncodeOptions& options) const {
+	if (options.region.height > 0) {
+		return encodeMessageInRegion(filePath, message, options);
 	}
 
-	// Decode the message length from the first pixel
-	if (_imageHandler->checkIfImageIsEncoded(image)) {
+	Image image;
+	if (!readImage(filePath, image)) {
 		return false;
 	}
 
-	// Encode message in image
-	bool status = _imageHandler->encodeMessageInImage(image, message);
+	bool status = encodeReadImage(image, message, options);
 
 	// Save the encoded message to image
 	if (!status || !writeImage(filePath, image)) {
+		releaseImage(image);
 		return false;
 	}
 	
 	// Return success
+	releaseImage(image);
 	return true;
 }
 
+/// <summary>
+/// Replace the message stored in the image with the new one, only the channels whose LSB differs are modified
+/// For .bmp and .ppm only the changed bytes are written to the file, .png is saved whole
+/// </summary>
+/// <param name="filePath">Filepath of the image, it could hold a message or not</param>
+/// <param name="message">Message that will replace the stored one</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <param name="changedBytes">Modifies the passed count with the number of bytes of the pixels that changed</param>
+/// <returns>Returns true if the message has been encoded and saved</returns>
+bool FileHandler::updateMessage(const std::string& filePath, const std::string& message, const EncodeOptions& options, size_t& changedBytes) const {
+	Image image;
+	if (!readImage(filePath, image)) {
+		return false;
+	}
+
+	std::vector<size_t> channels;
+	image.png.bestCompression = options.bestCompression;
+	bool status = _imageHandler->isSupportedCarrier(image) && _imageHandler->updateMessageInImage(image, message, options, channels);
+	changedBytes = channels.size();
+
+	// Same message encoded again changes nothing, the file is left untouched
+	if (status && !channels.empty() && !writeChangedChannels(filePath, image, channels)) {
+		status = writeImage(filePath, image);
+	}
+	releaseImage(image);
+	return status;
+}
+
+/// <summary>
+/// Replace the lowest bits of every channel with random bits, which wipes any message hidden in them
+/// For .bmp and .ppm only the pixels are written to the file in place, .png is saved whole
+/// </summary>
+/// <param name="filePath">Filepath of the image</param>
+/// <param name="bitCount">Number of the lowest bits of every channel that are replaced</param>
+/// <returns>Returns true if the image has been sanitized and saved</returns>
+bool FileHandler::sanitizeImage(const std::string& filePath, int bitCount) const {
+	Image image;
+	if (!readImage(filePath, image)) {
+		return false;
+	}
+
+	bool status = _imageHandler->isSupportedCarrier(image) && _sanitizeHandler->sanitizeImage(image, bitCount, createSeed());
+	if (status && !writePixels(filePath, image)) {
+		status = writeImage(filePath, image);
+	}
+	releaseImage(image);
+	return status;
+}
+
+/// <summary>
+/// Sanitize every image, the images are processed in parallel
+/// Files are read and written back through the asynchronous I/O handler
+/// </summary>
+/// <param name="filePaths">Filepaths of the images</param>
+/// <param name="bitCount">Number of the lowest bits of every channel that are replaced</param>
+/// <param name="statuses">Modifies the passed statuses with the result for every image</param>
+void FileHandler::sanitizeImages(const std::vector<std::string>& filePaths, int bitCount, std::vector<char>& statuses) const {
+	const uint64_t seed = createSeed();
+	_asyncIOHandler->processFiles(filePaths, 0, [&](size_t i, std::string& data, std::string& output) {
+		Image image;
+		MemoryStream stream((const uint8_t*)data.data(), data.size());
+		if (!readImage(stream, image)) {
+			return false;
+		}
+
+		// One image per thread, so the bands of a single image are not split further
+		bool status = _imageHandler->isSupportedCarrier(image) && _sanitizeHandler->sanitizeImage(image, bitCount, seed ^ (i * 0x9E3779B97F4A7C15ULL), false);
+		if (status) {
+			std::ostringstream sanitized;
+			status = writeImage(sanitized, image);
+			output = sanitized.str();
+		}
+		releaseImage(image);
+		return status;
+	}, statuses);
+}
+
+/// <summary>
+/// Encode every message into its image and save the modified images, the images are processed in parallel
+/// Files are read and written through the asynchronous I/O handler
+/// </summary>
+/// <param name="filePaths">Filepaths of the images</param>
+/// <param name="messages">Message for every image</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <param name="statuses">Modifies the passed statuses with the result for every image</param>
+void FileHandler::encodeMessages(const std::vector<std::string>& filePaths, const std::vector<std::string>& messages,
+	const EncodeOptions& options, std::vector<char>& statuses) const {
+	_asyncIOHandler->processFiles(filePaths, 0, [&](size_t i, std::string& data, std::string& output) {
+		Image image;
+		MemoryStream stream((const uint8_t*)data.data(), data.size());
+		if (!readImage(stream, image)) {
+			return false;
+		}
+
+		bool status = encodeReadImage(image, messages[i], options);
+		if (status) {
+			std::ostringstream encoded;
+			status = writeImage(encoded, image);
+			output = encoded.str();
+		}
+		releaseImage(image);
+		return status;
+	}, statuses);
+}
+
 /// <summary>
 /// Retrieves the encoded message from the image under the given filepath
 /// </summary>
@@ -288,11 +552,181 @@ std::string FileHandler::decodeMessage(const std::string& filePath) const {
 
 	// Decode the message length from the first pixel
 	if (!_imageHandler->checkIfImageIsEncoded(image)) {
+		releaseImage(image);
 		return "Image is Not Encoded";
 	}
 	
 	// Return the retrieved message
-	return _imageHandler->decodeMessageInImage(image);
+	std::string message = _imageHandler->decodeMessageInImage(image);
+	releaseImage(image);
+	return message;
+}
+
+/// <summary>
+/// Retrieves the encoded message from the image under the given filepath
+/// Unlike decodeMessage it reports failure through the return value instead of the message
+/// </summary>
+/// <param name="filePath">Filepath from which the image data will be read from</param>
+/// <param name="message">Modifies the passed message with the decoded one</param>
+/// <returns>Returns true if the image holds an encoded message and it was decoded</returns>
+bool FileHandler::readEncodedMessage(const std::string& filePath, std::string& message) const {
+	Image image;
+	if (!readImage(filePath, image)) {
+		releaseImage(image);
+		return false;
+	}
+
+	bool status = _imageHandler->checkIfImageIsEncoded(image);
+	if (status) {
+		message = _imageHandler->decodeMessageInImage(image);
+	}
+
+	releaseImage(image);
+	return status;
+}
+
+/// <summary>
+/// Retrieves the message encoded into the region of the image, only the region is read
+/// </summary>
+/// <param name="filePath">Filepath from which the image data will be read from</param>
+/// <param name="region">Region the message has been encoded into</param>
+/// <param name="message">Modifies the passed message with the decoded one</param>
+/// <returns>Returns true if the region holds an encoded message and it was decoded</returns>
+bool FileHandler::decodeMessageInRegion(const std::string& filePath, const RegionOfInterest& region, std::string& message) const {
+	RegionOfInterest resolved = region;
+	Image image;
+	Image band;
+	if (!readRegionPixels(filePath, resolved, image, band)) {
+		return false;
+	}
+
+	message = _imageHandler->decodeRegionMessage(band, resolved);
+	bool status = !message.empty();
+	releaseImage(band);
+	releaseImage(image);
+	return status;
+}
+
+/// <summary>
+/// Retrieve the encoded message and pass it to the sink in chunks as it is extracted, the pixels are not held whole
+/// For .bmp, .ppm, uncompressed .tga and 8 bit .pgm only the rows up to the end of the message are read, a window at a time
+/// Formats without fixed positions of the channels are read whole, the message is still passed on in chunks
+/// </summary>
+/// <param name="filePath">Filepath from which the image data will be read from</param>
+/// <param name="sink">Sink receiving the message, the first chunk is passed on before the rest of the image is read</param>
+/// <param name="chunkLength">Number of bytes passed to the sink at once, only the last chunk could be shorter</param>
+/// <returns>Returns true if the image holds an encoded message and all of it has been passed to the sink</returns>
+bool FileHandler::streamEncodedMessage(const std::string& filePath, const ImageHandler::PayloadSink& sink, size_t chunkLength) const {
+	std::ifstream file(filePath, std::ios::binary);
+	Image image;
+	if (!file.is_open() || !readImageHeader(file, image) || !_imageHandler->isSupportedCarrier(image)) {
+		return false;
+	}
+
+	uint64_t offset = 0;
+	auto getOffset = [&](size_t channel) {
+		return ImageCodecs::dispatch(image.fileType, [&](auto codec) {
+			return decltype(codec)::type::getChannelOffset(image, channel, offset);
+		});
+	};
+	const bool mapped = getOffset(0);
+	if (!mapped) {
+		file.clear();
+		file.seekg(0);
+		if (!readImage(file, image)) {
+			return false;
+		}
+	}
+
+	// Channels are pulled in order, rows of the file are read in pieces and seeked only over the padding between them
+	const size_t channelCount = image.getChannelCount();
+	const size_t rowLength = image.getRowLength();
+	size_t nextChannel = 0;
+	uint64_t position = UINT64_MAX;
+	ImageHandler::ChannelSource source = [&](uint8_t* channels, size_t count) {
+		if (nextChannel + count > channelCount) {
+			return false;
+		}
+		if (!mapped) {
+			std::memcpy(channels, image.pixels + nextChannel, count);
+			nextChannel += count;
+			return true;
+		}
+		while (count > 0) {
+			const size_t length = std::min(count, rowLength - nextChannel % rowLength);
+			if (!getOffset(nextChannel)) {
+				return false;
+			}
+			if (position != offset) {
+				file.seekg(offset);
+			}
+			file.read((char*)channels, (std::streamsize)length);
+			if ((size_t)file.gcount() != length) {
+				return false;
+			}
+			position = offset + length;
+			channels += length;
+			count -= length;
+			nextChannel += length;
+		}
+		return true;
+	};
+
+	// Constant message and the length or the header are read first, they tell where the data lies
+	std::vector<uint8_t> prefix(_imageHandler->getPayloadPrefixLength(image));
+	Image prefixImage = image;
+	prefixImage.pixels = prefix.data();
+	PayloadLayout layout;
+	if (!source(prefix.data(), prefix.size()) || !_imageHandler->getPayloadLayout(prefixImage, layout)) {
+		releaseImage(image);
+		return false;
+	}
+
+	bool status = false;
+	if (!layout.adaptive) {
+		nextChannel = layout.dataStart;
+		status = _imageHandler->extractPayload(layout, source, sink, chunkLength);
+	}
+	else {
+		// Cost map needs the texture of the whole image before the first channel of the data is known
+		file.clear();
+		file.seekg(0);
+		std::string message;
+		if (!mapped || readImage(file, image)) {
+			message = _imageHandler->decodeMessageInImage(image);
+		}
+		status = !message.empty() && chunkLength > 0;
+		for (size_t i = 0; status && i < message.length(); i += chunkLength) {
+			status = sink(message.data() + i, std::min(chunkLength, message.length() - i));
+		}
+	}
+	releaseImage(image);
+	return status;
+}
+
+/// <summary>
+/// Retrieve the encoded messages from every image, the images are read in parallel
+/// Files are read through the asynchronous I/O handler
+/// </summary>
+/// <param name="filePaths">Filepaths of the images</param>
+/// <param name="messages">Modifies the passed messages with the message decoded from every image</param>
+/// <param name="statuses">Modifies the passed statuses, true for images that hold an encoded message</param>
+void FileHandler::readEncodedMessages(const std::vector<std::string>& filePaths, std::vector<std::string>& messages, std::vector<char>& statuses) const {
+	messages.assign(filePaths.size(), "");
+	_asyncIOHandler->processFiles(filePaths, 0, [&](size_t i, std::string& data, std::string&) {
+		Image image;
+		MemoryStream stream((const uint8_t*)data.data(), data.size());
+		if (!readImage(stream, image)) {
+			return false;
+		}
+
+		bool status = _imageHandler->checkIfImageIsEncoded(image);
+		if (status) {
+			messages[i] = _imageHandler->decodeMessageInImage(image);
+		}
+		releaseImage(image);
+		return status;
+	}, statuses);
 }
 
 /// <summary>
@@ -301,15 +735,15 @@ std::string FileHandler::decodeMessage(const std::string& filePath) const {
 /// </summary>
 /// <param name="filePath">Filepath from which the image data will be read from</param>
 /// <param name="msg">Message that would be potentially saved to file</param>
+/// <param name="options">Options chosen for encoding</param>
 /// <returns>Returns true if message could be stored in this file</returns>
-bool FileHandler::checkIfCanWrite(const std::string& filePath, const std::string& msg) const {
-	Image image;
-	if (!readImage(filePath, image)) {
+bool FileHandler::checkIfCanWrite(const std::string& filePath, const std::string& msg, const EncodeOptions& options) const {
+	CapacityReport report;
+	if (!getCapacity(filePath, msg.length(), options, report)) {
 		return false;
 	}
 
-	// Return success
-	return true;
+	return report.fits;
 }
 
 /// <summary>
@@ -320,10 +754,13 @@ bool FileHandler::checkIfCanWrite(const std::string& filePath, const std::string
 bool FileHandler::checkIfCanRead(const std::string& filePath) const {
 	Image image;
 	if (!readImage(filePath, image)) { // Read the image
+		releaseImage(image);
 		return false;
 	}
 	
-	return _imageHandler->checkIfImageIsEncoded(image);
+	bool status = _imageHandler->checkIfImageIsEncoded(image);
+	releaseImage(image);
+	return status;
 }
 
 /// <summary>
@@ -334,4 +771,549 @@ bool FileHandler::checkIfCanRead(const std::string& filePath) const {
 /// <returns>Returns true if succesffully retrieved data from the image in filepath</returns>
 bool FileHandler::getInfoImage(const std::string& filePath, Image& image) const {
 	return readImage(filePath, image);
+}
+
+/// <summary>
+/// Read the image with its pixels, the first stage of the operations split into stages
+/// The image must be released by unloadImage once it is not needed
+/// </summary>
+/// <param name="filePath">Filepath from which the image data will be read from</param>
+/// <param name="image">Modifies the passed image with the images data</param>
+/// <returns>Returns true if the image has been read, nothing is left to release otherwise</returns>
+bool FileHandler::loadImage(const std::string& filePath, Image& image) const {
+	if (!readImage(filePath, image)) {
+		releaseImage(image);
+		return false;
+	}
+	return true;
+}
+
+/// <summary>
+/// Check if the loaded image holds an encoded message
+/// </summary>
+/// <param name="image">Image loaded with its pixels</param>
+/// <returns>Returns true if the image holds an encoded message</returns>
+bool FileHandler::probeImage(const Image& image) const {
+	return _imageHandler->checkIfImageIsEncoded(image);
+}
+
+/// <summary>
+/// Encode the message into the loaded image, the image must not hold another message
+/// </summary>
+/// <param name="image">Image loaded with its pixels</param>
+/// <param name="message">Message that will be encoded</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <returns>Returns true if the message has been encoded</returns>
+bool FileHandler::embedMessage(Image& image, const std::string& message, const EncodeOptions& options) const {
+	return encodeReadImage(image, message, options);
+}
+
+/// <summary>
+/// Decode the message from the loaded image
+/// </summary>
+/// <param name="image">Image loaded with its pixels</param>
+/// <param name="message">Modifies the passed message with the decoded one</param>
+/// <returns>Returns false if the image does not hold an encoded message</returns>
+bool FileHandler::extractMessage(const Image& image, std::string& message) const {
+	if (!_imageHandler->checkIfImageIsEncoded(image)) {
+		return false;
+	}
+
+	message = _imageHandler->decodeMessageInImage(image);
+	return true;
+}
+
+/// <summary>
+/// Save the loaded image to the file
+/// </summary>
+/// <param name="filePath">Filepath to which the image data will be saved to</param>
+/// <param name="image">Image loaded with its pixels</param>
+/// <returns>Returns true if the image has been saved</returns>
+bool FileHandler::saveImage(const std::string& filePath, const Image& image) const {
+	return writeImage(filePath, image);
+}
+
+/// <summary>
+/// Free the pixels of the image that has been loaded
+/// </summary>
+/// <param name="image">Image which pixels will be released</param>
+void FileHandler::unloadImage(Image& image) const {
+	releaseImage(image);
+}
+
+/// <summary>
+/// Determine how many chars of the message could be stored in the image under this path
+/// Images that are already encoded can not hold another message, so their capacity is 0
+/// </summary>
+/// <param name="filePath">Filepath from which the image data will be read from</param>
+/// <param name="capacity">Modifies the passed capacity with the maximum message length</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <returns>Returns true if the image could be read</returns>
+bool FileHandler::getMessageCapacity(const std::string& filePath, size_t& capacity, const EncodeOptions& options) const {
+	Image image;
+	if (!readImage(filePath, image)) {
+		releaseImage(image);
+		return false;
+	}
+
+	capacity = _imageHandler->checkIfImageIsEncoded(image) ? 0 : _imageHandler->getCapacity(image, 0, options).maxMessageLength;
+	releaseImage(image);
+	return true;
+}
+
+/// <summary>
+/// Determine how many chars of the message could be stored in every image, the images are read in parallel
+/// Files are read through the asynchronous I/O handler
+/// </summary>
+/// <param name="filePaths">Filepaths of the images</param>
+/// <param name="capacities">Modifies the passed capacities with the maximum message length, 0 for images that could not be read</param>
+/// <param name="options">Options chosen for encoding</param>
+void FileHandler::getMessageCapacities(const std::vector<std::string>& filePaths, std::vector<size_t>& capacities, const EncodeOptions& options) const {
+	capacities.assign(filePaths.size(), 0);
+	std::vector<char> statuses;
+	_asyncIOHandler->processFiles(filePaths, 0, [&](size_t i, std::string& data, std::string&) {
+		Image image;
+		MemoryStream stream((const uint8_t*)data.data(), data.size());
+		if (!readImage(stream, image)) {
+			return false;
+		}
+
+		capacities[i] = _imageHandler->checkIfImageIsEncoded(image) ? 0 : _imageHandler->getCapacity(image, 0, options).maxMessageLength;
+		releaseImage(image);
+		return true;
+	}, statuses);
+}
+
+/// <summary>
+/// Determine the capacity of the image under this path from its header only, pixels are not read
+/// </summary>
+/// <param name="filePath">Filepath from which the header will be read from</param>
+/// <param name="messageLength">Length of the message that would be encoded</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <param name="report">Modifies the passed report with the capacity of the image</param>
+/// <returns>Returns true if the header could be read</returns>
+bool FileHandler::getCapacity(const std::string& filePath, size_t messageLength, const EncodeOptions& options, CapacityReport& report) const {
+	Image image;
+	if (!readImageHeader(filePath, image)) {
+		return false;
+	}
+
+	report = _imageHandler->getCapacity(image, messageLength, options);
+	return true;
+}
+
+/// <summary>
+/// Find the image with the smallest capacity that still fits the message
+/// Only the beginnings of the files holding the headers are read, through the asynchronous I/O handler
+/// </summary>
+/// <param name="directory">Directory that holds the images</param>
+/// <param name="messageLength">Length of the message that would be encoded</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <param name="carrierPath">Modifies the passed path with the path to the chosen image</param>
+/// <param name="report">Modifies the passed report with the capacity of the chosen image</param>
+/// <returns>Returns true if any image in the directory fits the message</returns>
+bool FileHandler::findSmallestCarrier(const std::string& directory, size_t messageLength, const EncodeOptions& options,
+	std::string& carrierPath, CapacityReport& report) const {
+	std::vector<std::string> paths = listImages(directory);
+	std::vector<CapacityReport> reports(paths.size());
+	std::vector<char> valid(paths.size(), 0);
+	_asyncIOHandler->processFiles(paths, _headerProbeLength, [&](size_t i, std::string& data, std::string&) {
+		Image image;
+		MemoryStream stream((const uint8_t*)data.data(), data.size());
+		if (readImageHeader(stream, image)) {
+			reports[i] = _imageHandler->getCapacity(image, messageLength, options);
+		}
+		// Header is longer than the probe, e.g. big metadata before the image data of .png
+		else if (data.size() < _headerProbeLength || !getCapacity(paths[i], messageLength, options, reports[i])) {
+			return false;
+		}
+		return reports[i].fits;
+	}, valid);
+
+	// Paths are sorted, so the first of equally big images is chosen
+	bool found = false;
+	for (size_t i = 0; i < paths.size(); i++) {
+		if (valid[i] && (!found || reports[i].maxMessageLength < report.maxMessageLength)) {
+			carrierPath = paths[i];
+			report = reports[i];
+			found = true;
+		}
+	}
+	return found;
+}
+
+/// <summary>
+/// Analyze the image under this path and score how likely it holds a message hidden by any program
+/// </summary>
+/// <param name="filePath">Filepath from which the image data will be read from</param>
+/// <param name="report">Modifies the passed report with the result of the analysis</param>
+/// <param name="parallel">Analyze the parts of the image in parallel</param>
+/// <returns>Returns true if the image could be read</returns>
+bool FileHandler::analyzeImage(const std::string& filePath, SteganalysisReport& report, bool parallel) const {
+	Image image;
+	if (!readImage(filePath, image)) {
+		return false;
+	}
+
+	bool status = analyzeReadImage(filePath, image, report, parallel);
+	releaseImage(image);
+	return status;
+}
+
+/// <summary>
+/// Analyze every image in the directory, the images are analyzed in parallel
+/// Files are read through the asynchronous I/O handler while the images read before are analyzed
+/// </summary>
+/// <param name="directory">Directory that holds the images</param>
+/// <param name="reports">Modifies the passed reports with the result for every image that could be read</param>
+/// <returns>Returns number of images that could not be read</returns>
+size_t FileHandler::analyzeDirectory(const std::string& directory, std::vector<SteganalysisReport>& reports) const {
+	std::vector<std::string> paths = listImages(directory);
+	std::vector<SteganalysisReport> results(paths.size());
+	std::vector<char> valid(paths.size(), 0);
+	// One image per thread, so the tiles of a single image are not split further
+	_asyncIOHandler->processFiles(paths, 0, [&](size_t i, std::string& data, std::string&) {
+		Image image;
+		MemoryStream stream((const uint8_t*)data.data(), data.size());
+		if (!readImage(stream, image)) {
+			return false;
+		}
+
+		bool status = analyzeReadImage(paths[i], image, results[i], false);
+		releaseImage(image);
+		return status;
+	}, valid);
+
+	size_t failed = 0;
+	for (size_t i = 0; i < paths.size(); i++) {
+		if (valid[i]) {
+			reports.push_back(results[i]);
+		}
+		else {
+			failed++;
+		}
+	}
+	return failed;
+}
+
+/// <summary>
+/// Probe every file in the directory tree - its format, capacity and whether it holds a message
+/// Results are kept in the index file, files with the same size and last write time as in the index are not read,
+/// new and changed files are probed in parallel through the asynchronous I/O handler
+/// </summary>
+/// <param name="directory">Root of the directory tree</param>
+/// <param name="indexPath">Path of the index file, created if it does not exist</param>
+/// <param name="records">Modifies the passed records with the result for every file that could be read, sorted by path</param>
+/// <param name="probedCount">Modifies the passed count with the number of files that have been probed</param>
+/// <returns>Returns false if the directory could not be listed or the index could not be saved</returns>
+bool FileHandler::scanDirectory(const std::string& directory, const std::string& indexPath, std::vector<ProbeRecord>& records, size_t& probedCount) const {
+	records.clear();
+	probedCount = 0;
+	ProbeIndex index;
+	index.open(indexPath);
+
+	// Only size and last write time are needed to skip the file, both come from the listing
+	std::error_code error;
+	std::filesystem::recursive_directory_iterator iterator(directory, std::filesystem::directory_options::skip_permission_denied, error);
+	if (error) {
+		return false;
+	}
+	const std::filesystem::path indexName = std::filesystem::path(indexPath).filename();
+	std::vector<size_t> changed;
+	for (; iterator != std::filesystem::recursive_directory_iterator(); iterator.increment(error)) {
+		const std::filesystem::directory_entry& entry = *iterator;
+		if (!entry.is_regular_file(error) || (entry.path().filename() == indexName && std::filesystem::equivalent(entry.path(), indexPath, error))) {
+			continue;
+		}
+
+		ProbeRecord record;
+		record.filePath = entry.path().string();
+		record.fileSize = entry.file_size(error);
+		record.modifiedTime = entry.last_write_time(error).time_since_epoch().count();
+		ProbeRecord saved;
+		if (index.find(record.filePath, saved) && saved.fileSize == record.fileSize && saved.modifiedTime == record.modifiedTime) {
+			records.push_back(saved);
+			continue;
+		}
+		changed.push_back(records.size());
+		records.push_back(record);
+	}
+	probedCount = changed.size();
+
+	// First only the beginning of the file, most files are not images or not carriers and need nothing more
+	std::vector<std::string> paths;
+	for (size_t i : changed) {
+		paths.push_back(records[i].filePath);
+	}
+	std::vector<char> valid(paths.size(), 0);
+	std::vector<char> needsPixels(paths.size(), 0);
+	_asyncIOHandler->processFiles(paths, _headerProbeLength, [&](size_t i, std::string& data, std::string&) {
+		ProbeRecord& record = records[changed[i]];
+		MemoryStream stream((const uint8_t*)data.data(), data.size());
+		record.fileType = sniffFileType(stream);
+		Image image;
+		needsPixels[i] = record.fileType != FileType::UNKNOWN && (!readImageHeader(stream, image) || _imageHandler->isSupportedCarrier(image));
+		return true;
+	}, valid);
+
+	// Carriers are read whole, the message could be stored anywhere in the adaptive mode
+	std::vector<size_t> carriers;
+	paths.clear();
+	for (size_t i = 0; i < changed.size(); i++) {
+		if (valid[i] && needsPixels[i]) {
+			carriers.push_back(changed[i]);
+			paths.push_back(records[changed[i]].filePath);
+		}
+	}
+	std::vector<char> read(paths.size(), 0);
+	_asyncIOHandler->processFiles(paths, 0, [&](size_t i, std::string& data, std::string&) {
+		ProbeRecord& record = records[carriers[i]];
+		Image image;
+		MemoryStream stream((const uint8_t*)data.data(), data.size());
+		if (!readImage(stream, image)) {
+			return false;
+		}
+
+		// Too small images have no capacity and could not hold any message
+		size_t length = 0;
+		record.capacity = _imageHandler->getCapacity(image, 0, EncodeOptions()).maxMessageLength;
+		record.encoded = record.capacity > 0 && _imageHandler->checkIfImageIsEncoded(image);
+		record.messageLength = record.encoded && _imageHandler->getMessageLength(image, length) ? length : 0;
+		releaseImage(image);
+		return true;
+	}, read);
+
+	// Broken images stay in the index without capacity, files that could not be opened are probed again by the next scan
+	std::vector<char> failed(records.size(), 0);
+	for (size_t i = 0; i < changed.size(); i++) {
+		failed[changed[i]] = !valid[i];
+	}
+	size_t kept = 0;
+	for (size_t i = 0; i < records.size(); i++) {
+		if (failed[i]) {
+			continue;
+		}
+		if (kept != i) {
+			records[kept] = std::move(records[i]);
+		}
+		kept++;
+	}
+	records.resize(kept);
+
+	index.close();
+	return ProbeIndex::save(indexPath, records);
+}
+
+/// <summary>
+/// Compare the original image with the modified one - header fields, bytes before the pixel data and the pixels
+/// </summary>
+/// <param name="originalPath">Filepath of the original image, e.g. the carrier before encoding</param>
+/// <param name="modifiedPath">Filepath of the modified image</param>
+/// <param name="report">Modifies the passed report with the differences</param>
+/// <returns>Returns false if any of the images could not be read</returns>
+bool FileHandler::compareImages(const std::string& originalPath, const std::string& modifiedPath, CompareReport& report) const {
+	Image original;
+	Image modified;
+	if (!readImage(originalPath, original)) {
+		return false;
+	}
+	if (!readImage(modifiedPath, modified)) {
+		releaseImage(original);
+		return false;
+	}
+
+	report = CompareReport();
+	_compareHandler->compareHeaders(original, modified, report);
+
+	// Bytes the parsed fields do not cover, e.g. the gap between the BMP header and the pixels
+	std::string originalHeader;
+	std::string modifiedHeader;
+	if (readRawHeader(originalPath, original, originalHeader) && readRawHeader(modifiedPath, modified, modifiedHeader)) {
+		const size_t length = std::min(originalHeader.length(), modifiedHeader.length());
+		report.headerBytesChanged = std::max(originalHeader.length(), modifiedHeader.length()) - length;
+		for (size_t i = 0; i < length; i++) {
+			report.headerBytesChanged += originalHeader[i] != modifiedHeader[i];
+		}
+	}
+
+	// Same picture stored as BGR and RGB, e.g. a .bmp transcoded from a .ppm, is compared in the order of the original
+	reorderPixels(modified, false, hasReversedChannels(original.fileType) != hasReversedChannels(modified.fileType));
+	_compareHandler->comparePixels(original, modified, report);
+	releaseImage(original);
+	releaseImage(modified);
+	return true;
+}
+
+/// <summary>
+/// Save the image in another format, the picture is reordered for the layout of the new format
+/// Stored message is moved over bit by bit without encoding it again, afterwards the saved file is read back
+/// and its payload must match - otherwise the file is removed
+/// </summary>
+/// <param name="sourcePath">Filepath of the image</param>
+/// <param name="targetPath">Filepath to which the image is saved, must differ from the source</param>
+/// <param name="targetType">Format of the saved image</param>
+/// <param name="payloadBits">Modifies the passed count with the number of bits of the payload that has been moved, 0 if there is no message</param>
+/// <returns>Returns true if the image has been saved and its payload verified</returns>
+bool FileHandler::transcodeImage(const std::string& sourcePath, const std::string& targetPath, FileType targetType, size_t& payloadBits) const {
+	payloadBits = 0;
+	std::error_code error;
+	if (std::filesystem::equivalent(sourcePath, targetPath, error)) {
+		std::cout << "Error: the image can not be transcoded into itself" << std::endl;
+		return false;
+	}
+
+	Image image;
+	if (!readImage(sourcePath, image)) {
+		releaseImage(image);
+		return false;
+	}
+	if (!_imageHandler->isSupportedCarrier(image)) {
+		releaseImage(image);
+		return false;
+	}
+	// Other formats store 8 bits per channel, the higher bytes of 16 bit samples would be lost
+	if (image.bitsPerPixel != image.channels * 8) {
+		std::cout << "Error: only images with 8 bit channels could be transcoded" << std::endl;
+		releaseImage(image);
+		return false;
+	}
+
+	// Payload is taken out before the pixels move, only its bits are kept - not a copy of the pixels
+	std::vector<bool> payload;
+	if (_imageHandler->checkIfImageIsEncoded(image) && !_imageHandler->readPayloadBits(image, payload)) {
+		releaseImage(image);
+		return false;
+	}
+
+	// Order of the rows comes from the header of every image, e.g. top down .bmp, the new header sets the order of the target
+	const int sourceRowDirection = image.rowDirection;
+	const bool sourceReversed = hasReversedChannels(image.fileType);
+	const bool targetReversed = hasReversedChannels(targetType);
+	bool status = ImageCodecs::dispatch(targetType, [&](auto codec) {
+		typedef typename decltype(codec)::type Codec;
+		if (!Codec::createHeader(image)) {
+			std::cout << "Error: " << fileTypeToString.at(targetType) << " could not store pixels with " << (int)image.channels << " channels" << std::endl;
+			return false;
+		}
+		return true;
+	});
+	if (status) {
+		reorderPixels(image, sourceRowDirection != image.rowDirection, sourceReversed != targetReversed);
+		status = (payload.empty() || _imageHandler->writePayloadBits(image, payload)) && writeImage(targetPath, image);
+	}
+	releaseImage(image);
+	if (!status || payload.empty()) {
+		return status;
+	}
+
+	// Saved file must give back the same payload, the rest of the pixels does not matter for the message
+	Image saved;
+	std::vector<bool> savedPayload;
+	status = readImage(targetPath, saved) && _imageHandler->readPayloadBits(saved, savedPayload) && savedPayload == payload;
+	releaseImage(saved);
+	if (!status) {
+		std::cout << "Error: the message could not be verified in " << targetPath << ", the file has been removed" << std::endl;
+		std::filesystem::remove(targetPath, error);
+		return false;
+	}
+
+	payloadBits = payload.size();
+	return true;
+}
+
+/// <summary>
+/// Reorder the pixels in place for a format with another layout - flip the rows upside down and swap the red and blue channels
+/// </summary>
+/// <param name="image">Image with its pixels</param>
+/// <param name="flipRows">Reverse the order of the rows</param>
+/// <param name="swapChannels">Swap the first and the third channel of every color pixel</param>
+void FileHandler::reorderPixels(Image& image, bool flipRows, bool swapChannels) const {
+	const size_t rowLength = image.getRowLength();
+	if (flipRows) {
+		for (size_t top = 0, bottom = image.height - 1; top < bottom; top++, bottom--) {
+			std::swap_ranges(image.pixels + top * rowLength, image.pixels + (top + 1) * rowLength, image.pixels + bottom * rowLength);
+		}
+	}
+	// Alpha stays the last channel in both layouts, gray images have nothing to swap
+	if (swapChannels && image.channels >= 3) {
+		const size_t length = image.getChannelCount();
+		for (size_t i = 0; i < length; i += image.channels) {
+			std::swap(image.pixels[i], image.pixels[i + 2]);
+		}
+	}
+}
+
+/// <summary>
+/// Check if the format stores the color channels in blue, green, red order
+/// </summary>
+/// <param name="fileType">Type of the file</param>
+/// <returns>Returns the reversedChannels of the codec, false for unknown types</returns>
+bool FileHandler::hasReversedChannels(FileType fileType) const {
+	return ImageCodecs::dispatch(fileType, [](auto codec) {
+		return decltype(codec)::type::reversedChannels;
+	});
+}
+
+/// <summary>
+/// Recognize the format of the image from the first bytes of the file, the extension does not matter
+/// </summary>
+/// <param name="filePath">Filepath of the image</param>
+/// <returns>Returns type of the image, UNKNOWN if the file could not be read or its format is not supported</returns>
+FileType FileHandler::detectFileType(const std::string& filePath) const {
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open()) {
+		return FileType::UNKNOWN;
+	}
+	return sniffFileType(file);
+}
+
+/// <summary>
+/// Find every supported image in the directory, sorted by path so the order is repeatable
+/// </summary>
+/// <param name="directory">Directory that holds the images</param>
+/// <returns>Returns paths to the images in the directory</returns>
+std::vector<std::string> FileHandler::listImages(const std::string& directory) const {
+	std::vector<std::string> paths;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (!entry.is_regular_file()) {
+			continue;
+		}
+
+		std::string path = entry.path().string();
+		if (detectFileType(path) != FileType::UNKNOWN) {
+			paths.push_back(path);
+		}
+	}
+
+	std::sort(paths.begin(), paths.end());
+	return paths;
+}
+
+/// <summary>
+/// Free the pixels data allocated while reading the image
+/// </summary>
+/// <param name="image">Image which pixels will be released</param>
+void FileHandler::releaseImage(Image& image) const {
+	if (image.pixels != nullptr && (_bufferPool == nullptr || !_bufferPool->releasePixels(image.pixels))) {
+		delete[] image.pixels;
+	}
+	image.pixels = nullptr;
+}
+
+/// <summary>
+/// Allocate memory for the pixels of the image, taken from the buffer pool if there is one
+/// </summary>
+/// <param name="image">Image with width and height already read</param>
+void FileHandler::allocatePixels(Image& image) const {
+	const size_t length = image.getChannelCount();
+	image.pixels = _bufferPool != nullptr ? _bufferPool->acquirePixels(length) : new uint8_t[length];
+}
+
+/// <summary>
+/// Use the buffer pool for the pixels of every image read from now on
+/// </summary>
+/// <param name="bufferPool">Pool of buffers, nullptr to allocate every image separately</param>
+void FileHandler::setBufferPool(BufferPool* bufferPool) {
+	_bufferPool = bufferPool;
 }
\ No newline at end of file
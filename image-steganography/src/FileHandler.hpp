@@ -7,11 +7,23 @@
 #include <filesystem>
 #include <iomanip>
 #include <time.h>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cstring>
 
 #include "structs.hpp"
 #include "enums.hpp"
 #include "ImageHandler.hpp"
 #include "Helpers.hpp"
+#include "BufferPool.hpp"
+#include "SteganalysisHandler.hpp"
+#include "CodecRegistry.hpp"
+#include "MemoryStream.hpp"
+#include "AsyncIOHandler.hpp"
+#include "ProbeIndex.hpp"
+#include "SanitizeHandler.hpp"
+#include "CompareHandler.hpp"
 
 /// <summary>
 /// Class for reading and writing the image's data from/to the file
@@ -22,6 +34,34 @@ private:
 	/// Pointer to Image Handler to take care of the image data
 	/// </summary>
 	ImageHandler* _imageHandler;
+	/// <summary>
+	/// Pointer to Steganalysis Handler that detects messages hidden by any program
+	/// </summary>
+	SteganalysisHandler* _steganalysisHandler;
+	/// <summary>
+	/// Pointer to pool from which the pixels are taken, nullptr if every image is allocated separately
+	/// </summary>
+	BufferPool* _bufferPool = nullptr;
+	/// <summary>
+	/// Pointer to handler that reads and writes the files of bulk operations asynchronously
+	/// </summary>
+	AsyncIOHandler* _asyncIOHandler;
+	/// <summary>
+	/// Pointer to handler that replaces the lowest bits of the images with random bits
+	/// </summary>
+	SanitizeHandler* _sanitizeHandler;
+	/// <summary>
+	/// Pointer to handler that compares the original image with the modified one
+	/// </summary>
+	CompareHandler* _compareHandler;
+	/// <summary>
+	/// Number of bytes read from the beginning of the file when only its header is needed
+	/// </summary>
+	const size_t _headerProbeLength = 4096;
+	/// <summary>
+	/// Changed channels closer than this number of bytes are written in place together with the unchanged ones between them
+	/// </summary>
+	const size_t _inPlaceGap = 4096;
 
 	/// <summary>
 	/// Read the image depending on the file type and return the image data
@@ -31,6 +71,13 @@ private:
 	/// <returns>Returns if the image has been successfully read</returns>
 	bool readImage(const std::string& filePath, Image& image) const;
 	/// <summary>
+	/// Read the image from the stream, the type is recognized from its first bytes
+	/// </summary>
+	/// <param name="file">Input Stream of the image - opened file or its data in memory</param>
+	/// <param name="image">Image to which data will be saved</param>
+	/// <returns>Returns if the image has been successfully read</returns>
+	bool readImage(std::istream& file, Image& image) const;
+	/// <summary>
 	/// Save the modified pixels data with encoded message to the image
 	/// </summary>
 	/// <param name="filePath">Filepath to which the modfied image data will be saved</param>
@@ -38,47 +85,152 @@ private:
 	/// <returns>Returns if the image has been successfully saved</returns>
 	bool writeImage(const std::string& filePath, const Image& image) const;
 	/// <summary>
-	/// Helper method for writeImage that saves the modfied image data to a .ppm file
+	/// Save the image to the stream in the format it has been read from
 	/// </summary>
-	/// <param name="file">Input File Stream that has opened the requested .ppm file</param>
-	/// <param name="image">Image from which data will be read from</param>
-	/// <returns>Returns if the .ppm image has been successfully saved</returns>
-	bool writePPMImage(std::ofstream& file, const Image& image) const;
+	/// <param name="file">Output Stream to which the image is saved - opened file or a buffer in memory</param>
+	/// <param name="image">Image that holds the modfied data of the image</param>
+	/// <returns>Returns if the image has been successfully saved</returns>
+	bool writeImage(std::ostream& file, const Image& image) const;
 	/// <summary>
-	/// Helper method for writeImage that saves the modfied image data to a .bmp file
+	/// Read only the header of the image depending on the file type, pixels are not read
 	/// </summary>
-	/// <param name="file">Input File Stream that has opened the requested .bmp file</param>
-	/// <param name="image">Image from which data will be read from</param>
-	/// <returns>Returns if the .bmp image has been successfully saved</returns>
-	bool writeBMPImage(std::ofstream& file, const Image& image) const;
+	/// <param name="filePath">Filepath from which the header will be read from</param>
+	/// <param name="image">Image to which header data will be saved</param>
+	/// <returns>Returns if the header has been successfully read</returns>
+	bool readImageHeader(const std::string& filePath, Image& image) const;
 	/// <summary>
-	/// Helper method for readImage that reads the image data from a .png file
+	/// Read only the header of the image from the stream, pixels are not read
 	/// </summary>
-	/// <param name="file">Input File Stream that has opened the requested .png file</param>
-	/// <param name="image">Image to which data will be saved to</param>
-	/// <returns>Returns if the .png image has been successfully read</returns>
-	bool readPPMImage(std::ifstream& file, Image& image) const;
+	/// <param name="file">Input Stream of the image - opened file or its data in memory</param>
+	/// <param name="image">Image to which header data will be saved</param>
+	/// <returns>Returns if the header has been successfully read</returns>
+	bool readImageHeader(std::istream& file, Image& image) const;
 	/// <summary>
-	/// Helper method for readImage that reads the image data from a .bmp file
+	/// Read the first bytes of the stream and recognize its format, the stream is left at its beginning
 	/// </summary>
-	/// <param name="file">Input File Stream that has opened the requested .bmp file</param>
-	/// <param name="image">Image to which data will be saved to</param>
-	/// <returns>Returns if the .bmp image has been successfully read</returns>
-	bool readBMPImage(std::ifstream& file, Image& image) const;
+	/// <param name="file">Input Stream of the image - opened file or its data in memory</param>
+	/// <returns>Returns type of the image, UNKNOWN if no codec recognizes it</returns>
+	FileType sniffFileType(std::istream& file) const;
+	/// <summary>
+	/// Encode the message into the image that has been read, the image must not hold another message
+	/// </summary>
+	/// <param name="image">Image read with its pixels</param>
+	/// <param name="message">Message that will be encoded</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <returns>Returns true if the message has been encoded</returns>
+	bool encodeReadImage(Image& image, const std::string& message, const EncodeOptions& options) const;
+	/// <summary>
+	/// Analyze the image that has been read and score how likely it holds a message hidden by any program
+	/// </summary>
+	/// <param name="filePath">Filepath of the image, saved to the report</param>
+	/// <param name="image">Image read with its pixels</param>
+	/// <param name="report">Modifies the passed report with the result of the analysis</param>
+	/// <param name="parallel">Analyze the parts of the image in parallel</param>
+	/// <returns>Returns true if the image could be analyzed</returns>
+	bool analyzeReadImage(const std::string& filePath, const Image& image, SteganalysisReport& report, bool parallel) const;
+	/// <summary>
+	/// Write only the changed channels to the positions of the file they have been read from
+	/// </summary>
+	/// <param name="filePath">Filepath from which the image has been read</param>
+	/// <param name="image">Image with the modified pixels</param>
+	/// <param name="channels">Index of every changed channel in ascending order</param>
+	/// <returns>Returns false if the format does not store the pixels at fixed positions or the file could not be written</returns>
+	bool writeChangedChannels(const std::string& filePath, const Image& image, const std::vector<size_t>& channels) const;
+	/// <summary>
+	/// Write every pixel to the position of the file it has been read from, the header is left untouched
+	/// </summary>
+	/// <param name="filePath">Filepath from which the image has been read</param>
+	/// <param name="image">Image with the modified pixels</param>
+	/// <returns>Returns false if the format does not store the pixels at fixed positions or the file could not be written</returns>
+	bool writePixels(const std::string& filePath, const Image& image) const;
+	/// <summary>
+	/// Random seed for the sanitization, different for every call
+	/// </summary>
+	/// <returns>Returns the seed</returns>
+	uint64_t createSeed() const;
+	/// <summary>
+	/// Read the bytes of the file before the pixel data, only for formats storing the pixels at fixed positions
+	/// </summary>
+	/// <param name="filePath">Filepath of the image</param>
+	/// <param name="image">Image read from the file, only header data is used</param>
+	/// <param name="header">Modifies the passed data with the bytes before the first pixel</param>
+	/// <returns>Returns false if the pixels have no fixed position or the file could not be read</returns>
+	bool readRawHeader(const std::string& filePath, const Image& image, std::string& header) const;
+	/// <summary>
+	/// Read only the rows of the region, the pixels of the region are saved to a separate image
+	/// For .bmp and .ppm only the bytes of the region are read, .png has no fixed positions so it is read whole
+	/// </summary>
+	/// <param name="filePath">Filepath of the image</param>
+	/// <param name="region">Region chosen by the user, modified with the resolved width</param>
+	/// <param name="image">Modifies the passed image with the header data, pixels are read only for .png</param>
+	/// <param name="band">Modifies the passed image with the pixels of the region</param>
+	/// <returns>Returns false if the region does not fit in the image or the file could not be read, nothing is left to release then</returns>
+	bool readRegionPixels(const std::string& filePath, RegionOfInterest& region, Image& image, Image& band) const;
+	/// <summary>
+	/// Write the pixels of the region back to the positions of the file they have been read from
+	/// Bytes outside the region are left untouched, so separate regions of a .bmp or .ppm could be written at the same time
+	/// </summary>
+	/// <param name="filePath">Filepath of the image</param>
+	/// <param name="region">Region resolved by readRegionPixels</param>
+	/// <param name="image">Image read by readRegionPixels, a .png is saved whole with the pixels of the region copied in</param>
+	/// <param name="band">Pixels of the region</param>
+	/// <returns>Returns true if the region has been saved</returns>
+	bool writeRegionPixels(const std::string& filePath, const RegionOfInterest& region, Image& image, const Image& band) const;
+	/// <summary>
+	/// Encode the message into the region of the image, only the region is read and written
+	/// </summary>
+	/// <param name="filePath">Filepath of the image</param>
+	/// <param name="message">Message that will be encoded</param>
+	/// <param name="options">Options chosen for encoding with the region</param>
+	/// <returns>Returns true if the message has been encoded and saved</returns>
+	bool encodeMessageInRegion(const std::string& filePath, const std::string& message, const EncodeOptions& options) const;
+	/// <summary>
+	/// Free the pixels data allocated while reading the image
+	/// </summary>
+	/// <param name="image">Image which pixels will be released</param>
+	void releaseImage(Image& image) const;
+	/// <summary>
+	/// Allocate memory for the pixels of the image, taken from the buffer pool if there is one
+	/// </summary>
+	/// <param name="image">Image with width and height already read</param>
+	void allocatePixels(Image& image) const;
+	/// <summary>
+	/// Reorder the pixels in place for a format with another layout - flip the rows upside down and swap the red and blue channels
+	/// </summary>
+	/// <param name="image">Image with its pixels</param>
+	/// <param name="flipRows">Reverse the order of the rows</param>
+	/// <param name="swapChannels">Swap the first and the third channel of every color pixel</param>
+	void reorderPixels(Image& image, bool flipRows, bool swapChannels) const;
+	/// <summary>
+	/// Check if the format stores the color channels in blue, green, red order
+	/// </summary>
+	/// <param name="fileType">Type of the file</param>
+	/// <returns>Returns the reversedChannels of the codec, false for unknown types</returns>
+	bool hasReversedChannels(FileType fileType) const;
 public:
 	/// <summary>
 	/// Constructor
 	/// </summary>
 	FileHandler() {
 		_imageHandler = new ImageHandler();
+		_steganalysisHandler = new SteganalysisHandler();
+		_asyncIOHandler = new AsyncIOHandler();
+		_sanitizeHandler = new SanitizeHandler();
+		_compareHandler = new CompareHandler();
 	}
 	/// <summary>
 	/// Destructor
 	/// </summary>
 	~FileHandler() {
-		_imageHandler->~ImageHandler();
 		delete _imageHandler;
+		delete _steganalysisHandler;
+		delete _asyncIOHandler;
+		delete _sanitizeHandler;
+		delete _compareHandler;
 	}
+	// Owns the handlers above, so it is never copied
+	FileHandler(const FileHandler&) = delete;
+	FileHandler& operator=(const FileHandler&) = delete;
 	
 	/// <summary>
 	/// Determine if the image under this path has been already encoded and could hold the message
@@ -86,8 +238,9 @@ public:
 	/// </summary>
 	/// <param name="filePath">Filepath from which the image data will be read from</param>
 	/// <param name="msg">Message that would be potentially saved to file</param>
+	/// <param name="options">Options chosen for encoding</param>
 	/// <returns>Returns true if message could be stored in this file</returns>
-	bool checkIfCanWrite(const std::string& filePath, const std::string& msg) const;
+	bool checkIfCanWrite(const std::string& filePath, const std::string& msg, const EncodeOptions& options = EncodeOptions()) const;
 	/// <summary>
 	/// Checks if the file is a valid image file and if it has already a message encoded
 	/// </summary>
@@ -101,18 +254,231 @@ public:
 	/// <param name="image">Modifies the passed image with the images data</param>
 	/// <returns>Returns true if succesffully retrieved data from the image in filepath</returns>
 	bool getInfoImage(const std::string& filePath, Image& image) const;
+	/// <summary>
+	/// Read the image with its pixels, the first stage of the operations split into stages
+	/// The image must be released by unloadImage once it is not needed
+	/// </summary>
+	/// <param name="filePath">Filepath from which the image data will be read from</param>
+	/// <param name="image">Modifies the passed image with the images data</param>
+	/// <returns>Returns true if the image has been read, nothing is left to release otherwise</returns>
+	bool loadImage(const std::string& filePath, Image& image) const;
+	/// <summary>
+	/// Check if the loaded image holds an encoded message
+	/// </summary>
+	/// <param name="image">Image loaded with its pixels</param>
+	/// <returns>Returns true if the image holds an encoded message</returns>
+	bool probeImage(const Image& image) const;
+	/// <summary>
+	/// Encode the message into the loaded image, the image must not hold another message
+	/// </summary>
+	/// <param name="image">Image loaded with its pixels</param>
+	/// <param name="message">Message that will be encoded</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <returns>Returns true if the message has been encoded</returns>
+	bool embedMessage(Image& image, const std::string& message, const EncodeOptions& options = EncodeOptions()) const;
+	/// <summary>
+	/// Decode the message from the loaded image
+	/// </summary>
+	/// <param name="image">Image loaded with its pixels</param>
+	/// <param name="message">Modifies the passed message with the decoded one</param>
+	/// <returns>Returns false if the image does not hold an encoded message</returns>
+	bool extractMessage(const Image& image, std::string& message) const;
+	/// <summary>
+	/// Save the loaded image to the file
+	/// </summary>
+	/// <param name="filePath">Filepath to which the image data will be saved to</param>
+	/// <param name="image">Image loaded with its pixels</param>
+	/// <returns>Returns true if the image has been saved</returns>
+	bool saveImage(const std::string& filePath, const Image& image) const;
+	/// <summary>
+	/// Free the pixels of the image that has been loaded
+	/// </summary>
+	/// <param name="image">Image which pixels will be released</param>
+	void unloadImage(Image& image) const;
 	
 	/// <summary>
 	/// Encodes the message into the image and saves the modified image to the file
 	/// </summary>
 	/// <param name="filePath">Filepath to which the modfied image data will be saved to</param>
 	/// <param name="message"></param>
+	/// <param name="options">Options chosen for encoding, by default the message is encoded without extended options</param>
 	/// <returns></returns>
-	bool encodeMessage(const std::string& filePath, const std::string& message) const;
+	bool encodeMessage(const std::string& filePath, const std::string& message, const EncodeOptions& options = EncodeOptions()) const;
+	/// <summary>
+	/// Replace the message stored in the image with the new one, only the channels whose LSB differs are modified
+	/// For .bmp and .ppm only the changed bytes are written to the file, .png is saved whole
+	/// </summary>
+	/// <param name="filePath">Filepath of the image, it could hold a message or not</param>
+	/// <param name="message">Message that will replace the stored one</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <param name="changedBytes">Modifies the passed count with the number of bytes of the pixels that changed</param>
+	/// <returns>Returns true if the message has been encoded and saved</returns>
+	bool updateMessage(const std::string& filePath, const std::string& message, const EncodeOptions& options, size_t& changedBytes) const;
+	/// <summary>
+	/// Replace the lowest bits of every channel with random bits, which wipes any message hidden in them
+	/// For .bmp and .ppm only the pixels are written to the file in place, .png is saved whole
+	/// </summary>
+	/// <param name="filePath">Filepath of the image</param>
+	/// <param name="bitCount">Number of the lowest bits of every channel that are replaced</param>
+	/// <returns>Returns true if the image has been sanitized and saved</returns>
+	bool sanitizeImage(const std::string& filePath, int bitCount) const;
+	/// <summary>
+	/// Sanitize every image, the images are processed in parallel
+	/// Files are read and written back through the asynchronous I/O handler
+	/// </summary>
+	/// <param name="filePaths">Filepaths of the images</param>
+	/// <param name="bitCount">Number of the lowest bits of every channel that are replaced</param>
+	/// <param name="statuses">Modifies the passed statuses with the result for every image</param>
+	void sanitizeImages(const std::vector<std::string>& filePaths, int bitCount, std::vector<char>& statuses) const;
+	/// <summary>
+	/// Encode every message into its image and save the modified images, the images are processed in parallel
+	/// Files are read and written through the asynchronous I/O handler
+	/// </summary>
+	/// <param name="filePaths">Filepaths of the images</param>
+	/// <param name="messages">Message for every image</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <param name="statuses">Modifies the passed statuses with the result for every image</param>
+	void encodeMessages(const std::vector<std::string>& filePaths, const std::vector<std::string>& messages,
+		const EncodeOptions& options, std::vector<char>& statuses) const;
 	/// <summary>
 	/// Retrieves the encoded message from the image under the given filepath
 	/// </summary>
 	/// <param name="filePath">Filepath from which the image data will be read from</param>
 	/// <returns>Encoded message in the image under this path</returns>
 	std::string decodeMessage(const std::string& filePath) const;
+	/// <summary>
+	/// Retrieves the encoded message from the image under the given filepath
+	/// Unlike decodeMessage it reports failure through the return value instead of the message
+	/// </summary>
+	/// <param name="filePath">Filepath from which the image data will be read from</param>
+	/// <param name="message">Modifies the passed message with the decoded one</param>
+	/// <returns>Returns true if the image holds an encoded message and it was decoded</returns>
+	bool readEncodedMessage(const std::string& filePath, std::string& message) const;
+	/// <summary>
+	/// Retrieves the message encoded into the region of the image, only the region is read
+	/// </summary>
+	/// <param name="filePath">Filepath from which the image data will be read from</param>
+	/// <param name="region">Region the message has been encoded into</param>
+	/// <param name="message">Modifies the passed message with the decoded one</param>
+	/// <returns>Returns true if the region holds an encoded message and it was decoded</returns>
+	bool decodeMessageInRegion(const std::string& filePath, const RegionOfInterest& region, std::string& message) const;
+	/// <summary>
+	/// Retrieve the encoded message and pass it to the sink in chunks as it is extracted, the pixels are not held whole
+	/// For .bmp, .ppm, uncompressed .tga and 8 bit .pgm only the rows up to the end of the message are read, a window at a time
+	/// Formats without fixed positions of the channels are read whole, the message is still passed on in chunks
+	/// </summary>
+	/// <param name="filePath">Filepath from which the image data will be read from</param>
+	/// <param name="sink">Sink receiving the message, the first chunk is passed on before the rest of the image is read</param>
+	/// <param name="chunkLength">Number of bytes passed to the sink at once, only the last chunk could be shorter</param>
+	/// <returns>Returns true if the image holds an encoded message and all of it has been passed to the sink</returns>
+	bool streamEncodedMessage(const std::string& filePath, const ImageHandler::PayloadSink& sink, size_t chunkLength = 64 * 1024) const;
+	/// <summary>
+	/// Retrieve the encoded messages from every image, the images are read in parallel
+	/// Files are read through the asynchronous I/O handler
+	/// </summary>
+	/// <param name="filePaths">Filepaths of the images</param>
+	/// <param name="messages">Modifies the passed messages with the message decoded from every image</param>
+	/// <param name="statuses">Modifies the passed statuses, true for images that hold an encoded message</param>
+	void readEncodedMessages(const std::vector<std::string>& filePaths, std::vector<std::string>& messages, std::vector<char>& statuses) const;
+	/// <summary>
+	/// Determine how many chars of the message could be stored in the image under this path
+	/// Images that are already encoded can not hold another message, so their capacity is 0
+	/// </summary>
+	/// <param name="filePath">Filepath from which the image data will be read from</param>
+	/// <param name="capacity">Modifies the passed capacity with the maximum message length</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <returns>Returns true if the image could be read</returns>
+	bool getMessageCapacity(const std::string& filePath, size_t& capacity, const EncodeOptions& options = EncodeOptions()) const;
+	/// <summary>
+	/// Determine how many chars of the message could be stored in every image, the images are read in parallel
+	/// Files are read through the asynchronous I/O handler
+	/// </summary>
+	/// <param name="filePaths">Filepaths of the images</param>
+	/// <param name="capacities">Modifies the passed capacities with the maximum message length, 0 for images that could not be read</param>
+	/// <param name="options">Options chosen for encoding</param>
+	void getMessageCapacities(const std::vector<std::string>& filePaths, std::vector<size_t>& capacities, const EncodeOptions& options) const;
+	/// <summary>
+	/// Determine the capacity of the image under this path from its header only, pixels are not read
+	/// </summary>
+	/// <param name="filePath">Filepath from which the header will be read from</param>
+	/// <param name="messageLength">Length of the message that would be encoded</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <param name="report">Modifies the passed report with the capacity of the image</param>
+	/// <returns>Returns true if the header could be read</returns>
+	bool getCapacity(const std::string& filePath, size_t messageLength, const EncodeOptions& options, CapacityReport& report) const;
+	/// <summary>
+	/// Find the image with the smallest capacity that still fits the message
+	/// Only the beginnings of the files holding the headers are read, through the asynchronous I/O handler
+	/// </summary>
+	/// <param name="directory">Directory that holds the images</param>
+	/// <param name="messageLength">Length of the message that would be encoded</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <param name="carrierPath">Modifies the passed path with the path to the chosen image</param>
+	/// <param name="report">Modifies the passed report with the capacity of the chosen image</param>
+	/// <returns>Returns true if any image in the directory fits the message</returns>
+	bool findSmallestCarrier(const std::string& directory, size_t messageLength, const EncodeOptions& options,
+		std::string& carrierPath, CapacityReport& report) const;
+	/// <summary>
+	/// Analyze the image under this path and score how likely it holds a message hidden by any program
+	/// </summary>
+	/// <param name="filePath">Filepath from which the image data will be read from</param>
+	/// <param name="report">Modifies the passed report with the result of the analysis</param>
+	/// <param name="parallel">Analyze the parts of the image in parallel</param>
+	/// <returns>Returns true if the image could be read</returns>
+	bool analyzeImage(const std::string& filePath, SteganalysisReport& report, bool parallel = true) const;
+	/// <summary>
+	/// Analyze every image in the directory, the images are analyzed in parallel
+	/// Files are read through the asynchronous I/O handler while the images read before are analyzed
+	/// </summary>
+	/// <param name="directory">Directory that holds the images</param>
+	/// <param name="reports">Modifies the passed reports with the result for every image that could be read</param>
+	/// <returns>Returns number of images that could not be read</returns>
+	size_t analyzeDirectory(const std::string& directory, std::vector<SteganalysisReport>& reports) const;
+	/// <summary>
+	/// Probe every file in the directory tree - its format, capacity and whether it holds a message
+	/// Results are kept in the index file, files with the same size and last write time as in the index are not read,
+	/// new and changed files are probed in parallel through the asynchronous I/O handler
+	/// </summary>
+	/// <param name="directory">Root of the directory tree</param>
+	/// <param name="indexPath">Path of the index file, created if it does not exist</param>
+	/// <param name="records">Modifies the passed records with the result for every file that could be read, sorted by path</param>
+	/// <param name="probedCount">Modifies the passed count with the number of files that have been probed</param>
+	/// <returns>Returns false if the directory could not be listed or the index could not be saved</returns>
+	bool scanDirectory(const std::string& directory, const std::string& indexPath, std::vector<ProbeRecord>& records, size_t& probedCount) const;
+	/// <summary>
+	/// Compare the original image with the modified one - header fields, bytes before the pixel data and the pixels
+	/// </summary>
+	/// <param name="originalPath">Filepath of the original image, e.g. the carrier before encoding</param>
+	/// <param name="modifiedPath">Filepath of the modified image</param>
+	/// <param name="report">Modifies the passed report with the differences</param>
+	/// <returns>Returns false if any of the images could not be read</returns>
+	bool compareImages(const std::string& originalPath, const std::string& modifiedPath, CompareReport& report) const;
+	/// <summary>
+	/// Save the image in another format, the picture is reordered for the layout of the new format
+	/// Stored message is moved over bit by bit without encoding it again, afterwards the saved file is read back
+	/// and its payload must match - otherwise the file is removed
+	/// </summary>
+	/// <param name="sourcePath">Filepath of the image</param>
+	/// <param name="targetPath">Filepath to which the image is saved, must differ from the source</param>
+	/// <param name="targetType">Format of the saved image</param>
+	/// <param name="payloadBits">Modifies the passed count with the number of bits of the payload that has been moved, 0 if there is no message</param>
+	/// <returns>Returns true if the image has been saved and its payload verified</returns>
+	bool transcodeImage(const std::string& sourcePath, const std::string& targetPath, FileType targetType, size_t& payloadBits) const;
+	/// <summary>
+	/// Recognize the format of the image from the first bytes of the file, the extension does not matter
+	/// </summary>
+	/// <param name="filePath">Filepath of the image</param>
+	/// <returns>Returns type of the image, UNKNOWN if the file could not be read or its format is not supported</returns>
+	FileType detectFileType(const std::string& filePath) const;
+	/// <summary>
+	/// Find every supported image in the directory, sorted by path so the order is repeatable
+	/// </summary>
+	/// <param name="directory">Directory that holds the images</param>
+	/// <returns>Returns paths to the images in the directory</returns>
+	std::vector<std::string> listImages(const std::string& directory) const;
+	/// <summary>
+	/// Use the buffer pool for the pixels of every image read from now on
+	/// </summary>
+	/// <param name="bufferPool">Pool of buffers, nullptr to allocate every image separately</param>
+	void setBufferPool(BufferPool* bufferPool);
 };
\ No newline at end of file
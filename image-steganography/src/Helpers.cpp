@@ -5,13 +5,9 @@ bool Helpers::endsWith(std::string const& value, std::string const& ending) {
     if (ending.size() > value.size()) 
         return false;
 
-	std::string val = value;
-	// Transform the strings to lower case
-	std::transform(val.begin(), val.end(), val.begin(),
-		[](unsigned char c) { return std::tolower(c); });
-	
-	// Compare endings
-    return std::equal(ending.rbegin(), ending.rend(), val.rbegin());
+	// Compare endings in lower case without copying the value
+    return std::equal(ending.rbegin(), ending.rend(), value.rbegin(),
+		[](unsigned char a, unsigned char b) { return std::tolower(a) == std::tolower(b); });
 }
 
 std::vector<bool> Helpers::stringToBits(const std::string& msg) {
@@ -36,4 +32,79 @@ std::string Helpers::bitsToString(const std::vector<bool>& msg) {
 		str.push_back(c);
 	}
 	return str;
+}
+
+void Helpers::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+	size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	threadCount = std::min(threadCount, count);
+	if (threadCount <= 1) {
+		for (size_t i = 0; i < count; i++) {
+			task(i);
+		}
+		return;
+	}
+
+	// Each worker picks up the next free index until every task has been handed out
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < threadCount; t++) {
+		workers.emplace_back([&]() {
+			for (size_t i = next++; i < count; i = next++) {
+				task(i);
+			}
+		});
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+uint32_t Helpers::crc32(uint32_t crc, const uint8_t* data, size_t length) {
+	// Table for the reflected polynomial 0xEDB88320, built on the first call
+	static const std::vector<uint32_t> table = []() {
+		std::vector<uint32_t> values(256);
+		for (uint32_t n = 0; n < 256; n++) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++) {
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			values[n] = c;
+		}
+		return values;
+	}();
+
+	crc = ~crc;
+	for (size_t i = 0; i < length; i++) {
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+uint32_t Helpers::adler32(uint32_t adler, const uint8_t* data, size_t length) {
+	const uint32_t modulo = 65521;
+	uint32_t a = adler & 0xFFFF, b = adler >> 16;
+	while (length > 0) {
+		// Largest number of bytes for which the sums do not overflow before the modulo
+		size_t count = std::min(length, (size_t)5552);
+		length -= count;
+		while (count-- > 0) {
+			a += *data++;
+			b += a;
+		}
+		a %= modulo;
+		b %= modulo;
+	}
+	return (b << 16) | a;
+}
+
+uint64_t Helpers::getRemainingLength(std::istream& stream) {
+	// Streams that cannot seek, e.g. a pipe, give no limit and the read itself fails on missing bytes
+	const std::streampos position = stream.tellg();
+	if (position < 0 || !stream.seekg(0, std::ios::end)) {
+		stream.clear();
+		return UINT64_MAX;
+	}
+	const std::streampos end = stream.tellg();
+	stream.seekg(position);
+	return end > position ? (uint64_t)(end - position) : 0;
 }
\ No newline at end of file
@@ -3,10 +3,19 @@
 #include <vector>
 #include <algorithm>
 #include <cctype>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <istream>
 
 static class Helpers {
 public:
 	static bool endsWith(const std::string& value, const std::string& ending);
 	static std::vector<bool> stringToBits(const std::string& msg);
 	static std::string bitsToString(const std::vector<bool>& msg);
+	static void parallelFor(size_t count, const std::function<void(size_t)>& task);
+	static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length);
+	static uint32_t adler32(uint32_t adler, const uint8_t* data, size_t length);
+	static uint64_t getRemainingLength(std::istream& stream);
 };
@@ -11,31 +11,17 @@
 bool ImageHandler::encodeMessage(Image& image, const std::string& message, const int& startPixel) const
 {
     std::stringstream ss;
-    // Encode the message itself in the remaining pixel data
-    int pixelIndex = startPixel; 
-    int bitIndex = 0; // Keep track of the current bit being encoded
-    for (int i = 0; i < message.length(); i++) {
+    // Encode the message itself in the remaining pixel data, bits fill every channel of a pixel before moving to the next one
+    uint8_t* channel = image.pixels + (size_t)startPixel * image.channels;
+    for (size_t i = 0; i < message.length(); i++) {
         unsigned char letter = 0b00000000; // initialize to 0 binary
-        // Extract each bit of the character and store it in the corresponding pixel's color
+        // Extract each bit of the character and store it in the corresponding channel
         for (int bit = 7; bit >= 0; bit--) {
             // Shift to left and get the first bit
             unsigned char bitValue = (message[i] >> bit) & 1;
 
-            // Store the extracted bit in the pixel's color
-            switch (bitIndex % (image.bitsPerPixel / 8)) {
-            case 0:
-                replaceLastBit(image.pixels[pixelIndex].red, bitValue);
-                break;
-            case 1:
-                replaceLastBit(image.pixels[pixelIndex].green, bitValue);
-                break;
-            case 2:
-                replaceLastBit(image.pixels[pixelIndex].blue, bitValue);
-                break;
-            }
-            // If all three bits have been encoded, move on to the next pixel
-            if (++bitIndex % (image.bitsPerPixel / 8) == 0)
-                pixelIndex++;
+            // Store the extracted bit in the channel and move on to the next one
+            replaceLastBit(*channel++, bitValue);
 		    
 			letter = letter | (bitValue << bit);
         }
@@ -56,35 +42,13 @@ std::string ImageHandler::decodeMessage(const Image& image, const int& startPixe
 {
     std::stringstream ss;
     // Check the first few pixels of the image to see if they contain the encoded string
-    int pixelIndex = startPixel;
-    int bitIndex = 0; // Keep track of the current bit being encoded
-    int bits = pixelsAlocated * (image.bitsPerPixel / 8);
+    const uint8_t* channel = image.pixels + (size_t)startPixel * image.channels;
+    int bits = pixelsAlocated * image.channels;
     for (int i = 0; i < (bits / 8); i++) {
         unsigned char letter = 0b00000000; // initialize to 0 binary
         for (int b = 7; b >= 0; b--) {
-            unsigned char res;
-            switch (bitIndex % 3) { // take last bit
-            case 0:
-                res = image.pixels[pixelIndex].red & 1;
-                break;
-            case 1:
-                res = image.pixels[pixelIndex].green & 1;
-                break;
-            case 2:
-                res = image.pixels[pixelIndex].blue & 1;
-                break;
-            }
-
             // Using bitwise OR operator
-			letter = letter | (res << b); // shift bit to the left and add it to the letter
-
-            // If all three bits have been encoded, move on to the next pixel
-            if (++bitIndex % (image.bitsPerPixel / 8) == 0)
-                pixelIndex++;
-
-            if (bitIndex == bits) { // We checked every needed
-                break;
-            }
+			letter = letter | ((*channel++ & 1) << b); // take last bit, shift it to the left and add it to the letter
         }
         ss << letter;
     }
@@ -95,11 +59,21 @@ std::string ImageHandler::decodeMessage(const Image& image, const int& startPixe
 /// Determine how many pixels are needed to store the message
 /// </summary>
 /// <param name="message">Message that is going to be stored</param>
-/// <param name="bitsPerPixel">How many bits 1 pixel stores</param>
+/// <param name="channels">How many channels 1 pixel has, every channel stores a bit</param>
 /// <returns>Returns number of pixels needed to store message</returns>
-int ImageHandler::getPixelsNeededToAlocate(const std::string& message, const int& bitsPerPixel) const
+int ImageHandler::getPixelsNeededToAlocate(const std::string& message, const int& channels) const
+{
+    return (message.length() * 8) / channels + 1; // +1 to store the message length at the start
+}
+
+/// <summary>
+/// Determine how many pixels store the message length, 16 pixels of 3 channels
+/// </summary>
+/// <param name="image">Pass the image, only header data is used</param>
+/// <returns>Returns number of pixels of the length field</returns>
+int ImageHandler::getLengthPixels(const Image& image) const
 {
-    return (message.length() * 8) / (bitsPerPixel / 8) + 1; // +1 to store the message length at the start
+    return (_lengthFieldBits + image.channels - 1) / image.channels;
 }
 
 /// <summary>
@@ -127,9 +101,9 @@ bool ImageHandler::encodeMessageInImage(Image& image, const std::string& message
     // Calculate the number of pixels needed to store the message
     // Each pixel can store(usually if bits per pixel = 24) 3 bits of the message (one in each channel),
     // so we need at least as many pixels as the message length in bits divided by 3
-    int numPixels = getPixelsNeededToAlocate(_messageEncoded, image.bitsPerPixel)
-        + getPixelsNeededToAlocate(message, image.bitsPerPixel) + _pixelsNeededToAllocateLength;
-    if (numPixels > image.width * image.height)
+    const size_t numPixels = (size_t)getPixelsNeededToAlocate(_messageEncoded, image.channels)
+        + getPixelsNeededToAlocate(message, image.channels) + getLengthPixels(image);
+    if (numPixels > (size_t)image.width * image.height)
     {
         std::cout << "Error: message is too long to fit in the image" << std::endl;
         return false;
@@ -140,24 +114,94 @@ bool ImageHandler::encodeMessageInImage(Image& image, const std::string& message
         return false;
     }
     // Encode the number of chars that the message has
-    int currentPixel = getPixelsNeededToAlocate(_messageEncoded, image.bitsPerPixel);
+    int currentPixel = getPixelsNeededToAlocate(_messageEncoded, image.channels);
     std::string length = std::to_string(message.length());
     length = ((std::string)"000000").substr(0, 6 - length.length()) + length;
     if (!encodeMessage(image, length, currentPixel)) {
         return false;
     }
-    currentPixel += _pixelsNeededToAllocateLength;
+    currentPixel += getLengthPixels(image);
 
 	// Encode the message itself in the remaining pixel data
     if (!encodeMessage(image, message, currentPixel)) {
         return false;
     }
-    currentPixel += getPixelsNeededToAlocate(message, image.bitsPerPixel);
+    currentPixel += getPixelsNeededToAlocate(message, image.channels);
 
     // Return success
     return true;
 }
 
+/// <summary>
+/// Encode the message with the chosen options
+/// Without any extended option the image is encoded the same way as encodeMessageInImage without options
+/// With LSB matching the changed channels get +1 or -1 at random instead of the replaced lowest bit
+/// </summary>
+/// <param name="image">Pass the image that holds the data of pixels</param>
+/// <param name="message">Message that will be encoded in image</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <returns>Return true if successfulyy encoded message in image</returns>
+bool ImageHandler::encodeMessageInImage(Image& image, const std::string& message, const EncodeOptions& options) const {
+    if (!options.lsbMatching) {
+        return isExtended(options) ? encodeExtendedMessage(image, message, options) : encodeMessageInImage(image, message);
+    }
+
+    // Cost map reads the upper 7 bits, which +1 / -1 could change, so the channels would not be found again
+    if (options.adaptive) {
+        std::cout << "Error: LSB matching could not be used with adaptive mode" << std::endl;
+        return false;
+    }
+
+    // Message is encoded by replacement first, the channels that changed are then moved by +1 / -1 from the original value
+    // Only the channels the encoding writes are kept and compared, the rest of the image could not change
+    const uint8_t* bytes = (const uint8_t*)image.pixels;
+    const size_t length = getEncodedEnd(image, message, options);
+    std::vector<uint8_t> original(bytes, bytes + length);
+    bool status = isExtended(options) ? encodeExtendedMessage(image, message, options) : encodeMessageInImage(image, message);
+    if (status) {
+        uint64_t seed = options.matchingSeed;
+        if (seed == 0) {
+            std::random_device device;
+            seed = ((uint64_t)device() << 32) | device();
+        }
+        _sanitizeHandler->matchImage(image, original.data(), length, seed);
+    }
+    return status;
+}
+
+/// <summary>
+/// Encode the message over the message the image already holds, only the channels whose LSB differs are modified
+/// Channels of the old message that the new one does not use keep their bits
+/// </summary>
+/// <param name="image">Pass the image that holds the data of pixels, it could hold a message or not</param>
+/// <param name="message">Message that will replace the stored one</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <param name="changedChannels">Modifies the passed list with index of every changed channel in ascending order</param>
+/// <returns>Return true if successfully encoded message in image</returns>
+bool ImageHandler::updateMessageInImage(Image& image, const std::string& message, const EncodeOptions& options, std::vector<size_t>& changedChannels) const {
+    // Only the channels of the new constant message, header and data are written, the rest of the image could not change
+    // Keep their old LSBs, one bit per channel
+    const size_t channelCount = getEncodedEnd(image, message, options);
+    const uint8_t* bytes = (const uint8_t*)image.pixels;
+    std::vector<uint8_t> before((channelCount + 7) / 8, 0);
+    for (size_t i = 0; i < channelCount; i++) {
+        before[i >> 3] |= (bytes[i] & 1) << (i & 7);
+    }
+
+    changedChannels.clear();
+    if (!encodeMessageInImage(image, message, options)) {
+        return false;
+    }
+
+    // Replacing the LSB with the same bit leaves the channel as it was, so only the differing bits changed
+    for (size_t i = 0; i < channelCount; i++) {
+        if (((before[i >> 3] >> (i & 7)) & 1) != (bytes[i] & 1)) {
+            changedChannels.push_back(i);
+        }
+    }
+    return true;
+}
+
 /// <summary>
 /// Decode the message from the image
 /// First check if the image contains the message
@@ -167,29 +211,36 @@ bool ImageHandler::encodeMessageInImage(Image& image, const std::string& message
 /// <param name="image">Pass the image that holds the message</param>
 /// <returns>Return Decoded Message</returns>
 std::string ImageHandler::decodeMessageInImage(const Image& image) const {
+    if (checkIfImageIsExtended(image)) {
+        return decodeExtendedMessage(image);
+    }
+
     // Calculate the minimum number of pixels needed to store the message
-    int numPixels = getPixelsNeededToAlocate(_messageEncoded, image.bitsPerPixel) + _pixelsNeededToAllocateLength;
-    if (numPixels > image.width * image.height)
+    const size_t numPixels = (size_t)getPixelsNeededToAlocate(_messageEncoded, image.channels) + getLengthPixels(image);
+    if (numPixels > (size_t)image.width * image.height)
     {
         std::cout << "Error: message is too long to fit in the image" << std::endl;
         return "";
     }
 
     // Encode that the message is encoded at the begining
-    int currentPixel = getPixelsNeededToAlocate(_messageEncoded, image.bitsPerPixel);
+    int currentPixel = getPixelsNeededToAlocate(_messageEncoded, image.channels);
     std::string tempString = decodeMessage(image, 0, currentPixel);
     if (tempString.empty() || tempString != _messageEncoded) {
         return "";
     }
     // Encode the number of chars that the message has
-    std::string length = decodeMessage(image, currentPixel, _pixelsNeededToAllocateLength);
+    std::string length = decodeMessage(image, currentPixel, getLengthPixels(image));
     if (length.empty()) {
         return "";
     }
-    currentPixel += _pixelsNeededToAllocateLength;
+    currentPixel += getLengthPixels(image);
 
     // Encode the message itself in the remaining pixel data
-    int pixelsMessage = (std::atoi(length.c_str()) * 8) / (image.bitsPerPixel / 8) + 1;
+    int pixelsMessage = (std::atoi(length.c_str()) * 8) / image.channels + 1;
+    if (pixelsMessage < 0 || (size_t)currentPixel + pixelsMessage > (size_t)image.width * image.height) {
+        return "";
+    }
     std::string messageEncoded = decodeMessage(image, currentPixel, pixelsMessage);
     if (tempString.empty()) {
         return "";
@@ -206,17 +257,796 @@ std::string ImageHandler::decodeMessageInImage(const Image& image) const {
 /// <returns>Returns boolean - is the image encoded</returns>
 bool ImageHandler::checkIfImageIsEncoded(const Image& image) const {
     // Calculate the number of pixels needed to encode the string
-    int numPixels = getPixelsNeededToAlocate(_messageEncoded, image.bitsPerPixel) + _pixelsNeededToAllocateLength;
-    if (numPixels > image.width * image.height)
+    const size_t numPixels = (size_t)getPixelsNeededToAlocate(_messageEncoded, image.channels) + getLengthPixels(image);
+    if (numPixels > (size_t)image.width * image.height)
     {
         std::cout << "Error: message is too long to fit in the image" << std::endl;
         return false;
     }
 
-	std::string message = decodeMessage(image, 0, numPixels - _pixelsNeededToAllocateLength);
+	std::string message = decodeMessage(image, 0, numPixels - getLengthPixels(image));
     if (message.empty() || message != _messageEncoded) { // Check if we got the message
-		return false;
+		return checkIfImageIsExtended(image);
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Determine the length of the message stored in the image without decoding the message itself
+/// </summary>
+/// <param name="image">Pass the image that holds the message</param>
+/// <param name="length">Modifies the passed length with the length of the message</param>
+/// <returns>Returns false if the image does not hold a valid message</returns>
+bool ImageHandler::getMessageLength(const Image& image, size_t& length) const {
+    if (checkIfImageIsExtended(image)) {
+        MessageHeader header;
+        if (!readHeader(image, header)) {
+            return false;
+        }
+        length = header.messageLength;
+        return true;
+    }
+    if (!checkIfImageIsEncoded(image)) {
+        return false;
     }
 
+    // Length is stored as 6 chars right after the constant message
+    std::string field = decodeMessage(image, getPixelsNeededToAlocate(_messageEncoded, image.channels), getLengthPixels(image));
+    length = std::strtoull(field.c_str(), nullptr, 10);
     return true;
+}
+
+/// <summary>
+/// Read the lowest bit of every channel that holds the stored message - the constant message, the length or the header and the data
+/// Bits are returned in the order they are stored, so they could be moved to another image without decoding the message
+/// </summary>
+/// <param name="image">Pass the image that holds the message</param>
+/// <param name="bits">Modifies the passed bits with the payload of the image</param>
+/// <returns>Returns false if the image does not hold a valid message</returns>
+bool ImageHandler::readPayloadBits(const Image& image, std::vector<bool>& bits) const {
+    const uint8_t* bytes = (const uint8_t*)image.pixels;
+    bits.clear();
+    if (checkIfImageIsExtended(image)) {
+        MessageHeader header;
+        // Message of a region is not stored from the start of the image, so it is not moved with the payload
+        if (!readHeader(image, header) || header.region) {
+            return false;
+        }
+
+        // Matrix embedding spreads the data over whole groups of channels, they are moved as they are
+        const size_t dataStart = getDataStart(image);
+        const size_t dataBits = MatrixEmbedding::getCarrierLength((size_t)header.encodedLength * 8, header.matrixLevel);
+        std::vector<uint32_t> channels;
+        if (header.adaptive) {
+            if (!_costMapHandler->selectChannels(image, dataStart, dataBits, channels)) {
+                return false;
+            }
+        }
+        else if (dataStart + dataBits > getChannelCount(image)) {
+            return false;
+        }
+
+        bits.reserve(dataStart + dataBits);
+        for (size_t c = 0; c < dataStart; c++) {
+            bits.push_back(bytes[c] & 1);
+        }
+        for (size_t i = 0; i < dataBits; i++) {
+            bits.push_back(bytes[header.adaptive ? channels[i] : dataStart + i] & 1);
+        }
+        return true;
+    }
+
+    size_t length;
+    if (!getMessageLength(image, length)) {
+        return false;
+    }
+
+    // Constant message, length and the message are stored in whole pixels one after another, see encodeMessageInImage
+    const size_t channels = image.channels;
+    const size_t pixels = getPixelsNeededToAlocate(_messageEncoded, image.channels) + getLengthPixels(image)
+        + (length * 8) / channels + 1;
+    const size_t channelCount = std::min(pixels * channels, getChannelCount(image));
+    bits.reserve(channelCount);
+    for (size_t c = 0; c < channelCount; c++) {
+        bits.push_back(bytes[c] & 1);
+    }
+    return true;
+}
+
+/// <summary>
+/// Store the payload read by readPayloadBits into the image with the same number of channels, the message is not encoded again
+/// The constant message and the header go to the same channels, data stored by the cost map goes to the channels
+/// the cost map chooses in this image, which could differ when the pixels have been reordered
+/// </summary>
+/// <param name="image">Pass the image that will hold the message</param>
+/// <param name="bits">Payload read from another image</param>
+/// <returns>Returns false if the payload does not fit into the image</returns>
+bool ImageHandler::writePayloadBits(Image& image, const std::vector<bool>& bits) const {
+    if (bits.size() > getChannelCount(image)) {
+        return false;
+    }
+
+    // Constant message and the header are stored in the same channels of every image
+    uint8_t* bytes = (uint8_t*)image.pixels;
+    const size_t dataStart = std::min(getDataStart(image), bits.size());
+    for (size_t c = 0; c < dataStart; c++) {
+        replaceLastBit(bytes[c], bits[c]);
+    }
+
+    // Cost map ignores the lowest bits, so the channels are chosen the same way when the message is decoded
+    MessageHeader header;
+    if (checkIfImageIsExtended(image) && readHeader(image, header) && header.adaptive) {
+        std::vector<uint32_t> channels;
+        const size_t dataBits = bits.size() - dataStart;
+        if (dataBits != (size_t)header.encodedLength * 8 || !_costMapHandler->selectChannels(image, dataStart, dataBits, channels)) {
+            return false;
+        }
+        for (size_t i = 0; i < dataBits; i++) {
+            replaceLastBit(bytes[channels[i]], bits[dataStart + i]);
+        }
+        return true;
+    }
+
+    for (size_t c = dataStart; c < bits.size(); c++) {
+        replaceLastBit(bytes[c], bits[c]);
+    }
+    return true;
+}
+
+/// <summary>
+/// Determine the capacity of the image using only the data from its header - pixels are not needed
+/// Takes into account the bit depth, compression, the constant message, the header and parity bytes
+/// </summary>
+/// <param name="image">Pass the image that would hold the message, only header data is used</param>
+/// <param name="messageLength">Length of the message that would be encoded</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <returns>Returns the longest message that fits and whether the given message fits exactly</returns>
+CapacityReport ImageHandler::getCapacity(const Image& image, size_t messageLength, const EncodeOptions& options) const {
+    CapacityReport report;
+    if (!isSupportedCarrier(image) || ErrorCorrection::getParityLength(options.fecLevel) < 0
+        || !MatrixEmbedding::isSupportedLevel(options.matrixLevel) || (options.adaptive && options.matrixLevel != 0)) {
+        return report;
+    }
+
+    const size_t channels = image.channels;
+    report.availableChannels = getChannelCount(image);
+    if (!isExtended(options)) {
+        // Message of length L takes (L * 8) / channels + 1 pixels, see getPixelsNeededToAlocate
+        const size_t reservedPixels = getPixelsNeededToAlocate(_messageEncoded, image.channels) + getLengthPixels(image);
+        const size_t totalPixels = (size_t)image.width * image.height;
+        if (totalPixels > reservedPixels) {
+            report.maxMessageLength = std::min(((totalPixels - reservedPixels) * channels - 1) / 8, _maxMessageLength);
+        }
+        report.requiredChannels = (reservedPixels + messageLength * 8 / channels + 1) * channels;
+        report.fits = messageLength <= _maxMessageLength && report.requiredChannels <= report.availableChannels;
+        return report;
+    }
+
+    if (options.region.height > 0) {
+        // Region holds the constant message, the header, the region copies and the data in its own pixels
+        RegionOfInterest region = options.region;
+        report.availableChannels = 0;
+        if (options.adaptive || !resolveRegion(image, region)) {
+            return report;
+        }
+        report.availableChannels = (size_t)region.width * region.height * channels;
+        const size_t reservedChannels = getHeaderStart(image) + (_headerCopies * (_headerSize + _regionSize)) * 8;
+        const size_t dataChannels = report.availableChannels > reservedChannels ? report.availableChannels - reservedChannels : 0;
+        const size_t payloadBits = MatrixEmbedding::getPayloadLength(dataChannels, options.matrixLevel);
+        if (payloadBits >= 8) {
+            report.maxMessageLength = std::min<size_t>(_errorCorrection->getMessageLength(payloadBits / 8, options.fecLevel), UINT32_MAX);
+        }
+        const size_t dataRequired = MatrixEmbedding::getCarrierLength(_errorCorrection->getEncodedLength(messageLength, options.fecLevel) * 8, options.matrixLevel);
+        report.requiredChannels = reservedChannels + dataRequired;
+        report.fits = messageLength <= report.maxMessageLength && dataRequired <= dataChannels;
+        return report;
+    }
+
+    // Adaptive mode uses only whole pixels after the header
+    const size_t dataChannels = getDataChannelCount(image, options.adaptive);
+    const size_t payloadBits = MatrixEmbedding::getPayloadLength(dataChannels, options.matrixLevel);
+    if (payloadBits >= 8) {
+        size_t encodedLength = payloadBits / 8;
+        report.maxMessageLength = std::min<size_t>(_errorCorrection->getMessageLength(encodedLength, options.fecLevel), UINT32_MAX);
+    }
+    const size_t dataRequired = MatrixEmbedding::getCarrierLength(_errorCorrection->getEncodedLength(messageLength, options.fecLevel) * 8, options.matrixLevel);
+    report.requiredChannels = report.availableChannels - dataChannels + dataRequired;
+    report.fits = messageLength <= report.maxMessageLength && dataRequired <= dataChannels;
+    return report;
+}
+
+/// <summary>
+/// Determine if the pixels of the image could be used for encoding
+/// Only images with 8 bits per channel are supported - gray, color and color with alpha, every channel holds a bit
+/// Lower bytes of 16 bit PGM samples are the channels, PNG is compressed losslessly so it is supported as well
+/// </summary>
+/// <param name="image">Pass the image, only header data is used</param>
+/// <returns>Returns true if the image could hold the message</returns>
+bool ImageHandler::isSupportedCarrier(const Image& image) const {
+    if (image.channels == 0 || image.width == 0 || image.height == 0) {
+        return false;
+    }
+
+    switch (image.fileType) {
+    case FileType::BMP:
+        return BMPCodec::isSupportedLayout(image.bmp);
+    case FileType::PPM:
+        return image.ppm.magicNumber == "P6" && image.ppm.max_value <= 255;
+    case FileType::PNG:
+        return image.png.bitDepth == 8 && image.png.colorType != 3 && image.png.interlaceMethod == 0; // no palette
+    case FileType::PGM:
+    case FileType::TGA:
+        return true; // codecs read only the supported layouts
+    default:
+        return false;
+    }
+}
+
+/// <summary>
+/// Check the region lies inside the image and fill in its width when the rest of the rows is taken
+/// </summary>
+/// <param name="image">Pass the image, only header data is used</param>
+/// <param name="region">Region chosen by the user, modified with the resolved width</param>
+/// <returns>Returns false if the region is empty or does not fit in the image</returns>
+bool ImageHandler::resolveRegion(const Image& image, RegionOfInterest& region) const {
+    const uint32_t width = (uint32_t)image.width;
+    const uint32_t height = (uint32_t)image.height;
+    if (region.x >= width || region.y >= height || region.height == 0) {
+        return false;
+    }
+    if (region.width == 0) {
+        region.width = width - region.x;
+    }
+    return region.width <= width - region.x && region.height <= height - region.y;
+}
+
+/// <summary>
+/// Decode the message confined to the region, the region's pixels are passed as a separate image
+/// The region recorded with the message must be the requested one
+/// </summary>
+/// <param name="image">Pass the pixels of the region as a separate image</param>
+/// <param name="region">Region of the image the pixels come from, resolved by resolveRegion</param>
+/// <returns>Return Decoded Message or empty string if the region does not hold a message</returns>
+std::string ImageHandler::decodeRegionMessage(const Image& image, const RegionOfInterest& region) const {
+    MessageHeader header;
+    if (!checkIfImageIsExtended(image) || !readHeader(image, header) || !header.region) {
+        return "";
+    }
+    if (!(readRegion(image) == region)) {
+        std::cout << "Error: message is stored in another region of the image" << std::endl;
+        return "";
+    }
+
+    std::string encoded = header.matrixLevel == 0 ? readBytes(image, getRegionDataStart(image), header.encodedLength)
+        : _matrixEmbedding->extract((const uint8_t*)image.pixels + getRegionDataStart(image), header.encodedLength, header.matrixLevel);
+    std::string message;
+    if (_errorCorrection->decode(encoded, header.messageLength, header.fecLevel, message) < 0) {
+        std::cout << "Error: message has too many flipped bits to be fixed" << std::endl;
+        return "";
+    }
+    return message;
+}
+
+/// <summary>
+/// Store the bytes in LSB of the image's channels, one bit per channel, starting at the given channel
+/// </summary>
+/// <param name="image">Pass the image that holds the data</param>
+/// <param name="data">Bytes that are going to be stored</param>
+/// <param name="startByte">Index of the channel where the first bit is stored</param>
+void ImageHandler::writeBytes(Image& image, const std::string& data, size_t startByte) const {
+    uint8_t* channels = (uint8_t*)image.pixels + startByte;
+    for (unsigned char c : data) {
+        for (int bit = 7; bit >= 0; bit--) {
+            replaceLastBit(*channels++, (c >> bit) & 1);
+        }
+    }
+}
+
+/// <summary>
+/// Read the bytes from LSB of the image's channels, one bit per channel, starting at the given channel
+/// </summary>
+/// <param name="image">Pass the image that holds the data</param>
+/// <param name="startByte">Index of the channel where the first bit is stored</param>
+/// <param name="length">Number of bytes to read</param>
+/// <returns>Returns bytes read from the image</returns>
+std::string ImageHandler::readBytes(const Image& image, size_t startByte, size_t length) const {
+    const uint8_t* channels = (const uint8_t*)image.pixels + startByte;
+    std::string data(length, '\0');
+    for (size_t i = 0; i < length; i++, channels += 8) {
+        unsigned char letter = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            letter = (letter << 1) | (channels[bit] & 1);
+        }
+        data[i] = letter;
+    }
+    return data;
+}
+
+/// <summary>
+/// Store the bytes in LSB of the given channels, one bit per channel
+/// </summary>
+/// <param name="image">Pass the image that holds the data</param>
+/// <param name="data">Bytes that are going to be stored</param>
+/// <param name="channels">Index of the channel for every bit</param>
+void ImageHandler::writeBytes(Image& image, const std::string& data, const std::vector<uint32_t>& channels) const {
+    uint8_t* bytes = (uint8_t*)image.pixels;
+    const uint32_t* channel = channels.data();
+    for (unsigned char c : data) {
+        for (int bit = 7; bit >= 0; bit--) {
+            replaceLastBit(bytes[*channel++], (c >> bit) & 1);
+        }
+    }
+}
+
+/// <summary>
+/// Read the bytes from LSB of the given channels, one bit per channel
+/// </summary>
+/// <param name="image">Pass the image that holds the data</param>
+/// <param name="channels">Index of the channel for every bit</param>
+/// <returns>Returns bytes read from the image</returns>
+std::string ImageHandler::readBytes(const Image& image, const std::vector<uint32_t>& channels) const {
+    const uint8_t* bytes = (const uint8_t*)image.pixels;
+    std::string data(channels.size() / 8, '\0');
+    for (size_t i = 0; i < data.length(); i++) {
+        unsigned char letter = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            letter = (letter << 1) | (bytes[channels[i * 8 + bit]] & 1);
+        }
+        data[i] = letter;
+    }
+    return data;
+}
+
+/// <summary>
+/// Number of channels in the image that could hold a bit - every channel of every pixel
+/// </summary>
+/// <param name="image">Pass the image</param>
+/// <returns>Returns number of channels in the image</returns>
+size_t ImageHandler::getChannelCount(const Image& image) const {
+    return image.getChannelCount();
+}
+
+/// <summary>
+/// Index of the channel where the extended header starts - right after the constant message
+/// </summary>
+/// <param name="image">Pass the image</param>
+/// <returns>Returns index of the first channel of the header</returns>
+size_t ImageHandler::getHeaderStart(const Image& image) const {
+    return getPixelsNeededToAlocate(_messageEncodedExtended, image.channels) * image.channels;
+}
+
+/// <summary>
+/// Index of the channel where the data of the message encoded with extended options starts
+/// </summary>
+/// <param name="image">Pass the image</param>
+/// <returns>Returns index of the first channel of the data</returns>
+size_t ImageHandler::getDataStart(const Image& image) const {
+    return getHeaderStart(image) + _headerCopies * _headerSize * 8;
+}
+
+/// <summary>
+/// Number of channels that could hold the data of the message encoded with extended options
+/// </summary>
+/// <param name="image">Pass the image</param>
+/// <param name="adaptive">Data is stored in the channels chosen by the cost map, only whole pixels are used</param>
+/// <returns>Returns number of channels after the header</returns>
+size_t ImageHandler::getDataChannelCount(const Image& image, bool adaptive) const {
+    const size_t dataStart = getDataStart(image);
+    if (adaptive) {
+        return _costMapHandler->getAvailableChannels(image, dataStart);
+    }
+    const size_t channelCount = getChannelCount(image);
+    return channelCount > dataStart ? channelCount - dataStart : 0;
+}
+
+/// <summary>
+/// Check if the image starts with the extended constant message, allowing a few flipped bits
+/// </summary>
+/// <param name="image">Pass the image that holds the message</param>
+/// <returns>Returns true if the image has been encoded with extended options</returns>
+bool ImageHandler::checkIfImageIsExtended(const Image& image) const {
+    if (getChannelCount(image) < getDataStart(image)) {
+        return false;
+    }
+
+    // Random LSB match the constant message on so many bits only by chance of about 1 in 10^18
+    std::string marker = readBytes(image, 0, _messageEncodedExtended.length());
+    int flippedBits = 0;
+    for (size_t i = 0; i < marker.length(); i++) {
+        unsigned char diff = marker[i] ^ _messageEncodedExtended[i];
+        for (; diff != 0; diff &= diff - 1) {
+            flippedBits++;
+        }
+    }
+    return flippedBits <= _markerTolerance;
+}
+
+/// <summary>
+/// Convert the header to bytes stored in the image
+/// </summary>
+/// <param name="header">Header of the message</param>
+/// <returns>Returns header as bytes, little endian</returns>
+std::string ImageHandler::serializeHeader(const MessageHeader& header) const {
+    std::string data;
+    for (int i = 0; i < 4; i++) {
+        data.push_back((char)((header.messageLength >> (8 * i)) & 0xFF));
+    }
+    for (int i = 0; i < 4; i++) {
+        data.push_back((char)((header.encodedLength >> (8 * i)) & 0xFF));
+    }
+    data.push_back((char)(header.fecLevel | (header.matrixLevel << _matrixShift) | (header.adaptive ? _adaptiveFlag : 0) | (header.region ? _regionFlag : 0)));
+    return data;
+}
+
+/// <summary>
+/// Read every copy of the data stored the given number of times one after another and decide each bit by majority vote
+/// </summary>
+/// <param name="image">Pass the image that holds the data</param>
+/// <param name="startByte">Index of the channel where the first copy starts</param>
+/// <param name="length">Number of bytes of a single copy</param>
+/// <returns>Returns bytes agreed by the copies</returns>
+std::string ImageHandler::readCopies(const Image& image, size_t startByte, size_t length) const {
+    std::string copies = readBytes(image, startByte, length * _headerCopies);
+    std::string data(length, '\0');
+    for (size_t i = 0; i < length; i++) {
+        unsigned char a = copies[i], b = copies[i + length], c = copies[i + 2 * length];
+        data[i] = (a & b) | (a & c) | (b & c);
+    }
+    return data;
+}
+
+/// <summary>
+/// Read every copy of the header and decide each bit by majority vote
+/// </summary>
+/// <param name="image">Pass the image that holds the message</param>
+/// <param name="header">Header to which data will be saved</param>
+/// <returns>Returns true if the header is valid for this image</returns>
+bool ImageHandler::readHeader(const Image& image, MessageHeader& header) const {
+    std::string data = readCopies(image, getHeaderStart(image), _headerSize);
+    const unsigned char* bytes = (const unsigned char*)data.data();
+    header.messageLength = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    header.encodedLength = bytes[4] | (bytes[5] << 8) | (bytes[6] << 16) | ((uint32_t)bytes[7] << 24);
+    header.fecLevel = bytes[8] & ~(_adaptiveFlag | _regionFlag | _matrixMask);
+    header.adaptive = (bytes[8] & _adaptiveFlag) != 0;
+    header.region = (bytes[8] & _regionFlag) != 0;
+    header.matrixLevel = (bytes[8] & _matrixMask) >> _matrixShift;
+
+    // Header must describe data that actually fits in the image, data of a region follows the region copies
+    const size_t channelCount = getChannelCount(image);
+    const size_t dataChannels = !header.region ? getDataChannelCount(image, header.adaptive)
+        : channelCount > getRegionDataStart(image) ? channelCount - getRegionDataStart(image) : 0;
+    return ErrorCorrection::getParityLength(header.fecLevel) >= 0
+        && MatrixEmbedding::isSupportedLevel(header.matrixLevel)
+        && !(header.adaptive && (header.region || header.matrixLevel != 0))
+        && header.encodedLength == _errorCorrection->getEncodedLength(header.messageLength, header.fecLevel)
+        && MatrixEmbedding::getCarrierLength((size_t)header.encodedLength * 8, header.matrixLevel) <= dataChannels;
+}
+
+/// <summary>
+/// Index of the channel where the data of the message confined to a region starts - after the header and the region copies
+/// </summary>
+/// <param name="image">Pass the region read as a separate image</param>
+/// <returns>Returns index of the first channel of the data</returns>
+size_t ImageHandler::getRegionDataStart(const Image& image) const {
+    return getDataStart(image) + _headerCopies * _regionSize * 8;
+}
+
+/// <summary>
+/// Convert the region to bytes stored in the image
+/// </summary>
+/// <param name="region">Region of the message</param>
+/// <returns>Returns region as bytes, little endian</returns>
+std::string ImageHandler::serializeRegion(const RegionOfInterest& region) const {
+    std::string data;
+    for (uint32_t value : { region.x, region.y, region.width, region.height }) {
+        for (int i = 0; i < 4; i++) {
+            data.push_back((char)((value >> (8 * i)) & 0xFF));
+        }
+    }
+    return data;
+}
+
+/// <summary>
+/// Read every copy of the region stored after the header and decide each bit by majority vote
+/// </summary>
+/// <param name="image">Pass the region read as a separate image</param>
+/// <returns>Returns the region recorded with the message</returns>
+RegionOfInterest ImageHandler::readRegion(const Image& image) const {
+    std::string data = readCopies(image, getDataStart(image), _regionSize);
+    const unsigned char* bytes = (const unsigned char*)data.data();
+    uint32_t values[4];
+    for (int v = 0; v < 4; v++) {
+        const unsigned char* value = bytes + 4 * v;
+        values[v] = value[0] | (value[1] << 8) | (value[2] << 16) | ((uint32_t)value[3] << 24);
+    }
+
+    RegionOfInterest region;
+    region.x = values[0];
+    region.y = values[1];
+    region.width = values[2];
+    region.height = values[3];
+    return region;
+}
+
+/// <summary>
+/// Encode the extended constant message, the header and the message with parity bytes
+/// </summary>
+/// <param name="image">Pass the image that holds the data of pixels</param>
+/// <param name="message">Message that will be encoded in image</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <returns>Return true if successfully encoded message in image</returns>
+bool ImageHandler::encodeExtendedMessage(Image& image, const std::string& message, const EncodeOptions& options) const {
+    if (ErrorCorrection::getParityLength(options.fecLevel) < 0) {
+        std::cout << "Error: unsupported level of error correction" << std::endl;
+        return false;
+    }
+
+    // Image of a region holds only the pixels of the region, the region itself follows the header copies
+    const bool region = options.region.height > 0;
+    if (region && options.adaptive) {
+        std::cout << "Error: adaptive mode could not be used in a region" << std::endl;
+        return false;
+    }
+    if (!MatrixEmbedding::isSupportedLevel(options.matrixLevel) || (options.adaptive && options.matrixLevel != 0)) {
+        std::cout << "Error: unsupported level of matrix embedding" << std::endl;
+        return false;
+    }
+    const size_t channelCount = getChannelCount(image);
+    const size_t dataStart = region ? getRegionDataStart(image) : getDataStart(image);
+    const size_t dataChannels = !region ? getDataChannelCount(image, options.adaptive)
+        : channelCount > dataStart ? channelCount - dataStart : 0;
+
+    std::string encoded = _errorCorrection->encode(message, options.fecLevel);
+    if (MatrixEmbedding::getCarrierLength(encoded.length() * 8, options.matrixLevel) > dataChannels) {
+        std::cout << "Error: message is too long to fit in the image" << std::endl;
+        return false;
+    }
+
+    // The map uses only the upper 7 bits, so it could be chosen before any bit is written
+    std::vector<uint32_t> channels;
+    if (options.adaptive && !_costMapHandler->selectChannels(image, getDataStart(image), encoded.length() * 8, channels)) {
+        return false;
+    }
+
+    MessageHeader header;
+    header.messageLength = (uint32_t)message.length();
+    header.encodedLength = (uint32_t)encoded.length();
+    header.fecLevel = (uint8_t)options.fecLevel;
+    header.adaptive = options.adaptive;
+    header.region = region;
+    header.matrixLevel = (uint8_t)options.matrixLevel;
+    std::string headerData = serializeHeader(header);
+
+    writeBytes(image, _messageEncodedExtended, 0);
+    writeBytes(image, headerData + headerData + headerData, getHeaderStart(image));
+    if (region) {
+        std::string regionData = serializeRegion(options.region);
+        writeBytes(image, regionData + regionData + regionData, getDataStart(image));
+    }
+    if (options.adaptive) {
+        writeBytes(image, encoded, channels);
+    }
+    else if (options.matrixLevel != 0) {
+        _matrixEmbedding->embed((uint8_t*)image.pixels + dataStart, encoded, options.matrixLevel);
+    }
+    else {
+        writeBytes(image, encoded, dataStart);
+    }
+    return true;
+}
+
+/// <summary>
+/// Decode the message encoded with extended options and fix the flipped bits
+/// </summary>
+/// <param name="image">Pass the image that holds the message</param>
+/// <returns>Return Decoded Message or empty string if it could not be fixed</returns>
+std::string ImageHandler::decodeExtendedMessage(const Image& image) const {
+    MessageHeader header;
+    if (!readHeader(image, header)) {
+        return "";
+    }
+    if (header.region) {
+        std::cout << "Error: message is stored in a region of the image, decode it with --roi or --rows" << std::endl;
+        return "";
+    }
+
+    std::string encoded;
+    if (header.adaptive) {
+        std::vector<uint32_t> channels;
+        if (!_costMapHandler->selectChannels(image, getDataStart(image), (size_t)header.encodedLength * 8, channels)) {
+            return "";
+        }
+        encoded = readBytes(image, channels);
+    }
+    else if (header.matrixLevel != 0) {
+        encoded = _matrixEmbedding->extract((const uint8_t*)image.pixels + getDataStart(image), header.encodedLength, header.matrixLevel);
+    }
+    else {
+        encoded = readBytes(image, getDataStart(image), header.encodedLength);
+    }
+    std::string message;
+    if (_errorCorrection->decode(encoded, header.messageLength, header.fecLevel, message) < 0) {
+        std::cout << "Error: message has too many flipped bits to be fixed" << std::endl;
+        return "";
+    }
+    return message;
+}
+
+/// <summary>
+/// Determine if the chosen options need the extended header
+/// </summary>
+/// <param name="options">Options chosen for encoding</param>
+/// <returns>Returns true if the message has to be encoded with the extended header</returns>
+bool ImageHandler::isExtended(const EncodeOptions& options) const {
+    return options.fecLevel != 0 || options.adaptive || options.region.height > 0 || options.matrixLevel != 0;
+}
+
+/// <summary>
+/// Index after the last channel that encoding the message with the chosen options could change
+/// Data chosen by the cost map could lie anywhere after the header, so every channel is counted for it
+/// </summary>
+/// <param name="image">Pass the image, only header data is used</param>
+/// <param name="message">Message that will be encoded in image</param>
+/// <param name="options">Options chosen for encoding</param>
+/// <returns>Returns number of channels from the beginning of the image, at most every channel</returns>
+size_t ImageHandler::getEncodedEnd(const Image& image, const std::string& message, const EncodeOptions& options) const {
+    const size_t channelCount = getChannelCount(image);
+    if (!isExtended(options)) {
+        const size_t dataStart = (size_t)(getPixelsNeededToAlocate(_messageEncoded, image.channels) + getLengthPixels(image)) * image.channels;
+        return std::min(dataStart + message.length() * 8, channelCount);
+    }
+    if (options.adaptive) {
+        return channelCount;
+    }
+
+    // Constant message, header and region copies all come before the data
+    const size_t dataStart = options.region.height > 0 ? getRegionDataStart(image) : getDataStart(image);
+    const size_t encodedLength = _errorCorrection->getEncodedLength(message.length(), options.fecLevel);
+    return std::min(dataStart + MatrixEmbedding::getCarrierLength(encodedLength * 8, options.matrixLevel), channelCount);
+}
+
+/// <summary>
+/// Number of channels from the beginning of the image holding the constant message and the length or the header
+/// </summary>
+/// <param name="image">Pass the image, only header data is used</param>
+/// <returns>Returns number of channels read by getPayloadLayout</returns>
+size_t ImageHandler::getPayloadPrefixLength(const Image& image) const {
+    const size_t legacyLength = (size_t)(getPixelsNeededToAlocate(_messageEncoded, image.channels) + getLengthPixels(image)) * image.channels;
+    return std::min(std::max(legacyLength, getDataStart(image)), getChannelCount(image));
+}
+
+/// <summary>
+/// Find where the data of the stored message lies and how it is encoded, so it could be extracted as the image is read
+/// Only the first getPayloadPrefixLength channels of the pixels are read, the rest of them does not have to be read yet
+/// </summary>
+/// <param name="image">Pass the image with at least the first channels of its pixels</param>
+/// <param name="layout">Modifies the passed layout with the position and encoding of the data</param>
+/// <returns>Returns false if the image does not hold a message or holds an empty one</returns>
+bool ImageHandler::getPayloadLayout(const Image& image, PayloadLayout& layout) const {
+    layout = PayloadLayout();
+    if (checkIfImageIsExtended(image)) {
+        MessageHeader header;
+        if (!readHeader(image, header)) {
+            return false;
+        }
+        if (header.region) {
+            std::cout << "Error: message is stored in a region of the image, decode it with --roi or --rows" << std::endl;
+            return false;
+        }
+
+        layout.dataStart = getDataStart(image);
+        layout.messageLength = header.messageLength;
+        layout.encodedLength = header.encodedLength;
+        layout.fecLevel = header.fecLevel;
+        layout.matrixLevel = header.matrixLevel;
+        layout.adaptive = header.adaptive;
+        return layout.messageLength > 0;
+    }
+
+    // Same checks as decodeMessageInImage, the constant message and the length come before the data
+    const int markerPixels = getPixelsNeededToAlocate(_messageEncoded, image.channels);
+    const size_t pixelCount = (size_t)image.width * image.height;
+    if ((size_t)(markerPixels + getLengthPixels(image)) > pixelCount || decodeMessage(image, 0, markerPixels) != _messageEncoded) {
+        return false;
+    }
+    const int length = std::atoi(decodeMessage(image, markerPixels, getLengthPixels(image)).c_str());
+    const size_t dataPixel = (size_t)markerPixels + getLengthPixels(image);
+    if (length <= 0 || dataPixel + ((size_t)length * 8) / image.channels + 1 > pixelCount) {
+        return false;
+    }
+
+    layout.dataStart = dataPixel * image.channels;
+    layout.messageLength = (uint32_t)length;
+    layout.encodedLength = (uint32_t)length;
+    return true;
+}
+
+/// <summary>
+/// Extract the message from the channels as they are read and pass it to the sink in chunks
+/// Channels are pulled a window at a time and every block of error correction is fixed once it is complete,
+/// so neither the pixels nor the message have to be held whole
+/// </summary>
+/// <param name="layout">Layout found by getPayloadLayout, data stored by the cost map could not be extracted in order</param>
+/// <param name="source">Source of the channels, the first one pulled is the channel layout.dataStart</param>
+/// <param name="sink">Sink receiving the message</param>
+/// <param name="chunkLength">Number of bytes passed to the sink at once, only the last chunk could be shorter</param>
+/// <returns>Returns false if the channels end early, a block has too many flipped bits or the sink stops</returns>
+bool ImageHandler::extractPayload(const PayloadLayout& layout, const ChannelSource& source, const PayloadSink& sink, size_t chunkLength) const {
+    if (layout.adaptive || chunkLength == 0) {
+        return false;
+    }
+
+    // Window ends on a whole byte and a whole group - 8 groups always hold whole bytes
+    const size_t groupLength = MatrixEmbedding::getGroupLength(layout.matrixLevel);
+    const size_t groupBits = layout.matrixLevel == 0 ? 1 : layout.matrixLevel;
+    const size_t windowGroups = std::max<size_t>(_streamWindowChannels / groupLength / 8, 1) * 8;
+    const size_t windowBytes = windowGroups * groupBits / 8;
+    std::vector<uint8_t> channels(windowGroups * groupLength);
+
+    // Block of error correction - data of the block followed by its parity, fixed once all of its bytes are extracted
+    const int parityLength = ErrorCorrection::getParityLength(layout.fecLevel);
+    const size_t blockDataLength = ErrorCorrection::getBlockDataLength(layout.fecLevel);
+    std::string block;
+    size_t messageLeft = layout.messageLength;
+    size_t blockLength = parityLength > 0 ? std::min(blockDataLength, messageLeft) + parityLength : 0;
+
+    std::string chunk;
+    chunk.reserve(chunkLength);
+    auto emit = [&](const char* data, size_t length) {
+        while (length > 0) {
+            const size_t count = std::min(length, chunkLength - chunk.length());
+            chunk.append(data, count);
+            data += count;
+            length -= count;
+            if (chunk.length() == chunkLength) {
+                if (!sink(chunk.data(), chunk.length())) {
+                    return false;
+                }
+                chunk.clear();
+            }
+        }
+        return true;
+    };
+
+    for (size_t extracted = 0; extracted < layout.encodedLength;) {
+        const size_t bytes = std::min(windowBytes, (size_t)layout.encodedLength - extracted);
+        const size_t channelCount = (bytes * 8 + groupBits - 1) / groupBits * groupLength;
+        if (!source(channels.data(), channelCount)) {
+            return false;
+        }
+        const std::string data = _matrixEmbedding->extract(channels.data(), bytes, layout.matrixLevel);
+        extracted += bytes;
+
+        if (parityLength <= 0) {
+            if (!emit(data.data(), data.length())) {
+                return false;
+            }
+            continue;
+        }
+
+        for (size_t position = 0; position < data.length();) {
+            const size_t count = std::min(data.length() - position, blockLength - block.length());
+            block.append(data, position, count);
+            position += count;
+            if (block.length() < blockLength) {
+                continue;
+            }
+
+            std::string message;
+            const size_t messageLength = blockLength - parityLength;
+            if (_errorCorrection->decode(block, messageLength, layout.fecLevel, message) < 0) {
+                std::cout << "Error: message has too many flipped bits to be fixed" << std::endl;
+                return false;
+            }
+            if (!emit(message.data(), message.length())) {
+                return false;
+            }
+            block.clear();
+            messageLeft -= messageLength;
+            blockLength = std::min(blockDataLength, messageLeft) + parityLength;
+        }
+    }
+
+    return chunk.empty() || sink(chunk.data(), chunk.length());
 }
\ No newline at end of file
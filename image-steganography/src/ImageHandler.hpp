@@ -2,8 +2,18 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <random>
+#include <functional>
 
 #include "structs.hpp"
+#include "BMPCodec.hpp"
+#include "ErrorCorrection.hpp"
+#include "CostMapHandler.hpp"
+#include "MatrixEmbedding.hpp"
+#include "SanitizeHandler.hpp"
 
 /// <summary>
 /// Helper class for encoding and decoding strings in images
@@ -15,9 +25,69 @@ private:
 	/// </summary>
 	const std::string _messageEncoded = "msgEncoded";
 	/// <summary>
-	/// Number of pixels needed to store the message in pixels length
+	/// Number of bits of the message length stored after the constant message - 6 chars
 	/// </summary>
-	const int _pixelsNeededToAllocateLength = 16; // 16 pixels - 48 bit - 6 chars
+	const int _lengthFieldBits = 48;
+	/// <summary>
+	/// Longest message that fits in the 6 chars of the length field
+	/// </summary>
+	const size_t _maxMessageLength = 999999;
+	/// <summary>
+	/// Constant message that is encoded at the beginning of images encoded with extended options
+	/// </summary>
+	const std::string _messageEncodedExtended = "msgExtHead";
+	/// <summary>
+	/// Number of bits of the extended constant message that could be flipped and still be recognized
+	/// </summary>
+	const int _markerTolerance = 4;
+	/// <summary>
+	/// Number of copies of the extended header, every bit of the header is decided by majority vote
+	/// </summary>
+	const int _headerCopies = 3;
+	/// <summary>
+	/// Number of bytes the extended header takes, see serializeHeader
+	/// </summary>
+	const size_t _headerSize = 9;
+	/// <summary>
+	/// Bit of the fecLevel byte of the header set for messages stored by the adaptive mode
+	/// </summary>
+	const uint8_t _adaptiveFlag = 0x80;
+	/// <summary>
+	/// Bit of the fecLevel byte of the header set for messages confined to a region of the image
+	/// </summary>
+	const uint8_t _regionFlag = 0x40;
+	/// <summary>
+	/// Number of bytes the region stored after the header copies takes, see serializeRegion
+	/// </summary>
+	const size_t _regionSize = 16;
+	/// <summary>
+	/// Bits of the fecLevel byte of the header that hold the level of the matrix embedding
+	/// </summary>
+	const uint8_t _matrixMask = 0x1C;
+	/// <summary>
+	/// Position of the lowest bit of the matrix embedding level in the fecLevel byte
+	/// </summary>
+	const int _matrixShift = 2;
+	/// <summary>
+	/// Number of channels pulled from the source at once when the message is extracted as the image is read
+	/// </summary>
+	const size_t _streamWindowChannels = 64 * 1024;
+	/// <summary>
+	/// Pointer to error correction used by images encoded with extended options
+	/// </summary>
+	ErrorCorrection* _errorCorrection;
+	/// <summary>
+	/// Pointer to cost map that chooses the channels in the adaptive mode
+	/// </summary>
+	CostMapHandler* _costMapHandler;
+	/// <summary>
+	/// Pointer to matrix embedding of the data of images encoded with extended options
+	/// </summary>
+	MatrixEmbedding* _matrixEmbedding;
+	/// <summary>
+	/// Pointer to handler of the random bits, turns the replaced lowest bits into LSB matching
+	/// </summary>
+	SanitizeHandler* _sanitizeHandler;
 
 	/// <summary>
 	/// Business Logic that encoded the message in Image's pixel in LSB
@@ -39,9 +109,15 @@ private:
 	/// Determine how many pixels are needed to store the message
 	/// </summary>
 	/// <param name="message">Message that is going to be stored</param>
-	/// <param name="bitsPerPixel">How many bits 1 pixel stores</param>
+	/// <param name="channels">How many channels 1 pixel has, every channel stores a bit</param>
 	/// <returns>Returns number of pixels needed to store message</returns>
-	int getPixelsNeededToAlocate(const std::string& message, const int& bitsPerPixel = 24) const;
+	int getPixelsNeededToAlocate(const std::string& message, const int& channels = 3) const;
+	/// <summary>
+	/// Determine how many pixels store the message length, 16 pixels of 3 channels
+	/// </summary>
+	/// <param name="image">Pass the image, only header data is used</param>
+	/// <returns>Returns number of pixels of the length field</returns>
+	int getLengthPixels(const Image& image) const;
 	/// <summary>
 	/// Replace the last bit of the given byte with the given bit
 	/// </summary>
@@ -49,10 +125,162 @@ private:
 	/// <param name="bit">Bit to we want to replace the last bit of val</param>
 	/// <returns>Returns 8 bit val with changed last bit to requested</returns>
 	uint8_t replaceLastBit(uint8_t& val, unsigned char bit) const;
+	/// <summary>
+	/// Store the bytes in LSB of the image's channels, one bit per channel, starting at the given channel
+	/// </summary>
+	/// <param name="image">Pass the image that holds the data</param>
+	/// <param name="data">Bytes that are going to be stored</param>
+	/// <param name="startByte">Index of the channel where the first bit is stored</param>
+	void writeBytes(Image& image, const std::string& data, size_t startByte) const;
+	/// <summary>
+	/// Read the bytes from LSB of the image's channels, one bit per channel, starting at the given channel
+	/// </summary>
+	/// <param name="image">Pass the image that holds the data</param>
+	/// <param name="startByte">Index of the channel where the first bit is stored</param>
+	/// <param name="length">Number of bytes to read</param>
+	/// <returns>Returns bytes read from the image</returns>
+	std::string readBytes(const Image& image, size_t startByte, size_t length) const;
+	/// <summary>
+	/// Store the bytes in LSB of the given channels, one bit per channel
+	/// </summary>
+	/// <param name="image">Pass the image that holds the data</param>
+	/// <param name="data">Bytes that are going to be stored</param>
+	/// <param name="channels">Index of the channel for every bit</param>
+	void writeBytes(Image& image, const std::string& data, const std::vector<uint32_t>& channels) const;
+	/// <summary>
+	/// Read the bytes from LSB of the given channels, one bit per channel
+	/// </summary>
+	/// <param name="image">Pass the image that holds the data</param>
+	/// <param name="channels">Index of the channel for every bit</param>
+	/// <returns>Returns bytes read from the image</returns>
+	std::string readBytes(const Image& image, const std::vector<uint32_t>& channels) const;
+	/// <summary>
+	/// Number of channels in the image that could hold a bit - every channel of every pixel
+	/// </summary>
+	/// <param name="image">Pass the image</param>
+	/// <returns>Returns number of channels in the image</returns>
+	size_t getChannelCount(const Image& image) const;
+	/// <summary>
+	/// Index of the channel where the extended header starts - right after the constant message
+	/// </summary>
+	/// <param name="image">Pass the image</param>
+	/// <returns>Returns index of the first channel of the header</returns>
+	size_t getHeaderStart(const Image& image) const;
+	/// <summary>
+	/// Index of the channel where the data of the message encoded with extended options starts
+	/// </summary>
+	/// <param name="image">Pass the image</param>
+	/// <returns>Returns index of the first channel of the data</returns>
+	size_t getDataStart(const Image& image) const;
+	/// <summary>
+	/// Number of channels that could hold the data of the message encoded with extended options
+	/// </summary>
+	/// <param name="image">Pass the image</param>
+	/// <param name="adaptive">Data is stored in the channels chosen by the cost map, only whole pixels are used</param>
+	/// <returns>Returns number of channels after the header</returns>
+	size_t getDataChannelCount(const Image& image, bool adaptive) const;
+	/// <summary>
+	/// Check if the image starts with the extended constant message, allowing a few flipped bits
+	/// </summary>
+	/// <param name="image">Pass the image that holds the message</param>
+	/// <returns>Returns true if the image has been encoded with extended options</returns>
+	bool checkIfImageIsExtended(const Image& image) const;
+	/// <summary>
+	/// Convert the header to bytes stored in the image
+	/// </summary>
+	/// <param name="header">Header of the message</param>
+	/// <returns>Returns header as bytes, little endian</returns>
+	std::string serializeHeader(const MessageHeader& header) const;
+	/// <summary>
+	/// Read every copy of the header and decide each bit by majority vote
+	/// </summary>
+	/// <param name="image">Pass the image that holds the message</param>
+	/// <param name="header">Header to which data will be saved</param>
+	/// <returns>Returns true if the header is valid for this image</returns>
+	bool readHeader(const Image& image, MessageHeader& header) const;
+	/// <summary>
+	/// Read every copy of the data stored the given number of times one after another and decide each bit by majority vote
+	/// </summary>
+	/// <param name="image">Pass the image that holds the data</param>
+	/// <param name="startByte">Index of the channel where the first copy starts</param>
+	/// <param name="length">Number of bytes of a single copy</param>
+	/// <returns>Returns bytes agreed by the copies</returns>
+	std::string readCopies(const Image& image, size_t startByte, size_t length) const;
+	/// <summary>
+	/// Index of the channel where the data of the message confined to a region starts - after the header and the region copies
+	/// </summary>
+	/// <param name="image">Pass the region read as a separate image</param>
+	/// <returns>Returns index of the first channel of the data</returns>
+	size_t getRegionDataStart(const Image& image) const;
+	/// <summary>
+	/// Convert the region to bytes stored in the image
+	/// </summary>
+	/// <param name="region">Region of the message</param>
+	/// <returns>Returns region as bytes, little endian</returns>
+	std::string serializeRegion(const RegionOfInterest& region) const;
+	/// <summary>
+	/// Read every copy of the region stored after the header and decide each bit by majority vote
+	/// </summary>
+	/// <param name="image">Pass the region read as a separate image</param>
+	/// <returns>Returns the region recorded with the message</returns>
+	RegionOfInterest readRegion(const Image& image) const;
+	/// <summary>
+	/// Encode the extended constant message, the header and the message with parity bytes
+	/// </summary>
+	/// <param name="image">Pass the image that holds the data of pixels</param>
+	/// <param name="message">Message that will be encoded in image</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <returns>Return true if successfully encoded message in image</returns>
+	bool encodeExtendedMessage(Image& image, const std::string& message, const EncodeOptions& options) const;
+	/// <summary>
+	/// Decode the message encoded with extended options and fix the flipped bits
+	/// </summary>
+	/// <param name="image">Pass the image that holds the message</param>
+	/// <returns>Return Decoded Message or empty string if it could not be fixed</returns>
+	std::string decodeExtendedMessage(const Image& image) const;
+	/// <summary>
+	/// Determine if the chosen options need the extended header
+	/// </summary>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <returns>Returns true if the message has to be encoded with the extended header</returns>
+	bool isExtended(const EncodeOptions& options) const;
+	/// <summary>
+	/// Index after the last channel that encoding the message with the chosen options could change
+	/// Data chosen by the cost map could lie anywhere after the header, so every channel is counted for it
+	/// </summary>
+	/// <param name="image">Pass the image, only header data is used</param>
+	/// <param name="message">Message that will be encoded in image</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <returns>Returns number of channels from the beginning of the image, at most every channel</returns>
+	size_t getEncodedEnd(const Image& image, const std::string& message, const EncodeOptions& options) const;
 
 public:
-	ImageHandler() {}
-	~ImageHandler() {}
+	/// <summary>
+	/// Source of the channels of the image in order - fills the buffer with the given number of the next channels
+	/// Returns false once the image ends or could not be read
+	/// </summary>
+	typedef std::function<bool(uint8_t*, size_t)> ChannelSource;
+	/// <summary>
+	/// Sink receiving the message a chunk at a time - gets the bytes of the chunk and their number
+	/// Returns false to stop the extraction
+	/// </summary>
+	typedef std::function<bool(const char*, size_t)> PayloadSink;
+
+	ImageHandler() {
+		_errorCorrection = new ErrorCorrection();
+		_costMapHandler = new CostMapHandler();
+		_matrixEmbedding = new MatrixEmbedding();
+		_sanitizeHandler = new SanitizeHandler();
+	}
+	~ImageHandler() {
+		delete _errorCorrection;
+		delete _costMapHandler;
+		delete _matrixEmbedding;
+		delete _sanitizeHandler;
+	}
+	// Owns the handlers above, so it is never copied
+	ImageHandler(const ImageHandler&) = delete;
+	ImageHandler& operator=(const ImageHandler&) = delete;
 	/// <summary>
 	/// Encode that the message is stored in the image - at the beginig store constant message
 	/// Encode the length of the message
@@ -63,6 +291,26 @@ public:
 	/// <returns>Return true if successfulyy encoded message in image</returns>
 	bool encodeMessageInImage(Image& image, const std::string& message) const;
 	/// <summary>
+	/// Encode the message with the chosen options
+	/// Without any extended option the image is encoded the same way as encodeMessageInImage without options
+	/// With LSB matching the changed channels get +1 or -1 at random instead of the replaced lowest bit
+	/// </summary>
+	/// <param name="image">Pass the image that holds the data of pixels</param>
+	/// <param name="message">Message that will be encoded in image</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <returns>Return true if successfulyy encoded message in image</returns>
+	bool encodeMessageInImage(Image& image, const std::string& message, const EncodeOptions& options) const;
+	/// <summary>
+	/// Encode the message over the message the image already holds, only the channels whose LSB differs are modified
+	/// Channels of the old message that the new one does not use keep their bits
+	/// </summary>
+	/// <param name="image">Pass the image that holds the data of pixels, it could hold a message or not</param>
+	/// <param name="message">Message that will replace the stored one</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <param name="changedChannels">Modifies the passed list with index of every changed channel in ascending order</param>
+	/// <returns>Return true if successfully encoded message in image</returns>
+	bool updateMessageInImage(Image& image, const std::string& message, const EncodeOptions& options, std::vector<size_t>& changedChannels) const;
+	/// <summary>
 	/// Decode the message from the image
 	/// First check if the image contains the message
 	/// Then decode the length of the message
@@ -77,4 +325,85 @@ public:
 	/// <param name="image">Pass the image that holds the message</param>
 	/// <returns>Returns boolean - is the image encoded</returns>
 	bool checkIfImageIsEncoded(const Image& image) const;
+	/// <summary>
+	/// Determine the length of the message stored in the image without decoding the message itself
+	/// </summary>
+	/// <param name="image">Pass the image that holds the message</param>
+	/// <param name="length">Modifies the passed length with the length of the message</param>
+	/// <returns>Returns false if the image does not hold a valid message</returns>
+	bool getMessageLength(const Image& image, size_t& length) const;
+	/// <summary>
+	/// Read the lowest bit of every channel that holds the stored message - the constant message, the length or the header and the data
+	/// Bits are returned in the order they are stored, so they could be moved to another image without decoding the message
+	/// </summary>
+	/// <param name="image">Pass the image that holds the message</param>
+	/// <param name="bits">Modifies the passed bits with the payload of the image</param>
+	/// <returns>Returns false if the image does not hold a valid message</returns>
+	bool readPayloadBits(const Image& image, std::vector<bool>& bits) const;
+	/// <summary>
+	/// Store the payload read by readPayloadBits into the image with the same number of channels, the message is not encoded again
+	/// The constant message and the header go to the same channels, data stored by the cost map goes to the channels
+	/// the cost map chooses in this image, which could differ when the pixels have been reordered
+	/// </summary>
+	/// <param name="image">Pass the image that will hold the message</param>
+	/// <param name="bits">Payload read from another image</param>
+	/// <returns>Returns false if the payload does not fit into the image</returns>
+	bool writePayloadBits(Image& image, const std::vector<bool>& bits) const;
+	/// <summary>
+	/// Determine the capacity of the image using only the data from its header - pixels are not needed
+	/// Takes into account the bit depth, compression, the constant message, the header and parity bytes
+	/// </summary>
+	/// <param name="image">Pass the image that would hold the message, only header data is used</param>
+	/// <param name="messageLength">Length of the message that would be encoded</param>
+	/// <param name="options">Options chosen for encoding</param>
+	/// <returns>Returns the longest message that fits and whether the given message fits exactly</returns>
+	CapacityReport getCapacity(const Image& image, size_t messageLength, const EncodeOptions& options) const;
+	/// <summary>
+	/// Determine if the pixels of the image could be used for encoding
+	/// Only images with 8 bits per channel are supported - gray, color and color with alpha, every channel holds a bit
+	/// Lower bytes of 16 bit PGM samples are the channels, PNG is compressed losslessly so it is supported as well
+	/// </summary>
+	/// <param name="image">Pass the image, only header data is used</param>
+	/// <returns>Returns true if the image could hold the message</returns>
+	bool isSupportedCarrier(const Image& image) const;
+	/// <summary>
+	/// Check the region lies inside the image and fill in its width when the rest of the rows is taken
+	/// </summary>
+	/// <param name="image">Pass the image, only header data is used</param>
+	/// <param name="region">Region chosen by the user, modified with the resolved width</param>
+	/// <returns>Returns false if the region is empty or does not fit in the image</returns>
+	bool resolveRegion(const Image& image, RegionOfInterest& region) const;
+	/// <summary>
+	/// Decode the message confined to the region, the region's pixels are passed as a separate image
+	/// The region recorded with the message must be the requested one
+	/// </summary>
+	/// <param name="image">Pass the pixels of the region as a separate image</param>
+	/// <param name="region">Region of the image the pixels come from, resolved by resolveRegion</param>
+	/// <returns>Return Decoded Message or empty string if the region does not hold a message</returns>
+	std::string decodeRegionMessage(const Image& image, const RegionOfInterest& region) const;
+	/// <summary>
+	/// Number of channels from the beginning of the image holding the constant message and the length or the header
+	/// </summary>
+	/// <param name="image">Pass the image, only header data is used</param>
+	/// <returns>Returns number of channels read by getPayloadLayout</returns>
+	size_t getPayloadPrefixLength(const Image& image) const;
+	/// <summary>
+	/// Find where the data of the stored message lies and how it is encoded, so it could be extracted as the image is read
+	/// Only the first getPayloadPrefixLength channels of the pixels are read, the rest of them does not have to be read yet
+	/// </summary>
+	/// <param name="image">Pass the image with at least the first channels of its pixels</param>
+	/// <param name="layout">Modifies the passed layout with the position and encoding of the data</param>
+	/// <returns>Returns false if the image does not hold a message or holds an empty one</returns>
+	bool getPayloadLayout(const Image& image, PayloadLayout& layout) const;
+	/// <summary>
+	/// Extract the message from the channels as they are read and pass it to the sink in chunks
+	/// Channels are pulled a window at a time and every block of error correction is fixed once it is complete,
+	/// so neither the pixels nor the message have to be held whole
+	/// </summary>
+	/// <param name="layout">Layout found by getPayloadLayout, data stored by the cost map could not be extracted in order</param>
+	/// <param name="source">Source of the channels, the first one pulled is the channel layout.dataStart</param>
+	/// <param name="sink">Sink receiving the message</param>
+	/// <param name="chunkLength">Number of bytes passed to the sink at once, only the last chunk could be shorter</param>
+	/// <returns>Returns false if the channels end early, a block has too many flipped bits or the sink stops</returns>
+	bool extractPayload(const PayloadLayout& layout, const ChannelSource& source, const PayloadSink& sink, size_t chunkLength) const;
 };
@@ -0,0 +1,346 @@
+#pragma once
+#include "Inflater.hpp"
+
+/// <summary>
+/// Make sure at least the given number of bits is in the bit buffer, pulling the input when needed
+/// </summary>
+/// <param name="count">Number of bits needed, at most 57</param>
+void Inflater::ensureBits(int count) {
+	while (_bitCount < count) {
+		if (_inputPosition == _inputEnd && !_inputFinished) {
+			_inputEnd = _source(_input.data(), _input.size());
+			_inputPosition = 0;
+			_inputFinished = _inputEnd == 0;
+		}
+
+		// Past the end zeros are added, so the lookup could peek ahead, reading them is an error
+		uint64_t byte = 0;
+		if (_inputPosition < _inputEnd) {
+			byte = _input[_inputPosition++];
+		}
+		else {
+			_overrun += 8;
+		}
+		_bitBuffer |= byte << _bitCount;
+		_bitCount += 8;
+	}
+}
+
+/// <summary>
+/// Read the given number of bits, least significant first
+/// </summary>
+/// <param name="count">Number of bits, at most 32</param>
+/// <returns>Returns the bits</returns>
+uint32_t Inflater::readBits(int count) {
+	if (count == 0) {
+		return 0;
+	}
+
+	ensureBits(count);
+	uint32_t bits = (uint32_t)(_bitBuffer & ((1ull << count) - 1));
+	_bitBuffer >>= count;
+	_bitCount -= count;
+	if (_bitCount < _overrun) {
+		_error = true;
+	}
+	return bits;
+}
+
+/// <summary>
+/// Build the table for the canonical Huffman code with the given code lengths
+/// </summary>
+/// <param name="lengths">Code length of every symbol, 0 if the symbol is not used</param>
+/// <param name="count">Number of symbols</param>
+/// <param name="table">Table to which the code will be saved</param>
+/// <returns>Returns false if the lengths do not form a valid code</returns>
+bool Inflater::buildTable(const uint8_t* lengths, int count, HuffmanTable& table) const {
+	std::memset(table.counts, 0, sizeof(table.counts));
+	std::memset(table.fast, 0, sizeof(table.fast));
+	for (int symbol = 0; symbol < count; symbol++) {
+		table.counts[lengths[symbol]]++;
+	}
+	table.counts[0] = 0;
+
+	// More codes of some length than the shorter codes leave room for
+	int left = 1;
+	for (int length = 1; length < 16; length++) {
+		left = (left << 1) - table.counts[length];
+		if (left < 0) {
+			return false;
+		}
+	}
+
+	uint16_t offsets[16] = {};
+	uint32_t nextCode[16] = {};
+	for (int length = 1, code = 0; length < 15; length++) {
+		offsets[length + 1] = offsets[length] + table.counts[length];
+		code = (code + table.counts[length]) << 1;
+		nextCode[length + 1] = code;
+	}
+
+	for (int symbol = 0; symbol < count; symbol++) {
+		const int length = lengths[symbol];
+		if (length == 0) {
+			continue;
+		}
+		table.symbols[offsets[length]++] = symbol;
+
+		// Codes are stored from the most significant bit, the bits are read from the least significant one
+		uint32_t code = nextCode[length]++;
+		if (length <= _fastBits) {
+			uint32_t reversed = 0;
+			for (int bit = 0; bit < length; bit++) {
+				reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+			}
+			for (uint32_t index = reversed; index < (1u << _fastBits); index += 1u << length) {
+				table.fast[index] = (uint16_t)(symbol << 4 | length);
+			}
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// Decode the next symbol with the given table
+/// </summary>
+/// <param name="table">Table of the code</param>
+/// <returns>Returns the symbol, -1 for invalid code</returns>
+int Inflater::decodeSymbol(const HuffmanTable& table) {
+	ensureBits(15);
+	const uint16_t entry = table.fast[_bitBuffer & ((1 << _fastBits) - 1)];
+	if (entry != 0) {
+		readBits(entry & 15);
+		return entry >> 4;
+	}
+
+	// Longer code - walk the canonical code one bit at a time
+	int code = 0, first = 0, index = 0;
+	for (int length = 1; length < 16; length++) {
+		code |= (_bitBuffer >> (length - 1)) & 1;
+		const int count = table.counts[length];
+		if (code - count < first) {
+			readBits(length);
+			return table.symbols[index + (code - first)];
+		}
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	return -1;
+}
+
+/// <summary>
+/// Read the header of the next block and prepare its tables
+/// </summary>
+/// <returns>Returns false if the header is invalid</returns>
+bool Inflater::readBlockHeader() {
+	_finalBlock = readBits(1) == 1;
+	_blockType = readBits(2);
+
+	if (_blockType == 0) { // Stored block starts at the next byte
+		readBits(_bitCount % 8);
+		const uint32_t length = readBits(16);
+		const uint32_t complement = readBits(16);
+		_storedRemaining = length;
+		return length == (~complement & 0xFFFF);
+	}
+	else if (_blockType == 1) { // Fixed codes
+		uint8_t lengths[288];
+		std::memset(lengths, 8, 144);
+		std::memset(lengths + 144, 9, 112);
+		std::memset(lengths + 256, 7, 24);
+		std::memset(lengths + 280, 8, 8);
+		buildTable(lengths, 288, _literals);
+		std::memset(lengths, 5, 30);
+		buildTable(lengths, 30, _distances);
+		return true;
+	}
+	else if (_blockType == 2) {
+		return readDynamicTables();
+	}
+	return false;
+}
+
+/// <summary>
+/// Read the code lengths of the dynamic block and build its tables
+/// </summary>
+/// <returns>Returns false if the code lengths are invalid</returns>
+bool Inflater::readDynamicTables() {
+	const int literalCount = readBits(5) + 257;
+	const int distanceCount = readBits(5) + 1;
+	const int codeLengthCount = readBits(4) + 4;
+	if (literalCount > 286 || distanceCount > 30) {
+		return false;
+	}
+
+	uint8_t lengths[288 + 32] = {};
+	for (int i = 0; i < codeLengthCount; i++) {
+		lengths[codeLengthOrder[i]] = readBits(3);
+	}
+	HuffmanTable codeLengths;
+	if (!buildTable(lengths, 19, codeLengths)) {
+		return false;
+	}
+
+	// Lengths of both codes are stored as one sequence, repeats could cross from one to the other
+	std::memset(lengths, 0, sizeof(lengths));
+	const int total = literalCount + distanceCount;
+	for (int i = 0; i < total && !_error;) {
+		const int symbol = decodeSymbol(codeLengths);
+		int repeat = 0;
+		uint8_t value = 0;
+		if (symbol < 0) {
+			return false;
+		}
+		else if (symbol < 16) {
+			lengths[i++] = symbol;
+			continue;
+		}
+		else if (symbol == 16) {
+			if (i == 0) {
+				return false;
+			}
+			value = lengths[i - 1];
+			repeat = 3 + readBits(2);
+		}
+		else if (symbol == 17) {
+			repeat = 3 + readBits(3);
+		}
+		else {
+			repeat = 11 + readBits(7);
+		}
+
+		if (i + repeat > total) {
+			return false;
+		}
+		while (repeat-- > 0) {
+			lengths[i++] = value;
+		}
+	}
+
+	// End of block must have a code
+	if (lengths[256] == 0) {
+		return false;
+	}
+	return buildTable(lengths, literalCount, _literals) && buildTable(lengths + literalCount, distanceCount, _distances);
+}
+
+/// <summary>
+/// Decompress up to the given number of bytes, stops early at the end of the stream or on error
+/// </summary>
+/// <param name="output">Buffer to which the bytes will be saved</param>
+/// <param name="length">Number of bytes wanted</param>
+/// <returns>Returns number of bytes saved</returns>
+size_t Inflater::inflate(uint8_t* output, size_t length) {
+	if (!_headerRead) {
+		const uint32_t method = readBits(8);
+		const uint32_t flags = readBits(8);
+		// Deflate with at most 32 KB window, no preset dictionary
+		_error = (method & 15) != 8 || (method >> 4) > 7 || (method * 256 + flags) % 31 != 0 || (flags & 0x20) != 0;
+		_headerRead = true;
+	}
+
+	const size_t windowMask = _windowSize - 1;
+	size_t produced = 0;
+	auto put = [&](uint8_t byte) {
+		output[produced++] = byte;
+		_window[_windowPosition] = byte;
+		_windowPosition = (_windowPosition + 1) & windowMask;
+	};
+
+	while (produced < length && !_error) {
+		if (_copyLength > 0) { // Rest of the match that did not fit in the previous call
+			const size_t count = std::min(_copyLength, length - produced);
+			for (size_t i = 0; i < count; i++) {
+				put(_window[(_windowPosition - _copyDistance) & windowMask]);
+			}
+			_copyLength -= count;
+			continue;
+		}
+
+		if (_blockType < 0) {
+			if (_done) {
+				break;
+			}
+			_error = !readBlockHeader();
+			continue;
+		}
+
+		if (_blockType == 0) {
+			if (_storedRemaining == 0) {
+				_blockType = -1;
+				_done = _finalBlock;
+				continue;
+			}
+			put(readBits(8));
+			_storedRemaining--;
+			continue;
+		}
+
+		int symbol = decodeSymbol(_literals);
+		if (symbol < 0) {
+			_error = true;
+		}
+		else if (symbol < 256) {
+			put(symbol);
+		}
+		else if (symbol == 256) { // End of block
+			_blockType = -1;
+			_done = _finalBlock;
+		}
+		else {
+			symbol -= 257;
+			if (symbol >= 29) {
+				_error = true;
+				break;
+			}
+			// Extra bits of the length come before the distance code
+			_copyLength = lengthBase[symbol] + readBits(lengthExtra[symbol]);
+			const int distanceSymbol = decodeSymbol(_distances);
+			if (distanceSymbol < 0 || distanceSymbol >= 30) {
+				_error = true;
+				break;
+			}
+			_copyDistance = distanceBase[distanceSymbol] + readBits(distanceExtra[distanceSymbol]);
+			_error = _copyDistance > _totalOutput + produced;
+		}
+	}
+
+	_totalOutput += produced;
+	_adler = Helpers::adler32(_adler, output, produced);
+	return produced;
+}
+
+/// <summary>
+/// Decompress exactly the given number of bytes
+/// </summary>
+/// <param name="output">Buffer to which the bytes will be saved</param>
+/// <param name="length">Number of bytes wanted</param>
+/// <returns>Returns false if the stream is broken or ends before</returns>
+bool Inflater::read(uint8_t* output, size_t length) {
+	return inflate(output, length) == length;
+}
+
+/// <summary>
+/// Read the rest of the stream and check its checksum, the stream must not hold more data
+/// </summary>
+/// <returns>Returns true if the stream ends here and its checksum matches</returns>
+bool Inflater::finish() {
+	// Usually only the end of the last block is left
+	uint8_t extra;
+	while (!_done && !_error) {
+		if (inflate(&extra, 1) > 0) {
+			return false;
+		}
+	}
+	if (_error) {
+		return false;
+	}
+
+	readBits(_bitCount % 8);
+	uint32_t checksum = 0;
+	for (int i = 0; i < 4; i++) {
+		checksum = (checksum << 8) | readBits(8);
+	}
+	return !_error && checksum == _adler;
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstring>
+
+#include "Helpers.hpp"
+
+/// <summary>
+/// Class for decompressing zlib (deflate) streams, e.g. the image data of PNG
+/// Decompressed data is pulled in pieces of any size, compressed data is pulled from the source when needed,
+/// so neither of them has to be in memory at once - only the 32 KB window is kept
+/// </summary>
+class Inflater {
+public:
+	/// <summary>
+	/// Base length of the length symbols 257 - 285
+	/// </summary>
+	static constexpr uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	/// <summary>
+	/// Number of extra bits of the length symbols 257 - 285
+	/// </summary>
+	static constexpr uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	/// <summary>
+	/// Base distance of the distance symbols 0 - 29
+	/// </summary>
+	static constexpr uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	/// <summary>
+	/// Number of extra bits of the distance symbols 0 - 29
+	/// </summary>
+	static constexpr uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	/// <summary>
+	/// Order in which the lengths of the code length codes are stored
+	/// </summary>
+	static constexpr uint8_t codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+private:
+	/// <summary>
+	/// Number of bits looked up at once, longer codes are decoded bit by bit
+	/// </summary>
+	static constexpr int _fastBits = 10;
+	/// <summary>
+	/// Size of the window - the farthest distance a match could reach
+	/// </summary>
+	static constexpr size_t _windowSize = 32768;
+	/// <summary>
+	/// Number of bytes pulled from the source at once
+	/// </summary>
+	static constexpr size_t _inputSize = 65536;
+
+	/// <summary>
+	/// Huffman code decoded mostly by a single table lookup
+	/// </summary>
+	struct HuffmanTable {
+		// Symbol << 4 | code length for every possible _fastBits bits, 0 if the code is longer
+		uint16_t fast[1 << _fastBits];
+		// Number of codes of every length and symbols sorted by their code, for the longer codes
+		uint16_t counts[16];
+		uint16_t symbols[288];
+	};
+
+	/// <summary>
+	/// Function that fills the buffer with compressed data and returns number of bytes, 0 at the end
+	/// </summary>
+	std::function<size_t(uint8_t*, size_t)> _source;
+	std::vector<uint8_t> _input;
+	size_t _inputPosition = 0;
+	size_t _inputEnd = 0;
+	bool _inputFinished = false;
+	uint64_t _bitBuffer = 0;
+	int _bitCount = 0;
+	/// <summary>
+	/// Number of bits read after the end of the input, any of them means the stream is broken
+	/// </summary>
+	int _overrun = 0;
+
+	std::vector<uint8_t> _window;
+	size_t _windowPosition = 0;
+	uint64_t _totalOutput = 0;
+	uint32_t _adler = 1;
+
+	bool _headerRead = false;
+	bool _finalBlock = false;
+	bool _done = false;
+	bool _error = false;
+	/// <summary>
+	/// Type of the current block - 0 stored, 1 fixed, 2 dynamic, -1 between blocks
+	/// </summary>
+	int _blockType = -1;
+	size_t _storedRemaining = 0;
+	size_t _copyLength = 0;
+	size_t _copyDistance = 0;
+	HuffmanTable _literals;
+	HuffmanTable _distances;
+
+	/// <summary>
+	/// Make sure at least the given number of bits is in the bit buffer, pulling the input when needed
+	/// </summary>
+	/// <param name="count">Number of bits needed, at most 57</param>
+	void ensureBits(int count);
+	/// <summary>
+	/// Read the given number of bits, least significant first
+	/// </summary>
+	/// <param name="count">Number of bits, at most 32</param>
+	/// <returns>Returns the bits</returns>
+	uint32_t readBits(int count);
+	/// <summary>
+	/// Build the table for the canonical Huffman code with the given code lengths
+	/// </summary>
+	/// <param name="lengths">Code length of every symbol, 0 if the symbol is not used</param>
+	/// <param name="count">Number of symbols</param>
+	/// <param name="table">Table to which the code will be saved</param>
+	/// <returns>Returns false if the lengths do not form a valid code</returns>
+	bool buildTable(const uint8_t* lengths, int count, HuffmanTable& table) const;
+	/// <summary>
+	/// Decode the next symbol with the given table
+	/// </summary>
+	/// <param name="table">Table of the code</param>
+	/// <returns>Returns the symbol, -1 for invalid code</returns>
+	int decodeSymbol(const HuffmanTable& table);
+	/// <summary>
+	/// Read the header of the next block and prepare its tables
+	/// </summary>
+	/// <returns>Returns false if the header is invalid</returns>
+	bool readBlockHeader();
+	/// <summary>
+	/// Read the code lengths of the dynamic block and build its tables
+	/// </summary>
+	/// <returns>Returns false if the code lengths are invalid</returns>
+	bool readDynamicTables();
+	/// <summary>
+	/// Decompress up to the given number of bytes, stops early at the end of the stream or on error
+	/// </summary>
+	/// <param name="output">Buffer to which the bytes will be saved</param>
+	/// <param name="length">Number of bytes wanted</param>
+	/// <returns>Returns number of bytes saved</returns>
+	size_t inflate(uint8_t* output, size_t length);
+
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="source">Function that fills the buffer with compressed data and returns number of bytes, 0 at the end</param>
+	Inflater(std::function<size_t(uint8_t*, size_t)> source) : _source(source), _input(_inputSize), _window(_windowSize) {}
+	~Inflater() {}
+
+	/// <summary>
+	/// Decompress exactly the given number of bytes
+	/// </summary>
+	/// <param name="output">Buffer to which the bytes will be saved</param>
+	/// <param name="length">Number of bytes wanted</param>
+	/// <returns>Returns false if the stream is broken or ends before</returns>
+	bool read(uint8_t* output, size_t length);
+	/// <summary>
+	/// Read the rest of the stream and check its checksum, the stream must not hold more data
+	/// </summary>
+	/// <returns>Returns true if the stream ends here and its checksum matches</returns>
+	bool finish();
+};
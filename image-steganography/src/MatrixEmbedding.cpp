@@ -0,0 +1,149 @@
+#pragma once
+#include "MatrixEmbedding.hpp"
+
+/// <summary>
+/// Constructor - builds the syndrome tables
+/// </summary>
+MatrixEmbedding::MatrixEmbedding() {
+	for (int j = 0; j < _maxGroupBytes; j++) {
+		for (int b = 0; b < 256; b++) {
+			uint8_t syndrome = 0;
+			for (int i = 0; i < 8; i++) {
+				if ((b >> i) & 1) {
+					syndrome ^= (uint8_t)(8 * j + i + 1);
+				}
+			}
+			_syndromes[j][b] = syndrome;
+		}
+	}
+}
+
+/// <summary>
+/// Calculate the syndrome of the group from its lowest bits, 8 channels at a time
+/// </summary>
+/// <param name="channels">Pointer to the first channel of the group</param>
+/// <param name="groupLength">Number of channels of the group</param>
+/// <returns>Returns the syndrome</returns>
+int MatrixEmbedding::getSyndrome(const uint8_t* channels, size_t groupLength) const {
+	int syndrome = 0;
+	size_t j = 0;
+	for (; (j + 1) * 8 <= groupLength; j++) {
+		syndrome ^= _syndromes[j][packLowestBits(channels + j * 8)];
+	}
+
+	// Last channels of the group must not be read past, they could be the last channels of the image
+	uint8_t tail = 0;
+	for (size_t i = j * 8; i < groupLength; i++) {
+		tail |= (channels[i] & 1) << (i - j * 8);
+	}
+	return syndrome ^ _syndromes[j][tail];
+}
+
+/// <summary>
+/// Check if the level could be used, 0 or 2 to 7 - level 1 would be the plain replacement
+/// </summary>
+/// <param name="level">Number of bits hidden in every group</param>
+/// <returns>Returns true if the level is supported</returns>
+bool MatrixEmbedding::isSupportedLevel(int level) {
+	return level == 0 || (level >= 2 && level <= _maxLevel);
+}
+
+/// <summary>
+/// Number of channels of a single group
+/// </summary>
+/// <param name="level">Number of bits hidden in every group</param>
+/// <returns>Returns 2^level - 1, 1 for the plain replacement</returns>
+size_t MatrixEmbedding::getGroupLength(int level) {
+	return level == 0 ? 1 : ((size_t)1 << level) - 1;
+}
+
+/// <summary>
+/// Number of channels that hold the given number of bits, the last group is padded with zero bits
+/// </summary>
+/// <param name="bitCount">Number of bits of the data</param>
+/// <param name="level">Number of bits hidden in every group</param>
+/// <returns>Returns number of channels</returns>
+size_t MatrixEmbedding::getCarrierLength(size_t bitCount, int level) {
+	if (level == 0) {
+		return bitCount;
+	}
+	return (bitCount + level - 1) / level * getGroupLength(level);
+}
+
+/// <summary>
+/// Number of bits that the given number of channels could hold
+/// </summary>
+/// <param name="channelCount">Number of channels</param>
+/// <param name="level">Number of bits hidden in every group</param>
+/// <returns>Returns number of bits</returns>
+size_t MatrixEmbedding::getPayloadLength(size_t channelCount, int level) {
+	if (level == 0) {
+		return channelCount;
+	}
+	return channelCount / getGroupLength(level) * level;
+}
+
+/// <summary>
+/// Hide the data in the lowest bits of the channels, the bits of every byte go from the highest one
+/// </summary>
+/// <param name="channels">Pointer to the first channel, getCarrierLength channels must follow</param>
+/// <param name="data">Data that will be hidden</param>
+/// <param name="level">Number of bits hidden in every group</param>
+/// <returns>Returns number of channels that have been changed</returns>
+size_t MatrixEmbedding::embed(uint8_t* channels, const std::string& data, int level) const {
+	const size_t bitCount = data.length() * 8;
+	const size_t groupLength = getGroupLength(level);
+	size_t changed = 0;
+	if (level == 0) {
+		for (size_t i = 0; i < bitCount; i++) {
+			uint8_t bit = ((unsigned char)data[i >> 3] >> (7 - (i & 7))) & 1;
+			changed += (channels[i] & 1) != bit;
+			channels[i] = (channels[i] & 0xFE) | bit;
+		}
+		return changed;
+	}
+
+	for (size_t bit = 0; bit < bitCount; bit += level, channels += groupLength) {
+		// Bits past the end of the data pad the last group with zeros
+		int message = 0;
+		for (int i = 0; i < level; i++) {
+			const size_t index = bit + i;
+			message = (message << 1) | (index < bitCount ? ((unsigned char)data[index >> 3] >> (7 - (index & 7))) & 1 : 0);
+		}
+
+		const int position = getSyndrome(channels, groupLength) ^ message;
+		if (position != 0) {
+			channels[position - 1] ^= 1;
+			changed++;
+		}
+	}
+	return changed;
+}
+
+/// <summary>
+/// Read the data hidden by embed
+/// </summary>
+/// <param name="channels">Pointer to the first channel</param>
+/// <param name="length">Number of bytes of the data</param>
+/// <param name="level">Number of bits hidden in every group</param>
+/// <returns>Returns the data</returns>
+std::string MatrixEmbedding::extract(const uint8_t* channels, size_t length, int level) const {
+	std::string data(length, '\0');
+	const size_t bitCount = length * 8;
+	const size_t groupLength = getGroupLength(level);
+	if (level == 0) {
+		for (size_t i = 0; i < bitCount; i++) {
+			data[i >> 3] |= (channels[i] & 1) << (7 - (i & 7));
+		}
+		return data;
+	}
+
+	for (size_t bit = 0; bit < bitCount; bit += level, channels += groupLength) {
+		const int syndrome = getSyndrome(channels, groupLength);
+		for (int i = 0; i < level && bit + i < bitCount; i++) {
+			const size_t index = bit + i;
+			data[index >> 3] |= ((syndrome >> (level - 1 - i)) & 1) << (7 - (index & 7));
+		}
+	}
+	return data;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+/// <summary>
+/// Matrix embedding with binary Hamming codes - k bits of the message are hidden in the lowest bits of 2^k - 1 channels
+/// by changing at most one of them
+///
+/// The k bits of a group are the syndrome of its channels - XOR of the positions (1 to 2^k - 1) of the channels whose lowest bit is set.
+/// The encoder flips the lowest bit of the channel at position syndrome XOR message, so on average a payload bit costs
+/// (1 - 2^-k) / k changes instead of 1/2 of the plain replacement, at the price of more channels per bit.
+/// Level 0 is the plain replacement, one channel per bit.
+/// </summary>
+class MatrixEmbedding {
+private:
+	/// <summary>
+	/// Highest supported level, a group of 127 channels
+	/// </summary>
+	static const int _maxLevel = 7;
+	/// <summary>
+	/// Number of bytes of the lowest bits of the longest group
+	/// </summary>
+	static const int _maxGroupBytes = 16;
+
+	/// <summary>
+	/// Syndrome of 8 channels packed into a byte for every byte of the group - XOR of the positions of the set bits
+	/// </summary>
+	uint8_t _syndromes[_maxGroupBytes][256];
+
+	/// <summary>
+	/// Pack the lowest bits of 8 channels into a byte, the first channel goes to the lowest bit
+	/// </summary>
+	/// <param name="channels">Pointer to the first of the 8 channels</param>
+	/// <returns>Returns the packed bits</returns>
+	static uint8_t packLowestBits(const uint8_t* channels) {
+		// Lowest bit of every byte moves to bit 56 + index of the byte, no two partial products overlap
+		uint64_t word;
+		std::memcpy(&word, channels, sizeof(word));
+		return (uint8_t)(((word & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56);
+	}
+	/// <summary>
+	/// Calculate the syndrome of the group from its lowest bits, 8 channels at a time
+	/// </summary>
+	/// <param name="channels">Pointer to the first channel of the group</param>
+	/// <param name="groupLength">Number of channels of the group</param>
+	/// <returns>Returns the syndrome</returns>
+	int getSyndrome(const uint8_t* channels, size_t groupLength) const;
+
+public:
+	/// <summary>
+	/// Constructor - builds the syndrome tables
+	/// </summary>
+	MatrixEmbedding();
+	~MatrixEmbedding() {}
+
+	/// <summary>
+	/// Check if the level could be used, 0 or 2 to 7 - level 1 would be the plain replacement
+	/// </summary>
+	/// <param name="level">Number of bits hidden in every group</param>
+	/// <returns>Returns true if the level is supported</returns>
+	static bool isSupportedLevel(int level);
+	/// <summary>
+	/// Number of channels of a single group
+	/// </summary>
+	/// <param name="level">Number of bits hidden in every group</param>
+	/// <returns>Returns 2^level - 1, 1 for the plain replacement</returns>
+	static size_t getGroupLength(int level);
+	/// <summary>
+	/// Number of channels that hold the given number of bits, the last group is padded with zero bits
+	/// </summary>
+	/// <param name="bitCount">Number of bits of the data</param>
+	/// <param name="level">Number of bits hidden in every group</param>
+	/// <returns>Returns number of channels</returns>
+	static size_t getCarrierLength(size_t bitCount, int level);
+	/// <summary>
+	/// Number of bits that the given number of channels could hold
+	/// </summary>
+	/// <param name="channelCount">Number of channels</param>
+	/// <param name="level">Number of bits hidden in every group</param>
+	/// <returns>Returns number of bits</returns>
+	static size_t getPayloadLength(size_t channelCount, int level);
+
+	/// <summary>
+	/// Hide the data in the lowest bits of the channels, the bits of every byte go from the highest one
+	/// </summary>
+	/// <param name="channels">Pointer to the first channel, getCarrierLength channels must follow</param>
+	/// <param name="data">Data that will be hidden</param>
+	/// <param name="level">Number of bits hidden in every group</param>
+	/// <returns>Returns number of channels that have been changed</returns>
+	size_t embed(uint8_t* channels, const std::string& data, int level) const;
+	/// <summary>
+	/// Read the data hidden by embed
+	/// </summary>
+	/// <param name="channels">Pointer to the first channel</param>
+	/// <param name="length">Number of bytes of the data</param>
+	/// <param name="level">Number of bits hidden in every group</param>
+	/// <returns>Returns the data</returns>
+	std::string extract(const uint8_t* channels, size_t length, int level) const;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include "MemoryStream.hpp"
+
+/// <summary>
+/// Move the read position relative to the beginning, the current position or the end
+/// </summary>
+MemoryStream::Buffer::pos_type MemoryStream::Buffer::seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) {
+	if (!(mode & std::ios_base::in)) {
+		return pos_type(off_type(-1));
+	}
+
+	off_type base = 0;
+	if (direction == std::ios_base::cur) {
+		base = gptr() - eback();
+	}
+	else if (direction == std::ios_base::end) {
+		base = egptr() - eback();
+	}
+	return seekpos(pos_type(base + offset), mode);
+}
+
+/// <summary>
+/// Move the read position to the absolute position
+/// </summary>
+MemoryStream::Buffer::pos_type MemoryStream::Buffer::seekpos(pos_type position, std::ios_base::openmode mode) {
+	const off_type offset = off_type(position);
+	if (!(mode & std::ios_base::in) || offset < 0 || offset > egptr() - eback()) {
+		return pos_type(off_type(-1));
+	}
+
+	setg(eback(), eback() + offset, egptr());
+	return position;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <istream>
+#include <streambuf>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// Input stream reading the data of a file that is already in memory, so the codecs could parse it without copying
+/// The data is not owned and has to outlive the stream
+/// </summary>
+class MemoryStream : public std::istream {
+private:
+	/// <summary>
+	/// Stream buffer pointing directly at the data, seeking only moves the read position
+	/// </summary>
+	class Buffer : public std::streambuf {
+	public:
+		Buffer(const char* data, size_t length) {
+			char* begin = const_cast<char*>(data);
+			setg(begin, begin, begin + length);
+		}
+
+	protected:
+		/// <summary>
+		/// Move the read position relative to the beginning, the current position or the end
+		/// </summary>
+		pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) override;
+		/// <summary>
+		/// Move the read position to the absolute position
+		/// </summary>
+		pos_type seekpos(pos_type position, std::ios_base::openmode mode) override;
+	};
+
+	Buffer _buffer;
+
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="data">Data of the file</param>
+	/// <param name="length">Number of bytes</param>
+	MemoryStream(const uint8_t* data, size_t length) : std::istream(nullptr), _buffer((const char*)data, length) {
+		rdbuf(&_buffer);
+	}
+	~MemoryStream() {}
+};
@@ -0,0 +1,227 @@
+#pragma once
+#include "PGMCodec.hpp"
+#include "Helpers.hpp"
+
+/// <summary>
+/// Read the next field of the header, white space and comments before it are skipped and comments are kept
+/// </summary>
+/// <param name="file">Input Stream positioned in the header</param>
+/// <param name="pgm">Header to which the comments are added</param>
+/// <param name="field">Modifies the passed field with the text of the field</param>
+/// <returns>Returns false if the header ends before the field</returns>
+bool PGMCodec::readField(std::istream& file, PGMImage& pgm, std::string& field) {
+	field.clear();
+	int c = file.get();
+	while (c != EOF && (std::isspace(c) || c == '#')) {
+		if (c == '#') {
+			std::string comment;
+			std::getline(file, comment);
+			pgm.comments += "#" + comment + "\n";
+		}
+		c = file.get();
+	}
+
+	// Single white space after the field is taken with it, the pixels start right after the last one
+	while (c != EOF && !std::isspace(c)) {
+		if (c == '#') {
+			file.unget();
+			break;
+		}
+		field.push_back((char)c);
+		c = file.get();
+	}
+	return !field.empty();
+}
+
+/// <summary>
+/// Number of bytes of every sample - 1 up to maximum value 255, 2 above
+/// </summary>
+/// <param name="image">Image read from the file, only header data is used</param>
+/// <returns>Returns number of bytes of a sample</returns>
+size_t PGMCodec::getSampleLength(const Image& image) {
+	return image.pgm.maxValue > 255 ? 2 : 1;
+}
+
+/// <summary>
+/// Determine from the first bytes of the file if it is a binary .pgm file - starts with "P5" and a white space
+/// </summary>
+/// <param name="bytes">First bytes of the file</param>
+/// <param name="length">Number of bytes, at most sniffLength</param>
+/// <returns>Returns true if the file is a .pgm file</returns>
+bool PGMCodec::sniff(const uint8_t* bytes, size_t length) {
+	return length >= 3 && bytes[0] == 'P' && bytes[1] == '5' && std::isspace(bytes[2]);
+}
+
+/// <summary>
+/// Read the header of a .pgm file
+/// Leaves the file positioned at the first byte of the pixel data
+/// </summary>
+/// <param name="file">Input Stream of the .pgm file - opened file or its data in memory</param>
+/// <param name="image">Image to which header data will be saved</param>
+/// <returns>Returns if the .pgm header has been successfully read</returns>
+bool PGMCodec::readHeader(std::istream& file, Image& image) {
+	image.fileType = FileType::PGM;
+	image.channels = 1;
+	image.rowDirection = 1;
+
+	// Magic number, width, height and maximum value are separated by any white space, comments could be between them
+	PGMImage pgm;
+	std::string fields[4];
+	for (std::string& field : fields) {
+		if (!readField(file, pgm, field)) {
+			break;
+		}
+	}
+	char* end[3] = {};
+	const unsigned long width = std::strtoul(fields[1].c_str(), &end[0], 10);
+	const unsigned long height = std::strtoul(fields[2].c_str(), &end[1], 10);
+	const unsigned long maxValue = std::strtoul(fields[3].c_str(), &end[2], 10);
+	if (fields[0] != "P5" || *end[0] != '\0' || *end[1] != '\0' || *end[2] != '\0' || fields[3].empty()
+		|| width == 0 || height == 0 || width > UINT32_MAX || height > UINT32_MAX || maxValue == 0 || maxValue > _maxSampleValue) {
+		std::cout << "Error: Invalid PGM format" << std::endl;
+		return false;
+	}
+
+	pgm.magicNumber = fields[0];
+	image.width = pgm.width = (uint32_t)width;
+	image.height = pgm.height = (uint32_t)height;
+	pgm.maxValue = (uint32_t)maxValue;
+	image.pgm = pgm;
+	image.bitsPerPixel = (uint16_t)(getSampleLength(image) * 8);
+
+	// Pixels start right after the header, so they could be written in place later
+	image.dataOffset = (uint32_t)file.tellg();
+	image.dataSize = (uint32_t)(image.getChannelCount() * getSampleLength(image));
+	image.fileSize = image.dataOffset + image.dataSize;
+	if (!file.good()) {
+		return false;
+	}
+
+	// Samples are stored without compression, a header claiming more of them than the file holds is broken
+	if (!image.fitsInFile(image.getRowLength() * getSampleLength(image), Helpers::getRemainingLength(file))) {
+		std::cout << "Error: Invalid PGM format" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// <summary>
+/// Read the pixels of a .pgm file, the header has been read and the pixels allocated
+/// 16 bit samples are split row by row into the pixels and the higher bytes
+/// </summary>
+/// <param name="file">Input Stream of the .pgm file - opened file or its data in memory</param>
+/// <param name="image">Image to which data will be saved</param>
+/// <returns>Returns if the .pgm image has been successfully read</returns>
+bool PGMCodec::readPixels(std::istream& file, Image& image) {
+	const size_t length = image.getChannelCount();
+	if (getSampleLength(image) == 1) {
+		file.read((char*)image.pixels, length);
+		return (size_t)file.gcount() == length;
+	}
+
+	// Samples are big endian, the higher byte comes first
+	const size_t rowLength = image.getRowLength();
+	std::vector<uint8_t> row(rowLength * 2);
+	image.pgm.highBytes.resize(length);
+	for (size_t y = 0; y < image.height; y++) {
+		file.read((char*)row.data(), row.size());
+		if ((size_t)file.gcount() != row.size()) {
+			return false;
+		}
+		uint8_t* low = image.pixels + y * rowLength;
+		char* high = &image.pgm.highBytes[y * rowLength];
+		for (size_t x = 0; x < rowLength; x++) {
+			high[x] = (char)row[2 * x];
+			low[x] = row[2 * x + 1];
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// Save the image data to a .pgm file
+/// </summary>
+/// <param name="file">Output Stream to which the .pgm file is saved</param>
+/// <param name="image">Image from which data will be read from</param>
+/// <returns>Returns if the .pgm image has been successfully saved</returns>
+bool PGMCodec::write(std::ostream& file, const Image& image) {
+	const size_t length = image.getChannelCount();
+	if (getSampleLength(image) == 2 && image.pgm.highBytes.size() != length) {
+		return false;
+	}
+
+	file << image.pgm.magicNumber << std::endl;
+	if (image.pgm.comments != "") {
+		file << image.pgm.comments;
+	}
+	file << image.width << " " << image.height << std::endl;
+	file << image.pgm.maxValue << std::endl;
+
+	if (getSampleLength(image) == 1) {
+		file.write((const char*)image.pixels, length);
+		return file.good();
+	}
+
+	// Higher bytes are put back in front of the lower bytes one row at a time
+	const size_t rowLength = image.getRowLength();
+	std::vector<uint8_t> row(rowLength * 2);
+	for (size_t y = 0; y < image.height; y++) {
+		const uint8_t* low = image.pixels + y * rowLength;
+		const char* high = &image.pgm.highBytes[y * rowLength];
+		for (size_t x = 0; x < rowLength; x++) {
+			row[2 * x] = (uint8_t)high[x];
+			row[2 * x + 1] = low[x];
+		}
+		file.write((const char*)row.data(), row.size());
+	}
+
+	// The caller closes the file, return success
+	return file.good();
+}
+
+/// <summary>
+/// Position of the channel in the file, so a changed channel could be written in place
+/// 8 bit samples are stored one after another right after the header, the lower bytes of 16 bit samples are not
+/// </summary>
+/// <param name="image">Image read from the file, only header data is used</param>
+/// <param name="channel">Index of the channel - byte of the pixels</param>
+/// <param name="offset">Modifies the passed offset with the position of the channel in the file</param>
+/// <returns>Returns false if the channel has no fixed position in the file</returns>
+bool PGMCodec::getChannelOffset(const Image& image, size_t channel, uint64_t& offset) {
+	if (getSampleLength(image) != 1) {
+		return false;
+	}
+
+	offset = image.dataOffset + channel;
+	return true;
+}
+
+/// <summary>
+/// Fill the header for saving the pixels as an 8 bit .pgm file, e.g. pixels read from another format
+/// Only width, height and channels of the image are used, the rest of the header is replaced
+/// </summary>
+/// <param name="image">Image which header will be filled</param>
+/// <returns>Returns false if the image is not a gray image</returns>
+bool PGMCodec::createHeader(Image& image) {
+	if (image.channels != 1) {
+		return false;
+	}
+
+	image.fileType = FileType::PGM;
+	image.bitsPerPixel = 8;
+	image.rowDirection = 1;
+
+	PGMImage pgm;
+	pgm.magicNumber = "P5";
+	pgm.width = image.width;
+	pgm.height = image.height;
+	pgm.maxValue = 255;
+	image.pgm = pgm;
+
+	// Same header as write produces, so the pixels could be written in place later
+	const std::string header = pgm.magicNumber + "\n" + std::to_string(image.width) + " " + std::to_string(image.height) + "\n" + std::to_string(pgm.maxValue) + "\n";
+	image.dataOffset = (uint32_t)header.length();
+	image.dataSize = (uint32_t)image.getChannelCount();
+	image.fileSize = image.dataOffset + image.dataSize;
+	return true;
+}
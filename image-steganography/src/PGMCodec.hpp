@@ -0,0 +1,96 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+
+#include "structs.hpp"
+#include "enums.hpp"
+
+/// <summary>
+/// Codec for reading and writing binary .pgm images (P5), registered in CodecRegistry
+/// Samples of 8 bits are the single channel of every pixel. Samples of 16 bits are split - the lower byte, which holds
+/// the lowest bits, becomes the channel and the higher byte is kept aside, see PGMImage::highBytes
+/// </summary>
+class PGMCodec {
+private:
+	/// <summary>
+	/// Highest maximum value of a sample, 16 bits
+	/// </summary>
+	static const uint32_t _maxSampleValue = 65535;
+
+	/// <summary>
+	/// Read the next field of the header, white space and comments before it are skipped and comments are kept
+	/// </summary>
+	/// <param name="file">Input Stream positioned in the header</param>
+	/// <param name="pgm">Header to which the comments are added</param>
+	/// <param name="field">Modifies the passed field with the text of the field</param>
+	/// <returns>Returns false if the header ends before the field</returns>
+	static bool readField(std::istream& file, PGMImage& pgm, std::string& field);
+	/// <summary>
+	/// Number of bytes of every sample - 1 up to maximum value 255, 2 above
+	/// </summary>
+	/// <param name="image">Image read from the file, only header data is used</param>
+	/// <returns>Returns number of bytes of a sample</returns>
+	static size_t getSampleLength(const Image& image);
+
+public:
+	/// <summary>
+	/// Type of the files handled by this codec
+	/// </summary>
+	static constexpr FileType fileType = FileType::PGM;
+	/// <summary>
+	/// Layout of the channels as they are read and written - a single gray channel, rows are stored from the top of the picture
+	/// </summary>
+	static constexpr bool reversedChannels = false;
+
+	/// <summary>
+	/// Determine from the first bytes of the file if it is a binary .pgm file - starts with "P5" and a white space
+	/// </summary>
+	/// <param name="bytes">First bytes of the file</param>
+	/// <param name="length">Number of bytes, at most sniffLength</param>
+	/// <returns>Returns true if the file is a .pgm file</returns>
+	static bool sniff(const uint8_t* bytes, size_t length);
+	/// <summary>
+	/// Read the header of a .pgm file
+	/// Leaves the file positioned at the first byte of the pixel data
+	/// </summary>
+	/// <param name="file">Input Stream of the .pgm file - opened file or its data in memory</param>
+	/// <param name="image">Image to which header data will be saved</param>
+	/// <returns>Returns if the .pgm header has been successfully read</returns>
+	static bool readHeader(std::istream& file, Image& image);
+	/// <summary>
+	/// Read the pixels of a .pgm file, the header has been read and the pixels allocated
+	/// 16 bit samples are split row by row into the pixels and the higher bytes
+	/// </summary>
+	/// <param name="file">Input Stream of the .pgm file - opened file or its data in memory</param>
+	/// <param name="image">Image to which data will be saved</param>
+	/// <returns>Returns if the .pgm image has been successfully read</returns>
+	static bool readPixels(std::istream& file, Image& image);
+	/// <summary>
+	/// Save the image data to a .pgm file
+	/// </summary>
+	/// <param name="file">Output Stream to which the .pgm file is saved</param>
+	/// <param name="image">Image from which data will be read from</param>
+	/// <returns>Returns if the .pgm image has been successfully saved</returns>
+	static bool write(std::ostream& file, const Image& image);
+	/// <summary>
+	/// Position of the channel in the file, so a changed channel could be written in place
+	/// 8 bit samples are stored one after another right after the header, the lower bytes of 16 bit samples are not
+	/// </summary>
+	/// <param name="image">Image read from the file, only header data is used</param>
+	/// <param name="channel">Index of the channel - byte of the pixels</param>
+	/// <param name="offset">Modifies the passed offset with the position of the channel in the file</param>
+	/// <returns>Returns false if the channel has no fixed position in the file</returns>
+	static bool getChannelOffset(const Image& image, size_t channel, uint64_t& offset);
+	/// <summary>
+	/// Fill the header for saving the pixels as an 8 bit .pgm file, e.g. pixels read from another format
+	/// Only width, height and channels of the image are used, the rest of the header is replaced
+	/// </summary>
+	/// <param name="image">Image which header will be filled</param>
+	/// <returns>Returns false if the image is not a gray image</returns>
+	static bool createHeader(Image& image);
+};
@@ -0,0 +1,426 @@
+#pragma once
+#include "PNGCodec.hpp"
+
+/// <summary>
+/// Determine from the first bytes of the file if it is a .png file - starts with the 8 byte signature
+/// </summary>
+/// <param name="bytes">First bytes of the file</param>
+/// <param name="length">Number of bytes, at most sniffLength</param>
+/// <returns>Returns true if the file is a .png file</returns>
+bool PNGCodec::sniff(const uint8_t* bytes, size_t length) {
+	return length >= sizeof(_signature) && std::memcmp(bytes, _signature, sizeof(_signature)) == 0;
+}
+
+/// <summary>
+/// Read the header of a .png file and every chunk before the image data
+/// Leaves the file positioned at the first image data chunk
+/// </summary>
+/// <param name="file">Input Stream of the .png file - opened file or its data in memory</param>
+/// <param name="image">Image to which header data will be saved</param>
+/// <returns>Returns if the .png header has been successfully read</returns>
+bool PNGCodec::readHeader(std::istream& file, Image& image) {
+	image.fileType = FileType::PNG;
+	image.rowDirection = 1;
+	PNGImage png;
+
+	uint8_t signature[8] = {};
+	file.read((char*)signature, sizeof(signature));
+	std::string type, chunk;
+	if (!sniff(signature, sizeof(signature)) || !readChunk(file, type, chunk) || type != "IHDR" || chunk.size() != 25) {
+		std::cout << "Error: Invalid PNG format" << std::endl;
+		return false;
+	}
+
+	// Numbers in .png are big endian
+	const uint8_t* header = (const uint8_t*)chunk.data() + 8;
+	image.width = (uint32_t)header[0] << 24 | header[1] << 16 | header[2] << 8 | header[3];
+	image.height = (uint32_t)header[4] << 24 | header[5] << 16 | header[6] << 8 | header[7];
+	png.bitDepth = header[8];
+	png.colorType = header[9];
+	png.compressionMethod = header[10];
+	png.filterMethod = header[11];
+	png.interlaceMethod = header[12];
+
+	// Samples of every pixel - gray, -, RGB, palette index, gray with alpha, -, RGB with alpha
+	const int samples[7] = { 1, 0, 3, 1, 2, 0, 4 };
+	image.bitsPerPixel = png.colorType < 7 ? samples[png.colorType] * png.bitDepth : 0;
+	image.channels = png.colorType < 7 ? (uint8_t)samples[png.colorType] : 0;
+	image.dataSize = (uint32_t)((uint64_t)image.width * image.height * image.bitsPerPixel / 8);
+
+	// Chunks up to the first image data are kept, so they could be written back
+	while (true) {
+		const std::streampos start = file.tellg();
+		char chunkHeader[8] = {};
+		file.read(chunkHeader, sizeof(chunkHeader));
+		file.seekg(start);
+		if (file.good() && std::memcmp(chunkHeader + 4, "IDAT", 4) == 0) { // Image data is read only with the pixels
+			break;
+		}
+		if (!readChunk(file, type, chunk) || type == "IEND") {
+			std::cout << "Error: Invalid PNG format" << std::endl;
+			return false;
+		}
+		png.chunksBeforeData.push_back(chunk);
+	}
+
+	image.dataOffset = (uint32_t)file.tellg();
+	file.seekg(0, std::ios::end);
+	image.fileSize = (uint32_t)file.tellg();
+	file.seekg(image.dataOffset);
+	image.png = png;
+	if (!file.good()) {
+		return false;
+	}
+
+	// Compressed rows are bounded by the most deflate could inflate from the rest of the file and by maxChannelCount
+	const uint64_t rowBytes = ((uint64_t)image.width * image.bitsPerPixel + 7) / 8 + 1;
+	const uint64_t remaining = Helpers::getRemainingLength(file);
+	if (!image.hasSupportedSize() || !image.fitsInFile(rowBytes, std::min(remaining, UINT64_MAX / _maxInflateRatio) * _maxInflateRatio)) {
+		std::cout << "Error: Invalid PNG format" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// <summary>
+/// Read the pixels of a .png file, the header has been read and the pixels allocated
+/// Image data is inflated row by row as it is read, only 8 bit images without palette and interlacing are supported
+/// </summary>
+/// <param name="file">Input Stream of the .png file - opened file or its data in memory</param>
+/// <param name="image">Image to which data will be saved to</param>
+/// <returns>Returns if the .png image has been successfully read</returns>
+bool PNGCodec::readPixels(std::istream& file, Image& image) {
+	if (!isSupportedLayout(image.png) || image.png.interlaceMethod != 0) {
+		std::cout << "Error: only 8 bit gray, RGB or RGBA PNG without interlacing is supported" << std::endl;
+		return false;
+	}
+
+	// Image data chunks are pulled by the inflater one piece at a time, their CRC is checked on the way
+	uint32_t chunkRemaining = 0;
+	uint32_t crc = 0;
+	bool inChunk = false, dataEnded = false, broken = false;
+	auto readNumber = [&file]() {
+		uint8_t bytes[4] = {};
+		file.read((char*)bytes, 4);
+		return (uint32_t)bytes[0] << 24 | bytes[1] << 16 | bytes[2] << 8 | bytes[3];
+	};
+	auto source = [&](uint8_t* buffer, size_t size) -> size_t {
+		while (!dataEnded && chunkRemaining == 0) {
+			if (inChunk && readNumber() != crc) {
+				broken = dataEnded = true;
+				break;
+			}
+			inChunk = false;
+
+			const uint32_t length = readNumber();
+			char type[4] = {};
+			file.read(type, 4);
+			if (!file.good()) {
+				broken = dataEnded = true;
+				break;
+			}
+			if (std::memcmp(type, "IDAT", 4) != 0) { // Chunks after the image data are read later
+				file.seekg(-8, std::ios::cur);
+				dataEnded = true;
+				break;
+			}
+			crc = Helpers::crc32(0, (const uint8_t*)type, 4);
+			chunkRemaining = length;
+			inChunk = true;
+		}
+		if (dataEnded) {
+			return 0;
+		}
+
+		file.read((char*)buffer, std::min((size_t)chunkRemaining, size));
+		const size_t count = (size_t)file.gcount();
+		crc = Helpers::crc32(crc, buffer, count);
+		chunkRemaining -= (uint32_t)count;
+		if (count == 0) {
+			broken = dataEnded = true;
+		}
+		return count;
+	};
+
+	// Every row starts with its filter type, the previous row is already in the pixels
+	Inflater inflater(source);
+	const size_t rowLength = image.getRowLength();
+	uint8_t* raster = (uint8_t*)image.pixels;
+	bool status = true;
+	for (size_t y = 0; y < image.height && status; y++) {
+		uint8_t* row = raster + y * rowLength;
+		uint8_t filter = 0;
+		status = inflater.read(&filter, 1) && inflater.read(row, rowLength)
+			&& unfilterRow(filter, row, y > 0 ? row - rowLength : nullptr, rowLength, image.channels);
+	}
+	status = status && inflater.finish();
+	uint8_t rest[256];
+	while (status && source(rest, sizeof(rest)) > 0) {} // Skip what is left of the image data
+	if (!status || broken) {
+		std::cout << "Error: PNG image data is broken" << std::endl;
+		return false;
+	}
+
+	// Keep the chunks after the image data up to the end
+	std::string type, chunk;
+	while (readChunk(file, type, chunk)) {
+		if (type == "IEND") {
+			return true;
+		}
+		image.png.chunksAfterData.push_back(chunk);
+	}
+	return false;
+}
+
+/// <summary>
+/// Save the image data to a .png file
+/// Rows are filtered and deflated one by one, chunks other than the image data are written back unchanged
+/// </summary>
+/// <param name="file">Output Stream to which the .png file is saved</param>
+/// <param name="image">Image from which data will be read from</param>
+/// <returns>Returns if the .png image has been successfully saved</returns>
+bool PNGCodec::write(std::ostream& file, const Image& image) {
+	file.write((const char*)_signature, sizeof(_signature));
+
+	// Pixels are always written with 8 bit channels without interlacing, the color type keeps the number of channels
+	uint8_t header[13] = {
+		(uint8_t)(image.width >> 24), (uint8_t)(image.width >> 16), (uint8_t)(image.width >> 8), (uint8_t)image.width,
+		(uint8_t)(image.height >> 24), (uint8_t)(image.height >> 16), (uint8_t)(image.height >> 8), (uint8_t)image.height,
+		8, image.png.colorType, 0, 0, 0
+	};
+	writeChunk(file, "IHDR", header, sizeof(header));
+	for (const std::string& chunk : image.png.chunksBeforeData) {
+		file.write(chunk.data(), chunk.size());
+	}
+
+	// Every piece of the compressed stream becomes one image data chunk
+	Deflater deflater([&](const uint8_t* data, size_t length) {
+		writeChunk(file, "IDAT", data, length);
+		return file.good();
+	}, image.png.bestCompression);
+
+	const size_t rowLength = image.getRowLength();
+	const uint8_t* raster = (const uint8_t*)image.pixels;
+	std::vector<uint8_t> filtered(rowLength + 1);
+	for (size_t y = 0; y < image.height; y++) {
+		const uint8_t* row = raster + y * rowLength;
+		filterRow(row, y > 0 ? row - rowLength : nullptr, rowLength, image.channels, filtered.data());
+		if (!deflater.write(filtered.data(), filtered.size())) {
+			return false;
+		}
+	}
+	if (!deflater.finish()) {
+		return false;
+	}
+
+	for (const std::string& chunk : image.png.chunksAfterData) {
+		file.write(chunk.data(), chunk.size());
+	}
+	writeChunk(file, "IEND", nullptr, 0);
+	return file.good();
+}
+
+/// <summary>
+/// Read a whole chunk of the .png file and check its CRC
+/// </summary>
+/// <param name="file">Input Stream positioned at the beginning of the chunk</param>
+/// <param name="type">Modifies the passed type with the type of the chunk</param>
+/// <param name="chunk">Modifies the passed chunk with the whole chunk - length, type, data and CRC</param>
+/// <returns>Returns false if the chunk could not be read or its CRC does not match</returns>
+bool PNGCodec::readChunk(std::istream& file, std::string& type, std::string& chunk) {
+	chunk.resize(8);
+	file.read(&chunk[0], 8);
+	if (!file.good()) {
+		return false;
+	}
+
+	const uint8_t* header = (const uint8_t*)chunk.data();
+	const uint32_t length = (uint32_t)header[0] << 24 | header[1] << 16 | header[2] << 8 | header[3];
+	if (length > 0x7FFFFFFF) {
+		return false;
+	}
+	type = chunk.substr(4, 4);
+	chunk.resize(12 + (size_t)length);
+	file.read(&chunk[8], length + 4);
+	if (!file.good()) {
+		return false;
+	}
+
+	const uint8_t* crcBytes = (const uint8_t*)chunk.data() + 8 + length;
+	const uint32_t crc = (uint32_t)crcBytes[0] << 24 | crcBytes[1] << 16 | crcBytes[2] << 8 | crcBytes[3];
+	return crc == Helpers::crc32(0, (const uint8_t*)chunk.data() + 4, 4 + (size_t)length);
+}
+
+/// <summary>
+/// Write a chunk of the .png file with its CRC
+/// </summary>
+/// <param name="file">Output Stream</param>
+/// <param name="type">Type of the chunk, 4 chars</param>
+/// <param name="data">Data of the chunk</param>
+/// <param name="length">Number of bytes of the data</param>
+void PNGCodec::writeChunk(std::ostream& file, const char* type, const uint8_t* data, size_t length) {
+	// Numbers in .png are big endian
+	const uint8_t lengthBytes[4] = { (uint8_t)(length >> 24), (uint8_t)(length >> 16), (uint8_t)(length >> 8), (uint8_t)length };
+	file.write((const char*)lengthBytes, 4);
+	file.write(type, 4);
+	file.write((const char*)data, length);
+
+	uint32_t crc = Helpers::crc32(0, (const uint8_t*)type, 4);
+	crc = Helpers::crc32(crc, data, length);
+	const uint8_t crcBytes[4] = { (uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc };
+	file.write((const char*)crcBytes, 4);
+}
+
+/// <summary>
+/// Filter a single row of the .png image with the filter that gives the smallest sum of absolute differences
+/// </summary>
+/// <param name="row">Bytes of the row</param>
+/// <param name="previous">Bytes of the previous row, nullptr for the first row</param>
+/// <param name="length">Number of bytes of the row</param>
+/// <param name="bytesPerPixel">Number of bytes of a single pixel</param>
+/// <param name="output">Filter type followed by the filtered bytes, length + 1 bytes</param>
+void PNGCodec::filterRow(const uint8_t* row, const uint8_t* previous, size_t length, size_t bytesPerPixel, uint8_t* output) {
+	// Prediction of the byte from its left, up and upper left neighbours for every filter
+	auto predict = [&](int filter, size_t i) -> uint8_t {
+		const int left = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+		const int up = previous != nullptr ? previous[i] : 0;
+		const int upperLeft = previous != nullptr && i >= bytesPerPixel ? previous[i - bytesPerPixel] : 0;
+		switch (filter) {
+		case 1: return left;
+		case 2: return up;
+		case 3: return (left + up) / 2;
+		case 4: {
+			const int estimate = left + up - upperLeft;
+			const int distanceLeft = std::abs(estimate - left);
+			const int distanceUp = std::abs(estimate - up);
+			const int distanceUpperLeft = std::abs(estimate - upperLeft);
+			if (distanceLeft <= distanceUp && distanceLeft <= distanceUpperLeft) {
+				return left;
+			}
+			return distanceUp <= distanceUpperLeft ? up : upperLeft;
+		}
+		default: return 0;
+		}
+	};
+
+	int bestFilter = 0;
+	uint64_t bestSum = UINT64_MAX;
+	for (int filter = 0; filter < 5; filter++) {
+		uint64_t sum = 0;
+		for (size_t i = 0; i < length && sum < bestSum; i++) {
+			sum += std::abs((int8_t)(row[i] - predict(filter, i)));
+		}
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestFilter = filter;
+		}
+	}
+
+	output[0] = (uint8_t)bestFilter;
+	for (size_t i = 0; i < length; i++) {
+		output[i + 1] = (uint8_t)(row[i] - predict(bestFilter, i));
+	}
+}
+
+/// <summary>
+/// Undo the filter of a single row of the .png image in place
+/// </summary>
+/// <param name="filter">Type of the filter, 0 - 4</param>
+/// <param name="row">Bytes of the row</param>
+/// <param name="previous">Bytes of the previous row, nullptr for the first row</param>
+/// <param name="length">Number of bytes of the row</param>
+/// <param name="bytesPerPixel">Number of bytes of a single pixel</param>
+/// <returns>Returns false for unknown filter</returns>
+bool PNGCodec::unfilterRow(uint8_t filter, uint8_t* row, const uint8_t* previous, size_t length, size_t bytesPerPixel) {
+	switch (filter) {
+	case 0: // None
+		return true;
+	case 1: // Sub
+		for (size_t i = bytesPerPixel; i < length; i++) {
+			row[i] += row[i - bytesPerPixel];
+		}
+		return true;
+	case 2: // Up
+		if (previous != nullptr) {
+			for (size_t i = 0; i < length; i++) {
+				row[i] += previous[i];
+			}
+		}
+		return true;
+	case 3: // Average
+		for (size_t i = 0; i < length; i++) {
+			const int left = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+			const int up = previous != nullptr ? previous[i] : 0;
+			row[i] += (uint8_t)((left + up) / 2);
+		}
+		return true;
+	case 4: // Paeth
+		for (size_t i = 0; i < length; i++) {
+			const int left = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+			const int up = previous != nullptr ? previous[i] : 0;
+			const int upperLeft = previous != nullptr && i >= bytesPerPixel ? previous[i - bytesPerPixel] : 0;
+			const int estimate = left + up - upperLeft;
+			const int distanceLeft = std::abs(estimate - left);
+			const int distanceUp = std::abs(estimate - up);
+			const int distanceUpperLeft = std::abs(estimate - upperLeft);
+			if (distanceLeft <= distanceUp && distanceLeft <= distanceUpperLeft) {
+				row[i] += (uint8_t)left;
+			}
+			else {
+				row[i] += (uint8_t)(distanceUp <= distanceUpperLeft ? up : upperLeft);
+			}
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+/// <summary>
+/// Position of the channel in the file, so a changed channel could be written in place
+/// Pixels are compressed, so no channel has a fixed position
+/// </summary>
+/// <param name="image">Image read from the file, only header data is used</param>
+/// <param name="channel">Index of the channel - byte of the pixels</param>
+/// <param name="offset">Modifies the passed offset with the position of the channel in the file</param>
+/// <returns>Returns false if the channel has no fixed position in the file</returns>
+bool PNGCodec::getChannelOffset(const Image&, size_t, uint64_t&) {
+	return false;
+}
+
+/// <summary>
+/// Fill the header for saving the pixels as an 8 bit .png file without other chunks, e.g. pixels read from another format
+/// Only width, height and channels of the image are used, the rest of the header is replaced
+/// </summary>
+/// <param name="image">Image which header will be filled</param>
+/// <returns>Returns false if no color type has the number of channels of the image</returns>
+bool PNGCodec::createHeader(Image& image) {
+	// Color type for 1 - 4 channels - gray, gray with alpha, RGB, RGB with alpha
+	const uint8_t colorTypes[5] = { 0, 0, 4, 2, 6 };
+	if (image.channels < 1 || image.channels > 4) {
+		return false;
+	}
+
+	image.fileType = FileType::PNG;
+	image.bitsPerPixel = image.channels * 8;
+	image.rowDirection = 1;
+	image.dataSize = (uint32_t)image.getChannelCount();
+
+	PNGImage png;
+	png.bitDepth = 8;
+	png.colorType = colorTypes[image.channels];
+	png.compressionMethod = 0;
+	png.filterMethod = 0;
+	png.interlaceMethod = 0;
+	image.png = png;
+	return true;
+}
+
+/// <summary>
+/// Check if the pixels could be read - 8 bit channels of gray, gray with alpha, RGB or RGB with alpha, palette is not supported
+/// </summary>
+/// <param name="png">Header of the .png file</param>
+/// <returns>Returns true if the layout of the pixels is supported</returns>
+bool PNGCodec::isSupportedLayout(const PNGImage& png) {
+	return png.bitDepth == 8 && (png.colorType == 0 || png.colorType == 2 || png.colorType == 4 || png.colorType == 6);
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "structs.hpp"
+#include "enums.hpp"
+#include "Helpers.hpp"
+#include "Inflater.hpp"
+#include "Deflater.hpp"
+
+/// <summary>
+/// Codec for reading and writing .png images, registered in CodecRegistry
+/// Image data is inflated and deflated row by row, so only the pixels are held in memory
+/// </summary>
+class PNGCodec {
+private:
+	/// <summary>
+	/// Signature at the beginning of every .png file
+	/// </summary>
+	static constexpr uint8_t _signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	/// <summary>
+	/// Most bytes deflate could inflate from a single byte, a run of 258 bytes takes at least 2 bits
+	/// </summary>
+	static constexpr uint64_t _maxInflateRatio = 1032;
+
+	/// <summary>
+	/// Read a whole chunk of the .png file and check its CRC
+	/// </summary>
+	/// <param name="file">Input Stream positioned at the beginning of the chunk</param>
+	/// <param name="type">Modifies the passed type with the type of the chunk</param>
+	/// <param name="chunk">Modifies the passed chunk with the whole chunk - length, type, data and CRC</param>
+	/// <returns>Returns false if the chunk could not be read or its CRC does not match</returns>
+	static bool readChunk(std::istream& file, std::string& type, std::string& chunk);
+	/// <summary>
+	/// Write a chunk of the .png file with its CRC
+	/// </summary>
+	/// <param name="file">Output Stream</param>
+	/// <param name="type">Type of the chunk, 4 chars</param>
+	/// <param name="data">Data of the chunk</param>
+	/// <param name="length">Number of bytes of the data</param>
+	static void writeChunk(std::ostream& file, const char* type, const uint8_t* data, size_t length);
+	/// <summary>
+	/// Undo the filter of a single row of the .png image in place
+	/// </summary>
+	/// <param name="filter">Type of the filter, 0 - 4</param>
+	/// <param name="row">Bytes of the row</param>
+	/// <param name="previous">Bytes of the previous row, nullptr for the first row</param>
+	/// <param name="length">Number of bytes of the row</param>
+	/// <param name="bytesPerPixel">Number of bytes of a single pixel</param>
+	/// <returns>Returns false for unknown filter</returns>
+	static bool unfilterRow(uint8_t filter, uint8_t* row, const uint8_t* previous, size_t length, size_t bytesPerPixel);
+	/// <summary>
+	/// Filter a single row of the .png image with the filter that gives the smallest sum of absolute differences
+	/// </summary>
+	/// <param name="row">Bytes of the row</param>
+	/// <param name="previous">Bytes of the previous row, nullptr for the first row</param>
+	/// <param name="length">Number of bytes of the row</param>
+	/// <param name="bytesPerPixel">Number of bytes of a single pixel</param>
+	/// <param name="output">Filter type followed by the filtered bytes, length + 1 bytes</param>
+	static void filterRow(const uint8_t* row, const uint8_t* previous, size_t length, size_t bytesPerPixel, uint8_t* output);
+
+public:
+	/// <summary>
+	/// Type of the files handled by this codec
+	/// </summary>
+	static constexpr FileType fileType = FileType::PNG;
+	/// <summary>
+	/// Layout of the channels as they are read and written - red, green, blue order, rows are stored from the top of the picture
+	/// Pixels moved to another format are reordered when the layouts differ
+	/// </summary>
+	static constexpr bool reversedChannels = false;
+
+	/// <summary>
+	/// Determine from the first bytes of the file if it is a .png file - starts with the 8 byte signature
+	/// </summary>
+	/// <param name="bytes">First bytes of the file</param>
+	/// <param name="length">Number of bytes, at most sniffLength</param>
+	/// <returns>Returns true if the file is a .png file</returns>
+	static bool sniff(const uint8_t* bytes, size_t length);
+	/// <summary>
+	/// Read the header of a .png file and every chunk before the image data
+	/// Leaves the file positioned at the first image data chunk
+	/// </summary>
+	/// <param name="file">Input Stream of the .png file - opened file or its data in memory</param>
+	/// <param name="image">Image to which header data will be saved</param>
+	/// <returns>Returns if the .png header has been successfully read</returns>
+	static bool readHeader(std::istream& file, Image& image);
+	/// <summary>
+	/// Read the pixels of a .png file, the header has been read and the pixels allocated
+	/// Image data is inflated row by row as it is read, only 8 bit RGB images without interlacing are supported
+	/// </summary>
+	/// <param name="file">Input Stream of the .png file - opened file or its data in memory</param>
+	/// <param name="image">Image to which data will be saved to</param>
+	/// <returns>Returns if the .png image has been successfully read</returns>
+	static bool readPixels(std::istream& file, Image& image);
+	/// <summary>
+	/// Save the image data to a .png file
+	/// Rows are filtered and deflated one by one, chunks other than the image data are written back unchanged
+	/// </summary>
+	/// <param name="file">Output Stream to which the .png file is saved</param>
+	/// <param name="image">Image from which data will be read from</param>
+	/// <returns>Returns if the .png image has been successfully saved</returns>
+	static bool write(std::ostream& file, const Image& image);
+	/// <summary>
+	/// Position of the channel in the file, so a changed channel could be written in place
+	/// Pixels are compressed, so no channel has a fixed position
+	/// </summary>
+	/// <param name="image">Image read from the file, only header data is used</param>
+	/// <param name="channel">Index of the channel - byte of the pixels</param>
+	/// <param name="offset">Modifies the passed offset with the position of the channel in the file</param>
+	/// <returns>Returns false if the channel has no fixed position in the file</returns>
+	static bool getChannelOffset(const Image& image, size_t channel, uint64_t& offset);
+	/// <summary>
+	/// Fill the header for saving the pixels as an 8 bit .png file without other chunks, e.g. pixels read from another format
+	/// Only width, height and channels of the image are used, the rest of the header is replaced
+	/// </summary>
+	/// <param name="image">Image which header will be filled</param>
+	/// <returns>Returns false if no color type has the number of channels of the image</returns>
+	static bool createHeader(Image& image);
+	/// <summary>
+	/// Check if the pixels could be read - 8 bit channels of gray, gray with alpha, RGB or RGB with alpha, palette is not supported
+	/// </summary>
+	/// <param name="png">Header of the .png file</param>
+	/// <returns>Returns true if the layout of the pixels is supported</returns>
+	static bool isSupportedLayout(const PNGImage& png);
+};
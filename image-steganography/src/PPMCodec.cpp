@@ -0,0 +1,158 @@
+#pragma once
+#include "PPMCodec.hpp"
+#include "Helpers.hpp"
+
+/// <summary>
+/// Determine from the first bytes of the file if it is a .ppm file - starts with "P6" or "P3" and a white space
+/// </summary>
+/// <param name="bytes">First bytes of the file</param>
+/// <param name="length">Number of bytes, at most sniffLength</param>
+/// <returns>Returns true if the file is a .ppm file</returns>
+bool PPMCodec::sniff(const uint8_t* bytes, size_t length) {
+	return length >= 3 && bytes[0] == 'P' && (bytes[1] == '6' || bytes[1] == '3') && std::isspace(bytes[2]);
+}
+
+/// <summary>
+/// Read the header of a .ppm file
+/// Leaves the file positioned at the first byte of the pixel data
+/// </summary>
+/// <param name="file">Input Stream of the .ppm file - opened file or its data in memory</param>
+/// <param name="image">Image to which header data will be saved</param>
+/// <returns>Returns if the .ppm header has been successfully read</returns>
+bool PPMCodec::readHeader(std::istream& file, Image& image) {
+	// Read the PPM file header
+	image.fileType = FileType::PPM;
+	image.bitsPerPixel = 24;
+	image.channels = 3;
+	image.rowDirection = 1;
+	
+	PPMImage ppm;
+	std::getline(file, ppm.magicNumber);
+	if (ppm.magicNumber != "P6" && ppm.magicNumber != "P3") {
+		std::cout << "Error: Invalid PPM format" << std::endl;
+		return false;
+	}
+
+	// Read the next three lines and extract the image width, height, and maximum value
+	std::string line;
+	for (int i = 0; i < 2; ++i) {
+		std::getline(file, line);
+		std::stringstream ss(line);
+		if (line[0] == '#') {
+			ppm.comments += line + "\n";
+			// Skip commented lines
+			--i;
+			continue;
+		}
+		if (i == 0) {
+			// Extract the width and height from the same line
+			ss >> image.width >> image.height;
+			ppm.width = image.width;
+			ppm.height = image.height;
+		}
+		else if (i == 1) {
+			// Extract the maximum value
+			ss >> ppm.max_value;
+		}
+	}
+	
+	image.ppm = ppm;
+	// Pixels start right after the header, so they could be written in place later
+	image.dataOffset = (uint32_t)file.tellg();
+	image.dataSize = (uint32_t)image.getChannelCount();
+	image.fileSize = image.dataSize + sizeof(image.ppm.magicNumber);
+	image.fileSize += sizeof(image.ppm.height) + sizeof(image.ppm.width) + sizeof(image.ppm.max_value);
+	image.fileSize += sizeof(image.ppm.comments);
+	if (!file.good()) {
+		return false;
+	}
+
+	// Every channel takes at least one byte, so a header claiming more pixels than the file holds is broken
+	if (!image.fitsInFile(image.getRowLength(), Helpers::getRemainingLength(file))) {
+		std::cout << "Error: Invalid PPM format" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// <summary>
+/// Read the pixels of a .ppm file, the header has been read and the pixels allocated
+/// </summary>
+/// <param name="file">Input Stream of the .ppm file - opened file or its data in memory</param>
+/// <param name="image">Image to which data will be saved</param>
+/// <returns>Returns if the .ppm image has been successfully read</returns>
+bool PPMCodec::readPixels(std::istream& file, Image& image) {
+	const size_t size = image.getChannelCount();
+	// Read the pixel data
+	file.read((char*)image.pixels, size);
+
+	return (size_t)file.gcount() == size;
+}
+
+/// <summary>
+/// Save the image data to a .ppm file
+/// </summary>
+/// <param name="file">Output Stream to which the .ppm file is saved</param>
+/// <param name="image">Image from which data will be read from</param>
+/// <returns>Returns if the .ppm image has been successfully saved</returns>
+bool PPMCodec::write(std::ostream& file, const Image& image) {
+	file << image.ppm.magicNumber << std::endl;
+	if (image.ppm.comments != "") {
+		file << image.ppm.comments;
+	}
+	file << image.width << " " << image.height << std::endl;
+	file << image.ppm.max_value << std::endl;
+	
+	const size_t size = image.getChannelCount();
+	file.write((char*)image.pixels, size);
+
+	// The caller closes the file, return success
+	return file.good();
+}
+
+/// <summary>
+/// Position of the channel in the file, so a changed channel could be written in place
+/// Pixels are stored one after another right after the header
+/// </summary>
+/// <param name="image">Image read from the file, only header data is used</param>
+/// <param name="channel">Index of the channel - byte of the pixels</param>
+/// <param name="offset">Modifies the passed offset with the position of the channel in the file</param>
+/// <returns>Returns false if the channel has no fixed position in the file</returns>
+bool PPMCodec::getChannelOffset(const Image& image, size_t channel, uint64_t& offset) {
+	if (image.ppm.magicNumber != "P6") {
+		return false;
+	}
+
+	offset = image.dataOffset + channel;
+	return true;
+}
+
+/// <summary>
+/// Fill the header for saving the pixels as a binary .ppm file, e.g. pixels read from another format
+/// Only width, height and channels of the image are used, the rest of the header is replaced
+/// </summary>
+/// <param name="image">Image which header will be filled</param>
+/// <returns>Returns false if the image is not a color image without alpha</returns>
+bool PPMCodec::createHeader(Image& image) {
+	if (image.channels != 3) {
+		return false;
+	}
+
+	image.fileType = FileType::PPM;
+	image.bitsPerPixel = 24;
+	image.rowDirection = 1;
+
+	PPMImage ppm;
+	ppm.magicNumber = "P6";
+	ppm.width = image.width;
+	ppm.height = image.height;
+	ppm.max_value = 255;
+	image.ppm = ppm;
+
+	// Same header as write produces, so the pixels could be written in place later
+	const std::string header = ppm.magicNumber + "\n" + std::to_string(image.width) + " " + std::to_string(image.height) + "\n" + std::to_string(ppm.max_value) + "\n";
+	image.dataOffset = (uint32_t)header.length();
+	image.dataSize = (uint32_t)image.getChannelCount();
+	image.fileSize = image.dataOffset + image.dataSize;
+	return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cctype>
+#include <cstdint>
+
+#include "structs.hpp"
+#include "enums.hpp"
+
+/// <summary>
+/// Codec for reading and writing .ppm images, registered in CodecRegistry
+/// </summary>
+class PPMCodec {
+public:
+	/// <summary>
+	/// Type of the files handled by this codec
+	/// </summary>
+	static constexpr FileType fileType = FileType::PPM;
+	/// <summary>
+	/// Layout of the channels as they are read and written - red, green, blue order, rows are stored from the top of the picture
+	/// Pixels moved to another format are reordered when the layouts differ
+	/// </summary>
+	static constexpr bool reversedChannels = false;
+
+	/// <summary>
+	/// Determine from the first bytes of the file if it is a .ppm file - starts with "P6" or "P3" and a white space
+	/// </summary>
+	/// <param name="bytes">First bytes of the file</param>
+	/// <param name="length">Number of bytes, at most sniffLength</param>
+	/// <returns>Returns true if the file is a .ppm file</returns>
+	static bool sniff(const uint8_t* bytes, size_t length);
+	/// <summary>
+	/// Read the header of a .ppm file
+	/// Leaves the file positioned at the first byte of the pixel data
+	/// </summary>
+	/// <param name="file">Input Stream of the .ppm file - opened file or its data in memory</param>
+	/// <param name="image">Image to which header data will be saved</param>
+	/// <returns>Returns if the .ppm header has been successfully read</returns>
+	static bool readHeader(std::istream& file, Image& image);
+	/// <summary>
+	/// Read the pixels of a .ppm file, the header has been read and the pixels allocated
+	/// </summary>
+	/// <param name="file">Input Stream of the .ppm file - opened file or its data in memory</param>
+	/// <param name="image">Image to which data will be saved</param>
+	/// <returns>Returns if the .ppm image has been successfully read</returns>
+	static bool readPixels(std::istream& file, Image& image);
+	/// <summary>
+	/// Save the image data to a .ppm file
+	/// </summary>
+	/// <param name="file">Output Stream to which the .ppm file is saved</param>
+	/// <param name="image">Image from which data will be read from</param>
+	/// <returns>Returns if the .ppm image has been successfully saved</returns>
+	static bool write(std::ostream& file, const Image& image);
+	/// <summary>
+	/// Position of the channel in the file, so a changed channel could be written in place
+	/// Pixels are stored one after another right after the header
+	/// </summary>
+	/// <param name="image">Image read from the file, only header data is used</param>
+	/// <param name="channel">Index of the channel - byte of the pixels</param>
+	/// <param name="offset">Modifies the passed offset with the position of the channel in the file</param>
+	/// <returns>Returns false if the channel has no fixed position in the file</returns>
+	static bool getChannelOffset(const Image& image, size_t channel, uint64_t& offset);
+	/// <summary>
+	/// Fill the header for saving the pixels as a binary .ppm file, e.g. pixels read from another format
+	/// Only width, height and channels of the image are used, the rest of the header is replaced
+	/// </summary>
+	/// <param name="image">Image which header will be filled</param>
+	/// <returns>Returns false if the image is not a color image without alpha</returns>
+	static bool createHeader(Image& image);
+};
@@ -0,0 +1,185 @@
+#pragma once
+#include "ProbeIndex.hpp"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+/// <summary>
+/// Entry at the position of the sorted entries
+/// </summary>
+/// <param name="index">Position of the entry</param>
+/// <returns>Returns pointer to the entry in the opened index</returns>
+const ProbeIndex::Entry* ProbeIndex::getEntry(size_t index) const {
+	return (const Entry*)(_data + _headerSize) + index;
+}
+
+/// <summary>
+/// Path of the entry, empty if it points outside of the index
+/// </summary>
+/// <param name="entry">Entry of the opened index</param>
+/// <returns>Returns path of the entry</returns>
+std::string_view ProbeIndex::getPath(const Entry* entry) const {
+	if (entry->pathOffset > _length || entry->pathLength > _length - entry->pathOffset) {
+		return std::string_view();
+	}
+	return std::string_view((const char*)_data + entry->pathOffset, entry->pathLength);
+}
+
+/// <summary>
+/// Open the index saved in the file, a missing or damaged index is treated as empty
+/// </summary>
+/// <param name="indexPath">Path of the index file</param>
+/// <returns>Returns false if there is no valid index in the file</returns>
+bool ProbeIndex::open(const std::string& indexPath) {
+	close();
+#ifdef __linux__
+	int fd = ::open(indexPath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat status;
+	if (fstat(fd, &status) == 0 && status.st_size >= (off_t)_headerSize) {
+		void* mapped = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (mapped != MAP_FAILED) {
+			_data = (const uint8_t*)mapped;
+			_length = (size_t)status.st_size;
+			_mapped = true;
+		}
+	}
+	::close(fd);
+#else
+	std::ifstream file(indexPath, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+	_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	_data = (const uint8_t*)_buffer.data();
+	_length = _buffer.size();
+#endif
+
+	// Every entry must lie inside of the file, paths are checked when they are read
+	uint64_t count = 0;
+	if (_length >= _headerSize) {
+		std::memcpy(&count, _data + sizeof(_magic), sizeof(count));
+	}
+	if (_length < _headerSize || std::memcmp(_data, _magic, sizeof(_magic)) != 0 || count > (_length - _headerSize) / sizeof(Entry)) {
+		close();
+		return false;
+	}
+	_count = (size_t)count;
+	return true;
+}
+
+/// <summary>
+/// Close the opened index, records found before stay valid
+/// </summary>
+void ProbeIndex::close() {
+#ifdef __linux__
+	if (_mapped) {
+		munmap((void*)_data, _length);
+	}
+#endif
+	_buffer.clear();
+	_data = nullptr;
+	_length = 0;
+	_count = 0;
+	_mapped = false;
+}
+
+/// <summary>
+/// Number of entries of the opened index
+/// </summary>
+/// <returns>Returns number of entries</returns>
+size_t ProbeIndex::size() const {
+	return _count;
+}
+
+/// <summary>
+/// Find the record of the file in the opened index
+/// </summary>
+/// <param name="filePath">Path of the file</param>
+/// <param name="record">Modifies the passed record with the saved result</param>
+/// <returns>Returns false if the index does not hold the file</returns>
+bool ProbeIndex::find(const std::string& filePath, ProbeRecord& record) const {
+	size_t low = 0;
+	size_t high = _count;
+	while (low < high) {
+		const size_t middle = low + (high - low) / 2;
+		if (getPath(getEntry(middle)) < filePath) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	if (low == _count || getPath(getEntry(low)) != filePath) {
+		return false;
+	}
+
+	const Entry* entry = getEntry(low);
+	record.filePath = filePath;
+	record.fileSize = entry->fileSize;
+	record.modifiedTime = entry->modifiedTime;
+	record.fileType = (FileType)entry->fileType;
+	record.encoded = entry->encoded != 0;
+	record.messageLength = entry->messageLength;
+	record.capacity = entry->capacity;
+	return true;
+}
+
+/// <summary>
+/// Save the records as a new index, the file is replaced at once so a broken scan does not damage the old index
+/// The index must be closed before, the file could not be replaced on every system while it is mapped
+/// </summary>
+/// <param name="indexPath">Path of the index file</param>
+/// <param name="records">Records of the files, they are sorted by path</param>
+/// <returns>Returns false if the index could not be written</returns>
+bool ProbeIndex::save(const std::string& indexPath, std::vector<ProbeRecord>& records) {
+	std::sort(records.begin(), records.end(), [](const ProbeRecord& a, const ProbeRecord& b) {
+		return a.filePath < b.filePath;
+	});
+
+	const std::string temporaryPath = indexPath + ".tmp";
+	std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	const uint64_t count = records.size();
+	file.write(_magic, sizeof(_magic));
+	file.write((const char*)&count, sizeof(count));
+
+	uint64_t pathOffset = _headerSize + count * sizeof(Entry);
+	for (const ProbeRecord& record : records) {
+		Entry entry;
+		std::memset(&entry, 0, sizeof(entry));
+		entry.pathOffset = pathOffset;
+		entry.pathLength = (uint32_t)record.filePath.length();
+		entry.fileSize = record.fileSize;
+		entry.modifiedTime = record.modifiedTime;
+		entry.fileType = (uint16_t)record.fileType;
+		entry.encoded = record.encoded ? 1 : 0;
+		entry.messageLength = record.messageLength;
+		entry.capacity = record.capacity;
+		file.write((const char*)&entry, sizeof(entry));
+		pathOffset += entry.pathLength;
+	}
+	for (const ProbeRecord& record : records) {
+		file.write(record.filePath.data(), record.filePath.length());
+	}
+
+	file.close();
+	if (!file) {
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+#ifndef __linux__
+	// Rename does not replace an existing file everywhere
+	std::remove(indexPath.c_str());
+#endif
+	return std::rename(temporaryPath.c_str(), indexPath.c_str()) == 0;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "structs.hpp"
+#include "enums.hpp"
+
+/// <summary>
+/// Index of the probe results saved on the disk, so repeated scans of the same tree probe only new or changed files
+///
+/// Layout: [8 byte magic][u64 count][count entries sorted by path][paths]
+/// Entries have a fixed size and point into the paths, so the file is mapped into memory as it is
+/// and a file is found by binary search without parsing the whole index
+/// </summary>
+class ProbeIndex {
+private:
+	/// <summary>
+	/// Single entry of the index as it is stored in the file, little endian
+	/// </summary>
+	struct Entry {
+		uint64_t pathOffset;
+		uint64_t fileSize;
+		int64_t modifiedTime;
+		uint64_t messageLength;
+		uint64_t capacity;
+		uint32_t pathLength;
+		uint16_t fileType;
+		uint8_t encoded;
+		uint8_t reserved;
+	};
+
+	/// <summary>
+	/// First bytes of every index file, the last char is the version of the layout
+	/// </summary>
+	static constexpr char _magic[8] = { 'S', 'T', 'E', 'G', 'I', 'D', 'X', '1' };
+	static const size_t _headerSize = 16;
+
+	/// <summary>
+	/// Content of the opened index - mapped file on Linux, read into the buffer elsewhere
+	/// </summary>
+	const uint8_t* _data = nullptr;
+	size_t _length = 0;
+	std::string _buffer;
+	bool _mapped = false;
+	/// <summary>
+	/// Number of entries of the opened index
+	/// </summary>
+	size_t _count = 0;
+
+	/// <summary>
+	/// Entry at the position of the sorted entries
+	/// </summary>
+	/// <param name="index">Position of the entry</param>
+	/// <returns>Returns pointer to the entry in the opened index</returns>
+	const Entry* getEntry(size_t index) const;
+	/// <summary>
+	/// Path of the entry, empty if it points outside of the index
+	/// </summary>
+	/// <param name="entry">Entry of the opened index</param>
+	/// <returns>Returns path of the entry</returns>
+	std::string_view getPath(const Entry* entry) const;
+
+public:
+	ProbeIndex() {}
+	/// <summary>
+	/// Destructor, unmaps the opened index
+	/// </summary>
+	~ProbeIndex() {
+		close();
+	}
+
+	/// <summary>
+	/// Open the index saved in the file, a missing or damaged index is treated as empty
+	/// </summary>
+	/// <param name="indexPath">Path of the index file</param>
+	/// <returns>Returns false if there is no valid index in the file</returns>
+	bool open(const std::string& indexPath);
+	/// <summary>
+	/// Close the opened index, records found before stay valid
+	/// </summary>
+	void close();
+	/// <summary>
+	/// Number of entries of the opened index
+	/// </summary>
+	/// <returns>Returns number of entries</returns>
+	size_t size() const;
+	/// <summary>
+	/// Find the record of the file in the opened index
+	/// </summary>
+	/// <param name="filePath">Path of the file</param>
+	/// <param name="record">Modifies the passed record with the saved result</param>
+	/// <returns>Returns false if the index does not hold the file</returns>
+	bool find(const std::string& filePath, ProbeRecord& record) const;
+	/// <summary>
+	/// Save the records as a new index, the file is replaced at once so a broken scan does not damage the old index
+	/// The index must be closed before, the file could not be replaced on every system while it is mapped
+	/// </summary>
+	/// <param name="indexPath">Path of the index file</param>
+	/// <param name="records">Records of the files, they are sorted by path</param>
+	/// <returns>Returns false if the index could not be written</returns>
+	static bool save(const std::string& indexPath, std::vector<ProbeRecord>& records);
+};
@@ -0,0 +1,230 @@
+#pragma once
+#include "SanitizeHandler.hpp"
+
+namespace {
+	/// <summary>
+	/// Next value of splitmix64, used only to expand the seed into the state of the generators
+	/// </summary>
+	uint64_t splitMix64(uint64_t& state) {
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+#ifdef SIMD_SSE2
+	/// <summary>
+	/// Step the 4 generators held in the registers once, gives 16 random bytes
+	/// </summary>
+	inline __m128i nextRandom(__m128i& s0, __m128i& s1, __m128i& s2, __m128i& s3) {
+		const __m128i sum = _mm_add_epi32(s0, s3);
+		const __m128i result = _mm_add_epi32(_mm_or_si128(_mm_slli_epi32(sum, 7), _mm_srli_epi32(sum, 25)), s0);
+		const __m128i t = _mm_slli_epi32(s1, 9);
+		s2 = _mm_xor_si128(s2, s0);
+		s3 = _mm_xor_si128(s3, s1);
+		s1 = _mm_xor_si128(s1, s2);
+		s0 = _mm_xor_si128(s0, s3);
+		s2 = _mm_xor_si128(s2, t);
+		s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+		return result;
+	}
+#endif
+
+	uint32_t rotateLeft(uint32_t value, int count) {
+		return (value << count) | (value >> (32 - count));
+	}
+
+	/// <summary>
+	/// Step every generator once with plain code, 4 bytes of every generator one after another - the same order as SSE2
+	/// </summary>
+	void nextBlock(uint32_t (&state)[4][4], uint8_t* output) {
+		for (int lane = 0; lane < 4; lane++) {
+			uint32_t& s0 = state[0][lane];
+			uint32_t& s1 = state[1][lane];
+			uint32_t& s2 = state[2][lane];
+			uint32_t& s3 = state[3][lane];
+			const uint32_t result = rotateLeft(s0 + s3, 7) + s0;
+			const uint32_t t = s1 << 9;
+			s2 ^= s0;
+			s3 ^= s1;
+			s1 ^= s2;
+			s0 ^= s3;
+			s2 ^= t;
+			s3 = rotateLeft(s3, 11);
+			for (int i = 0; i < 4; i++) {
+				output[lane * 4 + i] = (uint8_t)(result >> (8 * i));
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Seed the 4 generators of a band, the state is expanded from the seed by splitmix64
+/// </summary>
+/// <param name="generator">Generators of the band</param>
+/// <param name="seed">Seed of the band</param>
+void SanitizeHandler::seedGenerator(Generator& generator, uint64_t seed) {
+	for (int word = 0; word < 4; word++) {
+		for (int lane = 0; lane < 4; lane += 2) {
+			const uint64_t value = splitMix64(seed);
+			generator.state[word][lane] = (uint32_t)value;
+			generator.state[word][lane + 1] = (uint32_t)(value >> 32);
+		}
+	}
+}
+
+/// <summary>
+/// Replace the masked bits of every byte with random bits
+/// </summary>
+/// <param name="generator">Generators of the band, their state moves on</param>
+/// <param name="bytes">Bytes of the band</param>
+/// <param name="length">Number of bytes</param>
+/// <param name="mask">Bits of every byte that are replaced</param>
+void SanitizeHandler::fillBand(Generator& generator, uint8_t* bytes, size_t length, uint8_t mask) {
+	size_t i = 0;
+#ifdef SIMD_SSE2
+	// Every step of the 4 generators gives 16 random bytes
+	__m128i s0 = _mm_load_si128((const __m128i*)generator.state[0]);
+	__m128i s1 = _mm_load_si128((const __m128i*)generator.state[1]);
+	__m128i s2 = _mm_load_si128((const __m128i*)generator.state[2]);
+	__m128i s3 = _mm_load_si128((const __m128i*)generator.state[3]);
+	const __m128i keep = _mm_set1_epi8((char)~mask);
+	const __m128i replace = _mm_set1_epi8((char)mask);
+	for (; i + 16 <= length; i += 16) {
+		const __m128i result = nextRandom(s0, s1, s2, s3);
+		__m128i* block = (__m128i*)(bytes + i);
+		const __m128i data = _mm_loadu_si128(block);
+		_mm_storeu_si128(block, _mm_or_si128(_mm_and_si128(data, keep), _mm_and_si128(result, replace)));
+	}
+	_mm_store_si128((__m128i*)generator.state[0], s0);
+	_mm_store_si128((__m128i*)generator.state[1], s1);
+	_mm_store_si128((__m128i*)generator.state[2], s2);
+	_mm_store_si128((__m128i*)generator.state[3], s3);
+#endif
+
+	// Rest of the band, or the whole band without SSE2, gives the same bits
+	uint8_t block[16];
+	for (; i < length; i += 16) {
+		nextBlock(generator.state, block);
+		for (size_t j = 0; j < 16 && i + j < length; j++) {
+			bytes[i + j] = (bytes[i + j] & ~mask) | (block[j] & mask);
+		}
+	}
+}
+
+/// <summary>
+/// Change every byte that differs from the original one in its lowest bit to the original value +1 or -1 at random,
+/// 0 always goes up and 255 always goes down
+/// </summary>
+/// <param name="generator">Generators of the band, their state moves on</param>
+/// <param name="original">Bytes of the band before the lowest bits have been replaced</param>
+/// <param name="bytes">Bytes of the band with the replaced lowest bits</param>
+/// <param name="length">Number of bytes</param>
+void SanitizeHandler::matchBand(Generator& generator, const uint8_t* original, uint8_t* bytes, size_t length) {
+	size_t i = 0;
+#ifdef SIMD_SSE2
+	// Lowest bit of every random byte chooses the direction of its channel
+	__m128i s0 = _mm_load_si128((const __m128i*)generator.state[0]);
+	__m128i s1 = _mm_load_si128((const __m128i*)generator.state[1]);
+	__m128i s2 = _mm_load_si128((const __m128i*)generator.state[2]);
+	__m128i s3 = _mm_load_si128((const __m128i*)generator.state[3]);
+	const __m128i ones = _mm_set1_epi8(1);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi8((char)0xFF);
+	for (; i + 16 <= length; i += 16) {
+		const __m128i random = nextRandom(s0, s1, s2, s3);
+		__m128i* block = (__m128i*)(bytes + i);
+		const __m128i before = _mm_loadu_si128((const __m128i*)(original + i));
+		const __m128i after = _mm_loadu_si128(block);
+		const __m128i unchanged = _mm_cmpeq_epi8(before, after);
+
+		__m128i down = _mm_cmpeq_epi8(_mm_and_si128(random, ones), ones);
+		down = _mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi8(before, zero), down), _mm_cmpeq_epi8(before, full));
+		const __m128i matched = _mm_or_si128(_mm_and_si128(down, _mm_sub_epi8(before, ones)), _mm_andnot_si128(down, _mm_add_epi8(before, ones)));
+		_mm_storeu_si128(block, _mm_or_si128(_mm_and_si128(unchanged, after), _mm_andnot_si128(unchanged, matched)));
+	}
+	_mm_store_si128((__m128i*)generator.state[0], s0);
+	_mm_store_si128((__m128i*)generator.state[1], s1);
+	_mm_store_si128((__m128i*)generator.state[2], s2);
+	_mm_store_si128((__m128i*)generator.state[3], s3);
+#endif
+
+	// Rest of the band, or the whole band without SSE2, makes the same changes
+	uint8_t block[16];
+	for (; i < length; i += 16) {
+		nextBlock(generator.state, block);
+		for (size_t j = 0; j < 16 && i + j < length; j++) {
+			const uint8_t before = original[i + j];
+			if (bytes[i + j] != before) {
+				const bool down = before == 255 || (before != 0 && (block[j] & 1));
+				bytes[i + j] = down ? before - 1 : before + 1;
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Replace the lowest bits of every channel of the image with random bits
+/// </summary>
+/// <param name="image">Image with its pixels</param>
+/// <param name="bitCount">Number of the lowest bits of every channel, 1 - maxBitCount</param>
+/// <param name="seed">Seed of the random bits, every band gets a different one derived from it</param>
+/// <param name="parallel">Process the bands in parallel</param>
+/// <returns>Returns false for invalid number of bits</returns>
+bool SanitizeHandler::sanitizeImage(Image& image, int bitCount, uint64_t seed, bool parallel) const {
+	if (bitCount < 1 || bitCount > maxBitCount) {
+		return false;
+	}
+
+	const uint8_t mask = (uint8_t)((1u << bitCount) - 1);
+	const size_t bandLength = image.getRowLength() * _bandRows;
+	const size_t length = image.getChannelCount();
+	const size_t bandCount = (length + bandLength - 1) / std::max<size_t>(bandLength, 1);
+	uint8_t* bytes = (uint8_t*)image.pixels;
+	auto sanitizeTask = [&](size_t band) {
+		Generator generator;
+		seedGenerator(generator, seed + band * 0xD1B54A32D192ED03ULL);
+		const size_t start = band * bandLength;
+		fillBand(generator, bytes + start, std::min(bandLength, length - start), mask);
+	};
+	if (parallel) {
+		Helpers::parallelFor(bandCount, sanitizeTask);
+	}
+	else {
+		for (size_t band = 0; band < bandCount; band++) {
+			sanitizeTask(band);
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// Turn the lowest bits replaced by the encoding into LSB matching - the changed channels get +1 or -1 at random instead,
+/// which sets the same lowest bit without the pairs of values that the replacement leaves in the histogram
+/// Only the lowest bits are read when decoding, so the message is decoded the same way
+/// </summary>
+/// <param name="image">Image with the encoded message</param>
+/// <param name="original">Channels of the image before the message has been encoded, the first length of them</param>
+/// <param name="length">Number of channels from the beginning of the image that the encoding could have changed</param>
+/// <param name="seed">Seed of the random changes, every band gets a different one derived from it</param>
+/// <param name="parallel">Process the bands in parallel</param>
+void SanitizeHandler::matchImage(Image& image, const uint8_t* original, size_t length, uint64_t seed, bool parallel) const {
+	const size_t bandLength = image.getRowLength() * _bandRows;
+	length = std::min(length, image.getChannelCount());
+	const size_t bandCount = (length + bandLength - 1) / std::max<size_t>(bandLength, 1);
+	uint8_t* bytes = (uint8_t*)image.pixels;
+	auto matchTask = [&](size_t band) {
+		Generator generator;
+		seedGenerator(generator, seed + band * 0xD1B54A32D192ED03ULL);
+		const size_t start = band * bandLength;
+		matchBand(generator, original + start, bytes + start, std::min(bandLength, length - start));
+	};
+	if (parallel) {
+		Helpers::parallelFor(bandCount, matchTask);
+	}
+	else {
+		for (size_t band = 0; band < bandCount; band++) {
+			matchTask(band);
+		}
+	}
+}
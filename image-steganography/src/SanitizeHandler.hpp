@@ -0,0 +1,86 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "simd.hpp"
+#include "structs.hpp"
+#include "Helpers.hpp"
+
+/// <summary>
+/// Class for wiping any message hidden in the lowest bits of the image, by this or any other program,
+/// and for turning the replaced lowest bits of an encoded message into random +1 / -1 changes (LSB matching)
+///
+/// The chosen number of lowest bits of every channel is replaced with random bits.
+/// Random bits come from 4 xoshiro128++ generators running side by side, one per SSE2 lane,
+/// the image is split into bands of rows and every band has its own generators, so the bands run in parallel.
+/// </summary>
+class SanitizeHandler {
+private:
+	/// <summary>
+	/// State of the 4 generators of a band - word of the state, then the generator (lane)
+	/// </summary>
+	struct Generator {
+		alignas(16) uint32_t state[4][4];
+	};
+
+	/// <summary>
+	/// Number of rows processed by a single task
+	/// </summary>
+	const int _bandRows = 64;
+
+	/// <summary>
+	/// Seed the 4 generators of a band, the state is expanded from the seed by splitmix64
+	/// </summary>
+	/// <param name="generator">Generators of the band</param>
+	/// <param name="seed">Seed of the band</param>
+	static void seedGenerator(Generator& generator, uint64_t seed);
+	/// <summary>
+	/// Replace the masked bits of every byte with random bits
+	/// </summary>
+	/// <param name="generator">Generators of the band, their state moves on</param>
+	/// <param name="bytes">Bytes of the band</param>
+	/// <param name="length">Number of bytes</param>
+	/// <param name="mask">Bits of every byte that are replaced</param>
+	static void fillBand(Generator& generator, uint8_t* bytes, size_t length, uint8_t mask);
+	/// <summary>
+	/// Change every byte that differs from the original one in its lowest bit to the original value +1 or -1 at random,
+	/// 0 always goes up and 255 always goes down
+	/// </summary>
+	/// <param name="generator">Generators of the band, their state moves on</param>
+	/// <param name="original">Bytes of the band before the lowest bits have been replaced</param>
+	/// <param name="bytes">Bytes of the band with the replaced lowest bits</param>
+	/// <param name="length">Number of bytes</param>
+	static void matchBand(Generator& generator, const uint8_t* original, uint8_t* bytes, size_t length);
+
+public:
+	/// <summary>
+	/// Largest number of lowest bits that could be replaced
+	/// </summary>
+	static const int maxBitCount = 8;
+
+	SanitizeHandler() {}
+	~SanitizeHandler() {}
+
+	/// <summary>
+	/// Replace the lowest bits of every channel of the image with random bits
+	/// </summary>
+	/// <param name="image">Image with its pixels</param>
+	/// <param name="bitCount">Number of the lowest bits of every channel, 1 - maxBitCount</param>
+	/// <param name="seed">Seed of the random bits, every band gets a different one derived from it</param>
+	/// <param name="parallel">Process the bands in parallel</param>
+	/// <returns>Returns false for invalid number of bits</returns>
+	bool sanitizeImage(Image& image, int bitCount, uint64_t seed, bool parallel = true) const;
+	/// <summary>
+	/// Turn the lowest bits replaced by the encoding into LSB matching - the changed channels get +1 or -1 at random instead,
+	/// which sets the same lowest bit without the pairs of values that the replacement leaves in the histogram
+	/// Only the lowest bits are read when decoding, so the message is decoded the same way
+	/// </summary>
+	/// <param name="image">Image with the encoded message</param>
+	/// <param name="original">Channels of the image before the message has been encoded, the first length of them</param>
+	/// <param name="length">Number of channels from the beginning of the image that the encoding could have changed</param>
+	/// <param name="seed">Seed of the random changes, every band gets a different one derived from it</param>
+	/// <param name="parallel">Process the bands in parallel</param>
+	void matchImage(Image& image, const uint8_t* original, size_t length, uint64_t seed, bool parallel = false) const;
+};
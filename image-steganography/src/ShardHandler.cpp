@@ -0,0 +1,220 @@
+#pragma once
+#include "ShardHandler.hpp"
+
+/// <summary>
+/// Create the header stored at the beginning of the shard
+/// </summary>
+/// <param name="payloadId">Id shared by every shard of the same message</param>
+/// <param name="sequence">Position of the shard in the message</param>
+/// <param name="total">Number of shards the message was split into</param>
+/// <returns>Returns header of the shard</returns>
+std::string ShardHandler::createShardHeader(const std::string& payloadId, size_t sequence, size_t total) const {
+	std::stringstream ss;
+	ss << _shardMagic << payloadId
+		<< std::setw(_sequenceLength) << std::setfill('0') << sequence
+		<< std::setw(_totalLength) << std::setfill('0') << total;
+	return ss.str();
+}
+
+/// <summary>
+/// Split the decoded message into the shard header and its data
+/// </summary>
+/// <param name="message">Message decoded from the image</param>
+/// <param name="shard">Shard to which data will be saved</param>
+/// <returns>Returns true if the message is a valid shard</returns>
+bool ShardHandler::parseShard(const std::string& message, Shard& shard) const {
+	if (message.length() < _shardHeaderLength || message.compare(0, _shardMagic.length(), _shardMagic) != 0) {
+		return false;
+	}
+
+	const size_t sequenceOffset = _shardMagic.length() + _payloadIdLength;
+	const size_t totalOffset = sequenceOffset + _sequenceLength;
+	std::string sequence = message.substr(sequenceOffset, _sequenceLength);
+	std::string total = message.substr(totalOffset, _totalLength);
+	auto isNumber = [](const std::string& value) {
+		return std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); });
+	};
+	if (!isNumber(sequence) || !isNumber(total)) {
+		return false;
+	}
+
+	shard.payloadId = message.substr(_shardMagic.length(), _payloadIdLength);
+	shard.sequence = std::atoi(sequence.c_str());
+	shard.total = std::atoi(total.c_str());
+	shard.data = message.substr(_shardHeaderLength);
+	return shard.total > 0 && shard.sequence < shard.total;
+}
+
+/// <summary>
+/// Calculate the id of the message - FNV-1a hash written as 8 hex chars
+/// </summary>
+/// <param name="message">Message that is going to be split</param>
+/// <returns>Returns id of the message</returns>
+std::string ShardHandler::getPayloadId(const std::string& message) const {
+	uint32_t hash = 2166136261u;
+	for (unsigned char c : message) {
+		hash ^= c;
+		hash *= 16777619u;
+	}
+
+	std::stringstream ss;
+	ss << std::hex << std::setw(_payloadIdLength) << std::setfill('0') << hash;
+	return ss.str();
+}
+
+/// <summary>
+/// Split the message across the images in the directory and encode every part in parallel
+/// Images are filled in the order of their paths until the whole message is stored
+/// </summary>
+/// <param name="directory">Directory that holds the images</param>
+/// <param name="message">Message that will be encoded in the images</param>
+/// <param name="options">Options chosen for encoding every shard</param>
+/// <param name="shardsUsed">Modifies the passed value with the number of images used</param>
+/// <returns>Returns true if the whole message has been encoded</returns>
+bool ShardHandler::encodeShards(const std::string& directory, const std::string& message, const EncodeOptions& options, size_t& shardsUsed) const {
+	std::vector<std::string> paths = _fileHandler->listImages(directory);
+	if (paths.empty()) {
+		return false;
+	}
+
+	// Find out how much every image could hold, already encoded images hold nothing
+	std::vector<size_t> capacities;
+	_fileHandler->getMessageCapacities(paths, capacities, options);
+
+	// Assign consecutive parts of the message to the images in order of their paths
+	std::vector<std::pair<std::string, std::string>> shards; // image path - part of the message
+	size_t offset = 0;
+	for (size_t i = 0; i < paths.size() && offset < message.length(); i++) {
+		if (capacities[i] <= _shardHeaderLength) {
+			continue;
+		}
+
+		size_t length = std::min(capacities[i] - _shardHeaderLength, message.length() - offset);
+		shards.push_back({ paths[i], message.substr(offset, length) });
+		offset += length;
+	}
+
+	if (offset < message.length() || shards.size() > _maxShards) {
+		std::cout << "Error: message is too long to fit in the images" << std::endl;
+		return false;
+	}
+
+	// Encode every shard with its header in parallel
+	const std::string payloadId = getPayloadId(message);
+	std::vector<std::string> shardPaths;
+	std::vector<std::string> shardMessages;
+	for (size_t i = 0; i < shards.size(); i++) {
+		shardPaths.push_back(shards[i].first);
+		shardMessages.push_back(createShardHeader(payloadId, i, shards.size()) + shards[i].second);
+	}
+
+	// Images are kept as they were, so the shards written before a failure could be taken back
+	std::vector<std::string> originals(shardPaths.size());
+	for (size_t i = 0; i < shardPaths.size(); i++) {
+		if (!readFile(shardPaths[i], originals[i])) {
+			std::cout << "Error: unable to read " << shardPaths[i] << std::endl;
+			return false;
+		}
+	}
+
+	std::vector<char> statuses;
+	_fileHandler->encodeMessages(shardPaths, shardMessages, options, statuses);
+	if (std::find(statuses.begin(), statuses.end(), 0) == statuses.end()) {
+		shardsUsed = shards.size();
+		return true;
+	}
+
+	// Message without every shard could not be decoded, images that could not be restored are reported
+	for (size_t i = 0; i < shardPaths.size(); i++) {
+		if (statuses[i] && !writeFile(shardPaths[i], originals[i])) {
+			std::cout << "Error: " << shardPaths[i] << " still holds a partial shard" << std::endl;
+		}
+	}
+	return false;
+}
+
+/// <summary>
+/// Read every byte of the file, so it could be restored later
+/// </summary>
+/// <param name="filePath">Path of the file</param>
+/// <param name="data">Modifies the passed data with the bytes of the file</param>
+/// <returns>Returns true if the whole file has been read</returns>
+bool ShardHandler::readFile(const std::string& filePath, std::string& data) const {
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+	data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return !file.bad();
+}
+
+/// <summary>
+/// Replace the file with the given bytes
+/// </summary>
+/// <param name="filePath">Path of the file</param>
+/// <param name="data">Bytes that will be written</param>
+/// <returns>Returns true if every byte has been written</returns>
+bool ShardHandler::writeFile(const std::string& filePath, const std::string& data) const {
+	std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+	file.write(data.data(), (std::streamsize)data.size());
+	file.close();
+	return !file.fail();
+}
+
+/// <summary>
+/// Decode every image in the directory in parallel and put the shards back together
+/// The images could be in any order, shards are matched by their payload id and sequence
+/// </summary>
+/// <param name="directory">Directory that holds the images</param>
+/// <param name="messages">Modifies the passed list with every complete message found</param>
+/// <returns>Returns true if at least one complete message has been decoded</returns>
+bool ShardHandler::decodeShards(const std::string& directory, std::vector<std::string>& messages) const {
+	std::vector<std::string> paths = _fileHandler->listImages(directory);
+
+	// Decode every image, images that do not hold a shard are skipped
+	std::vector<std::string> decoded;
+	std::vector<char> statuses;
+	_fileHandler->readEncodedMessages(paths, decoded, statuses);
+
+	std::map<std::string, std::vector<Shard>> payloads; // payload id - shards of the message
+	for (size_t i = 0; i < paths.size(); i++) {
+		Shard shard;
+		if (!statuses[i] || !parseShard(decoded[i], shard)) {
+			continue;
+		}
+
+		shard.filePath = paths[i];
+		payloads[shard.payloadId].push_back(std::move(shard));
+	}
+
+	// Put together the messages that have every shard
+	for (auto& payload : payloads) {
+		std::vector<Shard>& shards = payload.second;
+		std::sort(shards.begin(), shards.end(), [](const Shard& a, const Shard& b) {
+			return a.sequence < b.sequence;
+		});
+		// The same shard could be found twice if the image has been copied
+		shards.erase(std::unique(shards.begin(), shards.end(), [](const Shard& a, const Shard& b) {
+			return a.sequence == b.sequence;
+		}), shards.end());
+
+		const uint32_t total = shards.front().total;
+		bool complete = shards.size() == total;
+		for (size_t i = 0; complete && i < shards.size(); i++) {
+			complete = shards[i].sequence == i && shards[i].total == total;
+		}
+		if (!complete) {
+			std::cout << "Error: missing shards of message " << payload.first
+				<< " (found " << shards.size() << " of " << total << ")" << std::endl;
+			continue;
+		}
+
+		std::string message;
+		for (const Shard& shard : shards) {
+			message += shard.data;
+		}
+		messages.push_back(message);
+	}
+
+	return !messages.empty();
+}
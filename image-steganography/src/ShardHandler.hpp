@@ -0,0 +1,116 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <fstream>
+
+#include "structs.hpp"
+#include "FileHandler.hpp"
+#include "Helpers.hpp"
+
+/// <summary>
+/// Class for splitting a message that is too long for one image across many images
+/// and for putting the message back together from those images
+/// </summary>
+class ShardHandler {
+private:
+	/// <summary>
+	/// Pointer to file handler that encodes and decodes the single images
+	/// </summary>
+	FileHandler* _fileHandler;
+	/// <summary>
+	/// Constant message that is stored at the beginning of every shard
+	/// </summary>
+	const std::string _shardMagic = "SHRD";
+	/// <summary>
+	/// Number of hex chars of the payload id that follows the magic in the shard header
+	/// </summary>
+	const size_t _payloadIdLength = 8;
+	/// <summary>
+	/// Number of digits of the sequence that follows the payload id in the shard header
+	/// </summary>
+	const size_t _sequenceLength = 4;
+	/// <summary>
+	/// Number of digits of the total that ends the shard header
+	/// </summary>
+	const size_t _totalLength = 4;
+	/// <summary>
+	/// Number of chars of the shard header - magic, payload id, sequence, total
+	/// </summary>
+	const size_t _shardHeaderLength = _shardMagic.length() + _payloadIdLength + _sequenceLength + _totalLength;
+	/// <summary>
+	/// Largest number of images the message could be split across - the digits of the total
+	/// </summary>
+	const size_t _maxShards = 9999;
+
+	/// <summary>
+	/// Create the header stored at the beginning of the shard
+	/// </summary>
+	/// <param name="payloadId">Id shared by every shard of the same message</param>
+	/// <param name="sequence">Position of the shard in the message</param>
+	/// <param name="total">Number of shards the message was split into</param>
+	/// <returns>Returns header of the shard</returns>
+	std::string createShardHeader(const std::string& payloadId, size_t sequence, size_t total) const;
+	/// <summary>
+	/// Split the decoded message into the shard header and its data
+	/// </summary>
+	/// <param name="message">Message decoded from the image</param>
+	/// <param name="shard">Shard to which data will be saved</param>
+	/// <returns>Returns true if the message is a valid shard</returns>
+	bool parseShard(const std::string& message, Shard& shard) const;
+	/// <summary>
+	/// Calculate the id of the message - FNV-1a hash written as 8 hex chars
+	/// </summary>
+	/// <param name="message">Message that is going to be split</param>
+	/// <returns>Returns id of the message</returns>
+	std::string getPayloadId(const std::string& message) const;
+	/// <summary>
+	/// Read every byte of the file, so it could be restored later
+	/// </summary>
+	/// <param name="filePath">Path of the file</param>
+	/// <param name="data">Modifies the passed data with the bytes of the file</param>
+	/// <returns>Returns true if the whole file has been read</returns>
+	bool readFile(const std::string& filePath, std::string& data) const;
+	/// <summary>
+	/// Replace the file with the given bytes
+	/// </summary>
+	/// <param name="filePath">Path of the file</param>
+	/// <param name="data">Bytes that will be written</param>
+	/// <returns>Returns true if every byte has been written</returns>
+	bool writeFile(const std::string& filePath, const std::string& data) const;
+
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="fileHandler">File handler used to encode and decode the images</param>
+	ShardHandler(FileHandler* fileHandler) {
+		_fileHandler = fileHandler;
+	}
+	~ShardHandler() {}
+
+	/// <summary>
+	/// Split the message across the images in the directory and encode every part in parallel
+	/// Images are filled in the order of their paths until the whole message is stored
+	/// If any shard fails, the images already encoded are restored, so no image is left with a partial message
+	/// </summary>
+	/// <param name="directory">Directory that holds the images</param>
+	/// <param name="message">Message that will be encoded in the images</param>
+	/// <param name="options">Options chosen for encoding every shard</param>
+	/// <param name="shardsUsed">Modifies the passed value with the number of images used</param>
+	/// <returns>Returns true if the whole message has been encoded</returns>
+	bool encodeShards(const std::string& directory, const std::string& message, const EncodeOptions& options, size_t& shardsUsed) const;
+	/// <summary>
+	/// Decode every image in the directory in parallel and put the shards back together
+	/// The images could be in any order, shards are matched by their payload id and sequence
+	/// </summary>
+	/// <param name="directory">Directory that holds the images</param>
+	/// <param name="messages">Modifies the passed list with every complete message found</param>
+	/// <returns>Returns true if at least one complete message has been decoded</returns>
+	bool decodeShards(const std::string& directory, std::vector<std::string>& messages) const;
+};
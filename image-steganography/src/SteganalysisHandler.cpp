@@ -0,0 +1,348 @@
+#pragma once
+#include "SteganalysisHandler.hpp"
+
+/// <summary>
+/// Build the histogram of the channel values of the tile
+/// </summary>
+/// <param name="data">First channel of the tile</param>
+/// <param name="length">Number of channels in the tile</param>
+/// <param name="stats">Statistics to which the histogram will be added</param>
+void SteganalysisHandler::buildHistogram(const uint8_t* data, size_t length, TileStats& stats) const {
+	// Four separate histograms, so runs of the same value do not wait on each other's increments
+	uint32_t counts[4][256] = {};
+	size_t i = 0;
+
+#ifdef SIMD_SSE2
+	// SSE2 has no scatter, so 16 channels are loaded at once and taken apart in registers instead of a load per channel
+	auto addWord = [&](uint32_t word) {
+		counts[0][word & 0xFF]++;
+		counts[1][(word >> 8) & 0xFF]++;
+		counts[2][(word >> 16) & 0xFF]++;
+		counts[3][word >> 24]++;
+	};
+	for (; i + 16 <= length; i += 16) {
+		const __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+		addWord((uint32_t)_mm_cvtsi128_si32(block));
+		addWord((uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(block, 4)));
+		addWord((uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(block, 8)));
+		addWord((uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(block, 12)));
+	}
+#endif
+
+	for (; i + 4 <= length; i += 4) {
+		counts[0][data[i]]++;
+		counts[1][data[i + 1]]++;
+		counts[2][data[i + 2]]++;
+		counts[3][data[i + 3]]++;
+	}
+	for (; i < length; i++) {
+		counts[0][data[i]]++;
+	}
+
+	for (int value = 0; value < 256; value++) {
+		stats.histogram[value] += (uint64_t)counts[0][value] + counts[1][value] + counts[2][value] + counts[3][value];
+	}
+	stats.channels += length;
+}
+
+/// <summary>
+/// Count regular and singular groups of the rows of the tile, for every channel separately
+/// Every row is split into 4 rows of lanes - a lane is a group and a channel, so 8 lanes are classified at once with SSE2
+/// </summary>
+/// <param name="data">First channel of the tile</param>
+/// <param name="width">Width of the image in pixels</param>
+/// <param name="channels">Number of channels of every pixel</param>
+/// <param name="rows">Number of rows in the tile</param>
+/// <param name="stats">Statistics to which the counts will be added</param>
+void SteganalysisHandler::countGroups(const uint8_t* data, size_t width, size_t channels, size_t rows, TileStats& stats) const {
+	const size_t groupsPerRow = width / _groupSize;
+	const size_t lanes = groupsPerRow * channels;
+	if (lanes == 0) {
+		return;
+	}
+
+	// Counts in the order of TileStats - regular and singular for M and -M, then the same with flipped LSBs
+	uint64_t counts[8] = {};
+	std::vector<uint8_t> values(lanes * _groupSize);
+
+	// Smoothness of the group - sum of differences of the neighbouring values
+	auto smoothness = [](int v0, int v1, int v2, int v3) {
+		return std::abs(v1 - v0) + std::abs(v2 - v1) + std::abs(v3 - v2);
+	};
+	// F-1 flips 2k-1 <-> 2k
+	auto flipNegative = [](int v) {
+		return v + ((v & 1) ? 1 : -1);
+	};
+	// Mask M = [0 1 1 0], F1 flips 2k <-> 2k+1, the second pass works on the same group with every LSB flipped
+	auto classifyLane = [&](size_t lane) {
+		const int v0 = values[lane], v1 = values[lanes + lane], v2 = values[2 * lanes + lane], v3 = values[3 * lanes + lane];
+		const int original = smoothness(v0, v1, v2, v3);
+		const int positive = smoothness(v0, v1 ^ 1, v2 ^ 1, v3);
+		const int negative = smoothness(v0, flipNegative(v1), flipNegative(v2), v3);
+		const int flippedOriginal = smoothness(v0 ^ 1, v1 ^ 1, v2 ^ 1, v3 ^ 1);
+		const int flippedPositive = smoothness(v0 ^ 1, v1, v2, v3 ^ 1);
+		const int flippedNegative = smoothness(v0 ^ 1, flipNegative(v1 ^ 1), flipNegative(v2 ^ 1), v3 ^ 1);
+
+		// Group is regular if flipping makes it less smooth, singular if more smooth
+		counts[0] += positive > original;
+		counts[1] += positive < original;
+		counts[2] += negative > original;
+		counts[3] += negative < original;
+		counts[4] += flippedPositive > flippedOriginal;
+		counts[5] += flippedPositive < flippedOriginal;
+		counts[6] += flippedNegative > flippedOriginal;
+		counts[7] += flippedNegative < flippedOriginal;
+	};
+
+	for (size_t row = 0; row < rows; row++) {
+		const uint8_t* line = data + row * width * channels;
+		for (size_t group = 0; group < groupsPerRow; group++) {
+			for (int i = 0; i < _groupSize; i++) {
+				std::memcpy(&values[i * lanes + group * channels], line + (group * _groupSize + i) * channels, channels);
+			}
+		}
+		size_t lane = 0;
+
+#ifdef SIMD_SSE2
+		// Values are widened to 16 bits, F-1 could step out of the byte range
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi16(1);
+		auto load = [&](size_t offset) {
+			return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)&values[offset]), zero);
+		};
+		auto absolute = [&](__m128i x) {
+			return _mm_max_epi16(x, _mm_sub_epi16(zero, x));
+		};
+		auto smoothnessLanes = [&](__m128i v0, __m128i v1, __m128i v2, __m128i v3) {
+			return _mm_add_epi16(_mm_add_epi16(absolute(_mm_sub_epi16(v1, v0)), absolute(_mm_sub_epi16(v2, v1))), absolute(_mm_sub_epi16(v3, v2)));
+		};
+		auto flipNegativeLanes = [&](__m128i v) {
+			const __m128i odd = _mm_and_si128(v, one);
+			return _mm_sub_epi16(_mm_add_epi16(v, _mm_add_epi16(odd, odd)), one);
+		};
+
+		// Comparisons give -1 per lane, they are subtracted into 16 bit sums that are moved to counts before they overflow
+		__m128i sums[8];
+		auto flush = [&]() {
+			for (int k = 0; k < 8; k++) {
+				alignas(16) int32_t parts[4];
+				_mm_store_si128((__m128i*)parts, _mm_madd_epi16(sums[k], one));
+				counts[k] += (uint64_t)parts[0] + parts[1] + parts[2] + parts[3];
+				sums[k] = zero;
+			}
+		};
+		for (int k = 0; k < 8; k++) {
+			sums[k] = zero;
+		}
+		auto count = [&](int k, __m128i flipped, __m128i original) {
+			sums[k] = _mm_sub_epi16(sums[k], _mm_cmpgt_epi16(flipped, original));
+			sums[k + 1] = _mm_sub_epi16(sums[k + 1], _mm_cmpgt_epi16(original, flipped));
+		};
+
+		for (size_t block = 1; lane + 8 <= lanes; lane += 8, block++) {
+			const __m128i v0 = load(lane), v1 = load(lanes + lane), v2 = load(2 * lanes + lane), v3 = load(3 * lanes + lane);
+			const __m128i w0 = _mm_xor_si128(v0, one), w1 = _mm_xor_si128(v1, one), w2 = _mm_xor_si128(v2, one), w3 = _mm_xor_si128(v3, one);
+			const __m128i original = smoothnessLanes(v0, v1, v2, v3);
+			const __m128i flippedOriginal = smoothnessLanes(w0, w1, w2, w3);
+			count(0, smoothnessLanes(v0, w1, w2, v3), original);
+			count(2, smoothnessLanes(v0, flipNegativeLanes(v1), flipNegativeLanes(v2), v3), original);
+			count(4, smoothnessLanes(w0, v1, v2, w3), flippedOriginal);
+			count(6, smoothnessLanes(w0, flipNegativeLanes(w1), flipNegativeLanes(w2), w3), flippedOriginal);
+			if (block % _laneBlocks == 0) {
+				flush();
+			}
+		}
+		flush();
+#endif
+
+		for (; lane < lanes; lane++) {
+			classifyLane(lane);
+		}
+		stats.groups += lanes;
+	}
+
+	stats.regular += counts[0];
+	stats.singular += counts[1];
+	stats.regularNegative += counts[2];
+	stats.singularNegative += counts[3];
+	stats.flippedRegular += counts[4];
+	stats.flippedSingular += counts[5];
+	stats.flippedRegularNegative += counts[6];
+	stats.flippedSingularNegative += counts[7];
+}
+
+/// <summary>
+/// Chi-square pair of values test - probability that the values of pairs (2k, 2k+1) are equalized by embedding
+/// </summary>
+/// <param name="histogram">Histogram of the channel values</param>
+/// <returns>Returns probability 0 - 1 that the channels carry a message</returns>
+double SteganalysisHandler::chiSquareProbability(const uint64_t* histogram) const {
+	double chiSquare = 0;
+	int pairs = 0;
+	for (int value = 0; value < 256; value += 2) {
+		const double expected = (histogram[value] + histogram[value + 1]) / 2.0;
+		if (expected <= 4) { // Too few values for the test
+			continue;
+		}
+		const double difference = histogram[value] - expected;
+		chiSquare += difference * difference / expected;
+		pairs++;
+	}
+
+	if (pairs < 2) {
+		return 0;
+	}
+	return upperGamma((pairs - 1) / 2.0, chiSquare / 2);
+}
+
+/// <summary>
+/// Estimate the part of the channels carrying a message from the counts of RS analysis
+/// </summary>
+/// <param name="stats">Statistics of the whole image</param>
+/// <returns>Returns the estimated part of the channels, 0 - 1</returns>
+double SteganalysisHandler::rsEstimate(const TileStats& stats) const {
+	if (stats.groups == 0) {
+		return 0;
+	}
+
+	const double groups = (double)stats.groups;
+	const double d0 = (stats.regular - (double)stats.singular) / groups;
+	const double d1 = (stats.flippedRegular - (double)stats.flippedSingular) / groups;
+	const double negativeD0 = (stats.regularNegative - (double)stats.singularNegative) / groups;
+	const double negativeD1 = (stats.flippedRegularNegative - (double)stats.flippedSingularNegative) / groups;
+
+	// 2(d1 + d0)x^2 + (d-0 - d-1 - d1 - 3d0)x + d0 - d-0 = 0, root with the smaller absolute value
+	const double a = 2 * (d1 + d0);
+	const double b = negativeD0 - negativeD1 - d1 - 3 * d0;
+	const double c = d0 - negativeD0;
+	double x;
+	if (std::abs(a) < 1e-12) {
+		if (std::abs(b) < 1e-12) {
+			return 0;
+		}
+		x = -c / b;
+	}
+	else {
+		const double discriminant = b * b - 4 * a * c;
+		if (discriminant < 0) {
+			return 0;
+		}
+		const double first = (-b + std::sqrt(discriminant)) / (2 * a);
+		const double second = (-b - std::sqrt(discriminant)) / (2 * a);
+		x = std::abs(first) < std::abs(second) ? first : second;
+	}
+
+	const double estimate = x / (x - 0.5);
+	return std::min(1.0, std::max(0.0, estimate));
+}
+
+/// <summary>
+/// Regularized upper incomplete gamma function Q(a, x)
+/// </summary>
+/// <param name="a">Shape parameter</param>
+/// <param name="x">Upper limit</param>
+/// <returns>Returns Q(a, x)</returns>
+double SteganalysisHandler::upperGamma(double a, double x) {
+	if (x <= 0) {
+		return 1;
+	}
+
+	const double logPrefix = a * std::log(x) - x - std::lgamma(a);
+	if (x < a + 1) { // Series converges quickly, Q = 1 - P
+		double term = 1 / a, sum = term;
+		for (int n = 1; n < 1000 && std::abs(term) > std::abs(sum) * 1e-15; n++) {
+			term *= x / (a + n);
+			sum += term;
+		}
+		return std::max(0.0, 1 - sum * std::exp(logPrefix));
+	}
+
+	// Continued fraction, modified Lentz's method
+	const double tiny = 1e-300;
+	double b = x + 1 - a, c = 1 / tiny, d = 1 / b, h = d;
+	for (int n = 1; n < 1000; n++) {
+		const double an = -n * (n - a);
+		b += 2;
+		d = an * d + b;
+		d = std::abs(d) < tiny ? tiny : d;
+		c = b + an / c;
+		c = std::abs(c) < tiny ? tiny : c;
+		d = 1 / d;
+		const double delta = d * c;
+		h *= delta;
+		if (std::abs(delta - 1) < 1e-15) {
+			break;
+		}
+	}
+	return std::exp(logPrefix) * h;
+}
+
+/// <summary>
+/// Analyze the image and score how likely its LSBs carry a message
+/// </summary>
+/// <param name="image">Image with the pixels read</param>
+/// <param name="parallel">Analyze the tiles in parallel, false when many images are analyzed at once</param>
+/// <returns>Returns the report of the image, only the estimates and the score are filled</returns>
+SteganalysisReport SteganalysisHandler::analyzeImage(const Image& image, bool parallel) const {
+	SteganalysisReport report;
+	if (image.pixels == nullptr || image.width == 0 || image.height == 0) {
+		return report;
+	}
+
+	const size_t rowChannels = image.getRowLength();
+	const size_t rowsPerTile = std::max((size_t)1, (_tileChannels + rowChannels - 1) / rowChannels);
+	const size_t tileCount = (image.height + rowsPerTile - 1) / rowsPerTile;
+	const uint8_t* data = (const uint8_t*)image.pixels;
+
+	std::vector<TileStats> tiles(tileCount);
+	auto analyzeTile = [&](size_t tile) {
+		const size_t firstRow = tile * rowsPerTile;
+		const size_t rows = std::min(rowsPerTile, (size_t)image.height - firstRow);
+		const uint8_t* tileData = data + firstRow * rowChannels;
+		buildHistogram(tileData, rows * rowChannels, tiles[tile]);
+		countGroups(tileData, image.width, image.channels, rows, tiles[tile]);
+	};
+	if (parallel) {
+		Helpers::parallelFor(tileCount, analyzeTile);
+	}
+	else {
+		for (size_t tile = 0; tile < tileCount; tile++) {
+			analyzeTile(tile);
+		}
+	}
+
+	// Tiles follow the order of embedding, so the test over growing prefix shows how far sequential message reaches
+	TileStats total;
+	bool prefixEmbedded = true;
+	size_t prefixChannels = 0;
+	for (const TileStats& tile : tiles) {
+		for (int value = 0; value < 256; value++) {
+			total.histogram[value] += tile.histogram[value];
+		}
+		total.channels += tile.channels;
+		total.regular += tile.regular;
+		total.singular += tile.singular;
+		total.regularNegative += tile.regularNegative;
+		total.singularNegative += tile.singularNegative;
+		total.flippedRegular += tile.flippedRegular;
+		total.flippedSingular += tile.flippedSingular;
+		total.flippedRegularNegative += tile.flippedRegularNegative;
+		total.flippedSingularNegative += tile.flippedSingularNegative;
+		total.groups += tile.groups;
+
+		if (prefixEmbedded && chiSquareProbability(total.histogram) > _chiSquareThreshold) {
+			prefixChannels = total.channels;
+		}
+		else {
+			prefixEmbedded = false;
+		}
+	}
+
+	report.chiSquareProbability = chiSquareProbability(total.histogram);
+	report.chiSquarePrefix = (double)prefixChannels / total.channels;
+	report.rsEstimate = rsEstimate(total);
+	// Chi-square alone gives false alarms on images with smooth histograms, so only the whole image result is trusted
+	report.score = report.rsEstimate;
+	report.suspicious = report.score > _suspiciousScore || report.chiSquareProbability > _chiSquareThreshold;
+	return report;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+
+#include "simd.hpp"
+#include "structs.hpp"
+#include "Helpers.hpp"
+
+/// <summary>
+/// Class for detecting messages hidden in the LSBs of the image by any program
+/// Runs the chi-square pair of values test and the RS (regular / singular groups) analysis
+/// The image is split into bands of rows (tiles) that are analyzed in parallel
+/// </summary>
+class SteganalysisHandler {
+private:
+	/// <summary>
+	/// Statistics gathered from a single tile
+	/// </summary>
+	struct TileStats {
+		size_t channels = 0;
+		uint64_t histogram[256] = {};
+		// Regular and singular groups for the masks M and -M, in the image and in the image with flipped LSBs
+		uint64_t regular = 0, singular = 0, regularNegative = 0, singularNegative = 0;
+		uint64_t flippedRegular = 0, flippedSingular = 0, flippedRegularNegative = 0, flippedSingularNegative = 0;
+		uint64_t groups = 0;
+	};
+
+	/// <summary>
+	/// Number of channels every tile should hold at least, tiles are made of whole rows
+	/// </summary>
+	const size_t _tileChannels = 16384;
+	/// <summary>
+	/// Number of pixels in the group of RS analysis
+	/// </summary>
+	static const int _groupSize = 4;
+	/// <summary>
+	/// Number of blocks of 8 lanes counted in 16 bit sums before they are added to the counts, every block adds at most 1
+	/// </summary>
+	static constexpr size_t _laneBlocks = 4096;
+	/// <summary>
+	/// Probability above which the chi-square test considers the LSBs random - carrying a message
+	/// </summary>
+	const double _chiSquareThreshold = 0.95;
+	/// <summary>
+	/// Score above which the image is reported as suspicious
+	/// Clean photos score up to about 0.25, a message over half of the channels scores above it in most of them,
+	/// a shorter one could be missed and a message filling the image is found by the chi-square test instead
+	/// </summary>
+	const double _suspiciousScore = 0.3;
+
+	/// <summary>
+	/// Build the histogram of the channel values of the tile
+	/// </summary>
+	/// <param name="data">First channel of the tile</param>
+	/// <param name="length">Number of channels in the tile</param>
+	/// <param name="stats">Statistics to which the histogram will be added</param>
+	void buildHistogram(const uint8_t* data, size_t length, TileStats& stats) const;
+	/// <summary>
+	/// Count regular and singular groups of the rows of the tile, for every channel separately
+	/// Every row is split into 4 rows of lanes - a lane is a group and a channel, so 8 lanes are classified at once with SSE2
+	/// </summary>
+	/// <param name="data">First channel of the tile</param>
+	/// <param name="width">Width of the image in pixels</param>
+	/// <param name="channels">Number of channels of every pixel</param>
+	/// <param name="rows">Number of rows in the tile</param>
+	/// <param name="stats">Statistics to which the counts will be added</param>
+	void countGroups(const uint8_t* data, size_t width, size_t channels, size_t rows, TileStats& stats) const;
+	/// <summary>
+	/// Chi-square pair of values test - probability that the values of pairs (2k, 2k+1) are equalized by embedding
+	/// </summary>
+	/// <param name="histogram">Histogram of the channel values</param>
+	/// <returns>Returns probability 0 - 1 that the channels carry a message</returns>
+	double chiSquareProbability(const uint64_t* histogram) const;
+	/// <summary>
+	/// Estimate the part of the channels carrying a message from the counts of RS analysis
+	/// </summary>
+	/// <param name="stats">Statistics of the whole image</param>
+	/// <returns>Returns the estimated part of the channels, 0 - 1</returns>
+	double rsEstimate(const TileStats& stats) const;
+	/// <summary>
+	/// Regularized upper incomplete gamma function Q(a, x)
+	/// </summary>
+	/// <param name="a">Shape parameter</param>
+	/// <param name="x">Upper limit</param>
+	/// <returns>Returns Q(a, x)</returns>
+	static double upperGamma(double a, double x);
+
+public:
+	/// <summary>
+	/// Analyze the image and score how likely its LSBs carry a message
+	/// </summary>
+	/// <param name="image">Image with the pixels read</param>
+	/// <param name="parallel">Analyze the tiles in parallel, false when many images are analyzed at once</param>
+	/// <returns>Returns the report of the image, only the estimates and the score are filled</returns>
+	SteganalysisReport analyzeImage(const Image& image, bool parallel = true) const;
+};
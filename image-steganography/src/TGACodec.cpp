@@ -0,0 +1,285 @@
+#pragma once
+#include "TGACodec.hpp"
+#include "Helpers.hpp"
+
+/// <summary>
+/// Decode the run length encoded packets straight into the pixels, a packet may continue on the next row
+/// </summary>
+/// <param name="file">Input Stream positioned at the first packet</param>
+/// <param name="image">Image to which the pixels are saved</param>
+/// <returns>Returns false if the packets end before the last pixel</returns>
+bool TGACodec::readRunLengthPixels(std::istream& file, Image& image) {
+	const size_t pixelLength = image.channels;
+	const size_t length = image.getChannelCount();
+	uint8_t* pixel = image.pixels;
+	uint8_t* end = image.pixels + length;
+	while (pixel < end) {
+		const int packet = file.get();
+		if (packet == EOF) {
+			return false;
+		}
+
+		const size_t count = (size_t)(packet & 0x7F) + 1;
+		const size_t packetLength = count * pixelLength;
+		if (packetLength > (size_t)(end - pixel)) {
+			return false;
+		}
+		if (packet & 0x80) {
+			// Run packet - single pixel repeated count times
+			file.read((char*)pixel, (std::streamsize)pixelLength);
+			for (size_t i = pixelLength; i < packetLength; i++) {
+				pixel[i] = pixel[i - pixelLength];
+			}
+		}
+		else {
+			// Raw packet - count pixels stored as they are
+			file.read((char*)pixel, (std::streamsize)packetLength);
+		}
+		if (!file.good()) {
+			return false;
+		}
+		pixel += packetLength;
+	}
+	return true;
+}
+
+/// <summary>
+/// Encode the pixels to run length encoded packets one row at a time, a packet never continues on the next row
+/// Two or more same pixels make a run packet, the pixels between them make raw packets
+/// </summary>
+/// <param name="file">Output Stream to which the packets are written</param>
+/// <param name="image">Image from which the pixels are read</param>
+/// <returns>Returns if the packets have been successfully written</returns>
+bool TGACodec::writeRunLengthPixels(std::ostream& file, const Image& image) {
+	const size_t pixelLength = image.channels;
+	const size_t rowLength = image.getRowLength();
+	// Every packet takes a single byte more than its pixels and holds at least one pixel, so a row never takes more than this
+	std::vector<uint8_t> packets(rowLength + image.width);
+
+	for (size_t y = 0; y < image.height; y++) {
+		const uint8_t* row = image.pixels + y * rowLength;
+		auto samePixels = [&](size_t a, size_t b) {
+			return std::memcmp(row + a * pixelLength, row + b * pixelLength, pixelLength) == 0;
+		};
+
+		size_t length = 0;
+		for (size_t x = 0; x < image.width;) {
+			size_t run = 1;
+			while (x + run < image.width && run < _maxPacketLength && samePixels(x, x + run)) {
+				run++;
+			}
+			if (run >= 2) {
+				packets[length++] = (uint8_t)(0x80 | (run - 1));
+				std::memcpy(&packets[length], row + x * pixelLength, pixelLength);
+				length += pixelLength;
+				x += run;
+				continue;
+			}
+
+			// Raw packet ends before the next pair of same pixels, which starts a run packet
+			size_t count = 1;
+			while (x + count < image.width && count < _maxPacketLength
+				&& !(x + count + 1 < image.width && samePixels(x + count, x + count + 1))) {
+				count++;
+			}
+			packets[length++] = (uint8_t)(count - 1);
+			std::memcpy(&packets[length], row + x * pixelLength, count * pixelLength);
+			length += count * pixelLength;
+			x += count;
+		}
+		file.write((const char*)packets.data(), (std::streamsize)length);
+	}
+	return file.good();
+}
+
+/// <summary>
+/// Determine from the first bytes of the file if it is a .tga file
+/// The format has no signature - no color map, a supported image type and an empty color map specification are expected
+/// </summary>
+/// <param name="bytes">First bytes of the file</param>
+/// <param name="length">Number of bytes, at most sniffLength</param>
+/// <returns>Returns true if the file is a .tga file</returns>
+bool TGACodec::sniff(const uint8_t* bytes, size_t length) {
+	if (length < 8 || bytes[1] != 0) {
+		return false;
+	}
+
+	const uint8_t imageType = bytes[2] & ~_runLengthType;
+	if (imageType != _trueColorType && imageType != _grayscaleType) {
+		return false;
+	}
+	for (size_t i = 3; i < 8; i++) {
+		if (bytes[i] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// Read the header of a .tga file, every byte up to the pixel data is kept, so the header is written back exactly as it has been read
+/// </summary>
+/// <param name="file">Input Stream of the .tga file - opened file or its data in memory</param>
+/// <param name="image">Image to which header data will be saved</param>
+/// <returns>Returns if the .tga header has been successfully read</returns>
+bool TGACodec::readHeader(std::istream& file, Image& image) {
+	image.fileType = FileType::TGA;
+
+	TGAImage tga;
+	std::string& header = tga.rawHeader;
+	header.resize(_headerSize);
+	file.read(&header[0], header.size());
+	if (!file.good()) {
+		return false;
+	}
+
+	tga.idLength = (uint8_t)header[0];
+	tga.colorMapType = (uint8_t)header[1];
+	tga.imageType = (uint8_t)header[2];
+	image.width = readField(header, 12);
+	image.height = readField(header, 14);
+	tga.pixelDepth = (uint8_t)header[16];
+	tga.descriptor = (uint8_t)header[17];
+
+	// Grayscale of 8 bits, true color of 24 or 32 bits, rows stored from left to right
+	const uint8_t imageType = tga.imageType & ~_runLengthType;
+	const bool grayscale = imageType == _grayscaleType && tga.pixelDepth == 8;
+	const bool trueColor = imageType == _trueColorType && (tga.pixelDepth == 24 || tga.pixelDepth == 32);
+	if (tga.colorMapType != 0 || (!grayscale && !trueColor) || (tga.descriptor & 0x10) || image.width == 0 || image.height == 0) {
+		std::cout << "Error: Unsupported TGA format" << std::endl;
+		return false;
+	}
+
+	// Image id follows the header, it is kept with it
+	header.resize(_headerSize + tga.idLength);
+	file.read(&header[_headerSize], tga.idLength);
+	if (!file.good()) {
+		return false;
+	}
+
+	image.bitsPerPixel = tga.pixelDepth;
+	image.channels = (uint8_t)(tga.pixelDepth / 8);
+	image.rowDirection = (tga.descriptor & 0x20) ? 1 : -1;
+	image.dataOffset = (uint32_t)header.size();
+	// Length of run length encoded pixels is known once they have been read
+	image.dataSize = (tga.imageType & _runLengthType) ? 0 : (uint32_t)image.getChannelCount();
+	image.fileSize = image.dataOffset + image.dataSize;
+	image.tga = tga;
+
+	// Uncompressed pixels have to be in the rest of the file
+	const uint64_t remaining = Helpers::getRemainingLength(file);
+	if (!isRunLengthEncoded(image)) {
+		return image.fitsInFile(image.getRowLength(), remaining);
+	}
+	// Packet of a count and one pixel repeats it at most _maxPacketLength times, which still bounds the pixels by the file
+	const uint64_t packets = remaining / (1 + image.channels) + 1;
+	return image.hasSupportedSize() && image.fitsInFile(image.width, std::min(packets, UINT64_MAX / _maxPacketLength) * _maxPacketLength);
+}
+
+/// <summary>
+/// Read the pixels of a .tga file, the header has been read and the pixels allocated
+/// Everything after the pixels of an uncompressed image is kept, see TGAImage::trailer
+/// </summary>
+/// <param name="file">Input Stream of the .tga file - opened file or its data in memory</param>
+/// <param name="image">Image to which data will be saved</param>
+/// <returns>Returns if the .tga image has been successfully read</returns>
+bool TGACodec::readPixels(std::istream& file, Image& image) {
+	file.seekg(image.dataOffset);
+	if (isRunLengthEncoded(image)) {
+		if (!readRunLengthPixels(file, image)) {
+			return false;
+		}
+		image.dataSize = (uint32_t)((uint64_t)file.tellg() - image.dataOffset);
+		image.fileSize = image.dataOffset + image.dataSize;
+		return true;
+	}
+
+	const size_t length = image.getChannelCount();
+	file.read((char*)image.pixels, (std::streamsize)length);
+	if ((size_t)file.gcount() != length) {
+		return false;
+	}
+
+	// Extension area and footer point into the file, they stay valid since the pixels keep their length
+	image.tga.trailer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+/// <summary>
+/// Save the image data to a .tga file, the header read from the file or made by createHeader is written unchanged
+/// Run length encoded images are encoded again
+/// </summary>
+/// <param name="file">Output Stream to which the .tga file is saved</param>
+/// <param name="image">Image from which data will be read from</param>
+/// <returns>Returns if the .tga image has been successfully saved</returns>
+bool TGACodec::write(std::ostream& file, const Image& image) {
+	if (image.tga.rawHeader.size() != image.dataOffset) {
+		return false;
+	}
+	file.write(image.tga.rawHeader.data(), image.tga.rawHeader.size());
+
+	if (isRunLengthEncoded(image)) {
+		return writeRunLengthPixels(file, image);
+	}
+
+	file.write((const char*)image.pixels, (std::streamsize)image.getChannelCount());
+	file.write(image.tga.trailer.data(), image.tga.trailer.size());
+
+	// The caller closes the file, return success
+	return file.good();
+}
+
+/// <summary>
+/// Position of the channel in the file, so a changed channel could be written in place
+/// Pixels of uncompressed images are stored one after another right after the header, run length encoded pixels are not
+/// </summary>
+/// <param name="image">Image read from the file, only header data is used</param>
+/// <param name="channel">Index of the channel - byte of the pixels</param>
+/// <param name="offset">Modifies the passed offset with the position of the channel in the file</param>
+/// <returns>Returns false if the channel has no fixed position in the file</returns>
+bool TGACodec::getChannelOffset(const Image& image, size_t channel, uint64_t& offset) {
+	if (isRunLengthEncoded(image)) {
+		return false;
+	}
+
+	offset = image.dataOffset + channel;
+	return true;
+}
+
+/// <summary>
+/// Fill the header for saving the pixels as an uncompressed bottom up .tga file, e.g. pixels read from another format
+/// 1 channel is stored as grayscale, 3 and 4 channels as true color
+/// Only width, height and channels of the image are used, the rest of the header is replaced
+/// </summary>
+/// <param name="image">Image which header will be filled</param>
+/// <returns>Returns false if the channels of the image could not be stored</returns>
+bool TGACodec::createHeader(Image& image) {
+	if ((image.channels != 1 && image.channels != 3 && image.channels != 4) || image.width > UINT16_MAX || image.height > UINT16_MAX) {
+		return false;
+	}
+
+	TGAImage tga;
+	tga.idLength = 0;
+	tga.colorMapType = 0;
+	tga.imageType = image.channels == 1 ? _grayscaleType : _trueColorType;
+	tga.pixelDepth = (uint8_t)(image.channels * 8);
+	// Alpha bits of every pixel, rows stored from the bottom
+	tga.descriptor = image.channels == 4 ? 8 : 0;
+
+	std::string& header = tga.rawHeader;
+	header.assign(_headerSize, '\0');
+	header[2] = (char)tga.imageType;
+	writeField(header, 12, (uint16_t)image.width);
+	writeField(header, 14, (uint16_t)image.height);
+	header[16] = (char)tga.pixelDepth;
+	header[17] = (char)tga.descriptor;
+
+	image.fileType = FileType::TGA;
+	image.bitsPerPixel = tga.pixelDepth;
+	image.rowDirection = -1;
+	image.dataOffset = _headerSize;
+	image.dataSize = (uint32_t)image.getChannelCount();
+	image.fileSize = image.dataOffset + image.dataSize;
+	image.tga = tga;
+	return true;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <cstdint>
+#include <cstring>
+
+#include "structs.hpp"
+#include "enums.hpp"
+
+/// <summary>
+/// Codec for reading and writing .tga images, registered in CodecRegistry
+/// True color images of 24 or 32 bits and grayscale images of 8 bits are supported, both uncompressed and run length encoded.
+/// Images with a color map and images stored from right to left are not supported
+/// </summary>
+class TGACodec {
+private:
+	/// <summary>
+	/// Number of bytes of the header, the image id and the color map follow
+	/// </summary>
+	static const uint32_t _headerSize = 18;
+	/// <summary>
+	/// Largest number of pixels held by a single packet of run length encoded data
+	/// </summary>
+	static const size_t _maxPacketLength = 128;
+	/// <summary>
+	/// Image types of the header - uncompressed, the run length encoded types add this to the type
+	/// </summary>
+	static const uint8_t _trueColorType = 2;
+	static const uint8_t _grayscaleType = 3;
+	static const uint8_t _runLengthType = 8;
+
+	/// <summary>
+	/// Read the little endian number from the bytes of the header
+	/// </summary>
+	/// <param name="header">Bytes of the header</param>
+	/// <param name="offset">Position of the number in the header</param>
+	/// <returns>Returns the number</returns>
+	static uint16_t readField(const std::string& header, size_t offset) {
+		return (uint16_t)((uint8_t)header[offset] | ((uint8_t)header[offset + 1] << 8));
+	}
+	/// <summary>
+	/// Store the little endian number into the bytes of the header
+	/// </summary>
+	/// <param name="header">Bytes of the header</param>
+	/// <param name="offset">Position of the number in the header</param>
+	/// <param name="value">Number that is stored</param>
+	static void writeField(std::string& header, size_t offset, uint16_t value) {
+		header[offset] = (char)(value & 0xFF);
+		header[offset + 1] = (char)(value >> 8);
+	}
+	/// <summary>
+	/// Check if the image data is run length encoded
+	/// </summary>
+	/// <param name="image">Image read from the file, only header data is used</param>
+	/// <returns>Returns true for image types 10 and 11</returns>
+	static bool isRunLengthEncoded(const Image& image) {
+		return (image.tga.imageType & _runLengthType) != 0;
+	}
+	/// <summary>
+	/// Decode the run length encoded packets straight into the pixels, a packet may continue on the next row
+	/// </summary>
+	/// <param name="file">Input Stream positioned at the first packet</param>
+	/// <param name="image">Image to which the pixels are saved</param>
+	/// <returns>Returns false if the packets end before the last pixel</returns>
+	static bool readRunLengthPixels(std::istream& file, Image& image);
+	/// <summary>
+	/// Encode the pixels to run length encoded packets one row at a time, a packet never continues on the next row
+	/// Two or more same pixels make a run packet, the pixels between them make raw packets
+	/// </summary>
+	/// <param name="file">Output Stream to which the packets are written</param>
+	/// <param name="image">Image from which the pixels are read</param>
+	/// <returns>Returns if the packets have been successfully written</returns>
+	static bool writeRunLengthPixels(std::ostream& file, const Image& image);
+
+public:
+	/// <summary>
+	/// Type of the files handled by this codec
+	/// </summary>
+	static constexpr FileType fileType = FileType::TGA;
+	/// <summary>
+	/// Layout of the channels as they are read and written - blue, green, red and alpha order
+	/// Rows are stored from the bottom of the picture unless bit 5 of the descriptor is set, see Image::rowDirection
+	/// </summary>
+	static constexpr bool reversedChannels = true;
+
+	/// <summary>
+	/// Determine from the first bytes of the file if it is a .tga file
+	/// The format has no signature - no color map, a supported image type and an empty color map specification are expected
+	/// </summary>
+	/// <param name="bytes">First bytes of the file</param>
+	/// <param name="length">Number of bytes, at most sniffLength</param>
+	/// <returns>Returns true if the file is a .tga file</returns>
+	static bool sniff(const uint8_t* bytes, size_t length);
+	/// <summary>
+	/// Read the header of a .tga file, every byte up to the pixel data is kept, so the header is written back exactly as it has been read
+	/// </summary>
+	/// <param name="file">Input Stream of the .tga file - opened file or its data in memory</param>
+	/// <param name="image">Image to which header data will be saved</param>
+	/// <returns>Returns if the .tga header has been successfully read</returns>
+	static bool readHeader(std::istream& file, Image& image);
+	/// <summary>
+	/// Read the pixels of a .tga file, the header has been read and the pixels allocated
+	/// Everything after the pixels of an uncompressed image is kept, see TGAImage::trailer
+	/// </summary>
+	/// <param name="file">Input Stream of the .tga file - opened file or its data in memory</param>
+	/// <param name="image">Image to which data will be saved</param>
+	/// <returns>Returns if the .tga image has been successfully read</returns>
+	static bool readPixels(std::istream& file, Image& image);
+	/// <summary>
+	/// Save the image data to a .tga file, the header read from the file or made by createHeader is written unchanged
+	/// Run length encoded images are encoded again
+	/// </summary>
+	/// <param name="file">Output Stream to which the .tga file is saved</param>
+	/// <param name="image">Image from which data will be read from</param>
+	/// <returns>Returns if the .tga image has been successfully saved</returns>
+	static bool write(std::ostream& file, const Image& image);
+	/// <summary>
+	/// Position of the channel in the file, so a changed channel could be written in place
+	/// Pixels of uncompressed images are stored one after another right after the header, run length encoded pixels are not
+	/// </summary>
+	/// <param name="image">Image read from the file, only header data is used</param>
+	/// <param name="channel">Index of the channel - byte of the pixels</param>
+	/// <param name="offset">Modifies the passed offset with the position of the channel in the file</param>
+	/// <returns>Returns false if the channel has no fixed position in the file</returns>
+	static bool getChannelOffset(const Image& image, size_t channel, uint64_t& offset);
+	/// <summary>
+	/// Fill the header for saving the pixels as an uncompressed bottom up .tga file, e.g. pixels read from another format
+	/// 1 channel is stored as grayscale, 3 and 4 channels as true color
+	/// Only width, height and channels of the image are used, the rest of the header is replaced
+	/// </summary>
+	/// <param name="image">Image which header will be filled</param>
+	/// <returns>Returns false if the channels of the image could not be stored</returns>
+	static bool createHeader(Image& image);
+};
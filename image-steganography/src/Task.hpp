@@ -0,0 +1,156 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+/// <summary>
+/// Result of a coroutine that is awaited by another coroutine, e.g. bool status = co_await handler.loadImage(...)
+///
+/// The coroutine starts only once it is awaited and resumes the awaiting one when it finishes,
+/// so a chain of stages runs on whichever thread the last stage was resumed on.
+/// The outermost task is started by Task::start or waited for by Task::wait.
+/// </summary>
+/// <typeparam name="T">Type of the result</typeparam>
+template <typename T>
+class Task {
+public:
+	struct promise_type;
+	typedef std::coroutine_handle<promise_type> Handle;
+
+	/// <summary>
+	/// State of the coroutine shared with the task - its result and the coroutine awaiting it
+	/// </summary>
+	struct promise_type {
+		T value{};
+		std::exception_ptr exception;
+		std::coroutine_handle<> continuation;
+
+		/// <summary>
+		/// Awaitable of the end of the coroutine, hands the thread over to the awaiting coroutine
+		/// </summary>
+		struct FinalAwaiter {
+			bool await_ready() const noexcept {
+				return false;
+			}
+			std::coroutine_handle<> await_suspend(Handle handle) const noexcept {
+				std::coroutine_handle<> continuation = handle.promise().continuation;
+				return continuation ? continuation : std::noop_coroutine();
+			}
+			void await_resume() const noexcept {}
+		};
+
+		Task get_return_object() {
+			return Task(Handle::from_promise(*this));
+		}
+		std::suspend_always initial_suspend() const noexcept {
+			return {};
+		}
+		FinalAwaiter final_suspend() const noexcept {
+			return {};
+		}
+		void return_value(T result) {
+			value = std::move(result);
+		}
+		void unhandled_exception() {
+			exception = std::current_exception();
+		}
+	};
+
+private:
+	/// <summary>
+	/// Coroutine that starts the task and hands over its result, destroys itself once it finishes
+	/// </summary>
+	struct Detached {
+		struct promise_type {
+			Detached get_return_object() const noexcept {
+				return {};
+			}
+			std::suspend_never initial_suspend() const noexcept {
+				return {};
+			}
+			std::suspend_never final_suspend() const noexcept {
+				return {};
+			}
+			void return_void() const noexcept {}
+			void unhandled_exception() const noexcept {
+				std::terminate();
+			}
+		};
+	};
+
+	Handle _handle;
+
+	/// <summary>
+	/// Await the task and pass its result to the callback
+	/// </summary>
+	static Detached run(Task task, std::function<void(T)> done) {
+		done(co_await task);
+	}
+
+public:
+	explicit Task(Handle handle) : _handle(handle) {}
+	Task(Task&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+	/// <summary>
+	/// Destructor, destroys the coroutine - a task must not be destroyed while it is running
+	/// </summary>
+	~Task() {
+		if (_handle) {
+			_handle.destroy();
+		}
+	}
+
+	bool await_ready() const noexcept {
+		return !_handle || _handle.done();
+	}
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) const noexcept {
+		_handle.promise().continuation = continuation;
+		return _handle;
+	}
+	T await_resume() {
+		// Empty task, e.g. one that has been moved from, is ready at once and has no result
+		if (!_handle) {
+			return T{};
+		}
+		if (_handle.promise().exception) {
+			std::rethrow_exception(_handle.promise().exception);
+		}
+		return std::move(_handle.promise().value);
+	}
+
+	/// <summary>
+	/// Start the task without waiting for it, the callback gets the result on the thread the task finished on
+	/// </summary>
+	/// <param name="task">Task that will be started</param>
+	/// <param name="done">Callback that gets the result</param>
+	static void start(Task task, std::function<void(T)> done) {
+		run(std::move(task), std::move(done));
+	}
+	/// <summary>
+	/// Start the task and block the calling thread until it finishes
+	/// The calling thread must not be a thread of the executor the task runs on
+	/// </summary>
+	/// <param name="task">Task that will be started</param>
+	/// <returns>Returns the result of the task</returns>
+	static T wait(Task task) {
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool finished = false;
+		T result{};
+		run(std::move(task), [&](T value) {
+			std::lock_guard<std::mutex> lock(mutex);
+			result = std::move(value);
+			finished = true;
+			// Notified under the lock, the waiting thread could return and destroy the condition right after it is released
+			condition.notify_one();
+		});
+
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&]() { return finished; });
+		return result;
+	}
+};
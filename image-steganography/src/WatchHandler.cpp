@@ -0,0 +1,373 @@
+#pragma once
+#include "WatchHandler.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <iomanip>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <cstring>
+
+namespace {
+	// Event loop woken up by SIGINT or SIGTERM, the handler may only touch these
+	volatile sig_atomic_t signalReceived = 0;
+	int signalWakeFd = -1;
+
+	void handleSignal(int) {
+		signalReceived = 1;
+		uint64_t one = 1;
+		if (signalWakeFd >= 0) {
+			ssize_t written = write(signalWakeFd, &one, sizeof(one));
+			(void)written;
+		}
+	}
+}
+#endif
+
+/// <summary>
+/// Worker loop - takes the files from the queue until the watch stops
+/// </summary>
+void WatchHandler::workerLoop() {
+	while (true) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(_jobsMutex);
+			_jobsCondition.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+			if (_jobs.empty()) {
+				return;
+			}
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+		_spaceCondition.notify_one();
+
+		const Clock::time_point start = Clock::now();
+		std::string result;
+		bool status = false;
+		try {
+			status = handleFile(job.path, result);
+		}
+		catch (const std::exception& exception) {
+			// File that could not be handled, e.g. too large to allocate, is logged as failed and the worker goes on
+			result = exception.what();
+		}
+		const Clock::time_point end = Clock::now();
+
+		const double latency = std::chrono::duration<double, std::milli>(end - job.arrival).count();
+		const double queued = std::chrono::duration<double, std::milli>(start - job.arrival).count();
+		std::lock_guard<std::mutex> lock(_outputMutex);
+		_latencies.push_back(latency);
+		_failedCount += status ? 0 : 1;
+		std::cout << std::fixed << std::setprecision(2) << job.path << ": " << (status ? "" : "failed - ") << result
+			<< " (" << latency << " ms, queued " << queued << " ms)" << std::endl;
+	}
+}
+
+/// <summary>
+/// Handle a single file with the chosen operation
+/// </summary>
+/// <param name="path">Path of the file in the watched directory</param>
+/// <param name="result">Modifies the passed result with a short description of the outcome</param>
+/// <returns>Returns true if the operation succeeded</returns>
+bool WatchHandler::handleFile(const std::string& path, std::string& result) const {
+	if (_fileHandler->detectFileType(path) == FileType::UNKNOWN) {
+		result = "not a supported image";
+		return false;
+	}
+
+	const std::filesystem::path name = std::filesystem::path(path).filename();
+	switch (_operation) {
+	case DaemonOperation::OP_PROBE:
+		result = _fileHandler->checkIfCanRead(path) ? "holds a message" : "holds no message";
+		return true;
+	case DaemonOperation::OP_DECODE: {
+		std::string message;
+		if (!_fileHandler->readEncodedMessage(path, message)) {
+			result = "holds no message";
+			return false;
+		}
+
+		const std::string outputPath = (std::filesystem::path(_outputDirectory) / name).string() + ".txt";
+		std::ofstream output(outputPath, std::ios::binary);
+		if (!output.write(message.data(), message.length())) {
+			result = "unable to write " + outputPath;
+			return false;
+		}
+		result = "message of " + std::to_string(message.length()) + " bytes written to " + outputPath;
+		return true;
+	}
+	case DaemonOperation::OP_ENCODE: {
+		std::ifstream sidecar(path + _sidecarExtension, std::ios::binary);
+		if (!sidecar.is_open()) {
+			result = "unable to read " + path + _sidecarExtension;
+			return false;
+		}
+		std::string message((std::istreambuf_iterator<char>(sidecar)), std::istreambuf_iterator<char>());
+
+		// The watched file stays untouched, the encoded image is saved to the output directory
+		Image image;
+		if (!_fileHandler->loadImage(path, image)) {
+			result = "unable to read the image";
+			return false;
+		}
+		const std::string outputPath = (std::filesystem::path(_outputDirectory) / name).string();
+		bool status = false;
+		if (_fileHandler->probeImage(image)) {
+			result = "holds a message already";
+		}
+		else if (!_fileHandler->embedMessage(image, message, _options)) {
+			result = "message of " + std::to_string(message.length()) + " bytes does not fit";
+		}
+		else if (!_fileHandler->saveImage(outputPath, image)) {
+			result = "unable to write " + outputPath;
+		}
+		else {
+			result = "message of " + std::to_string(message.length()) + " bytes encoded to " + outputPath;
+			status = true;
+		}
+		_fileHandler->unloadImage(image);
+		return status;
+	}
+	default:
+		result = "unsupported operation";
+		return false;
+	}
+}
+
+/// <summary>
+/// Queue every file of the directory that has not been seen yet or changed since and forget the removed ones, used once the kernel drops events
+/// </summary>
+/// <param name="directory">Watched directory</param>
+void WatchHandler::rescanDirectory(const std::string& directory) {
+	std::vector<std::string> paths;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.is_regular_file()) {
+			paths.push_back(entry.path().string());
+		}
+	}
+
+	// Files removed while the events were dropped are forgotten
+	for (auto seen = _seen.begin(); seen != _seen.end();) {
+		seen = std::filesystem::exists(seen->first, error) ? std::next(seen) : _seen.erase(seen);
+	}
+
+	std::sort(paths.begin(), paths.end());
+	const Clock::time_point arrival = Clock::now();
+	for (const std::string& path : paths) {
+		addFile(path, arrival);
+	}
+}
+
+/// <summary>
+/// Print the number of handled files and the latency percentiles
+/// </summary>
+void WatchHandler::printSummary() {
+	std::lock_guard<std::mutex> lock(_outputMutex);
+	std::cout << "Files: " << _latencies.size() << " (failed " << _failedCount << ")" << std::endl;
+	if (_latencies.empty()) {
+		return;
+	}
+
+	std::sort(_latencies.begin(), _latencies.end());
+	auto percentile = [this](double p) {
+		return _latencies[std::min(_latencies.size() - 1, (size_t)(p / 100 * _latencies.size()))];
+	};
+	std::cout << std::fixed << std::setprecision(2)
+		<< "Latency ms - p50: " << percentile(50) << " p90: " << percentile(90) << " p99: " << percentile(99)
+		<< " max: " << _latencies.back() << std::endl;
+}
+
+#ifdef __linux__
+/// <summary>
+/// Decide whether the new file should be queued and queue it, waiting while the queue is full
+/// </summary>
+/// <param name="path">Path of the file that arrived</param>
+/// <param name="arrival">Time the event has been read</param>
+void WatchHandler::addFile(const std::string& path, Clock::time_point arrival) {
+	// Hidden files are the usual temporaries of producers that rename the finished file in
+	if (std::filesystem::path(path).filename().string().rfind('.', 0) == 0) {
+		return;
+	}
+
+	std::string imagePath = path;
+	if (_operation == DaemonOperation::OP_ENCODE) {
+		// Image is queued by whichever of the image and its sidecar arrives last
+		if (Helpers::endsWith(path, _sidecarExtension)) {
+			imagePath = path.substr(0, path.length() - std::strlen(_sidecarExtension));
+			if (!std::filesystem::is_regular_file(imagePath)) {
+				return;
+			}
+		}
+		else if (!std::filesystem::is_regular_file(path + _sidecarExtension)) {
+			return;
+		}
+	}
+
+	// Writer closing the file more than once or a rescan gives the same version, which is queued only once
+	FileVersion version;
+	if (!getVersion(imagePath, version)) {
+		return;
+	}
+	auto seen = _seen.find(imagePath);
+	if (seen != _seen.end() && seen->second == version) {
+		return;
+	}
+	_seen[imagePath] = version;
+
+	{
+		std::unique_lock<std::mutex> lock(_jobsMutex);
+		while (_jobs.size() >= _queueCapacity && !signalReceived) {
+			_spaceCondition.wait_for(lock, std::chrono::milliseconds(100));
+		}
+		_jobs.push_back({ imagePath, arrival });
+	}
+	_jobsCondition.notify_one();
+}
+
+/// <summary>
+/// Read the version of the image and for the encode operation of its sidecar
+/// </summary>
+/// <param name="path">Path of the image</param>
+/// <param name="version">Modifies the passed version</param>
+/// <returns>Returns false if the image or its sidecar is no longer there</returns>
+bool WatchHandler::getVersion(const std::string& path, FileVersion& version) const {
+	struct stat status;
+	if (stat(path.c_str(), &status) != 0) {
+		return false;
+	}
+	version.device = (uint64_t)status.st_dev;
+	version.inode = (uint64_t)status.st_ino;
+	version.size = (uint64_t)status.st_size;
+	version.modified = (int64_t)status.st_mtim.tv_sec * 1000000000 + status.st_mtim.tv_nsec;
+
+	// New message written for the same image is encoded again
+	if (_operation == DaemonOperation::OP_ENCODE) {
+		if (stat((path + _sidecarExtension).c_str(), &status) != 0) {
+			return false;
+		}
+		version.sidecarModified = (int64_t)status.st_mtim.tv_sec * 1000000000 + status.st_mtim.tv_nsec;
+	}
+	return true;
+}
+
+/// <summary>
+/// Watch the directory and handle every new file until the process receives SIGINT or SIGTERM
+/// </summary>
+/// <param name="directory">Watched directory</param>
+/// <param name="workerCount">Number of threads handling the files</param>
+/// <param name="queueCapacity">Number of files waiting for a worker before the event loop waits, 0 for twice the workers</param>
+/// <returns>Returns false if the watch could not be started</returns>
+bool WatchHandler::run(const std::string& directory, size_t workerCount, size_t queueCapacity) {
+	std::error_code error;
+	if (!std::filesystem::is_directory(directory, error)) {
+		std::cout << "Error: " << directory << " is not a directory" << std::endl;
+		return false;
+	}
+	if (_operation != DaemonOperation::OP_PROBE) {
+		std::filesystem::create_directories(_outputDirectory, error);
+		if (!std::filesystem::is_directory(_outputDirectory, error)) {
+			std::cout << "Error: unable to create the output directory " << _outputDirectory << std::endl;
+			return false;
+		}
+		if (std::filesystem::equivalent(directory, _outputDirectory, error)) {
+			std::cout << "Error: the output directory must differ from the watched directory" << std::endl;
+			return false;
+		}
+	}
+
+	int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd < 0 || inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM) < 0) {
+		std::cout << "Error: unable to watch " << directory << ": " << std::strerror(errno) << std::endl;
+		if (inotifyFd >= 0) {
+			close(inotifyFd);
+		}
+		return false;
+	}
+
+	int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	signalWakeFd = wakeFd;
+	signalReceived = 0;
+	signal(SIGINT, handleSignal);
+	signal(SIGTERM, handleSignal);
+
+	// Workers share warm pixel buffers, every image read by them comes from the pool
+	workerCount = std::max<size_t>(1, workerCount);
+	_queueCapacity = queueCapacity > 0 ? queueCapacity : workerCount * 2;
+	BufferPool bufferPool(workerCount * 2);
+	_fileHandler->setBufferPool(&bufferPool);
+	_stopping = false;
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < workerCount; i++) {
+		workers.emplace_back(&WatchHandler::workerLoop, this);
+	}
+	std::cout << "Watching " << directory << " with " << workerCount << " workers and a queue of " << _queueCapacity << " files" << std::endl;
+
+	pollfd fds[2] = { { inotifyFd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+	alignas(inotify_event) char readBuffer[64 * 1024];
+	while (!signalReceived) {
+		int count = poll(fds, 2, -1);
+		if (count < 0 && errno != EINTR) {
+			break;
+		}
+		if (count <= 0 || !(fds[0].revents & POLLIN)) {
+			continue;
+		}
+
+		ssize_t readBytes;
+		while (!signalReceived && (readBytes = read(inotifyFd, readBuffer, sizeof(readBuffer))) > 0) {
+			const Clock::time_point arrival = Clock::now();
+			for (ssize_t offset = 0; offset < readBytes && !signalReceived;) {
+				const inotify_event* event = (const inotify_event*)(readBuffer + offset);
+				offset += sizeof(inotify_event) + event->len;
+				if (event->mask & IN_Q_OVERFLOW) {
+					std::cout << "Warning: events have been dropped, listing the directory again" << std::endl;
+					rescanDirectory(directory);
+				}
+				else if (event->mask & IN_IGNORED) {
+					std::cout << "Error: the watched directory has been removed" << std::endl;
+					signalReceived = 1;
+				}
+				else if (event->len > 0 && (event->mask & (IN_DELETE | IN_MOVED_FROM))) {
+					_seen.erase((std::filesystem::path(directory) / event->name).string());
+				}
+				else if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+					addFile((std::filesystem::path(directory) / event->name).string(), arrival);
+				}
+			}
+		}
+	}
+
+	// Let the workers finish the queued files and stop, set under the lock so no worker misses the wake up
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		_stopping = true;
+	}
+	_jobsCondition.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	_fileHandler->setBufferPool(nullptr);
+	signalWakeFd = -1;
+	close(wakeFd);
+	close(inotifyFd);
+	printSummary();
+	std::cout << "Watch stopped" << std::endl;
+	return true;
+}
+#else
+void WatchHandler::addFile(const std::string& path, Clock::time_point arrival) {}
+
+bool WatchHandler::run(const std::string& directory, size_t workerCount, size_t queueCapacity) {
+	std::cout << "Error: watch mode is supported only on Linux" << std::endl;
+	return false;
+}
+#endif
@@ -0,0 +1,160 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <iostream>
+
+#include "enums.hpp"
+#include "structs.hpp"
+#include "FileHandler.hpp"
+#include "BufferPool.hpp"
+
+/// <summary>
+/// Long running mode that handles every file written or moved into the watched directory
+///
+/// The directory is watched with inotify - a file is queued once it has been closed after writing or renamed into the directory,
+/// so a producer that writes elsewhere and renames the file in is never read half written.
+/// The queue is bounded, once it is full the event loop waits for the workers and the kernel keeps the events meanwhile.
+/// If the kernel drops events the directory is listed again and every file not seen before is queued.
+/// A file written again or replaced under the same name is queued again, repeated events of the same version are not.
+///
+/// Probe prints whether the image holds a message, decode writes the message to <output directory>/<name>.txt,
+/// encode hides the content of the sidecar <name>.msg and saves the image to <output directory>/<name> - the image is queued
+/// once both files are present, whichever arrives last. Results are never written to the watched directory.
+/// Every file prints its latency from the arrival of the event to the end of the operation.
+/// </summary>
+class WatchHandler {
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	/// <summary>
+	/// File waiting for a worker
+	/// </summary>
+	struct Job {
+		std::string path;
+		Clock::time_point arrival;
+	};
+
+	/// <summary>
+	/// Version of a queued file - device, inode, size and time of the last change of the image
+	/// and the time of the last change of its sidecar for the encode operation
+	/// </summary>
+	struct FileVersion {
+		uint64_t device = 0;
+		uint64_t inode = 0;
+		uint64_t size = 0;
+		int64_t modified = 0;
+		int64_t sidecarModified = 0;
+
+		bool operator==(const FileVersion& other) const {
+			return device == other.device && inode == other.inode && size == other.size
+				&& modified == other.modified && sidecarModified == other.sidecarModified;
+		}
+	};
+
+	/// <summary>
+	/// Pointer to file handler that handles the files
+	/// </summary>
+	FileHandler* _fileHandler;
+	/// <summary>
+	/// Operation done with every file - probe, decode or encode
+	/// </summary>
+	DaemonOperation _operation;
+	/// <summary>
+	/// Directory to which the decoded messages and encoded images are written
+	/// </summary>
+	std::string _outputDirectory;
+	/// <summary>
+	/// Options used by the encode operation
+	/// </summary>
+	EncodeOptions _options;
+	/// <summary>
+	/// Extension of the sidecar files holding the messages to encode
+	/// </summary>
+	static constexpr const char* _sidecarExtension = ".msg";
+
+	std::mutex _jobsMutex;
+	std::condition_variable _jobsCondition;
+	std::condition_variable _spaceCondition;
+	std::deque<Job> _jobs;
+	size_t _queueCapacity = 0;
+	std::atomic<bool> _stopping;
+	/// <summary>
+	/// Version of every queued file that is still in the directory, used only by the event loop
+	/// Entries are dropped once the file is deleted or moved away, so a reused name is handled again
+	/// </summary>
+	std::unordered_map<std::string, FileVersion> _seen;
+
+	std::mutex _outputMutex;
+	/// <summary>
+	/// Latency of every handled file in microseconds
+	/// </summary>
+	std::vector<double> _latencies;
+	size_t _failedCount = 0;
+
+	/// <summary>
+	/// Worker loop - takes the files from the queue until the watch stops
+	/// </summary>
+	void workerLoop();
+	/// <summary>
+	/// Handle a single file with the chosen operation
+	/// </summary>
+	/// <param name="path">Path of the file in the watched directory</param>
+	/// <param name="result">Modifies the passed result with a short description of the outcome</param>
+	/// <returns>Returns true if the operation succeeded</returns>
+	bool handleFile(const std::string& path, std::string& result) const;
+	/// <summary>
+	/// Decide whether the new file should be queued and queue it, waiting while the queue is full
+	/// </summary>
+	/// <param name="path">Path of the file that arrived</param>
+	/// <param name="arrival">Time the event has been read</param>
+	void addFile(const std::string& path, Clock::time_point arrival);
+	/// <summary>
+	/// Read the version of the image and for the encode operation of its sidecar
+	/// </summary>
+	/// <param name="path">Path of the image</param>
+	/// <param name="version">Modifies the passed version</param>
+	/// <returns>Returns false if the image or its sidecar is no longer there</returns>
+	bool getVersion(const std::string& path, FileVersion& version) const;
+	/// <summary>
+	/// Queue every file of the directory that has not been seen yet or changed since and forget the removed ones, used once the kernel drops events
+	/// </summary>
+	/// <param name="directory">Watched directory</param>
+	void rescanDirectory(const std::string& directory);
+	/// <summary>
+	/// Print the number of handled files and the latency percentiles
+	/// </summary>
+	void printSummary();
+
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="fileHandler">File handler used to handle the files</param>
+	/// <param name="operation">Operation done with every file - probe, decode or encode</param>
+	/// <param name="outputDirectory">Directory for the results of decode and encode, unused by probe</param>
+	/// <param name="options">Options used by the encode operation</param>
+	WatchHandler(FileHandler* fileHandler, DaemonOperation operation, const std::string& outputDirectory, const EncodeOptions& options) {
+		_fileHandler = fileHandler;
+		_operation = operation;
+		_outputDirectory = outputDirectory;
+		_options = options;
+		_stopping = false;
+	}
+	~WatchHandler() {}
+
+	/// <summary>
+	/// Watch the directory and handle every new file until the process receives SIGINT or SIGTERM
+	/// </summary>
+	/// <param name="directory">Watched directory</param>
+	/// <param name="workerCount">Number of threads handling the files</param>
+	/// <param name="queueCapacity">Number of files waiting for a worker before the event loop waits, 0 for twice the workers</param>
+	/// <returns>Returns false if the watch could not be started</returns>
+	bool run(const std::string& directory, size_t workerCount, size_t queueCapacity = 0);
+};
@@ -0,0 +1,330 @@
+#pragma once
+#include "Y4MHandler.hpp"
+
+/// <summary>
+/// Read the stream header and calculate the size of every frame
+/// </summary>
+/// <param name="input">Stream positioned at the beginning of the video</param>
+/// <param name="header">Header to which data will be saved</param>
+/// <returns>Returns true if the header describes supported 8 bit video</returns>
+bool Y4MHandler::readHeader(std::istream& input, Y4MHeader& header) const {
+	if (!std::getline(input, header.line) || header.line.compare(0, 10, "YUV4MPEG2 ") != 0) {
+		std::cout << "Error: Invalid Y4M format" << std::endl;
+		return false;
+	}
+
+	header.width = 0;
+	header.height = 0;
+	header.colorSpace = "420jpeg"; // Default when the header does not say
+	std::stringstream ss(header.line.substr(10));
+	std::string token;
+	while (ss >> token) {
+		switch (token[0]) {
+		case 'W':
+			header.width = std::atoi(token.c_str() + 1);
+			break;
+		case 'H':
+			header.height = std::atoi(token.c_str() + 1);
+			break;
+		case 'C':
+			header.colorSpace = token.substr(1);
+			break;
+		}
+	}
+
+	// Chroma planes are subsampled depending on the color space
+	const size_t luma = (size_t)header.width * header.height;
+	const size_t halfWidth = (header.width + 1) / 2;
+	const size_t halfHeight = (header.height + 1) / 2;
+	// High bit depth color spaces (e.g. 420p10) use two bytes per sample and are not supported
+	const size_t depth = header.colorSpace.find('p');
+	if (depth != std::string::npos && depth + 1 < header.colorSpace.length() && std::isdigit((unsigned char)header.colorSpace[depth + 1])) {
+		std::cout << "Error: unsupported Y4M color space " << header.colorSpace << std::endl;
+		return false;
+	}
+
+	if (header.colorSpace.compare(0, 3, "420") == 0) {
+		header.frameSize = luma + 2 * halfWidth * halfHeight;
+	}
+	else if (header.colorSpace == "422") {
+		header.frameSize = luma + 2 * halfWidth * header.height;
+	}
+	else if (header.colorSpace == "444") {
+		header.frameSize = 3 * luma;
+	}
+	else if (header.colorSpace == "mono") {
+		header.frameSize = luma;
+	}
+	else {
+		std::cout << "Error: unsupported Y4M color space " << header.colorSpace << std::endl;
+		return false;
+	}
+	return luma > 0;
+}
+
+/// <summary>
+/// Read the next frame of the video
+/// </summary>
+/// <param name="input">Stream positioned at the beginning of the frame</param>
+/// <param name="header">Header of the video</param>
+/// <param name="frame">Frame to which data will be saved, its buffers are reused</param>
+/// <returns>Returns false at the end of the video or for a broken frame</returns>
+bool Y4MHandler::readFrame(std::istream& input, const Y4MHeader& header, Y4MFrame& frame) const {
+	std::string line;
+	if (!std::getline(input, line) || line.compare(0, 5, "FRAME") != 0) {
+		return false;
+	}
+
+	frame.parameters = line.substr(5);
+	frame.data.resize(header.frameSize);
+	input.read(&frame.data[0], header.frameSize);
+	return (size_t)input.gcount() == header.frameSize;
+}
+
+/// <summary>
+/// Number of bytes of the message every frame holds - one bit per sample, whole bytes only
+/// </summary>
+/// <param name="header">Header of the video</param>
+/// <returns>Returns number of bytes held by a single frame</returns>
+size_t Y4MHandler::getBytesPerFrame(const Y4MHeader& header) const {
+	return header.frameSize / 8;
+}
+
+/// <summary>
+/// Stream the frames through the pipeline - read in order, processed in parallel, consumed in order
+/// </summary>
+/// <param name="input">Stream positioned at the first frame</param>
+/// <param name="header">Header of the video</param>
+/// <param name="process">Called for every frame on the worker threads</param>
+/// <param name="consume">Called for every processed frame in order, returns false to stop the pipeline</param>
+/// <param name="needFrame">Called before reading a frame, returns false to stop reading</param>
+/// <returns>Returns number of frames consumed</returns>
+size_t Y4MHandler::runPipeline(std::istream& input, const Y4MHeader& header,
+	const std::function<void(Y4MFrame&)>& process,
+	const std::function<bool(Y4MFrame&)>& consume,
+	const std::function<bool(size_t)>& needFrame) const {
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<Y4MFrame> work;          // frames read, waiting for a worker
+	std::map<size_t, Y4MFrame> done;    // frames processed, waiting for their turn
+	std::vector<Y4MFrame> freeFrames;   // buffers of consumed frames, reused by the reader
+	size_t inFlight = 0;
+	size_t framesRead = 0;
+	bool readerDone = false;
+	bool stopped = false;
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < std::max(1u, std::thread::hardware_concurrency()); i++) {
+		workers.emplace_back([&]() {
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true) {
+				changed.wait(lock, [&]() { return !work.empty() || readerDone || stopped; });
+				if (work.empty()) {
+					return;
+				}
+				Y4MFrame frame = std::move(work.front());
+				work.pop_front();
+
+				lock.unlock();
+				process(frame);
+				lock.lock();
+				const size_t index = frame.index;
+				done.emplace(index, std::move(frame));
+				changed.notify_all();
+			}
+		});
+	}
+
+	size_t consumed = 0;
+	std::thread writer([&]() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			changed.wait(lock, [&]() { return done.count(consumed) > 0 || (readerDone && consumed == framesRead) || stopped; });
+			if (stopped || done.count(consumed) == 0) {
+				return;
+			}
+			Y4MFrame frame = std::move(done[consumed]);
+			done.erase(consumed);
+
+			lock.unlock();
+			bool keepGoing = consume(frame);
+			lock.lock();
+			freeFrames.push_back(std::move(frame));
+			inFlight--;
+			consumed++;
+			stopped = !keepGoing;
+			changed.notify_all();
+		}
+	});
+
+	// Read the frames on this thread, never more than the limit at once
+	for (size_t index = 0; needFrame(index); index++) {
+		Y4MFrame frame;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			changed.wait(lock, [&]() { return inFlight < _maxFramesInFlight || stopped; });
+			if (stopped) {
+				break;
+			}
+			if (!freeFrames.empty()) {
+				frame = std::move(freeFrames.back());
+				freeFrames.pop_back();
+			}
+		}
+
+		if (!readFrame(input, header, frame)) {
+			break;
+		}
+		frame.index = index;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		work.push_back(std::move(frame));
+		inFlight++;
+		framesRead++;
+		changed.notify_all();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		readerDone = true;
+		changed.notify_all();
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	writer.join();
+	return consumed;
+}
+
+/// <summary>
+/// Encode the message across the frames of the video and save the result to the output
+/// Frames after the message are copied unchanged
+/// </summary>
+/// <param name="inputPath">Path of the video that holds the message</param>
+/// <param name="outputPath">Path to which the encoded video will be saved</param>
+/// <param name="message">Message that will be encoded in the video</param>
+/// <returns>Returns true if the whole message has been encoded</returns>
+bool Y4MHandler::encodeMessage(const std::string& inputPath, const std::string& outputPath, const std::string& message) const {
+	std::ifstream input(inputPath, std::ios::binary);
+	Y4MHeader header;
+	if (!input.is_open() || !readHeader(input, header)) {
+		return false;
+	}
+
+	// Constant message, length and the message itself form one stream of bytes spread over the frames
+	std::string prefix = _messageEncoded;
+	for (size_t i = 0; i < _lengthSize; i++) {
+		prefix.push_back((char)(((uint64_t)message.length() >> (8 * i)) & 0xFF));
+	}
+	const size_t streamLength = prefix.length() + message.length();
+	const size_t bytesPerFrame = getBytesPerFrame(header);
+	const size_t framesNeeded = (streamLength + bytesPerFrame - 1) / bytesPerFrame;
+
+	// Check the number of frames up front, assuming plain FRAME lines
+	std::error_code error;
+	const size_t fileSize = std::filesystem::file_size(inputPath, error);
+	if (!error && (fileSize - header.line.length() - 1) / (header.frameSize + 6) < framesNeeded) {
+		std::cout << "Error: message is too long to fit in the video" << std::endl;
+		return false;
+	}
+
+	std::ofstream output(outputPath, std::ios::binary);
+	if (!output.is_open()) {
+		return false;
+	}
+	output << header.line << "\n";
+
+	auto process = [&](Y4MFrame& frame) {
+		const size_t start = frame.index * bytesPerFrame;
+		const size_t end = std::min(start + bytesPerFrame, streamLength);
+		uint8_t* samples = (uint8_t*)&frame.data[0];
+		for (size_t position = start; position < end; position++) {
+			const unsigned char c = position < prefix.length() ? prefix[position] : message[position - prefix.length()];
+			for (int bit = 7; bit >= 0; bit--, samples++) {
+				*samples = (*samples & ~1) | ((c >> bit) & 1);
+			}
+		}
+	};
+	auto consume = [&](Y4MFrame& frame) {
+		output << "FRAME" << frame.parameters << "\n";
+		output.write(frame.data.data(), frame.data.size());
+		return output.good();
+	};
+	size_t framesWritten = runPipeline(input, header, process, consume, [](size_t) { return true; });
+
+	if (framesWritten < framesNeeded) {
+		std::cout << "Error: message is too long to fit in the video" << std::endl;
+		return false;
+	}
+	return output.good();
+}
+
+/// <summary>
+/// Decode the message from the frames of the video and write it to the output as frames are processed
+/// Reading stops at the frame that holds the end of the message
+/// </summary>
+/// <param name="inputPath">Path of the video that holds the message</param>
+/// <param name="output">Stream to which the message will be written</param>
+/// <returns>Returns true if the whole message has been decoded</returns>
+bool Y4MHandler::decodeMessage(const std::string& inputPath, std::ostream& output) const {
+	std::ifstream input(inputPath, std::ios::binary);
+	Y4MHeader header;
+	if (!input.is_open() || !readHeader(input, header)) {
+		return false;
+	}
+
+	const size_t bytesPerFrame = getBytesPerFrame(header);
+	const size_t prefixLength = _messageEncoded.length() + _lengthSize;
+	if (bytesPerFrame < prefixLength) {
+		return false;
+	}
+
+	// Known once the first frame has been consumed, until then frames are read ahead
+	std::atomic<size_t> framesNeeded(SIZE_MAX);
+	size_t remaining = 0;
+	bool encoded = false;
+
+	auto process = [&](Y4MFrame& frame) {
+		frame.payload.resize(bytesPerFrame);
+		const uint8_t* samples = (const uint8_t*)frame.data.data();
+		for (size_t i = 0; i < bytesPerFrame; i++, samples += 8) {
+			unsigned char letter = 0;
+			for (int bit = 0; bit < 8; bit++) {
+				letter = (letter << 1) | (samples[bit] & 1);
+			}
+			frame.payload[i] = letter;
+		}
+	};
+	auto consume = [&](Y4MFrame& frame) {
+		size_t offset = 0;
+		if (frame.index == 0) {
+			if (frame.payload.compare(0, _messageEncoded.length(), _messageEncoded) != 0) {
+				return false;
+			}
+			uint64_t length = 0;
+			for (size_t i = 0; i < _lengthSize; i++) {
+				length |= (uint64_t)(unsigned char)frame.payload[_messageEncoded.length() + i] << (8 * i);
+			}
+			encoded = true;
+			remaining = length;
+			framesNeeded = (prefixLength + length + bytesPerFrame - 1) / bytesPerFrame;
+			offset = prefixLength;
+		}
+
+		const size_t length = std::min(remaining, frame.payload.length() - offset);
+		output.write(frame.payload.data() + offset, length);
+		remaining -= length;
+		return remaining > 0 && output.good();
+	};
+	runPipeline(input, header, process, consume, [&](size_t index) { return index < framesNeeded; });
+
+	if (!encoded) {
+		return false;
+	}
+	if (remaining > 0) {
+		std::cout << "Error: video ends before the end of the message" << std::endl;
+		return false;
+	}
+	output.flush();
+	return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+
+#include "structs.hpp"
+
+/// <summary>
+/// Class for hiding the message in uncompressed YUV4MPEG2 (.y4m) video
+/// Every frame is a carrier - the message continues from one frame to the next, one bit in LSB of every sample
+/// Frames are streamed through a bounded pipeline, so only a few frames are in memory at once
+/// </summary>
+class Y4MHandler {
+private:
+	/// <summary>
+	/// Constant message that is encoded at the beginning of the first frame
+	/// </summary>
+	const std::string _messageEncoded = "msgEncoded";
+	/// <summary>
+	/// Number of bytes of the message length stored after the constant message
+	/// </summary>
+	const size_t _lengthSize = 8;
+	/// <summary>
+	/// Number of frames read but not written yet, limits the memory used by the pipeline
+	/// </summary>
+	size_t _maxFramesInFlight;
+
+	/// <summary>
+	/// Read the stream header and calculate the size of every frame
+	/// </summary>
+	/// <param name="input">Stream positioned at the beginning of the video</param>
+	/// <param name="header">Header to which data will be saved</param>
+	/// <returns>Returns true if the header describes supported 8 bit video</returns>
+	bool readHeader(std::istream& input, Y4MHeader& header) const;
+	/// <summary>
+	/// Read the next frame of the video
+	/// </summary>
+	/// <param name="input">Stream positioned at the beginning of the frame</param>
+	/// <param name="header">Header of the video</param>
+	/// <param name="frame">Frame to which data will be saved, its buffers are reused</param>
+	/// <returns>Returns false at the end of the video or for a broken frame</returns>
+	bool readFrame(std::istream& input, const Y4MHeader& header, Y4MFrame& frame) const;
+	/// <summary>
+	/// Number of bytes of the message every frame holds - one bit per sample, whole bytes only
+	/// </summary>
+	/// <param name="header">Header of the video</param>
+	/// <returns>Returns number of bytes held by a single frame</returns>
+	size_t getBytesPerFrame(const Y4MHeader& header) const;
+	/// <summary>
+	/// Stream the frames through the pipeline - read in order, processed in parallel, consumed in order
+	/// </summary>
+	/// <param name="input">Stream positioned at the first frame</param>
+	/// <param name="header">Header of the video</param>
+	/// <param name="process">Called for every frame on the worker threads</param>
+	/// <param name="consume">Called for every processed frame in order, returns false to stop the pipeline</param>
+	/// <param name="needFrame">Called before reading a frame, returns false to stop reading</param>
+	/// <returns>Returns number of frames consumed</returns>
+	size_t runPipeline(std::istream& input, const Y4MHeader& header,
+		const std::function<void(Y4MFrame&)>& process,
+		const std::function<bool(Y4MFrame&)>& consume,
+		const std::function<bool(size_t)>& needFrame) const;
+
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	Y4MHandler() {
+		_maxFramesInFlight = 2 * std::max(1u, std::thread::hardware_concurrency());
+	}
+	~Y4MHandler() {}
+
+	/// <summary>
+	/// Encode the message across the frames of the video and save the result to the output
+	/// Frames after the message are copied unchanged
+	/// </summary>
+	/// <param name="inputPath">Path of the video that holds the message</param>
+	/// <param name="outputPath">Path to which the encoded video will be saved</param>
+	/// <param name="message">Message that will be encoded in the video</param>
+	/// <returns>Returns true if the whole message has been encoded</returns>
+	bool encodeMessage(const std::string& inputPath, const std::string& outputPath, const std::string& message) const;
+	/// <summary>
+	/// Decode the message from the frames of the video and write it to the output as frames are processed
+	/// Reading stops at the frame that holds the end of the message
+	/// </summary>
+	/// <param name="inputPath">Path of the video that holds the message</param>
+	/// <param name="output">Stream to which the message will be written</param>
+	/// <returns>Returns true if the whole message has been decoded</returns>
+	bool decodeMessage(const std::string& inputPath, std::ostream& output) const;
+};
@@ -13,17 +13,55 @@ enum Messages {
 	MSG_UNABLE_TO_ENCODE,
 	MSG_UNABLE_TO_DECODE,
 	MSG_NOT_ENCODED,
-	MSG_MISSING_MESSAGE_TO_ENCODE
+	MSG_MISSING_MESSAGE_TO_ENCODE,
+	MSG_NOT_A_DIRECTORY,
+	MSG_INVALID_OPTION
+};
+
+enum DaemonOperation {
+	OP_ENCODE = 1,
+	OP_DECODE = 2,
+	OP_PROBE = 3,
+	OP_CAPACITY = 4
+};
+
+enum DaemonStatus {
+	STATUS_OK = 0,
+	STATUS_ERROR = 1,
+	STATUS_BAD_REQUEST = 2
+};
+
+enum AsyncStage {
+	STAGE_LOAD,
+	STAGE_PROBE,
+	STAGE_EMBED,
+	STAGE_EXTRACT,
+	STAGE_SAVE,
+	STAGE_DONE
+};
+
+const std::unordered_map<AsyncStage, std::string> asyncStageToString = {
+	{AsyncStage::STAGE_LOAD, "load"},
+	{AsyncStage::STAGE_PROBE, "probe"},
+	{AsyncStage::STAGE_EMBED, "embed"},
+	{AsyncStage::STAGE_EXTRACT, "extract"},
+	{AsyncStage::STAGE_SAVE, "save"},
+	{AsyncStage::STAGE_DONE, "done"}
 };
 
 enum FileType {
+	UNKNOWN = 0,
 	BMP = 0x4D42,
-	PNG = 0xD8FF,
+	PNG = 0x5089,
 	PPM = 0x5030,
+	PGM = 0x5035,
+	TGA = 0x4754,
 };
 
 const std::unordered_map<FileType, std::string> fileTypeToString = {
 	{FileType::BMP, "BMP"},
 	{FileType::PNG, "PNG"},
-	{FileType::PPM, "PPM"}
+	{FileType::PPM, "PPM"},
+	{FileType::PGM, "PGM"},
+	{FileType::TGA, "TGA"}
 };
\ No newline at end of file
@@ -0,0 +1,8 @@
+#pragma once
+
+// SSE2 is part of every x64 target, 32 bit MSVC builds have it with /arch:SSE2
+// Kernels guarded by SIMD_SSE2 keep a scalar version for the other targets
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_SSE2 1
+#endif
@@ -1,6 +1,8 @@
 #pragma once
 #include "enums.hpp"
 #include <string>
+#include <vector>
+#include <cstddef>
 
 struct BMPImage {
 	uint16_t fileType;
@@ -18,6 +20,16 @@ struct BMPImage {
 	uint32_t yPixelsPerMeter;
 	uint32_t colorsInColorTable;
 	uint32_t importantColorCount;
+	// Color masks of bit fields compression (3 or 6), 0 when the header has none
+	uint32_t redMask = 0;
+	uint32_t greenMask = 0;
+	uint32_t blueMask = 0;
+	uint32_t alphaMask = 0;
+	// Height is stored negative - rows go from the top of the picture
+	bool topDown = false;
+	// Every byte before the pixel data - file header, info header of any version (40, 52, 56, 108 or 124 bytes),
+	// color masks and the gap up to dataOffset, written back unchanged
+	std::string rawHeader;
 };
 
 struct PPMImage {
@@ -28,17 +40,49 @@ struct PPMImage {
 	uint32_t max_value;
 };
 
-// Structure to hold the data for a single image pixel
-struct Pixel {
-	uint8_t red;
-	uint8_t green;
-	uint8_t blue;
+struct PNGImage {
+	uint8_t bitDepth;
+	uint8_t colorType;
+	uint8_t compressionMethod;
+	uint8_t filterMethod;
+	uint8_t interlaceMethod;
+	// Whole chunks (length, type, data and CRC) before and after the image data, written back unchanged
+	std::vector<std::string> chunksBeforeData;
+	std::vector<std::string> chunksAfterData;
+	// Compress harder when the image is written - smaller file, slower
+	bool bestCompression = false;
+};
+
+struct PGMImage {
+	std::string magicNumber;
+	std::string comments;
+	uint32_t width;
+	uint32_t height;
+	uint32_t maxValue;
+	// Samples above 255 take 2 bytes, big endian - the pixels hold the lower bytes, which carry the lowest bits,
+	// and the higher bytes are kept here to be written back unchanged
+	std::string highBytes;
+};
+
+struct TGAImage {
+	uint8_t idLength;
+	uint8_t colorMapType;
+	// 2 - true color, 3 - grayscale, 10 and 11 - the same compressed with run length encoding
+	uint8_t imageType;
+	uint8_t pixelDepth;
+	// Bits 0 - 3 alpha bits of every pixel, bit 5 rows stored from the top of the picture
+	uint8_t descriptor;
+	// Every byte before the pixel data - 18 byte header, image id and color map, written back unchanged
+	std::string rawHeader;
+	// Extension area, developer area and footer of TGA 2.0 after the pixel data, kept only for uncompressed images
+	// because the offsets they hold stay valid only while the pixel data keeps its length
+	std::string trailer;
 };
 
 // Structure to hold the data for an entire image
 struct Image {
-	// stored as 1D array
-	Pixel* pixels;
+	// Channels of every pixel one after another, stored as 1D array of width * height * channels bytes
+	uint8_t* pixels = nullptr;
 	std::string last_modified_time;
 	
 	FileType fileType;
@@ -48,7 +92,198 @@ struct Image {
 	uint32_t height;
 	uint16_t bitsPerPixel;
 	uint32_t dataSize;
+	// Number of channels of every pixel in the order of the file - 1 gray, 3 color, 4 color with alpha
+	uint8_t channels = 3;
+
+	// Order of the rows in the file and in pixels - 1 from the top of the picture, -1 from the bottom (most .bmp files)
+	// Pixels are kept in the order of the file, the picture is walked with the signed stride instead of reordering the rows
+	int rowDirection = 1;
 
 	BMPImage bmp;
 	PPMImage ppm;
-};
\ No newline at end of file
+	PNGImage png;
+	PGMImage pgm;
+	TGAImage tga;
+
+	// Largest number of channels of an image whose size cannot be checked against the file, e.g. compressed pixels
+	static constexpr uint64_t maxChannelCount = (uint64_t)1 << 30;
+
+	// Number of channels of a single row
+	size_t getRowLength() const {
+		return (size_t)width * channels;
+	}
+	// Number of channels of the whole image
+	size_t getChannelCount() const {
+		return getRowLength() * height;
+	}
+	// Check that height rows of rowBytes bytes each fit in the bytes the file has left for the pixels
+	// Compared by division, so dimensions of a broken header cannot overflow the product
+	bool fitsInFile(uint64_t rowBytes, uint64_t available) const {
+		return rowBytes == 0 || height <= available / rowBytes;
+	}
+	// Check that the image has at most maxChannelCount channels, for formats whose pixel data is compressed
+	bool hasSupportedSize() const {
+		const uint64_t rowLength = getRowLength();
+		return rowLength == 0 || height <= maxChannelCount / rowLength;
+	}
+	// Distance between the channels of picture row y and row y + 1, negative when the rows are stored from the bottom
+	ptrdiff_t getRowStride() const {
+		return rowDirection * (ptrdiff_t)getRowLength();
+	}
+	// First channel of the top row of the picture, row y starts at getTopRow() + y * getRowStride()
+	uint8_t* getTopRow() const {
+		return rowDirection > 0 || height == 0 ? pixels : pixels + (size_t)(height - 1) * getRowLength();
+	}
+};
+
+// Rectangle of the image the message is confined to, rows are counted in the order they are stored in the file
+// Width 0 takes the rest of every row from x, a region without rows is the whole image
+struct RegionOfInterest {
+	uint32_t x = 0;
+	uint32_t y = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+
+	bool operator==(const RegionOfInterest& other) const {
+		return x == other.x && y == other.y && width == other.width && height == other.height;
+	}
+};
+
+// Options chosen by the user for encoding the message
+struct EncodeOptions {
+	// Level of error correction - 0 (none) to 3, see ErrorCorrection
+	int fecLevel = 0;
+	// Compress PNG images harder when they are written
+	bool bestCompression = false;
+	// Store the message in the most textured pixels instead of from the first pixel, see CostMapHandler
+	bool adaptive = false;
+	// Store the message only in the pixels of the region, which is read and written without the rest of the image
+	RegionOfInterest region;
+	// Number of bits hidden by changing at most one channel of every 2^level - 1, 0 for one bit per channel, see MatrixEmbedding
+	int matrixLevel = 0;
+	// Set the lowest bits by adding or subtracting 1 at random instead of replacing them, see SanitizeHandler::matchImage
+	bool lsbMatching = false;
+	// Seed of the random changes of LSB matching, 0 picks a different seed every time
+	uint64_t matchingSeed = 0;
+};
+
+// Header stored after the constant message in images encoded with extended options
+struct MessageHeader {
+	uint32_t messageLength;
+	// Length of the data stored in the pixels - message with parity bytes
+	uint32_t encodedLength;
+	uint8_t fecLevel;
+	// Data is stored in the channels chosen by the cost map, saved in the highest bit of the fecLevel byte
+	bool adaptive = false;
+	// Message is confined to a region, saved in the second highest bit of the fecLevel byte
+	// The region follows the header copies, the marker, header and data are stored in the region's pixels
+	bool region = false;
+	// Level of the matrix embedding of the data, saved in bits 2 - 4 of the fecLevel byte
+	uint8_t matrixLevel = 0;
+};
+
+// Position and encoding of the data of the stored message, enough to extract the data without the rest of the image
+struct PayloadLayout {
+	// Index of the channel where the data starts
+	size_t dataStart = 0;
+	uint32_t messageLength = 0;
+	// Length of the data stored in the pixels - message with parity bytes
+	uint32_t encodedLength = 0;
+	uint8_t fecLevel = 0;
+	uint8_t matrixLevel = 0;
+	// Data is stored in the channels chosen by the cost map of the whole image, so it could not be read in order
+	bool adaptive = false;
+};
+
+// Header of a YUV4MPEG2 video - the line is kept to be written back unchanged
+struct Y4MHeader {
+	std::string line;
+	uint32_t width;
+	uint32_t height;
+	std::string colorSpace;
+	// Number of bytes of every frame - all planes
+	size_t frameSize;
+};
+
+// Single frame of a YUV4MPEG2 video
+struct Y4MFrame {
+	size_t index;
+	// Everything after FRAME on the frame's line
+	std::string parameters;
+	// Samples of every plane
+	std::string data;
+	// Bytes of the message extracted from the frame
+	std::string payload;
+};
+
+// Capacity of the image computed from its header
+struct CapacityReport {
+	// Longest message that fits in the image
+	size_t maxMessageLength = 0;
+	// Channels that could hold a bit of the message
+	size_t availableChannels = 0;
+	// Channels needed for the requested message together with the constant message and header
+	size_t requiredChannels = 0;
+	bool fits = false;
+};
+
+// Structure to hold a single part of the message split across many images
+struct Shard {
+	std::string filePath;
+	std::string payloadId;
+	uint32_t sequence;
+	uint32_t total;
+	std::string data;
+};
+// Result of probing a single file during the scan of a directory tree, saved in ProbeIndex
+struct ProbeRecord {
+	std::string filePath;
+	// Size and last write time of the file when it was probed, the file is probed again when they change
+	uint64_t fileSize = 0;
+	int64_t modifiedTime = 0;
+	// UNKNOWN for files that are not images
+	FileType fileType = FileType::UNKNOWN;
+	// The image holds a message encoded by this program
+	bool encoded = false;
+	uint64_t messageLength = 0;
+	// Longest message that fits without extended options
+	uint64_t capacity = 0;
+};
+// Result of comparing the original image with the modified one
+struct CompareReport {
+	// Header fields that differ, e.g. "width: 100 -> 200"
+	std::vector<std::string> headerDifferences;
+	// Bytes of the files before the pixel data that differ, only for formats storing the pixels at fixed positions
+	size_t headerBytesChanged = 0;
+	// Both images have the same width and height, the pixels are compared only then
+	bool sameDimensions = false;
+	size_t totalBytes = 0;
+	size_t changedBytes = 0;
+	size_t changedBits = 0;
+	// Changed bits other than the lowest bit of the channel
+	size_t changedHigherBits = 0;
+	// Bounding box of the changed pixels, inclusive, valid only when some byte changed
+	uint32_t minX = 0;
+	uint32_t minY = 0;
+	uint32_t maxX = 0;
+	uint32_t maxY = 0;
+	// Largest difference of a single channel
+	uint8_t maxDifference = 0;
+	// Peak signal to noise ratio in dB, infinity for identical pixels
+	double psnr = 0;
+};
+// Result of the steganalysis of a single image
+struct SteganalysisReport {
+	std::string filePath;
+	// Probability that the LSBs of the whole image carry a message, chi-square pair of values test
+	double chiSquareProbability = 0;
+	// Part of the image, counted from the first pixel, over which the chi-square test detects a message
+	double chiSquarePrefix = 0;
+	// Estimated part of the channels carrying a message, RS analysis
+	double rsEstimate = 0;
+	// Final score 0 - 1, estimated part of the image carrying a message
+	double score = 0;
+	bool suspicious = false;
+	// The image holds the constant message of this program
+	bool ownMarker = false;
+};